@@ -0,0 +1,636 @@
+
+//
+// @NOTE : clock_gettime and syscall (for perf_event_open) require posix and default declarations
+//
+#define _DEFAULT_SOURCE
+
+//
+// Site of the current allocator call, library sets it through SDSF_ALLOCATION_SITE_HOOK
+//
+static _Thread_local int benchAllocationSite;
+#define SDSF_ALLOCATION_SITE_HOOK(site) (benchAllocationSite = (site))
+
+#define SDSF_IMPL
+#include "../simple_data_storage_format.h"
+#include "bench_counters.h"
+#include "bench_common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//
+// Benchmark generates deterministic documents of several shapes and measures deserialization, every serializer path
+// and freeing of deserialized result. Every operation is repeated and median time is reported.
+// If hardware counters are available, they are averaged over repeats and reported per input byte and per value.
+// With --alloc every operation runs once with counting allocator, which reports allocator calls, allocated bytes
+// and peak of live bytes per MB of input, both in total and per allocation site
+//
+// Usage : bench [--alloc] [shape name] [scale] [repeat count]
+//
+// @NOTE : mapped file path creates, maps and trims a file per document, so it is expected to be slower than other paths
+// for many tiny files
+//
+
+typedef struct
+{
+    const char* name;
+    void (*generate)(SdsfSerializer* sdsf, size_t docIndex, size_t scale);
+    size_t docCount;    // number of separate documents (per 1 scale unit for many tiny files)
+} BenchShape;
+
+typedef struct
+{
+    size_t  allocCount[SDSF_ALLOCATION_SITE_COUNT];
+    size_t  deallocCount[SDSF_ALLOCATION_SITE_COUNT];
+    size_t  allocBytes[SDSF_ALLOCATION_SITE_COUNT];
+    size_t  deallocBytes[SDSF_ALLOCATION_SITE_COUNT];
+    size_t  liveBytes;
+    size_t  peakLiveBytes;
+} BenchAllocationStats;
+
+typedef struct
+{
+    SdsfSerializedResult*   docs;
+    size_t                  docCount;
+    size_t                  totalSize;
+    size_t                  valueCount;
+} BenchDocs;
+
+void* bench_counting_alloc(size_t size, void* userData)
+{
+    BenchAllocationStats* const stats = (BenchAllocationStats*)userData;
+    stats->allocCount[benchAllocationSite] += 1;
+    stats->allocBytes[benchAllocationSite] += size;
+    stats->liveBytes += size;
+    stats->peakLiveBytes = stats->liveBytes > stats->peakLiveBytes ? stats->liveBytes : stats->peakLiveBytes;
+    return malloc(size);
+}
+
+void bench_counting_dealloc(void* ptr, size_t size, void* userData)
+{
+    BenchAllocationStats* const stats = (BenchAllocationStats*)userData;
+    stats->deallocCount[benchAllocationSite] += 1;
+    stats->deallocBytes[benchAllocationSite] += size;
+    stats->liveBytes -= size;
+    free(ptr);
+}
+
+//
+// Counters are cleared, live bytes are kept, so peak is measured from the current state
+//
+void bench_allocation_stats_reset(BenchAllocationStats* stats)
+{
+    const size_t liveBytes = stats->liveBytes;
+    memset(stats, 0, sizeof(BenchAllocationStats));
+    stats->liveBytes = liveBytes;
+    stats->peakLiveBytes = liveBytes;
+}
+
+// ==============================================================================================================
+//
+// Shapes
+//
+// ==============================================================================================================
+
+void generate_deep(SdsfSerializer* sdsf, size_t docIndex, size_t scale)
+{
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    char name[32];
+    for (size_t chain = 0; chain < 200 * scale; chain++)
+    {
+        snprintf(name, sizeof(name), "chain%zu", chain);
+        sdsf_serialize_composite_start(sdsf, name);
+        for (size_t depth = 0; depth < 256; depth++)
+        {
+            const bool isArray = (depth & 1) != 0;
+            sdsf_serialize_int(sdsf, isArray ? NULL : "depth", (int32_t)depth);
+            sdsf_serialize_float(sdsf, isArray ? NULL : "weight", (float)(bench_random(&state) % 1000) / 10.0f);
+            if (isArray)
+            {
+                sdsf_serialize_composite_start(sdsf, NULL);
+            }
+            else
+            {
+                sdsf_serialize_array_start(sdsf, "next");
+            }
+        }
+        for (size_t depth = 256; depth > 0; depth--)
+        {
+            if (((depth - 1) & 1) != 0)
+            {
+                sdsf_serialize_composite_end(sdsf);
+            }
+            else
+            {
+                sdsf_serialize_array_end(sdsf);
+            }
+        }
+        sdsf_serialize_composite_end(sdsf);
+    }
+}
+
+void generate_wide(SdsfSerializer* sdsf, size_t docIndex, size_t scale)
+{
+    uint64_t state = 0xD1B54A32D192ED03ull;
+    char name[32];
+    sdsf_serialize_composite_start(sdsf, "wide");
+    for (size_t it = 0; it < 300000 * scale; it++)
+    {
+        snprintf(name, sizeof(name), "field%zu", it);
+        switch (it % 4)
+        {
+            case 0: sdsf_serialize_int(sdsf, name, (int32_t)bench_random(&state)); break;
+            case 1: sdsf_serialize_float(sdsf, name, (float)bench_random(&state) / 65536.0f); break;
+            case 2: sdsf_serialize_bool(sdsf, name, (bench_random(&state) & 1) != 0); break;
+            case 3: sdsf_serialize_string(sdsf, name, "value"); break;
+        }
+    }
+    sdsf_serialize_composite_end(sdsf);
+}
+
+void generate_numeric(SdsfSerializer* sdsf, size_t docIndex, size_t scale)
+{
+    uint64_t state = 0x94D049BB133111EBull;
+    sdsf_serialize_array_start(sdsf, "ints");
+    for (size_t it = 0; it < 1000000 * scale; it++)
+    {
+        sdsf_serialize_int(sdsf, NULL, (int32_t)(bench_random(&state) % 2000000) - 1000000);
+    }
+    sdsf_serialize_array_end(sdsf);
+    sdsf_serialize_array_start(sdsf, "floats");
+    for (size_t it = 0; it < 500000 * scale; it++)
+    {
+        sdsf_serialize_float(sdsf, NULL, (float)bench_random(&state) / 4096.0f);
+    }
+    sdsf_serialize_array_end(sdsf);
+    sdsf_serialize_array_start(sdsf, "doubles");
+    for (size_t it = 0; it < 500000 * scale; it++)
+    {
+        sdsf_serialize_double(sdsf, NULL, (double)bench_random(&state) / 3.0);
+    }
+    sdsf_serialize_array_end(sdsf);
+}
+
+void generate_strings(SdsfSerializer* sdsf, size_t docIndex, size_t scale)
+{
+    static const char* const pieces[] = { "word", " ", "quote \"", "back\\slash", "line\n", "\xC3\xA9t\xC3\xA9", "tab\t", "longer piece of text" };
+    uint64_t state = 0xBF58476D1CE4E5B9ull;
+    char text[256];
+    sdsf_serialize_array_start(sdsf, "strings");
+    for (size_t it = 0; it < 300000 * scale; it++)
+    {
+        size_t length = 0;
+        const size_t pieceCount = bench_random(&state) % 8;
+        for (size_t piece = 0; piece < pieceCount; piece++)
+        {
+            const char* const str = pieces[bench_random(&state) % (sizeof(pieces) / sizeof(pieces[0]))];
+            const size_t strLength = strlen(str);
+            memcpy(text + length, str, strLength);
+            length += strLength;
+        }
+        text[length] = '\0';
+        sdsf_serialize_string(sdsf, NULL, text);
+    }
+    sdsf_serialize_array_end(sdsf);
+}
+
+void generate_binary(SdsfSerializer* sdsf, size_t docIndex, size_t scale)
+{
+    uint64_t state = 0x2545F4914F6CDD1Dull;
+    const size_t maxSize = 32768;
+    uint8_t* const data = (uint8_t*)malloc(maxSize);
+    char name[32];
+    for (size_t it = 0; it < 1000 * scale; it++)
+    {
+        const size_t size = 1 + bench_random(&state) % maxSize;
+        for (size_t byte = 0; byte < size; byte++)
+        {
+            data[byte] = (uint8_t)bench_random(&state);
+        }
+        snprintf(name, sizeof(name), "blob%zu", it);
+        sdsf_serialize_binary(sdsf, name, data, size);
+    }
+    free(data);
+}
+
+void generate_tiny(SdsfSerializer* sdsf, size_t docIndex, size_t scale)
+{
+    uint64_t state = 0x5851F42D4C957F2Dull + docIndex;
+    sdsf_serialize_int(sdsf, "id", (int32_t)docIndex);
+    sdsf_serialize_string(sdsf, "name", "tiny document");
+    sdsf_serialize_bool(sdsf, "enabled", (docIndex & 1) != 0);
+    sdsf_serialize_composite_start(sdsf, "position");
+        sdsf_serialize_float(sdsf, "x", (float)bench_random(&state) / 1024.0f);
+        sdsf_serialize_float(sdsf, "y", (float)bench_random(&state) / 1024.0f);
+        sdsf_serialize_float(sdsf, "z", (float)bench_random(&state) / 1024.0f);
+    sdsf_serialize_composite_end(sdsf);
+    sdsf_serialize_array_start(sdsf, "tags");
+        sdsf_serialize_string(sdsf, NULL, "first");
+        sdsf_serialize_string(sdsf, NULL, "second");
+    sdsf_serialize_array_end(sdsf);
+}
+
+static const BenchShape BENCH_SHAPES[] =
+{
+    { "deep",       generate_deep,      1 },
+    { "wide",       generate_wide,      1 },
+    { "numeric",    generate_numeric,   1 },
+    { "strings",    generate_strings,   1 },
+    { "binary",     generate_binary,    1 },
+    { "tiny",       generate_tiny,      5000 },
+};
+
+// ==============================================================================================================
+//
+// Serializer paths
+//
+// ==============================================================================================================
+
+size_t count_values(const SdsfValue* value)
+{
+    const SdsfValuePtrArray* const childs = value->type == SDSF_VALUE_ARRAY ? &value->asArray.childs
+        : value->type == SDSF_VALUE_COMPOSITE ? &value->asComposite.childs : NULL;
+    size_t count = 1;
+    for (size_t it = 0; childs && it < childs->size; it++)
+    {
+        count += count_values(childs->ptr[it]);
+    }
+    return count;
+}
+
+void serialize_value(SdsfSerializer* sdsf, const SdsfValue* value, const SdsfDeserializedResult* dr)
+{
+    switch (value->type)
+    {
+        case SDSF_VALUE_BOOL:   sdsf_serialize_bool(sdsf, value->name, value->asBool); break;
+        case SDSF_VALUE_INT:    sdsf_serialize_int(sdsf, value->name, value->asInt); break;
+        case SDSF_VALUE_FLOAT:  sdsf_serialize_float(sdsf, value->name, value->asFloat); break;
+        case SDSF_VALUE_INT64:  sdsf_serialize_int64(sdsf, value->name, value->asInt64); break;
+        case SDSF_VALUE_UINT64: sdsf_serialize_uint64(sdsf, value->name, value->asUint64); break;
+        case SDSF_VALUE_DOUBLE: sdsf_serialize_double(sdsf, value->name, value->asDouble); break;
+        case SDSF_VALUE_STRING: sdsf_serialize_string(sdsf, value->name, value->asString); break;
+        case SDSF_VALUE_BINARY:
+        {
+            sdsf_serialize_binary(sdsf, value->name, (const char*)dr->binaryData + value->asBinary.dataOffset, value->asBinary.dataSize);
+        } break;
+        case SDSF_VALUE_ARRAY:
+        {
+            sdsf_serialize_array_start(sdsf, value->name);
+            for (size_t it = 0; it < value->asArray.childs.size; it++)
+            {
+                serialize_value(sdsf, value->asArray.childs.ptr[it], dr);
+            }
+            sdsf_serialize_array_end(sdsf);
+        } break;
+        case SDSF_VALUE_COMPOSITE:
+        {
+            sdsf_serialize_composite_start(sdsf, value->name);
+            for (size_t it = 0; it < value->asComposite.childs.size; it++)
+            {
+                serialize_value(sdsf, value->asComposite.childs.ptr[it], dr);
+            }
+            sdsf_serialize_composite_end(sdsf);
+        } break;
+        default: break;
+    }
+}
+
+bool count_bytes(const void* data, size_t dataSize, void* userData)
+{
+    *(size_t*)userData += dataSize;
+    return true;
+}
+
+typedef struct
+{
+    size_t          writtenSize;
+    SdsfOutputSink  next;
+} BenchCountingSink;
+
+bool count_and_forward_bytes(const void* data, size_t dataSize, void* userData)
+{
+    BenchCountingSink* const sink = (BenchCountingSink*)userData;
+    sink->writtenSize += dataSize;
+    return sink->next.write(data, dataSize, sink->next.userData);
+}
+
+typedef enum
+{
+    BENCH_SERIALIZER_MEMORY,
+    BENCH_SERIALIZER_STREAMING,
+    BENCH_SERIALIZER_MAPPED,
+    BENCH_SERIALIZER_COMPRESSED,
+    BENCH_SERIALIZER_PATH_COUNT,
+} BenchSerializerPath;
+
+static const char* const BENCH_SERIALIZER_PATH_NAMES[] =
+{
+    "serialize (memory)",
+    "serialize (streaming)",
+    "serialize (mapped file)",
+    "serialize (lz stream)",
+};
+
+//
+// Returns number of serialized bytes (before compression for compressed path)
+//
+size_t serialize_tree(const SdsfDeserializedResult* dr, BenchSerializerPath path, SdsfAllocator allocator)
+{
+    size_t writtenSize = 0;
+    size_t compressedSize = 0;
+    const SdsfOutputSink counter = { count_bytes, &writtenSize };
+    SdsfCompressor compressor;
+    BenchCountingSink compressorInput;
+    SdsfSerializer sdsf;
+    switch (path)
+    {
+        case BENCH_SERIALIZER_MEMORY:       sdsf = sdsf_serializer_begin(allocator); break;
+        case BENCH_SERIALIZER_STREAMING:    sdsf = sdsf_serializer_begin_streaming(allocator, counter); break;
+        case BENCH_SERIALIZER_MAPPED:       sdsf = sdsf_serializer_begin_mapped(allocator, "bench_mapped_output.sdsf"); break;
+        default:
+        {
+            const SdsfOutputSink compressedCounter = { count_bytes, &compressedSize };
+            sdsf_compressor_begin(&compressor, allocator, sdsf_lz_codec(), compressedCounter);
+            compressorInput.writtenSize = 0;
+            compressorInput.next = sdsf_compressor_sink(&compressor);
+            const SdsfOutputSink compressorInputSink = { count_and_forward_bytes, &compressorInput };
+            sdsf = sdsf_serializer_begin_streaming(allocator, compressorInputSink);
+        } break;
+    }
+
+    for (size_t it = 0; it < dr->topLevelValues.size; it++)
+    {
+        serialize_value(&sdsf, dr->topLevelValues.ptr[it], dr);
+    }
+
+    SdsfSerializedResult sr = {0};
+    const SdsfSerializationError error = sdsf_serializer_end(&sdsf, &sr);
+    if (error)
+    {
+        printf("Serialization error : %s. Description : %s\n", SDSF_SERIALIZATION_ERROR_TO_STR[error], sdsf.errorMsg);
+    }
+    if (path == BENCH_SERIALIZER_COMPRESSED)
+    {
+        sdsf_compressor_end(&compressor);
+        writtenSize = compressorInput.writtenSize;
+    }
+    if (path == BENCH_SERIALIZER_MAPPED)
+    {
+        FILE* const file = fopen("bench_mapped_output.sdsf", "rb");
+        if (file)
+        {
+            fseek(file, 0, SEEK_END);
+            writtenSize = (size_t)ftell(file);
+            fclose(file);
+        }
+        remove("bench_mapped_output.sdsf");
+    }
+    writtenSize += sr.bufferSize;
+    sdsf_serialized_result_free(&sr);
+    return writtenSize;
+}
+
+// ==============================================================================================================
+//
+// Measurement
+//
+// ==============================================================================================================
+
+double median(double* times, size_t count)
+{
+    qsort(times, count, sizeof(double), bench_compare_doubles);
+    return count % 2 ? times[count / 2] : (times[count / 2 - 1] + times[count / 2]) / 2.0;
+}
+
+void report(const char* shape, const char* operation, size_t bytes, size_t values, double seconds,
+    const BenchCounters* counters, const BenchCounterValues* counterValues, size_t repeatCount)
+{
+    printf("%-10s %-26s %10.2f %12.2f %12.2f %10.3f\n",
+        shape, operation, (double)bytes / (1024.0 * 1024.0), (double)bytes / (1024.0 * 1024.0) / seconds, (double)values / 1e6 / seconds, seconds * 1000.0);
+    if (counters->isAnyAvailable)
+    {
+        bench_counters_print(counters, counterValues, "    per byte", (double)bytes * (double)repeatCount);
+        bench_counters_print(counters, counterValues, "    per value", (double)values * (double)repeatCount);
+    }
+}
+
+BenchDocs generate_docs(const BenchShape* shape, size_t scale, SdsfAllocator allocator)
+{
+    BenchDocs docs = {0};
+    docs.docCount = shape->docCount == 1 ? 1 : shape->docCount * scale;
+    docs.docs = (SdsfSerializedResult*)calloc(docs.docCount, sizeof(SdsfSerializedResult));
+    for (size_t it = 0; it < docs.docCount; it++)
+    {
+        SdsfSerializer sdsf = sdsf_serializer_begin(allocator);
+        shape->generate(&sdsf, it, scale);
+        sdsf_serializer_end(&sdsf, &docs.docs[it]);
+        docs.totalSize += docs.docs[it].bufferSize;
+    }
+    return docs;
+}
+
+void run_shape(const BenchShape* shape, size_t scale, size_t repeatCount, SdsfAllocator allocator, BenchCounters* counters)
+{
+    const BenchDocs docs = generate_docs(shape, scale, allocator);
+    SdsfDeserializedResult* const results = (SdsfDeserializedResult*)calloc(docs.docCount, sizeof(SdsfDeserializedResult));
+    double* const deserializeTimes = (double*)calloc(repeatCount, sizeof(double));
+    double* const freeTimes = (double*)calloc(repeatCount, sizeof(double));
+    double* const serializeTimes = (double*)calloc(repeatCount, sizeof(double));
+
+    size_t valueCount = 0;
+    BenchCounterValues deserializeCounters = {0};
+    BenchCounterValues freeCounters = {0};
+    for (size_t repeat = 0; repeat < repeatCount; repeat++)
+    {
+        bench_counters_start(counters);
+        const double deserializeStart = bench_now();
+        for (size_t it = 0; it < docs.docCount; it++)
+        {
+            const SdsfDeserializationError error = sdsf_deserialize(&results[it], docs.docs[it].buffer, docs.docs[it].bufferSize, allocator);
+            if (error)
+            {
+                printf("Deserialization error : %s. Description : %s\n", SDSF_DESERIALIZATION_ERROR_TO_STR[error], results[it].errorMsg);
+            }
+        }
+        deserializeTimes[repeat] = bench_now() - deserializeStart;
+        bench_counters_stop(counters, &deserializeCounters);
+
+        if (repeat == 0)
+        {
+            for (size_t it = 0; it < docs.docCount; it++)
+            {
+                for (size_t value = 0; value < results[it].topLevelValues.size; value++)
+                {
+                    valueCount += count_values(results[it].topLevelValues.ptr[value]);
+                }
+            }
+        }
+
+        bench_counters_start(counters);
+        const double freeStart = bench_now();
+        for (size_t it = 0; it < docs.docCount; it++)
+        {
+            sdsf_deserialized_result_free(&results[it]);
+        }
+        freeTimes[repeat] = bench_now() - freeStart;
+        bench_counters_stop(counters, &freeCounters);
+    }
+    report(shape->name, "deserialize", docs.totalSize, valueCount, median(deserializeTimes, repeatCount), counters, &deserializeCounters, repeatCount);
+    report(shape->name, "deserialized_result_free", docs.totalSize, valueCount, median(freeTimes, repeatCount), counters, &freeCounters, repeatCount);
+
+    //
+    // @NOTE : serializers write the same trees, throughput is measured by the size of produced text
+    //
+    for (size_t it = 0; it < docs.docCount; it++)
+    {
+        sdsf_deserialize(&results[it], docs.docs[it].buffer, docs.docs[it].bufferSize, allocator);
+    }
+    for (int path = 0; path < BENCH_SERIALIZER_PATH_COUNT; path++)
+    {
+        size_t writtenSize = 0;
+        BenchCounterValues serializeCounters = {0};
+        for (size_t repeat = 0; repeat < repeatCount; repeat++)
+        {
+            writtenSize = 0;
+            bench_counters_start(counters);
+            const double serializeStart = bench_now();
+            for (size_t it = 0; it < docs.docCount; it++)
+            {
+                writtenSize += serialize_tree(&results[it], (BenchSerializerPath)path, allocator);
+            }
+            serializeTimes[repeat] = bench_now() - serializeStart;
+            bench_counters_stop(counters, &serializeCounters);
+        }
+        report(shape->name, BENCH_SERIALIZER_PATH_NAMES[path], writtenSize, valueCount, median(serializeTimes, repeatCount), counters, &serializeCounters, repeatCount);
+    }
+
+    for (size_t it = 0; it < docs.docCount; it++)
+    {
+        sdsf_deserialized_result_free(&results[it]);
+        sdsf_serialized_result_free(&docs.docs[it]);
+    }
+    free(results);
+    free(docs.docs);
+    free(deserializeTimes);
+    free(freeTimes);
+    free(serializeTimes);
+}
+
+void report_allocations(const char* shape, const char* operation, const BenchAllocationStats* stats, size_t inputSize, size_t startLiveBytes)
+{
+    const double inputMb = (double)inputSize / (1024.0 * 1024.0);
+    size_t allocCount = 0;
+    size_t deallocCount = 0;
+    size_t allocBytes = 0;
+    for (int site = 0; site < SDSF_ALLOCATION_SITE_COUNT; site++)
+    {
+        allocCount += stats->allocCount[site];
+        deallocCount += stats->deallocCount[site];
+        allocBytes += stats->allocBytes[site];
+    }
+    printf("%-10s %-26s %12.1f %12.1f %12.3f %12.3f\n", shape, operation, (double)allocCount / inputMb, (double)deallocCount / inputMb,
+        (double)allocBytes / (1024.0 * 1024.0) / inputMb, (double)(stats->peakLiveBytes - startLiveBytes) / (1024.0 * 1024.0) / inputMb);
+    for (int site = 0; site < SDSF_ALLOCATION_SITE_COUNT; site++)
+    {
+        if (stats->allocCount[site] || stats->deallocCount[site])
+        {
+            printf("%-10s   %-24s %12.1f %12.1f %12.3f\n", "", SDSF_ALLOCATION_SITE_TO_STR[site] + strlen("SDSF_ALLOCATION_SITE_"),
+                (double)stats->allocCount[site] / inputMb, (double)stats->deallocCount[site] / inputMb, (double)stats->allocBytes[site] / (1024.0 * 1024.0) / inputMb);
+        }
+    }
+}
+
+void run_shape_allocations(const BenchShape* shape, size_t scale)
+{
+    BenchAllocationStats stats = {0};
+    const SdsfAllocator allocator = { bench_counting_alloc, bench_counting_dealloc, &stats };
+    const BenchDocs docs = generate_docs(shape, scale, allocator);
+    SdsfDeserializedResult* const results = (SdsfDeserializedResult*)calloc(docs.docCount, sizeof(SdsfDeserializedResult));
+
+    bench_allocation_stats_reset(&stats);
+    size_t startLiveBytes = stats.liveBytes;
+    for (size_t it = 0; it < docs.docCount; it++)
+    {
+        sdsf_deserialize(&results[it], docs.docs[it].buffer, docs.docs[it].bufferSize, allocator);
+    }
+    report_allocations(shape->name, "deserialize", &stats, docs.totalSize, startLiveBytes);
+
+    bench_allocation_stats_reset(&stats);
+    startLiveBytes = stats.liveBytes;
+    for (size_t it = 0; it < docs.docCount; it++)
+    {
+        sdsf_deserialized_result_free(&results[it]);
+    }
+    report_allocations(shape->name, "deserialized_result_free", &stats, docs.totalSize, startLiveBytes);
+
+    for (size_t it = 0; it < docs.docCount; it++)
+    {
+        sdsf_deserialize(&results[it], docs.docs[it].buffer, docs.docs[it].bufferSize, allocator);
+    }
+    for (int path = 0; path < BENCH_SERIALIZER_PATH_COUNT; path++)
+    {
+        bench_allocation_stats_reset(&stats);
+        startLiveBytes = stats.liveBytes;
+        for (size_t it = 0; it < docs.docCount; it++)
+        {
+            serialize_tree(&results[it], (BenchSerializerPath)path, allocator);
+        }
+        report_allocations(shape->name, BENCH_SERIALIZER_PATH_NAMES[path], &stats, docs.totalSize, startLiveBytes);
+    }
+
+    for (size_t it = 0; it < docs.docCount; it++)
+    {
+        sdsf_deserialized_result_free(&results[it]);
+        sdsf_serialized_result_free(&docs.docs[it]);
+    }
+    free(results);
+    free(docs.docs);
+}
+
+int main(int argc, char** argv)
+{
+    const SdsfAllocator allocator = { bench_alloc, bench_dealloc, NULL };
+    const bool isAllocationMode = argc > 1 && strcmp(argv[1], "--alloc") == 0;
+    const int argOffset = isAllocationMode ? 1 : 0;
+    const char* const shapeFilter = argc > 1 + argOffset && strcmp(argv[1 + argOffset], "all") != 0 ? argv[1 + argOffset] : NULL;
+    const size_t scale = argc > 2 + argOffset ? (size_t)strtoul(argv[2 + argOffset], NULL, 10) : 1;
+    const size_t repeatCount = argc > 3 + argOffset ? (size_t)strtoul(argv[3 + argOffset], NULL, 10) : 3;
+    if (!scale || !repeatCount)
+    {
+        printf("Usage : bench [--alloc] [shape name or all] [scale] [repeat count]\n");
+        return 1;
+    }
+
+    if (isAllocationMode)
+    {
+        printf("%-10s %-26s %12s %12s %12s %12s\n", "shape", "operation (per input MB)", "allocs", "deallocs", "alloc MB", "peak MB");
+        for (size_t it = 0; it < sizeof(BENCH_SHAPES) / sizeof(BENCH_SHAPES[0]); it++)
+        {
+            if (!shapeFilter || strcmp(shapeFilter, BENCH_SHAPES[it].name) == 0)
+            {
+                run_shape_allocations(&BENCH_SHAPES[it], scale);
+            }
+        }
+        return 0;
+    }
+
+    BenchCounters counters;
+    bench_counters_open(&counters);
+    if (!counters.isAnyAvailable)
+    {
+        printf("Hardware counters are not available (see /proc/sys/kernel/perf_event_paranoid), only time is reported\n");
+    }
+
+    printf("%-10s %-26s %10s %12s %12s %10s\n", "shape", "operation", "MB", "MB/s", "Mvalues/s", "median ms");
+    for (size_t it = 0; it < sizeof(BENCH_SHAPES) / sizeof(BENCH_SHAPES[0]); it++)
+    {
+        if (!shapeFilter || strcmp(shapeFilter, BENCH_SHAPES[it].name) == 0)
+        {
+            run_shape(&BENCH_SHAPES[it], scale, repeatCount, allocator, &counters);
+        }
+    }
+    bench_counters_close(&counters);
+    return 0;
+}
@@ -0,0 +1,53 @@
+
+#ifndef _SDSF_BENCH_COMMON_H_
+#define _SDSF_BENCH_COMMON_H_
+
+//
+// Helpers shared by benchmarks and generator : malloc based allocator callbacks, monotonic clock, deterministic random numbers
+// and comparison for sorting of timing samples
+//
+// Translation unit must define _DEFAULT_SOURCE (or _GNU_SOURCE) before any include to get clock_gettime declaration
+//
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+static inline void* bench_alloc(size_t size, void* _)
+{
+    return malloc(size);
+}
+
+static inline void bench_dealloc(void* ptr, size_t size, void* _)
+{
+    free(ptr);
+}
+
+static inline double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+//
+// xorshift generator, so inputs are the same on every run
+//
+static inline uint32_t bench_random(uint64_t* state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return (uint32_t)(x >> 16);
+}
+
+static inline int bench_compare_doubles(const void* a, const void* b)
+{
+    const double left = *(const double*)a;
+    const double right = *(const double*)b;
+    return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+#endif //_SDSF_BENCH_COMMON_H_
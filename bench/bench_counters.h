@@ -0,0 +1,179 @@
+
+#ifndef _SDSF_BENCH_COUNTERS_H_
+#define _SDSF_BENCH_COUNTERS_H_
+
+//
+// Hardware performance counters for benchmarks, read through perf_event_open around measured regions.
+// Every counter is opened separately, so counters which are not supported (virtual machines, containers,
+// perf_event_paranoid settings) are just reported as unavailable. Counters are user space only.
+// On platforms other than linux all counters are unavailable
+//
+// Translation unit must define _DEFAULT_SOURCE (or _GNU_SOURCE) before any include to get syscall declaration
+//
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef enum
+{
+    BENCH_COUNTER_CYCLES,
+    BENCH_COUNTER_INSTRUCTIONS,
+    BENCH_COUNTER_BRANCH_MISSES,
+    BENCH_COUNTER_L1D_MISSES,
+    BENCH_COUNTER_LLC_MISSES,
+    BENCH_COUNTER_COUNT,
+} BenchCounter;
+
+static const char* const BENCH_COUNTER_TO_STR[] =
+{
+    "cycles",
+    "instr",
+    "br-miss",
+    "L1d-miss",
+    "LLC-miss",
+};
+
+typedef struct
+{
+    int         fds[BENCH_COUNTER_COUNT];
+    bool        isAnyAvailable;
+} BenchCounters;
+
+//
+// Values of counters accumulated over measured regions, so interleaved regions can use separate values
+//
+typedef struct
+{
+    double      values[BENCH_COUNTER_COUNT];
+} BenchCounterValues;
+
+#ifdef __linux__
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static inline void bench_counters_open(BenchCounters* counters)
+{
+    static const struct { uint32_t type; uint64_t config; } events[BENCH_COUNTER_COUNT] =
+    {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    };
+
+    counters->isAnyAvailable = false;
+    for (int it = 0; it < BENCH_COUNTER_COUNT; it++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = events[it].type;
+        attr.config         = events[it].config;
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        counters->fds[it] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        counters->isAnyAvailable |= counters->fds[it] >= 0;
+    }
+}
+
+static inline void bench_counters_close(BenchCounters* counters)
+{
+    for (int it = 0; it < BENCH_COUNTER_COUNT; it++)
+    {
+        if (counters->fds[it] >= 0)
+        {
+            close(counters->fds[it]);
+        }
+    }
+}
+
+static inline void bench_counters_start(BenchCounters* counters)
+{
+    for (int it = 0; it < BENCH_COUNTER_COUNT; it++)
+    {
+        if (counters->fds[it] >= 0)
+        {
+            ioctl(counters->fds[it], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters->fds[it], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+static inline void bench_counters_stop(BenchCounters* counters, BenchCounterValues* values)
+{
+    for (int it = 0; it < BENCH_COUNTER_COUNT; it++)
+    {
+        if (counters->fds[it] >= 0)
+        {
+            ioctl(counters->fds[it], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (int it = 0; it < BENCH_COUNTER_COUNT; it++)
+    {
+        // value, time enabled, time running
+        uint64_t data[3];
+        if (counters->fds[it] >= 0 && read(counters->fds[it], data, sizeof(data)) == (ssize_t)sizeof(data) && data[2])
+        {
+            //
+            // Counters are multiplexed when there are more of them than hardware registers, so value is scaled
+            //
+            values->values[it] += (double)data[0] * ((double)data[1] / (double)data[2]);
+        }
+    }
+}
+
+#else
+
+static inline void bench_counters_open(BenchCounters* counters)
+{
+    counters->isAnyAvailable = false;
+    for (int it = 0; it < BENCH_COUNTER_COUNT; it++)
+    {
+        counters->fds[it] = -1;
+    }
+}
+
+static inline void bench_counters_close(BenchCounters* counters) { }
+static inline void bench_counters_start(BenchCounters* counters) { }
+static inline void bench_counters_stop(BenchCounters* counters, BenchCounterValues* values) { }
+
+#endif
+
+static inline bool bench_counters_is_available(const BenchCounters* counters, BenchCounter counter)
+{
+    return counters->fds[counter] >= 0;
+}
+
+//
+// Prints counters divided by divisor (for example number of processed bytes) as a single line
+//
+static inline void bench_counters_print(const BenchCounters* counters, const BenchCounterValues* values, const char* label, double divisor)
+{
+    printf("%-37s", label);
+    for (int it = 0; it < BENCH_COUNTER_COUNT; it++)
+    {
+        if (bench_counters_is_available(counters, (BenchCounter)it))
+        {
+            printf(" %s %.4f", BENCH_COUNTER_TO_STR[it], values->values[it] / divisor);
+        }
+        else
+        {
+            printf(" %s n/a", BENCH_COUNTER_TO_STR[it]);
+        }
+    }
+    if (bench_counters_is_available(counters, BENCH_COUNTER_CYCLES) && bench_counters_is_available(counters, BENCH_COUNTER_INSTRUCTIONS) && values->values[BENCH_COUNTER_CYCLES] > 0.0)
+    {
+        printf(" IPC %.2f", values->values[BENCH_COUNTER_INSTRUCTIONS] / values->values[BENCH_COUNTER_CYCLES]);
+    }
+    printf("\n");
+}
+
+#endif //_SDSF_BENCH_COUNTERS_H_
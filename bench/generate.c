@@ -0,0 +1,500 @@
+//
+// @NOTE : clock_gettime (used by bench_common.h) requires posix declarations
+//
+#define _DEFAULT_SOURCE
+
+#define SDSF_IMPL
+#include "../simple_data_storage_format.h"
+#include "bench_common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Generates valid sdsf documents of requested size and shape. Output depends only on the seed and other options,
+// so the same command always writes the same file. Document is written with streaming serializer, so memory usage
+// doesn't depend on the document size (except binary payload, which is kept by serializer until the end of the document,
+// because binary data blob is written last)
+//
+// Top level values are arrays and composites (unless both have zero weight). They are written until output reaches
+// requested size, so file is bigger by at most one top level value (its size is limited by fanout ^ depth)
+//
+// Usage : generate [options] <output path>
+//     --size <bytes>                  size of the document, K, M, G and T suffixes are supported (default 64M)
+//     --seed <number>                 seed of random generator (default 1)
+//     --depth <number>                maximal nesting depth of arrays and composites (default 4)
+//     --fanout <number>               maximal number of childs of array or composite, actual number is 1..fanout (default 8)
+//     --mix <type=weight,...>         weights of value types : bool, int, float, int64, uint64, double, string, binary, array, composite
+//                                     (default int=4,float=2,double=1,int64=1,uint64=1,bool=1,string=3,binary=0,array=1,composite=1)
+//                                     Types which are not mentioned keep their default weight
+//     --string-length <distribution>  length of strings in bytes : fixed:<n>, uniform:<min>:<max> or geometric:<mean> (default uniform:0:32)
+//     --binary-size <min>:<max>       size of binary values in bytes (default 16:4096)
+//
+
+typedef enum
+{
+    GENERATE_TYPE_BOOL,
+    GENERATE_TYPE_INT,
+    GENERATE_TYPE_FLOAT,
+    GENERATE_TYPE_INT64,
+    GENERATE_TYPE_UINT64,
+    GENERATE_TYPE_DOUBLE,
+    GENERATE_TYPE_STRING,
+    GENERATE_TYPE_BINARY,
+    GENERATE_TYPE_ARRAY,
+    GENERATE_TYPE_COMPOSITE,
+    GENERATE_TYPE_COUNT,
+} GenerateType;
+
+static const char* const GENERATE_TYPE_TO_STR[] =
+{
+    "bool",
+    "int",
+    "float",
+    "int64",
+    "uint64",
+    "double",
+    "string",
+    "binary",
+    "array",
+    "composite",
+};
+
+typedef enum
+{
+    GENERATE_STRING_LENGTH_FIXED,
+    GENERATE_STRING_LENGTH_UNIFORM,
+    GENERATE_STRING_LENGTH_GEOMETRIC,
+} GenerateStringLength;
+
+typedef struct
+{
+    uint64_t                size;
+    uint64_t                seed;
+    size_t                  depth;
+    size_t                  fanout;
+    uint32_t                weights[GENERATE_TYPE_COUNT];
+    GenerateStringLength    stringLength;
+    size_t                  stringLengthMin;
+    size_t                  stringLengthMax;
+    size_t                  stringLengthMean;
+    size_t                  binarySizeMin;
+    size_t                  binarySizeMax;
+    const char*             outputPath;
+} GenerateOptions;
+
+typedef struct
+{
+    FILE*       file;
+    uint64_t    writtenSize;
+    bool        isFailed;
+} GenerateOutput;
+
+typedef struct
+{
+    const GenerateOptions*  options;
+    SdsfSerializer*         sdsf;
+    uint64_t                state;
+    uint64_t                valueCount;
+    char*                   stringBuffer;
+    uint8_t*                binaryBuffer;
+} GenerateContext;
+
+bool generate_write(const void* data, size_t dataSize, void* userData)
+{
+    GenerateOutput* const output = (GenerateOutput*)userData;
+    output->isFailed |= fwrite(data, 1, dataSize, output->file) != dataSize;
+    output->writtenSize += dataSize;
+    return !output->isFailed;
+}
+
+//
+// splitmix64, seed is mixed on the first call, so neighbouring seeds give unrelated documents
+//
+uint64_t generate_random(GenerateContext* ctx)
+{
+    uint64_t z = (ctx->state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+size_t generate_range(GenerateContext* ctx, size_t min, size_t max)
+{
+    return min + (size_t)(generate_random(ctx) % ((uint64_t)(max - min) + 1));
+}
+
+// ==============================================================================================================
+//
+// Values
+//
+// ==============================================================================================================
+
+GenerateType generate_pick_type(GenerateContext* ctx, size_t depth)
+{
+    //
+    // Top level values are containers (unless containers are disabled), deepest values are never containers
+    //
+    const uint32_t* const weights = ctx->options->weights;
+    const bool hasContainers = ctx->options->depth && (weights[GENERATE_TYPE_ARRAY] || weights[GENERATE_TYPE_COMPOSITE]);
+    const int firstType = depth == 0 && hasContainers ? GENERATE_TYPE_ARRAY : 0;
+    const int typeCount = depth < ctx->options->depth ? GENERATE_TYPE_COUNT : GENERATE_TYPE_ARRAY;
+    uint64_t totalWeight = 0;
+    for (int it = firstType; it < typeCount; it++)
+    {
+        totalWeight += weights[it];
+    }
+
+    uint64_t pick = generate_random(ctx) % totalWeight;
+    for (int it = firstType; it < typeCount; it++)
+    {
+        if (pick < weights[it])
+        {
+            return (GenerateType)it;
+        }
+        pick -= weights[it];
+    }
+    return GENERATE_TYPE_INT;
+}
+
+const char* generate_string(GenerateContext* ctx)
+{
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 _-.,:;\"\\\n\t";
+    const GenerateOptions* const options = ctx->options;
+    size_t length = 0;
+    switch (options->stringLength)
+    {
+        case GENERATE_STRING_LENGTH_FIXED:      length = options->stringLengthMin; break;
+        case GENERATE_STRING_LENGTH_UNIFORM:    length = generate_range(ctx, options->stringLengthMin, options->stringLengthMax); break;
+        case GENERATE_STRING_LENGTH_GEOMETRIC:
+        {
+            while (length < options->stringLengthMax && generate_random(ctx) % (options->stringLengthMean + 1) != 0)
+            {
+                length += 1;
+            }
+        } break;
+    }
+
+    for (size_t it = 0; it < length; it++)
+    {
+        const uint64_t random = generate_random(ctx);
+        //
+        // Some characters are two byte utf-8 sequences
+        //
+        if ((random & 63) == 0 && it + 1 < length)
+        {
+            ctx->stringBuffer[it++] = (char)0xC3;
+            ctx->stringBuffer[it] = (char)(0xA0 + (random >> 8) % 32);
+        }
+        else
+        {
+            ctx->stringBuffer[it] = alphabet[(random >> 8) % (sizeof(alphabet) - 1)];
+        }
+    }
+    ctx->stringBuffer[length] = '\0';
+    return ctx->stringBuffer;
+}
+
+void generate_value(GenerateContext* ctx, const char* name, size_t depth)
+{
+    static const char* const words[] = { "id", "name", "value", "position", "items", "weight", "data", "label", "count", "child" };
+    SdsfSerializer* const sdsf = ctx->sdsf;
+    const GenerateType type = generate_pick_type(ctx, depth);
+    ctx->valueCount += 1;
+    switch (type)
+    {
+        case GENERATE_TYPE_BOOL:    sdsf_serialize_bool(sdsf, name, (generate_random(ctx) & 1) != 0); break;
+        case GENERATE_TYPE_INT:     sdsf_serialize_int(sdsf, name, (int32_t)(uint32_t)generate_random(ctx)); break;
+        case GENERATE_TYPE_FLOAT:   sdsf_serialize_float(sdsf, name, (float)(int32_t)(uint32_t)generate_random(ctx) / 65536.0f); break;
+        case GENERATE_TYPE_INT64:   sdsf_serialize_int64(sdsf, name, (int64_t)generate_random(ctx)); break;
+        case GENERATE_TYPE_UINT64:  sdsf_serialize_uint64(sdsf, name, generate_random(ctx)); break;
+        case GENERATE_TYPE_DOUBLE:
+        {
+            const uint64_t random = generate_random(ctx);
+            sdsf_serialize_double(sdsf, name, (double)(int64_t)random / (double)(1ull << (random % 64)));
+        } break;
+        case GENERATE_TYPE_STRING:  sdsf_serialize_string(sdsf, name, generate_string(ctx)); break;
+        case GENERATE_TYPE_BINARY:
+        {
+            const size_t size = generate_range(ctx, ctx->options->binarySizeMin, ctx->options->binarySizeMax);
+            for (size_t it = 0; it < size; it += 8)
+            {
+                const uint64_t random = generate_random(ctx);
+                memcpy(ctx->binaryBuffer + it, &random, size - it < 8 ? size - it : 8);
+            }
+            sdsf_serialize_binary(sdsf, name, ctx->binaryBuffer, size);
+        } break;
+        case GENERATE_TYPE_ARRAY:
+        {
+            const size_t childCount = generate_range(ctx, 1, ctx->options->fanout);
+            sdsf_serialize_array_start(sdsf, name);
+            for (size_t it = 0; it < childCount; it++)
+            {
+                generate_value(ctx, NULL, depth + 1);
+            }
+            sdsf_serialize_array_end(sdsf);
+        } break;
+        case GENERATE_TYPE_COMPOSITE:
+        {
+            const size_t childCount = generate_range(ctx, 1, ctx->options->fanout);
+            char childName[32];
+            sdsf_serialize_composite_start(sdsf, name);
+            for (size_t it = 0; it < childCount; it++)
+            {
+                snprintf(childName, sizeof(childName), "%s%zu", words[generate_random(ctx) % (sizeof(words) / sizeof(words[0]))], it);
+                generate_value(ctx, childName, depth + 1);
+            }
+            sdsf_serialize_composite_end(sdsf);
+        } break;
+        default: break;
+    }
+}
+
+// ==============================================================================================================
+//
+// Options
+//
+// ==============================================================================================================
+
+bool parse_number(const char* str, uint64_t* result)
+{
+    char* end = NULL;
+    const unsigned long long value = strtoull(str, &end, 10);
+    if (end == str)
+    {
+        return false;
+    }
+
+    uint64_t multiplier = 1;
+    switch (*end)
+    {
+        case '\0':              break;
+        case 'K': case 'k':     multiplier = 1ull << 10; end += 1; break;
+        case 'M': case 'm':     multiplier = 1ull << 20; end += 1; break;
+        case 'G': case 'g':     multiplier = 1ull << 30; end += 1; break;
+        case 'T': case 't':     multiplier = 1ull << 40; end += 1; break;
+        default:                return false;
+    }
+    *result = (uint64_t)value * multiplier;
+    return *end == '\0';
+}
+
+bool parse_size(const char* str, size_t* result)
+{
+    uint64_t value;
+    if (!parse_number(str, &value))
+    {
+        return false;
+    }
+    *result = (size_t)value;
+    return true;
+}
+
+//
+// Parses "<min>:<max>" into two numbers
+//
+bool parse_range(const char* str, size_t* min, size_t* max)
+{
+    char buffer[64];
+    const char* const separator = strchr(str, ':');
+    if (!separator || (size_t)(separator - str) >= sizeof(buffer))
+    {
+        return false;
+    }
+    memcpy(buffer, str, (size_t)(separator - str));
+    buffer[separator - str] = '\0';
+    return parse_size(buffer, min) && parse_size(separator + 1, max) && *min <= *max;
+}
+
+bool parse_mix(const char* str, uint32_t* weights)
+{
+    while (*str)
+    {
+        const char* const equals = strchr(str, '=');
+        if (!equals)
+        {
+            return false;
+        }
+
+        int type = 0;
+        for (; type < GENERATE_TYPE_COUNT; type++)
+        {
+            const size_t nameLength = strlen(GENERATE_TYPE_TO_STR[type]);
+            if ((size_t)(equals - str) == nameLength && strncmp(str, GENERATE_TYPE_TO_STR[type], nameLength) == 0)
+            {
+                break;
+            }
+        }
+        if (type == GENERATE_TYPE_COUNT)
+        {
+            return false;
+        }
+
+        char* end = NULL;
+        const unsigned long weight = strtoul(equals + 1, &end, 10);
+        if (end == equals + 1 || (*end != ',' && *end != '\0') || weight > 1000000)
+        {
+            return false;
+        }
+        weights[type] = (uint32_t)weight;
+        str = *end == ',' ? end + 1 : end;
+    }
+    return true;
+}
+
+bool parse_string_length(const char* str, GenerateOptions* options)
+{
+    if (strncmp(str, "fixed:", 6) == 0)
+    {
+        options->stringLength = GENERATE_STRING_LENGTH_FIXED;
+        return parse_size(str + 6, &options->stringLengthMin) && (options->stringLengthMax = options->stringLengthMin, true);
+    }
+    if (strncmp(str, "uniform:", 8) == 0)
+    {
+        options->stringLength = GENERATE_STRING_LENGTH_UNIFORM;
+        return parse_range(str + 8, &options->stringLengthMin, &options->stringLengthMax);
+    }
+    if (strncmp(str, "geometric:", 10) == 0)
+    {
+        //
+        // Long tail is cut at 64 means, so string buffer stays bounded
+        //
+        options->stringLength = GENERATE_STRING_LENGTH_GEOMETRIC;
+        options->stringLengthMin = 0;
+        return parse_size(str + 10, &options->stringLengthMean) && (options->stringLengthMax = options->stringLengthMean * 64 + 1, true);
+    }
+    return false;
+}
+
+bool parse_options(int argc, char** argv, GenerateOptions* options)
+{
+    static const uint32_t defaultWeights[GENERATE_TYPE_COUNT] = { 1, 4, 2, 1, 1, 1, 3, 0, 1, 1 };
+    memset(options, 0, sizeof(GenerateOptions));
+    options->size = 64ull << 20;
+    options->seed = 1;
+    options->depth = 4;
+    options->fanout = 8;
+    memcpy(options->weights, defaultWeights, sizeof(defaultWeights));
+    options->stringLength = GENERATE_STRING_LENGTH_UNIFORM;
+    options->stringLengthMin = 0;
+    options->stringLengthMax = 32;
+    options->binarySizeMin = 16;
+    options->binarySizeMax = 4096;
+
+    for (int it = 1; it < argc; it++)
+    {
+        const char* const arg = argv[it];
+        const char* const value = it + 1 < argc ? argv[it + 1] : NULL;
+        bool isValid = value != NULL;
+        if (strcmp(arg, "--size") == 0)                 isValid = isValid && parse_number(value, &options->size);
+        else if (strcmp(arg, "--seed") == 0)            isValid = isValid && parse_number(value, &options->seed);
+        else if (strcmp(arg, "--depth") == 0)           isValid = isValid && parse_size(value, &options->depth);
+        else if (strcmp(arg, "--fanout") == 0)          isValid = isValid && parse_size(value, &options->fanout) && options->fanout > 0;
+        else if (strcmp(arg, "--mix") == 0)             isValid = isValid && parse_mix(value, options->weights);
+        else if (strcmp(arg, "--string-length") == 0)   isValid = isValid && parse_string_length(value, options);
+        else if (strcmp(arg, "--binary-size") == 0)     isValid = isValid && parse_range(value, &options->binarySizeMin, &options->binarySizeMax);
+        else if (it + 1 == argc && arg[0] != '-')
+        {
+            options->outputPath = arg;
+            continue;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", arg);
+            return false;
+        }
+
+        if (!isValid)
+        {
+            fprintf(stderr, "Invalid value of option %s\n", arg);
+            return false;
+        }
+        it += 1;
+    }
+
+    //
+    // Leaf values must be possible, otherwise the deepest level can't be generated
+    //
+    uint64_t leafWeight = 0;
+    for (int it = 0; it < GENERATE_TYPE_ARRAY; it++)
+    {
+        leafWeight += options->weights[it];
+    }
+    if (!leafWeight)
+    {
+        fprintf(stderr, "At least one of non container types must have non zero weight\n");
+        return false;
+    }
+    if (options->stringLengthMax > (1u << 30) || options->binarySizeMax > (1u << 30))
+    {
+        fprintf(stderr, "Strings and binary values can't be bigger than 1G\n");
+        return false;
+    }
+    return options->outputPath != NULL;
+}
+
+int main(int argc, char** argv)
+{
+    GenerateOptions options;
+    if (!parse_options(argc, argv, &options))
+    {
+        fprintf(stderr, "Usage : generate [--size <bytes>] [--seed <number>] [--depth <number>] [--fanout <number>] [--mix <type=weight,...>]\n"
+                        "                 [--string-length fixed:<n>|uniform:<min>:<max>|geometric:<mean>] [--binary-size <min>:<max>] <output path>\n");
+        return 1;
+    }
+
+    GenerateOutput output = {0};
+    output.file = fopen(options.outputPath, "wb");
+    if (!output.file)
+    {
+        fprintf(stderr, "Unable to open %s\n", options.outputPath);
+        return 1;
+    }
+    setvbuf(output.file, NULL, _IOFBF, 1 << 20);
+
+    const SdsfAllocator allocator = { bench_alloc, bench_dealloc, NULL };
+    const SdsfOutputSink sink = { generate_write, &output };
+    SdsfSerializer sdsf = sdsf_serializer_begin_streaming(allocator, sink);
+
+    GenerateContext ctx = {0};
+    ctx.options = &options;
+    ctx.sdsf = &sdsf;
+    ctx.state = options.seed;
+    ctx.stringBuffer = (char*)malloc(options.stringLengthMax + 1);
+    ctx.binaryBuffer = (uint8_t*)malloc(options.binarySizeMax + 8);
+
+    //
+    // Binary data is written after all values, so it is counted as already written
+    //
+    char name[32];
+    uint64_t topLevelCount = 0;
+    uint64_t reportedSize = 0;
+    while (!output.isFailed && output.writtenSize + sdsf.mainBufferSize + sdsf.binaryDataBufferSize < options.size)
+    {
+        snprintf(name, sizeof(name), "value%llu", (unsigned long long)topLevelCount++);
+        generate_value(&ctx, name, 0);
+
+        if (output.writtenSize - reportedSize >= (1ull << 30))
+        {
+            reportedSize = output.writtenSize;
+            fprintf(stderr, "%llu MB written\n", (unsigned long long)(reportedSize >> 20));
+        }
+    }
+
+    SdsfSerializedResult result = {0};
+    const SdsfSerializationError error = sdsf_serializer_end(&sdsf, &result);
+    sdsf_serialized_result_free(&result);
+    output.isFailed |= fclose(output.file) != 0;
+    free(ctx.stringBuffer);
+    free(ctx.binaryBuffer);
+    if (error || output.isFailed)
+    {
+        fprintf(stderr, "Unable to write %s : %s\n", options.outputPath, error ? sdsf.errorMsg : "write failed");
+        return 1;
+    }
+
+    printf("%s : %llu bytes, %llu top level values, %llu values\n", options.outputPath,
+        (unsigned long long)output.writtenSize, (unsigned long long)topLevelCount, (unsigned long long)ctx.valueCount);
+    return 0;
+}
@@ -0,0 +1,439 @@
+
+//
+// @NOTE : clock_gettime and syscall (for perf_event_open) require posix and default declarations
+//
+#define _DEFAULT_SOURCE
+
+#define SDSF_IMPL
+#include "../simple_data_storage_format.h"
+#include "bench_counters.h"
+#include "bench_common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//
+// Microbenchmarks of separate hot functions on fixed inputs. Every kernel is warmed up, then timed for a number of samples,
+// each sample runs kernel over the whole input. Reported numbers are nanoseconds per operation
+// and, if available, hardware counters per operation summed over all samples
+//
+// Usage : micro [kernel name or all] [sample count]
+//
+
+#define MICRO_WARM_UP_SAMPLE_COUNT  5
+#define MICRO_ITEM_COUNT            100000
+
+typedef struct
+{
+    SdsfAllocator           allocator;
+
+    char*                   tokenText;
+    size_t                  tokenTextSize;
+    char*                   literalText;
+    size_t                  literalTextSize;
+    _SdsfComsumedString*    tokens;
+    size_t                  tokenCount;
+
+    const char**            strings;
+    size_t*                 stringLengths;
+
+    int64_t*                ints;
+    double*                 doubles;
+    char                    numberBuffer[SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY];
+
+    SdsfSerializer          serializer;
+} MicroContext;
+
+typedef struct
+{
+    const char* name;
+    //
+    // Returns number of performed operations
+    //
+    size_t (*run)(MicroContext* ctx);
+} MicroKernel;
+
+//
+// Results are accumulated here, so compiler can't throw the work away
+//
+static volatile size_t microSink;
+
+// ==============================================================================================================
+//
+// Kernels
+//
+// ==============================================================================================================
+
+//
+// Walks document the same way tokenizer does : content of a string literal is consumed in literal mode,
+// closing quote is consumed as a reserved symbol
+//
+size_t kernel_consume_string_tokens(MicroContext* ctx)
+{
+    size_t consumePtr = 0;
+    size_t count = 0;
+    size_t checksum = 0;
+    int literalState = 0;
+    _SdsfComsumedString str;
+    while (_sdsf_consume_string(ctx->tokenText, ctx->tokenTextSize, &consumePtr, &str, literalState == 1))
+    {
+        if (literalState == 1)
+        {
+            literalState = 2;
+        }
+        else if (str.size == 1 && str.ptr[0] == '\"')
+        {
+            literalState = literalState == 0 ? 1 : 0;
+        }
+        checksum += str.size;
+        count += 1;
+    }
+    microSink += checksum;
+    return count;
+}
+
+size_t kernel_consume_string_literals(MicroContext* ctx)
+{
+    size_t consumePtr = 0;
+    size_t count = 0;
+    size_t checksum = 0;
+    _SdsfComsumedString str;
+    while (consumePtr < ctx->literalTextSize)
+    {
+        consumePtr += 1; // opening quote
+        _sdsf_consume_string(ctx->literalText, ctx->literalTextSize, &consumePtr, &str, true);
+        consumePtr += 1; // closing quote
+        checksum += str.size + str.hasEscapes;
+        count += 1;
+    }
+    microSink += checksum;
+    return count;
+}
+
+size_t kernel_match_string(MicroContext* ctx)
+{
+    const char* errorMsg = NULL;
+    size_t checksum = 0;
+    for (size_t it = 0; it < ctx->tokenCount; it++)
+    {
+        checksum += (size_t)_sdsf_match_string(&errorMsg, &ctx->tokens[it]);
+    }
+    microSink += checksum;
+    return ctx->tokenCount;
+}
+
+size_t kernel_val_array_add(MicroContext* ctx)
+{
+    SdsfValueArray values = {0};
+    for (size_t it = 0; it < MICRO_ITEM_COUNT; it++)
+    {
+        SdsfValue* const value = _sdsf_val_array_add(&values, &ctx->allocator);
+        value->type = SDSF_VALUE_INT;
+        value->asInt = (int32_t)it;
+    }
+    microSink += values.size;
+    _sdsf_val_array_clear(&values, &ctx->allocator);
+    return MICRO_ITEM_COUNT;
+}
+
+size_t kernel_string_array_save(MicroContext* ctx)
+{
+    SdsfStringArray strings = {0};
+    size_t checksum = 0;
+    for (size_t it = 0; it < MICRO_ITEM_COUNT; it++)
+    {
+        const char* const saved = _sdsf_string_array_save(&strings, &ctx->allocator, ctx->strings[it], ctx->stringLengths[it]);
+        checksum += (size_t)saved[0];
+    }
+    microSink += checksum;
+    _sdsf_string_array_clear(&strings, &ctx->allocator);
+    return MICRO_ITEM_COUNT;
+}
+
+//
+// Main buffer starts from the default capacity every sample, so growth is included
+//
+size_t kernel_push_to_main_buffer_growing(MicroContext* ctx)
+{
+    SdsfSerializer* const sdsf = &ctx->serializer;
+    sdsf->allocator.dealloc(sdsf->mainBuffer, sdsf->mainBufferCapacity, sdsf->allocator.userData);
+    sdsf->mainBuffer = sdsf->allocator.alloc(SDSF_SERIALIZER_MAIN_BUFFER_DEFAULT_CAPACITY, sdsf->allocator.userData);
+    sdsf->mainBufferCapacity = SDSF_SERIALIZER_MAIN_BUFFER_DEFAULT_CAPACITY;
+    sdsf->mainBufferSize = 0;
+    for (size_t it = 0; it < MICRO_ITEM_COUNT; it++)
+    {
+        _sdsf_push_to_main_buffer(sdsf, ctx->strings[it], ctx->stringLengths[it]);
+    }
+    microSink += sdsf->mainBufferSize;
+    return MICRO_ITEM_COUNT;
+}
+
+size_t kernel_push_to_main_buffer_warm(MicroContext* ctx)
+{
+    SdsfSerializer* const sdsf = &ctx->serializer;
+    sdsf->mainBufferSize = 0;
+    for (size_t it = 0; it < MICRO_ITEM_COUNT; it++)
+    {
+        _sdsf_push_to_main_buffer(sdsf, ctx->strings[it], ctx->stringLengths[it]);
+    }
+    microSink += sdsf->mainBufferSize;
+    return MICRO_ITEM_COUNT;
+}
+
+size_t kernel_format_int(MicroContext* ctx)
+{
+    size_t checksum = 0;
+    for (size_t it = 0; it < MICRO_ITEM_COUNT; it++)
+    {
+        checksum += _sdsf_format_int64(ctx->numberBuffer, ctx->ints[it]);
+    }
+    microSink += checksum;
+    return MICRO_ITEM_COUNT;
+}
+
+size_t kernel_format_float_snprintf(MicroContext* ctx)
+{
+    size_t checksum = 0;
+    for (size_t it = 0; it < MICRO_ITEM_COUNT; it++)
+    {
+        checksum += (size_t)snprintf(ctx->numberBuffer, SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, "%f", (float)ctx->doubles[it]);
+    }
+    microSink += checksum;
+    return MICRO_ITEM_COUNT;
+}
+
+size_t kernel_format_double_snprintf(MicroContext* ctx)
+{
+    size_t checksum = 0;
+    for (size_t it = 0; it < MICRO_ITEM_COUNT; it++)
+    {
+        checksum += (size_t)snprintf(ctx->numberBuffer, SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, "%.17g", ctx->doubles[it]);
+    }
+    microSink += checksum;
+    return MICRO_ITEM_COUNT;
+}
+
+size_t kernel_format_hex_double(MicroContext* ctx)
+{
+    size_t checksum = 0;
+    for (size_t it = 0; it < MICRO_ITEM_COUNT; it++)
+    {
+        uint64_t bits;
+        memcpy(&bits, &ctx->doubles[it], sizeof(double));
+        checksum += _sdsf_format_hex_float(ctx->numberBuffer, bits, true);
+    }
+    microSink += checksum;
+    return MICRO_ITEM_COUNT;
+}
+
+static const MicroKernel MICRO_KERNELS[] =
+{
+    { "consume_string_tokens",          kernel_consume_string_tokens },
+    { "consume_string_literals",        kernel_consume_string_literals },
+    { "match_string",                   kernel_match_string },
+    { "val_array_add",                  kernel_val_array_add },
+    { "string_array_save",              kernel_string_array_save },
+    { "push_to_main_buffer_growing",    kernel_push_to_main_buffer_growing },
+    { "push_to_main_buffer_warm",       kernel_push_to_main_buffer_warm },
+    { "format_int",                     kernel_format_int },
+    { "format_float_snprintf",          kernel_format_float_snprintf },
+    { "format_double_snprintf",         kernel_format_double_snprintf },
+    { "format_hex_double",              kernel_format_hex_double },
+};
+
+// ==============================================================================================================
+//
+// Inputs
+//
+// ==============================================================================================================
+
+void micro_context_init(MicroContext* ctx, SdsfAllocator allocator)
+{
+    static const char* const words[] = { "a", "name", "position", "x", "some longer text value", "quote \"inside\"", "back\\slash", "\xC3\xA9t\xC3\xA9", "" };
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    memset(ctx, 0, sizeof(MicroContext));
+    ctx->allocator = allocator;
+
+    ctx->strings = (const char**)malloc(MICRO_ITEM_COUNT * sizeof(const char*));
+    ctx->stringLengths = (size_t*)malloc(MICRO_ITEM_COUNT * sizeof(size_t));
+    ctx->ints = (int64_t*)malloc(MICRO_ITEM_COUNT * sizeof(int64_t));
+    ctx->doubles = (double*)malloc(MICRO_ITEM_COUNT * sizeof(double));
+    for (size_t it = 0; it < MICRO_ITEM_COUNT; it++)
+    {
+        ctx->strings[it] = words[bench_random(&state) % (sizeof(words) / sizeof(words[0]))];
+        ctx->stringLengths[it] = strlen(ctx->strings[it]);
+        const uint32_t magnitude = bench_random(&state) % 4;
+        const int64_t number = (int64_t)bench_random(&state) * (magnitude == 3 ? 1000003 : 1);
+        ctx->ints[it] = (magnitude == 0 ? number % 100 : number) * ((it & 1) ? -1 : 1);
+        ctx->doubles[it] = (double)bench_random(&state) / (double)(1 + bench_random(&state) % 1000);
+    }
+
+    //
+    // Token input is a document of composites with every value type except binary data
+    //
+    SdsfSerializer sdsf = sdsf_serializer_begin(allocator);
+    char name[32];
+    for (size_t it = 0; it < MICRO_ITEM_COUNT / 10; it++)
+    {
+        snprintf(name, sizeof(name), "entity%zu", it);
+        sdsf_serialize_composite_start(&sdsf, name);
+            sdsf_serialize_int(&sdsf, "id", (int32_t)ctx->ints[it]);
+            sdsf_serialize_int64(&sdsf, "big", ctx->ints[it] * 1000003);
+            sdsf_serialize_float(&sdsf, "weight", (float)ctx->doubles[it]);
+            sdsf_serialize_double(&sdsf, "precise", ctx->doubles[it]);
+            sdsf_serialize_bool(&sdsf, "enabled", (it & 1) != 0);
+            sdsf_serialize_string(&sdsf, "label", ctx->strings[it]);
+            sdsf_serialize_array_start(&sdsf, "tags");
+                sdsf_serialize_string(&sdsf, NULL, ctx->strings[it + 1]);
+                sdsf_serialize_uint64(&sdsf, NULL, (uint64_t)it);
+            sdsf_serialize_array_end(&sdsf);
+        sdsf_serialize_composite_end(&sdsf);
+    }
+    SdsfSerializedResult document = {0};
+    sdsf_serializer_end(&sdsf, &document);
+    ctx->tokenTextSize = document.bufferSize;
+    ctx->tokenText = (char*)malloc(document.bufferSize);
+    memcpy(ctx->tokenText, document.buffer, document.bufferSize);
+    sdsf_serialized_result_free(&document);
+
+    //
+    // Tokens for matching are everything outside of string literals
+    //
+    ctx->tokens = (_SdsfComsumedString*)malloc(ctx->tokenTextSize * sizeof(_SdsfComsumedString));
+    size_t consumePtr = 0;
+    int literalState = 0;
+    _SdsfComsumedString str;
+    while (_sdsf_consume_string(ctx->tokenText, ctx->tokenTextSize, &consumePtr, &str, literalState == 1))
+    {
+        if (literalState == 1)
+        {
+            literalState = 2;
+            continue;
+        }
+        if (str.size == 1 && str.ptr[0] == '\"')
+        {
+            literalState = literalState == 0 ? 1 : 0;
+        }
+        ctx->tokens[ctx->tokenCount++] = str;
+    }
+
+    //
+    // Literal input is just quoted strings one after another
+    //
+    size_t literalCapacity = 0;
+    for (size_t it = 0; it < MICRO_ITEM_COUNT; it++)
+    {
+        literalCapacity += ctx->stringLengths[it] * 2 + 2;
+    }
+    ctx->literalText = (char*)malloc(literalCapacity);
+    for (size_t it = 0; it < MICRO_ITEM_COUNT; it++)
+    {
+        ctx->literalText[ctx->literalTextSize++] = '\"';
+        for (size_t c = 0; c < ctx->stringLengths[it]; c++)
+        {
+            const char symbol = ctx->strings[it][c];
+            if (symbol == '\"' || symbol == '\\')
+            {
+                ctx->literalText[ctx->literalTextSize++] = '\\';
+            }
+            ctx->literalText[ctx->literalTextSize++] = symbol;
+        }
+        ctx->literalText[ctx->literalTextSize++] = '\"';
+    }
+
+    ctx->serializer = sdsf_serializer_begin(allocator);
+}
+
+void micro_context_free(MicroContext* ctx)
+{
+    SdsfSerializedResult result = {0};
+    sdsf_serializer_end(&ctx->serializer, &result);
+    sdsf_serialized_result_free(&result);
+    free(ctx->tokenText);
+    free(ctx->literalText);
+    free(ctx->tokens);
+    free((void*)ctx->strings);
+    free(ctx->stringLengths);
+    free(ctx->ints);
+    free(ctx->doubles);
+}
+
+// ==============================================================================================================
+//
+// Measurement
+//
+// ==============================================================================================================
+
+//
+// Nearest rank percentile of sorted samples
+//
+double percentile(const double* sorted, size_t count, double p)
+{
+    const double exactRank = p / 100.0 * (double)count;
+    size_t rank = (size_t)exactRank;
+    rank += (double)rank < exactRank ? 1 : 0;
+    rank = rank < 1 ? 1 : (rank > count ? count : rank);
+    return sorted[rank - 1];
+}
+
+void run_kernel(const MicroKernel* kernel, MicroContext* ctx, size_t sampleCount, BenchCounters* counters)
+{
+    double* const samples = (double*)malloc(sampleCount * sizeof(double));
+    for (size_t it = 0; it < MICRO_WARM_UP_SAMPLE_COUNT; it++)
+    {
+        kernel->run(ctx);
+    }
+    size_t opCount = 0;
+    BenchCounterValues counterValues = {0};
+    for (size_t it = 0; it < sampleCount; it++)
+    {
+        bench_counters_start(counters);
+        const double start = bench_now();
+        opCount = kernel->run(ctx);
+        samples[it] = (bench_now() - start) * 1e9 / (double)(opCount ? opCount : 1);
+        bench_counters_stop(counters, &counterValues);
+    }
+    qsort(samples, sampleCount, sizeof(double), bench_compare_doubles);
+    printf("%-30s %10zu %10.2f %10.2f %10.2f %10.2f %10.2f\n", kernel->name, opCount,
+        samples[0], percentile(samples, sampleCount, 50.0), percentile(samples, sampleCount, 90.0), percentile(samples, sampleCount, 99.0), samples[sampleCount - 1]);
+    if (counters->isAnyAvailable)
+    {
+        bench_counters_print(counters, &counterValues, "    per op", (double)opCount * (double)sampleCount);
+    }
+    free(samples);
+}
+
+int main(int argc, char** argv)
+{
+    const SdsfAllocator allocator = { bench_alloc, bench_dealloc, NULL };
+    const char* const kernelFilter = argc > 1 && strcmp(argv[1], "all") != 0 ? argv[1] : NULL;
+    const size_t sampleCount = argc > 2 ? (size_t)strtoul(argv[2], NULL, 10) : 51;
+    if (!sampleCount)
+    {
+        printf("Usage : micro [kernel name or all] [sample count]\n");
+        return 1;
+    }
+
+    BenchCounters counters;
+    bench_counters_open(&counters);
+    if (!counters.isAnyAvailable)
+    {
+        printf("Hardware counters are not available (see /proc/sys/kernel/perf_event_paranoid), only time is reported\n");
+    }
+
+    MicroContext ctx;
+    micro_context_init(&ctx, allocator);
+    printf("%-30s %10s %10s %10s %10s %10s %10s\n", "kernel (ns per op)", "ops", "min", "median", "p90", "p99", "max");
+    for (size_t it = 0; it < sizeof(MICRO_KERNELS) / sizeof(MICRO_KERNELS[0]); it++)
+    {
+        if (!kernelFilter || strcmp(kernelFilter, MICRO_KERNELS[it].name) == 0)
+        {
+            run_kernel(&MICRO_KERNELS[it], &ctx, sampleCount, &counters);
+        }
+    }
+    micro_context_free(&ctx);
+    bench_counters_close(&counters);
+    return 0;
+}
@@ -0,0 +1,5 @@
+#!/bin/sh
+
+cc ./bench/bench.c -O2 -g -std=c11 -Wall -o ./bench/bench -lpthread
+cc ./bench/micro.c -O2 -g -std=c11 -Wall -o ./bench/micro -lpthread
+cc ./bench/generate.c -O2 -g -std=c11 -Wall -o ./bench/generate -lpthread
@@ -14,8 +14,8 @@
     Simple data storage format (sdsf) is a text-based format.
     Data is stored using prebuit types. Those types are:
     1) boolean
-    2) integer
-    3) floating point
+    2) integer (32 and 64 bit, signed and unsigned)
+    3) floating point (single and double precision)
     4) string
     5) binary
     6) array
@@ -23,10 +23,21 @@
 
      - Boolean values are represented using 't' or 'f' characters
      - Integer values are represented using decimals. Example : 0, -1, 1, 999999, -999999, etc.
-     - Floating point values are represented using decimals. Example : 0.0, 0.1, -0.1, 999.999, -999.999, etc.
+       Integers which don't fit into int32_t are stored as 64 bit integers. 64 bit integer type can also be requested explicitly
+       using 'l' (int64_t) or 'u' (uint64_t) suffix. Example : 1l, -9000000000, 18446744073709551615u, etc.
+     - Floating point values are represented using decimals with optional exponent. Example : 0.0, 0.1, -0.1, 999.999, -999.999, 1.5e-3, etc.
+       Double precision values use 'd' suffix. Example : 0.1d, 1e300d, 2d, etc.
+       Floating point values can also be written as hexadecimal literals (same as C's "%a" format). Example : 0x1.99999ap-4, -0x1.8p+1, 0x1.999999999999ap-4d, etc.
+       Hexadecimal literals are converted to exactly the same bits they were written from. Infinities and NaNs are stored as hexadecimal literals
+       with exponent one above maximum (p+128 for floats and p+1024 for doubles). Example : 0x1p+128 (float infinity), -0x1.8p+1024d (double NaN), etc.
      - String values are represented using double quotation marks. Example : "string of text", etc.
+       Strings can have escape sequences : \" \\ \/ \b \f \n \r \t and \uXXXX (utf-16 code unit, surrogate pairs are supported).
+       Example : "quote \" and backslash \\", "\u00e9t\u00e9", etc. Any other characters (including new lines) can be stored in strings as is
      - Binary values are special kind of values, which are used to store binary data in file. Binary value points to a binary blob at the end of file.
        Binary values start with 'b' character and are followed by two integer values separated by '-' character. Example : b0-100, b99-1024, etc.
+       Binary values can also be typed. In that case 'b' character is followed by element type tag and ':' character. Example : bf32:0-4096, bu16be:8-72, etc.
+       Supported element type tags are u8, i8, u16, i16, u32, i32, u64, i64, f32 and f64. Tag can end with "le" (little endian, default) or "be" (big endian).
+       Size of typed binary value must be a multiple of element size
      - Arrays can store multiple member (child) values. Array members must have no name. Arrays start with '[' character, each member is separated with ','
        character. Arrays end with ']' character. Example : [0, t, "string", b0-123, [1, 2, 3]]
      - Composite values can also store multiple childs. But, unlike an arrays, composite childs must have names and must not be separated by ',' character.
@@ -41,6 +52,7 @@
      - can have any letter
      - can have numbers
      - can't begin with number
+     - must have at least two characters (single characters are read as bool or int literals)
      - can't have ',' '[' ']' '{' '}' '"' '@' '.' '-' characters
 
     Values and identifiers are separated using:
@@ -75,6 +87,88 @@
         Important - if c file api is used to read file (fopen, fread, etc.), "rb" mode must be used because "r" mode can alter file size and stuff
         Important - even if deserialization fails sdsf_deserialized_result_free must be called
 
+    Deserialization behaviour can be altered by calling sdsf_deserialize_with_flags with SdsfDeserializerFlags instead of sdsf_deserialize.
+    If SDSF_DESERIALIZER_FLAG_VALIDATE_UTF8 is set, every identifier and literal is checked to be valid utf-8 right after it was consumed
+    by the tokenizer (binary data blob is not checked), and SDSF_DESERIALIZATION_ERROR_INVALID_UTF8 is returned for malformed input.
+    Tokenizer notes non-ascii bytes while it looks for the end of a token, so ascii tokens are not scanned again. Non-ascii text is checked
+    16 bytes at a time with SSSE3. With gcc, clang and msvc on x86 SSSE3 code is always compiled and selected at run time if cpu supports it,
+    other compilers need SSSE3 enabled at compile time (-mssse3). Otherwise text is checked one byte at a time using the same lookup tables
+    If SDSF_DESERIALIZER_FLAG_PACK_ARRAYS is set, non-empty arrays where all members are bools, ints, floats, int64s, uint64s or doubles
+    (all of the same type) are stored as SDSF_VALUE_PACKED_ARRAY values - elements are stored in a single buffer without SdsfValue
+    per element (bools are stored as bits, bit (index % 8) of byte (index / 8)). Arrays with mixed members are stored as usual.
+    Packed array elements can be accessed with sdsf_packed_array_as_* functions (sdsf_packed_array_as_float, sdsf_packed_array_as_bits, etc.)
+    or one by one with sdsf_packed_array_get. Members of packed int, float and double arrays which are written as plain decimals are converted
+    in bulk, without going through the tokenizer (members and separators of up to 64 members are found from character class bit masks built
+    16 bytes at a time, then the whole batch is converted, integers 8 digits at a time)
+    With the same flag, rectangular nested numeric arrays (matrices, grids, etc.) like [[1, 2, 3], [4, 5, 6]] are stored as SDSF_VALUE_TENSOR
+    values - all elements of all nested arrays are stored in a single buffer in row-major order, together with shape of the tensor ({ 2, 3 } for the
+    example above). Nested arrays must have the same element type and the same shape. sdsf_array_as_tensor gives access to tensor data and shape
+    (packed numeric arrays are returned as tensors with a single dimension)
+
+    Typed binary values can be accessed without any copies or conversions using sdsf_binary_as_* functions (sdsf_binary_as_f32, sdsf_binary_as_u16, etc.)
+    These functions return pointer straight into the deserialized binary data blob. NULL is returned if value has different element type, different
+    endianness than the host (except u8 and i8) or if data is not properly aligned (typed binary values written by the serializer are always aligned)
+
+    Multiple independent files can be deserialized in parallel with sdsf_deserialize_many. User provides array of SdsfInput's (data and size),
+    arrays for results and errors of the same size and an array of threadCount allocators - allocator with index i is used only by the thread i,
+    so allocators can use thread-local memory (same thread-safe allocator can be passed multiple times). Calling thread is one of the threads.
+    Result i is built with allocator of the thread which deserialized it and must be freed with sdsf_deserialized_result_free even if failed.
+    Function returns error of the first failed input (errors array has errors of all inputs). sdsf_hardware_thread_count can be used to choose threadCount
+    Example :
+        SdsfDeserializationError err = sdsf_deserialize_many(results, errors, inputs, fileCount, allocators, threadCount, 0);
+
+    Single big file can be deserialized on multiple threads with sdsf_deserialize_parallel. Text is split into ranges before top level identifiers
+    (ranges are at least SDSF_PARALLEL_MIN_RANGE_SIZE bytes long) with a fast scan which looks only at brackets and string literals,
+    then each range is parsed by its own thread into its own value and string blocks. Blocks and top level values of all ranges are joined
+    into a single SdsfDeserializedResult, binary data blob is copied once in the end. Result is the same as with sdsf_deserialize_with_flags.
+    If SDSF_DESERIALIZER_FLAG_PACK_ARRAYS is set, large top level arrays of numbers (at least 2 * SDSF_PARALLEL_MIN_RANGE_SIZE bytes long) are also
+    split between threads at ',' characters - every thread converts its members straight into the packed array buffer.
+    Allocator is used by all threads at the same time, so it must be thread-safe. Small files (and threadCount of 1) are deserialized on the calling thread
+    Example :
+        SdsfDeserializationError err = sdsf_deserialize_parallel(&dr, data, dataSize, allocator, sdsf_hardware_thread_count(), 0);
+
+    Files which can't be split (few large top level values) can be deserialized with sdsf_deserialize_pipelined. It uses two threads - additional
+    thread runs the tokenizer (and utf-8 validation) and passes tokens to the calling thread through a lock-free ring, calling thread builds values
+    at the same time. Allocator is used only by the calling thread. Result is the same as with sdsf_deserialize_with_flags, but bulk conversion
+    of packed array members is not used (tokenizer is always ahead of the builder), so files with large numeric arrays are better
+    deserialized with sdsf_deserialize_parallel. Small files are deserialized on the calling thread
+
+    Files can be loaded and deserialized at the same time with sdsf_load_file. Additional thread reads the file in SDSF_LOADER_CHUNK_SIZE chunks,
+    calling thread deserializes everything which was read so far and sleeps until the next chunk only when it needs it (token which touches
+    the end of loaded data is tokenized again when more data is available). Binary data blob is copied when the whole file is read.
+    sdsf_load_files does the same for many files at once (arguments are the same as for sdsf_deserialize_many, but with file paths
+    instead of SdsfInput's), each of threadCount threads loads its own file. If file can't be opened or read, SDSF_DESERIALIZATION_ERROR_READ_FAILED
+    is returned. Loaded data is not kept - SdsfDeserializedResult never points to it
+    Example :
+        SdsfDeserializationError err = sdsf_load_file(&dr, "config.sdsf", allocator, 0);
+
+    Deserialized result can be shared between threads using sdsf_share_result. It moves result to the reference counted
+    SdsfSharedDocument (with refCount of 1), which must be treated as read-only from that moment. Any number of threads can read shared
+    document without locks, sdsf_shared_document_retain / sdsf_shared_document_release must be used to share and release references.
+    For hot reloading SdsfDocumentSlot (zero-initialized) can be used:
+     - readers call sdsf_document_slot_acquire to get the current document (it is retained for them) and release it when done.
+       Acquire is lock-free and never waits for the publisher
+     - publisher calls sdsf_document_slot_publish with a new document. Slot retains new document and releases the previous one as soon as
+       no reader can acquire it anymore. Previous document is freed when its last reader releases it (publisher still must release its own reference)
+     - to destroy slot publish NULL
+    Example :
+        SdsfSharedDocument* doc = sdsf_document_slot_acquire(&slot);    // reader thread
+        if (doc) { read(&doc->result); sdsf_shared_document_release(doc); }
+        SdsfSharedDocument* newDoc = sdsf_share_result(&dr);            // publisher thread
+        sdsf_document_slot_publish(&slot, newDoc);
+        sdsf_shared_document_release(newDoc);
+
+    String values with literals up to 15 bytes long are stored right in the SdsfValue (SdsfValue::asStringInline) instead of the separate string storage,
+    SdsfValue::asString points to that buffer in such case. Because of that, copy of SdsfValue must not outlive the original value.
+    sdsf_string_size returns size of the string value without strlen call for short strings
+
+    Arrays of composites (entity tables like [{ id 1 hp 0.5 }, { id 2 hp 1.0 }]) can be converted to struct-of-arrays form using sdsf_array_to_columns.
+    User provides SdsfColumnSpec (child name and value type) for every required column, and each column gets a contiguous typed buffer with
+    a value for every array member plus a validity bitmap (see sdsf_column_is_valid). Members which have no child with such name, have
+    a child of different type or are not composites at all are marked as null in the bitmap. Lossless conversions are allowed - int values
+    can be stored to int64, uint64 (if not negative) and double columns, int64 values to uint64 columns (if not negative), float values to double columns.
+    String columns point to strings of SdsfDeserializedResult, so result must outlive columns. Columns must be freed with sdsf_columns_free
+
     To serialize file user must:
         1) provide SdsfAllocator for library to use
         2) call sdsf_serializer_begin
@@ -84,27 +178,104 @@
         5) use SdsfSerializedResult data as needed
         6) free SdsfSerializedResult using sdsf_serialized_result_free
 
+        By default floating point values are written as decimals. If SDSF_SERIALIZER_FLAG_HEX_FLOATS is set in SdsfSerializer::flags
+        (after sdsf_serializer_begin call), floats and doubles are written as hexadecimal literals instead. Hexadecimal literals are
+        written and read with simple bit manipulations (no decimal conversion) and restore exactly the same value
+
+        Typed arrays can be stored as typed binary values using sdsf_serialize_binary_* functions (sdsf_serialize_binary_f32, etc.)
+        Data is written to the binary data blob as is, using host endianness
+
+        Flat buffer of numbers can be written as nested arrays using sdsf_serialize_tensor. Buffer is expected to be in row-major order,
+        shape lists sizes of dimensions from the outermost one to the innermost one
+
         Important - if SdsfSerializationError occurs, user can continue serialization process. Serialization error invalidates only a single command
         For example, if following sequence of commands was executed:
-            sdsf_serialize_string(&sdsf, "a", "first string");
+            sdsf_serialize_string(&sdsf, "aa", "first string");
             sdsf_serialize_string(&sdsf, NULL, "this command will fail because name is null");
-            sdsf_serialize_string(&sdsf, "c", "third string");
+            sdsf_serialize_string(&sdsf, "cc", "third string");
         Resulting sdsf file will look like this:
-            a "first string"
-            c "third string"
+            aa "first string"
+            cc "third string"
+
+    Serializer can also write data to SdsfOutputSink instead of building result in memory. To do that user must call sdsf_serializer_begin_streaming
+    instead of sdsf_serializer_begin. Text part of the file is written to the output each time main buffer is full, binary data blob is still
+    kept in memory and written by sdsf_serializer_end (because it must be in the end of file). SdsfSerializedResult is empty in that case.
+    If output write fails, sdsf_serializer_end returns SDSF_SERIALIZATION_ERROR_OUTPUT_FAILED
+
+    Serializer started with sdsf_serializer_begin_mapped writes data straight into memory mapped file at given path. File grows in big steps
+    (mapping starts from SDSF_SERIALIZER_MAIN_BUFFER_DEFAULT_CAPACITY and doubles, but never grows by more than SDSF_SERIALIZER_MAPPED_FILE_GROWTH
+    at once, mremap is used on linux if _GNU_SOURCE is defined) and is trimmed to the size of serialized data by sdsf_serializer_end,
+    so there is no final write and no copy in separate buffer. SdsfSerializedResult is empty in that case. On posix systems file is resized
+    with ftruncate, which unistd.h declares only if _POSIX_C_SOURCE >= 200112L (default for gnu modes; in strict c modes it must be defined
+    before any include), otherwise file is never created.
+    If file can't be created or grown, sdsf_serializer_end returns SDSF_SERIALIZATION_ERROR_OUTPUT_FAILED. Same as with any memory mapped file,
+    running out of disk space while pages are written can't be reported as error (process receives SIGBUS on posix systems)
+
+    To read file without building SdsfValue tree user can call sdsf_read_events with SdsfEventSink. Sink receives an SdsfEvent for every value
+    and for every start and end of array or composite, in order of appearance in file. Event names, strings and binary data pointers are valid
+    only during the sink call. Sink can stop reading by returning false (SDSF_DESERIALIZATION_ERROR_STOPPED_BY_EVENT_SINK is returned in that case).
+    Event reader allocates memory only for the longest name, the longest string and the nesting depth
+
+    Files larger than available memory can be read with sdsf_read_events_from_fd. File descriptor is read through a sliding window of windowSize
+    bytes (0 means SDSF_EVENT_READER_WINDOW_SIZE), so memory usage is bounded by window size and nesting depth (window grows only if a single
+    name, string or literal doesn't fit into it). Reading starts at current descriptor position. Binary data is read from the blob at the end
+    of file when binary value is reported, so it is available only if descriptor can be read at offset (regular files). For pipes and sockets
+    binaryData is NULL, unless the rest of file fits into the window. If reading fails, SDSF_DESERIALIZATION_ERROR_READ_FAILED is returned
+
+    Files can be compressed while they are written. SdsfCompressor wraps SdsfOutputSink and compresses everything written to it with SdsfCodec
+    (sdsf_lz_codec returns built-in lz4-like codec, user can provide any other codec with the same callbacks). Data is compressed in 64kb frames,
+    so memory usage doesn't depend on file size. Compressor works with streaming serializer and with transcoder:
+        SdsfCompressor compressor;
+        sdsf_compressor_begin(&compressor, allocator, sdsf_lz_codec(), fileOutput);
+        SdsfSerializer serializer = sdsf_serializer_begin_streaming(allocator, sdsf_compressor_sink(&compressor));
+        ...
+        SdsfSerializationError err = sdsf_serializer_end(&serializer, &result);
+        bool isWritten = sdsf_compressor_end(&compressor); // writes the last frame, returns false if any output write failed
+    Compressed file is read with sdsf_read_compressed_events_from_fd (codec must be the same). Frames are decompressed straight into the sliding
+    window, so there is no full decompressed copy. Compressor writes blob position after the last frame, so reader seeks straight to the blob
+    and binary data is decompressed from the blob frames when binary value is reported.
+    If compressed data is corrupted or truncated, SDSF_DESERIALIZATION_ERROR_DECOMPRESSION_FAILED is returned
+
+    Sdsf data can be transcoded to json and back using sdsf_transcode_to_json and sdsf_transcode_from_json functions. Both are built on top of
+    event-like reading and streaming writing, so no intermediate tree is created. Both write result to SdsfOutputSink. Mapping is:
+     - top level sdsf values <-> top level json object
+     - composite <-> object, array <-> array, bool <-> true/false, string <-> string
+     - int, int64 and uint64 <-> integer number. Json integers are stored as the smallest type they fit into (int, int64 or uint64)
+     - float and double <-> number with fraction or exponent. Json numbers are always stored as doubles. Infinities and NaNs can't be transcoded
+     - binary <-> {"$binary": "<base64 data>", "$type": "<element type tag>"} ("$type" is written only for typed binary values)
+       If SDSF_TRANSCODER_FLAG_BINARY_SIDECAR is set in SdsfTranscoder::flags, binary data is written to SdsfTranscoder::sidecarOutput instead
+       and binary values become {"$binaryRef": [<offset in sidecar>, <size>], "$type": "<element type tag>"}.
+       To transcode such json back, sidecar data must be provided in SdsfTranscoder::sidecarData and SdsfTranscoder::sidecarDataSize
+     - json null values can't be transcoded, json object keys must be valid sdsf identifiers
+    Sdsf is always validated as utf-8 when transcoded to json
+    Example :
+        SdsfTranscoder transcoder = { allocator };
+        SdsfTranscodingError err = sdsf_transcode_to_json(&transcoder, data, dataSize, output);
 
     User can alter library behaviour using preprocessor definitions:
-        SDSF_VALUES_ARRAY_DEFAULT_CAPACITY                  - defines default size for SdsfValueArray
+        SDSF_VALUES_ARRAY_DEFAULT_CAPACITY                  - defines size of the first block of SdsfValueArray
         SDSF_VALUES_PTR_ARRAY_DEFAULT_CAPACITY              - defines default size for SdsfValuePtrArray
-        SDSF_STRING_ARRAY_DEFAULT_CAPACITY                  - defines default size for SdsfStringArray
+        SDSF_STRING_ARRAY_DEFAULT_CAPACITY                  - defines size of the first block of SdsfStringArray
+        SDSF_PARALLEL_MIN_RANGE_SIZE                        - defines minimal size of a text range parsed by a single thread in sdsf_deserialize_parallel
+        SDSF_LOADER_CHUNK_SIZE                              - defines size of a single read in sdsf_load_file and sdsf_load_files
+        SDSF_EVENT_READER_WINDOW_SIZE                       - defines default size of input window for sdsf_read_events_from_fd
         SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY             - defines size for serializer's staging buffer (used for converting integers and floats to string)
         SDSF_SERIALIZER_MAIN_BUFFER_DEFAULT_CAPACITY        - defines default size for serializer's main (aka result) buffer
         SDSF_SERIALIZER_STACK_DEFAULT_CAPACITY              - defines default size for serializer's _SdsfSerializerStackEntry stack
         SDSF_SERIALIZER_BINARY_DATA_BUFFER_DEFAULT_CAPACITY - defines default size for serializer's binary data buffer
+        SDSF_SERIALIZER_MAPPED_FILE_GROWTH                  - defines maximal size by which file of sdsf_serializer_begin_mapped grows at once
+        SDSF_TRANSCODER_OUTPUT_BUFFER_CAPACITY              - defines size for buffer of json written by sdsf_transcode_to_json
+        SDSF_ALLOCATION_SITE_HOOK(site)                     - called with SdsfAllocationSite before allocator calls which grow (or free) values, strings,
+                                                              child pointers, binary data, serializer buffers and stacks, and with SDSF_ALLOCATION_SITE_OTHER after them.
+                                                              Allocator calls made outside of such scope belong to SDSF_ALLOCATION_SITE_OTHER. Can be used for allocation profiling :
+                                                                  static _Thread_local SdsfAllocationSite g_currentSite;
+                                                                  #define SDSF_ALLOCATION_SITE_HOOK(site) (g_currentSite = (site))
+                                                              Hook is called on the thread which calls allocator, so site must be thread local if documents are processed
+                                                              on several threads at once (sdsf_deserialize_many, sdsf_load_files or user threads). Does nothing by default
 
     Library does not check SdsfAllocator::alloc result. Valid pointer is always expected
 
-    Both serialization and deserialization operations return error codes (SdsfDeserializationError / SdsfSerializationError)
+    Serialization, deserialization and transcoding operations return error codes (SdsfDeserializationError / SdsfSerializationError / SdsfTranscodingError / SdsfColumnsError)
     On success error code is 0, so user can do error check using if statement:
     SdsfDeserializationError err = sdsf_deserialize(&dr, data, dataSize, allocator);
     if (err)
@@ -112,7 +283,7 @@
         // Handle error
     }
 
-    If error occurs, SdsfDeserializedResult and SdsfSerializer will have error description in errorMsg member
+    If error occurs, SdsfDeserializedResult, SdsfEventReader, SdsfColumns, SdsfSerializer and SdsfTranscoder will have error description in errorMsg member
     To access error message in unified manner sdsf_get_error_message macro can be used
 */
 
@@ -122,6 +293,7 @@ extern "C" {
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifndef SDSF_VALUES_ARRAY_DEFAULT_CAPACITY
 #   define SDSF_VALUES_ARRAY_DEFAULT_CAPACITY 1024
@@ -135,6 +307,18 @@ extern "C" {
 #   define SDSF_STRING_ARRAY_DEFAULT_CAPACITY 2048
 #endif
 
+#ifndef SDSF_PARALLEL_MIN_RANGE_SIZE
+#   define SDSF_PARALLEL_MIN_RANGE_SIZE 65536
+#endif
+
+#ifndef SDSF_LOADER_CHUNK_SIZE
+#   define SDSF_LOADER_CHUNK_SIZE (1024 * 1024)
+#endif
+
+#ifndef SDSF_EVENT_READER_WINDOW_SIZE
+#   define SDSF_EVENT_READER_WINDOW_SIZE 65536
+#endif
+
 #ifndef SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY
 #   define SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY 128
 #endif
@@ -151,6 +335,18 @@ extern "C" {
 #   define SDSF_SERIALIZER_MAIN_BUFFER_DEFAULT_CAPACITY 2048
 #endif
 
+#ifndef SDSF_SERIALIZER_MAPPED_FILE_GROWTH
+#   define SDSF_SERIALIZER_MAPPED_FILE_GROWTH (64 * 1024 * 1024)
+#endif
+
+#ifndef SDSF_TRANSCODER_OUTPUT_BUFFER_CAPACITY
+#   define SDSF_TRANSCODER_OUTPUT_BUFFER_CAPACITY 16384
+#endif
+
+#ifndef SDSF_ALLOCATION_SITE_HOOK
+#   define SDSF_ALLOCATION_SITE_HOOK(site)
+#endif
+
 typedef enum
 {
     SDSF_VALUE_UNDEFINED,
@@ -161,6 +357,11 @@ typedef enum
     SDSF_VALUE_BINARY,
     SDSF_VALUE_ARRAY,
     SDSF_VALUE_COMPOSITE,
+    SDSF_VALUE_INT64,
+    SDSF_VALUE_UINT64,
+    SDSF_VALUE_DOUBLE,
+    SDSF_VALUE_PACKED_ARRAY,
+    SDSF_VALUE_TENSOR,
 } SdsfValueType;
 
 const char* SDSF_VALUE_TYPE_TO_STR[] =
@@ -173,6 +374,11 @@ const char* SDSF_VALUE_TYPE_TO_STR[] =
     "SDSF_VALUE_BINARY",
     "SDSF_VALUE_ARRAY",
     "SDSF_VALUE_COMPOSITE",
+    "SDSF_VALUE_INT64",
+    "SDSF_VALUE_UINT64",
+    "SDSF_VALUE_DOUBLE",
+    "SDSF_VALUE_PACKED_ARRAY",
+    "SDSF_VALUE_TENSOR",
 };
 
 typedef enum
@@ -184,6 +390,13 @@ typedef enum
     SDSF_DESERIALIZATION_ERROR_UNEXPECTED_BINARY_DATA_BLOB,
     SDSF_DESERIALIZATION_ERROR_UNEXPECTED_IDENTIFIER,
     SDSF_DESERIALIZATION_ERROR_INVALID_BINARY_LITERAL,
+    SDSF_DESERIALIZATION_ERROR_INVALID_NUMERIC_LITERAL,
+    SDSF_DESERIALIZATION_ERROR_INVALID_STRING_LITERAL,
+    SDSF_DESERIALIZATION_ERROR_INVALID_UTF8,
+    SDSF_DESERIALIZATION_ERROR_UNEXPECTED_END_OF_DATA,
+    SDSF_DESERIALIZATION_ERROR_STOPPED_BY_EVENT_SINK,
+    SDSF_DESERIALIZATION_ERROR_READ_FAILED,
+    SDSF_DESERIALIZATION_ERROR_DECOMPRESSION_FAILED,
 } SdsfDeserializationError;
 
 const char* SDSF_DESERIALIZATION_ERROR_TO_STR[] =
@@ -195,6 +408,75 @@ const char* SDSF_DESERIALIZATION_ERROR_TO_STR[] =
     "SDSF_DESERIALIZATION_ERROR_UNEXPECTED_BINARY_DATA_BLOB",
     "SDSF_DESERIALIZATION_ERROR_UNEXPECTED_IDENTIFIER",
     "SDSF_DESERIALIZATION_ERROR_INVALID_BINARY_LITERAL",
+    "SDSF_DESERIALIZATION_ERROR_INVALID_NUMERIC_LITERAL",
+    "SDSF_DESERIALIZATION_ERROR_INVALID_STRING_LITERAL",
+    "SDSF_DESERIALIZATION_ERROR_INVALID_UTF8",
+    "SDSF_DESERIALIZATION_ERROR_UNEXPECTED_END_OF_DATA",
+    "SDSF_DESERIALIZATION_ERROR_STOPPED_BY_EVENT_SINK",
+    "SDSF_DESERIALIZATION_ERROR_READ_FAILED",
+    "SDSF_DESERIALIZATION_ERROR_DECOMPRESSION_FAILED",
+};
+
+typedef enum
+{
+    SDSF_DESERIALIZER_FLAG_VALIDATE_UTF8 = 1 << 0,
+    SDSF_DESERIALIZER_FLAG_PACK_ARRAYS   = 1 << 1,
+} SdsfDeserializerFlags;
+
+typedef enum
+{
+    SDSF_BINARY_RAW,
+    SDSF_BINARY_U8,
+    SDSF_BINARY_I8,
+    SDSF_BINARY_U16,
+    SDSF_BINARY_I16,
+    SDSF_BINARY_U32,
+    SDSF_BINARY_I32,
+    SDSF_BINARY_U64,
+    SDSF_BINARY_I64,
+    SDSF_BINARY_F32,
+    SDSF_BINARY_F64,
+} SdsfBinaryElementType;
+
+const char* SDSF_BINARY_ELEMENT_TYPE_TO_STR[] =
+{
+    "SDSF_BINARY_RAW",
+    "SDSF_BINARY_U8",
+    "SDSF_BINARY_I8",
+    "SDSF_BINARY_U16",
+    "SDSF_BINARY_I16",
+    "SDSF_BINARY_U32",
+    "SDSF_BINARY_I32",
+    "SDSF_BINARY_U64",
+    "SDSF_BINARY_I64",
+    "SDSF_BINARY_F32",
+    "SDSF_BINARY_F64",
+};
+
+//
+// Passed to SDSF_ALLOCATION_SITE_HOOK
+//
+typedef enum
+{
+    SDSF_ALLOCATION_SITE_OTHER,
+    SDSF_ALLOCATION_SITE_VALUES,
+    SDSF_ALLOCATION_SITE_STRINGS,
+    SDSF_ALLOCATION_SITE_CHILD_POINTERS,
+    SDSF_ALLOCATION_SITE_BINARY_DATA,
+    SDSF_ALLOCATION_SITE_SERIALIZER_BUFFERS,
+    SDSF_ALLOCATION_SITE_STACK,
+    SDSF_ALLOCATION_SITE_COUNT,
+} SdsfAllocationSite;
+
+const char* SDSF_ALLOCATION_SITE_TO_STR[] =
+{
+    "SDSF_ALLOCATION_SITE_OTHER",
+    "SDSF_ALLOCATION_SITE_VALUES",
+    "SDSF_ALLOCATION_SITE_STRINGS",
+    "SDSF_ALLOCATION_SITE_CHILD_POINTERS",
+    "SDSF_ALLOCATION_SITE_BINARY_DATA",
+    "SDSF_ALLOCATION_SITE_SERIALIZER_BUFFERS",
+    "SDSF_ALLOCATION_SITE_STACK",
 };
 
 typedef struct
@@ -235,11 +517,20 @@ typedef struct SdsfValue
         bool asBool;
         int32_t asInt;
         float asFloat;
-        const char* asString;
+        int64_t asInt64;
+        uint64_t asUint64;
+        double asDouble;
+        struct
+        {
+            const char* asString;
+            char asStringInline[16];    // strings up to 15 bytes long are stored here, asString points to this buffer in that case
+        };
         struct
         {
             size_t dataOffset;
             size_t dataSize;
+            SdsfBinaryElementType elementType;
+            bool isBigEndian;
         } asBinary;
         struct
         {
@@ -249,9 +540,31 @@ typedef struct SdsfValue
         {
             SdsfValuePtrArray childs;
         } asComposite;
+        struct
+        {
+            SdsfValueType elementType;  // SDSF_VALUE_BOOL, SDSF_VALUE_INT, SDSF_VALUE_FLOAT, SDSF_VALUE_INT64, SDSF_VALUE_UINT64 or SDSF_VALUE_DOUBLE
+            void* data;                 // elements stored one after another, bools are stored as bits
+            size_t size;                // number of elements
+        } asPackedArray;
+        struct
+        {
+            SdsfValueType elementType;  // SDSF_VALUE_INT, SDSF_VALUE_FLOAT, SDSF_VALUE_INT64, SDSF_VALUE_UINT64 or SDSF_VALUE_DOUBLE
+            uint32_t rank;
+            size_t* shape;              // rank sizes, from the outermost dimension to the innermost one
+            void* data;                 // elements in row-major order, stored in the same allocation right after shape
+        } asTensor;
     };
 } SdsfValue;
 
+typedef struct
+{
+    SdsfValueType   elementType;
+    size_t          rank;
+    const size_t*   shape;
+    const void*     data;
+    size_t          count;  // total number of elements
+} SdsfTensor;
+
 typedef struct
 {
     SdsfAllocator       allocator;
@@ -263,6 +576,26 @@ typedef struct
     const char*         errorMsg;
 } SdsfDeserializedResult;
 
+typedef struct
+{
+    const void* data;
+    size_t      dataSize;
+} SdsfInput;
+
+typedef struct
+{
+    SdsfDeserializedResult  result;     // must not be changed after document was shared
+    volatile int32_t        refCount;
+} SdsfSharedDocument;
+
+typedef struct
+{
+    SdsfSharedDocument* volatile    document;
+    volatile int32_t                epoch;
+    volatile int32_t                readerCounts[2];
+    volatile int32_t                isPublishing;
+} SdsfDocumentSlot;
+
 typedef enum
 {
     SDSF_SERIALIZATION_ERROR_ALL_FINE = 0,
@@ -273,6 +606,9 @@ typedef enum
     SDSF_SERIALIZATION_ERROR_UNABLE_TO_END_ARRAY,
     SDSF_SERIALIZATION_ERROR_UNABLE_TO_END_COMPOSITE,
     SDSF_SERIALIZATION_ERROR_UNFINISHED_ARRAY_OR_COMPOSITE_VALUES,
+    SDSF_SERIALIZATION_ERROR_OUTPUT_FAILED,
+    SDSF_SERIALIZATION_ERROR_INVALID_TENSOR,
+    SDSF_SERIALIZATION_ERROR_INVALID_BINARY,
 } SdsfSerializationError;
 
 const char* SDSF_SERIALIZATION_ERROR_TO_STR[] =
@@ -285,6 +621,9 @@ const char* SDSF_SERIALIZATION_ERROR_TO_STR[] =
     "SDSF_SERIALIZATION_ERROR_UNABLE_TO_END_ARRAY",
     "SDSF_SERIALIZATION_ERROR_UNABLE_TO_END_COMPOSITE",
     "SDSF_SERIALIZATION_ERROR_UNFINISHED_ARRAY_OR_COMPOSITE_VALUES",
+    "SDSF_SERIALIZATION_ERROR_OUTPUT_FAILED",
+    "SDSF_SERIALIZATION_ERROR_INVALID_TENSOR",
+    "SDSF_SERIALIZATION_ERROR_INVALID_BINARY",
 };
 
 typedef enum 
@@ -294,9 +633,50 @@ typedef enum
     _SDSF_SERIALIZER_IN_COMPOSITE,
 } _SdsfSerializerStackEntry;
 
+typedef enum
+{
+    SDSF_SERIALIZER_FLAG_HEX_FLOATS = 1 << 0,
+} SdsfSerializerFlags;
+
+typedef struct
+{
+    bool (*write)(const void* data, size_t dataSize, void* userData);
+    void* userData;
+} SdsfOutputSink;
+
+typedef struct
+{
+    size_t  (*compress)(const void* src, size_t srcSize, void* dst, size_t dstCapacity, void* userData);  // returns compressed size or 0 if result doesn't fit into dst
+    bool    (*decompress)(const void* src, size_t srcSize, void* dst, size_t dstSize, void* userData);    // must fill exactly dstSize bytes
+    void*   userData;
+} SdsfCodec;
+
+typedef struct
+{
+    SdsfAllocator   allocator;
+    SdsfCodec       codec;
+    SdsfOutputSink  output;
+    bool            isOutputFailed;
+    char*           frame;
+    size_t          frameSize;
+    char*           packedFrame;
+    uint64_t        rawOffset;              // decompressed offset of the current frame
+    uint64_t        fileOffset;             // offset of the current frame header from the stream start
+    bool            isBlobFound;
+    bool            isBlobScanInString;
+    size_t          blobScanSkip;
+    uint64_t        blobOffset;             // decompressed offset of binary data blob
+    bool            isBlobFrameWritten;
+    uint64_t        blobFrameRawOffset;
+    uint64_t        blobFrameFileOffset;
+} SdsfCompressor;
+
 typedef struct
 {
     SdsfAllocator               allocator;
+    uint32_t                    flags;
+    SdsfOutputSink              output;
+    bool                        isOutputFailed;
     char*                       stagingBuffer1;
     char*                       stagingBuffer2;
     _SdsfSerializerStackEntry*  stack;
@@ -308,6 +688,7 @@ typedef struct
     void*                       mainBuffer;
     size_t                      mainBufferSize;
     size_t                      mainBufferCapacity;
+    void*                       mappedOutput;   // main buffer is a memory mapped file if this is not NULL (see sdsf_serializer_begin_mapped)
     const char*                 errorMsg;
 } SdsfSerializer;
 
@@ -319,15 +700,205 @@ typedef struct
     size_t          bufferCapacity;
 } SdsfSerializedResult;
 
+typedef enum
+{
+    SDSF_COLUMNS_ERROR_ALL_FINE = 0,
+    SDSF_COLUMNS_ERROR_NOT_AN_ARRAY,
+    SDSF_COLUMNS_ERROR_UNSUPPORTED_COLUMN_TYPE,
+} SdsfColumnsError;
+
+const char* SDSF_COLUMNS_ERROR_TO_STR[] =
+{
+    "SDSF_COLUMNS_ERROR_ALL_FINE",
+    "SDSF_COLUMNS_ERROR_NOT_AN_ARRAY",
+    "SDSF_COLUMNS_ERROR_UNSUPPORTED_COLUMN_TYPE",
+};
+
+typedef struct
+{
+    const char*     name;       // name of the composite child which goes to the column
+    SdsfValueType   type;       // SDSF_VALUE_BOOL, SDSF_VALUE_INT, SDSF_VALUE_FLOAT, SDSF_VALUE_INT64, SDSF_VALUE_UINT64, SDSF_VALUE_DOUBLE or SDSF_VALUE_STRING
+} SdsfColumnSpec;
+
+typedef struct
+{
+    const char*     name;
+    SdsfValueType   type;
+    void*           data;       // rowCount elements of bool, int32_t, float, int64_t, uint64_t, double or const char* type. Missing values are zeroed
+    uint8_t*        validity;   // bit (row % 8) of byte (row / 8) is set if row has the value
+    size_t          nullCount;
+} SdsfColumn;
+
+typedef struct
+{
+    SdsfAllocator   allocator;
+    SdsfColumn*     columns;
+    size_t          columnCount;
+    size_t          rowCount;
+    const char*     errorMsg;
+} SdsfColumns;
+
+typedef enum
+{
+    SDSF_EVENT_VALUE,
+    SDSF_EVENT_ARRAY_BEGIN,
+    SDSF_EVENT_ARRAY_END,
+    SDSF_EVENT_COMPOSITE_BEGIN,
+    SDSF_EVENT_COMPOSITE_END,
+} SdsfEventType;
+
+const char* SDSF_EVENT_TYPE_TO_STR[] =
+{
+    "SDSF_EVENT_VALUE",
+    "SDSF_EVENT_ARRAY_BEGIN",
+    "SDSF_EVENT_ARRAY_END",
+    "SDSF_EVENT_COMPOSITE_BEGIN",
+    "SDSF_EVENT_COMPOSITE_END",
+};
+
+typedef struct
+{
+    SdsfEventType   type;
+    SdsfValue       value;      // name, type and payload of the value. parent and childs are never set. name is NULL for array members and *_END events
+    size_t          stringSize; // size of value.asString without null terminator
+    const void*     binaryData; // data of binary value or NULL if value points outside of the binary data blob
+    size_t          depth;      // top level values have depth 0
+} SdsfEvent;
+
+typedef struct
+{
+    bool (*handle)(const SdsfEvent* event, void* userData);
+    void* userData;
+} SdsfEventSink;
+
+typedef struct
+{
+    SdsfValueType   type;
+    size_t          childCount;
+} _SdsfEventReaderScope;
+
+typedef struct
+{
+    SdsfAllocator   allocator;
+    void*           nameBuffer;
+    size_t          nameBufferCapacity;
+    void*           stringBuffer;
+    size_t          stringBufferCapacity;
+    void*           scopes;
+    size_t          scopesSize;
+    size_t          scopesCapacity;
+    const char*     errorMsg;
+} SdsfEventReader;
+
+typedef enum
+{
+    SDSF_TRANSCODING_ERROR_ALL_FINE = 0,
+    SDSF_TRANSCODING_ERROR_INVALID_SDSF,
+    SDSF_TRANSCODING_ERROR_INVALID_JSON,
+    SDSF_TRANSCODING_ERROR_UNSUPPORTED_VALUE,
+    SDSF_TRANSCODING_ERROR_INVALID_BINARY,
+    SDSF_TRANSCODING_ERROR_SERIALIZATION_FAILED,
+    SDSF_TRANSCODING_ERROR_OUTPUT_FAILED,
+} SdsfTranscodingError;
+
+const char* SDSF_TRANSCODING_ERROR_TO_STR[] =
+{
+    "SDSF_TRANSCODING_ERROR_ALL_FINE",
+    "SDSF_TRANSCODING_ERROR_INVALID_SDSF",
+    "SDSF_TRANSCODING_ERROR_INVALID_JSON",
+    "SDSF_TRANSCODING_ERROR_UNSUPPORTED_VALUE",
+    "SDSF_TRANSCODING_ERROR_INVALID_BINARY",
+    "SDSF_TRANSCODING_ERROR_SERIALIZATION_FAILED",
+    "SDSF_TRANSCODING_ERROR_OUTPUT_FAILED",
+};
+
+typedef enum
+{
+    SDSF_TRANSCODER_FLAG_BINARY_SIDECAR = 1 << 0,
+} SdsfTranscoderFlags;
+
+typedef struct
+{
+    SdsfAllocator   allocator;
+    uint32_t        flags;
+    SdsfOutputSink  sidecarOutput;      // sdsf -> json : receives binary data if SDSF_TRANSCODER_FLAG_BINARY_SIDECAR is set
+    const void*     sidecarData;        // json -> sdsf : data referenced by {"$binaryRef": [offset, size]} objects
+    size_t          sidecarDataSize;
+    const char*     errorMsg;
+} SdsfTranscoder;
+
 SdsfDeserializationError sdsf_deserialize(SdsfDeserializedResult* result, const void* data, size_t dataSize, SdsfAllocator allocator);
+SdsfDeserializationError sdsf_deserialize_with_flags(SdsfDeserializedResult* result, const void* data, size_t dataSize, SdsfAllocator allocator, uint32_t flags);
+SdsfDeserializationError sdsf_deserialize_many(SdsfDeserializedResult* results, SdsfDeserializationError* errors, const SdsfInput* inputs, size_t count, const SdsfAllocator* allocators, size_t threadCount, uint32_t flags);
+SdsfDeserializationError sdsf_deserialize_parallel(SdsfDeserializedResult* result, const void* data, size_t dataSize, SdsfAllocator allocator, size_t threadCount, uint32_t flags);
+SdsfDeserializationError sdsf_deserialize_pipelined(SdsfDeserializedResult* result, const void* data, size_t dataSize, SdsfAllocator allocator, uint32_t flags);
+SdsfDeserializationError sdsf_load_file(SdsfDeserializedResult* result, const char* path, SdsfAllocator allocator, uint32_t flags);
+SdsfDeserializationError sdsf_load_files(SdsfDeserializedResult* results, SdsfDeserializationError* errors, const char* const* paths, size_t count, const SdsfAllocator* allocators, size_t threadCount, uint32_t flags);
 void sdsf_deserialized_result_free(SdsfDeserializedResult* sdsf);
+size_t sdsf_hardware_thread_count();
+
+size_t sdsf_string_size(const SdsfValue* value);
+
+SdsfSharedDocument* sdsf_share_result(SdsfDeserializedResult* result);
+void sdsf_shared_document_retain(SdsfSharedDocument* document);
+void sdsf_shared_document_release(SdsfSharedDocument* document);
+SdsfSharedDocument* sdsf_document_slot_acquire(SdsfDocumentSlot* slot);
+void sdsf_document_slot_publish(SdsfDocumentSlot* slot, SdsfSharedDocument* document);
+
+const void*     sdsf_binary_as_typed(const SdsfDeserializedResult* sdsf, const SdsfValue* value, SdsfBinaryElementType type, size_t* count);
+const uint8_t*  sdsf_binary_as_u8(const SdsfDeserializedResult* sdsf, const SdsfValue* value, size_t* count);
+const int8_t*   sdsf_binary_as_i8(const SdsfDeserializedResult* sdsf, const SdsfValue* value, size_t* count);
+const uint16_t* sdsf_binary_as_u16(const SdsfDeserializedResult* sdsf, const SdsfValue* value, size_t* count);
+const int16_t*  sdsf_binary_as_i16(const SdsfDeserializedResult* sdsf, const SdsfValue* value, size_t* count);
+const uint32_t* sdsf_binary_as_u32(const SdsfDeserializedResult* sdsf, const SdsfValue* value, size_t* count);
+const int32_t*  sdsf_binary_as_i32(const SdsfDeserializedResult* sdsf, const SdsfValue* value, size_t* count);
+const uint64_t* sdsf_binary_as_u64(const SdsfDeserializedResult* sdsf, const SdsfValue* value, size_t* count);
+const int64_t*  sdsf_binary_as_i64(const SdsfDeserializedResult* sdsf, const SdsfValue* value, size_t* count);
+const float*    sdsf_binary_as_f32(const SdsfDeserializedResult* sdsf, const SdsfValue* value, size_t* count);
+const double*   sdsf_binary_as_f64(const SdsfDeserializedResult* sdsf, const SdsfValue* value, size_t* count);
+
+bool            sdsf_packed_array_get(const SdsfValue* array, size_t index, SdsfValue* element);
+const void*     sdsf_packed_array_as_typed(const SdsfValue* array, SdsfValueType elementType, size_t* count);
+const uint8_t*  sdsf_packed_array_as_bits(const SdsfValue* array, size_t* count);
+const int32_t*  sdsf_packed_array_as_int(const SdsfValue* array, size_t* count);
+const float*    sdsf_packed_array_as_float(const SdsfValue* array, size_t* count);
+const int64_t*  sdsf_packed_array_as_int64(const SdsfValue* array, size_t* count);
+const uint64_t* sdsf_packed_array_as_uint64(const SdsfValue* array, size_t* count);
+const double*   sdsf_packed_array_as_double(const SdsfValue* array, size_t* count);
+
+bool sdsf_array_as_tensor(const SdsfValue* array, SdsfTensor* tensor);
+
+SdsfColumnsError sdsf_array_to_columns(SdsfColumns* result, const SdsfValue* array, const SdsfColumnSpec* specs, size_t specCount, SdsfAllocator allocator);
+bool sdsf_column_is_valid(const SdsfColumn* column, size_t row);
+void sdsf_columns_free(SdsfColumns* columns);
+
+SdsfDeserializationError sdsf_read_events(SdsfEventReader* reader, const void* data, size_t dataSize, SdsfAllocator allocator, SdsfEventSink sink, uint32_t flags);
+SdsfDeserializationError sdsf_read_events_from_fd(SdsfEventReader* reader, int fd, size_t windowSize, SdsfAllocator allocator, SdsfEventSink sink, uint32_t flags);
+SdsfDeserializationError sdsf_read_compressed_events_from_fd(SdsfEventReader* reader, int fd, size_t windowSize, SdsfCodec codec, SdsfAllocator allocator, SdsfEventSink sink, uint32_t flags);
 
 SdsfSerializer sdsf_serializer_begin(SdsfAllocator allocator);
+SdsfSerializer sdsf_serializer_begin_streaming(SdsfAllocator allocator, SdsfOutputSink output);
+SdsfSerializer sdsf_serializer_begin_mapped(SdsfAllocator allocator, const char* path);
 SdsfSerializationError sdsf_serialize_bool(SdsfSerializer* sdsf, const char* name, bool value);
 SdsfSerializationError sdsf_serialize_int(SdsfSerializer* sdsf, const char* name, int32_t value);
 SdsfSerializationError sdsf_serialize_float(SdsfSerializer* sdsf, const char* name, float value);
+SdsfSerializationError sdsf_serialize_int64(SdsfSerializer* sdsf, const char* name, int64_t value);
+SdsfSerializationError sdsf_serialize_uint64(SdsfSerializer* sdsf, const char* name, uint64_t value);
+SdsfSerializationError sdsf_serialize_double(SdsfSerializer* sdsf, const char* name, double value);
 SdsfSerializationError sdsf_serialize_string(SdsfSerializer* sdsf, const char* name, const char* value);
 SdsfSerializationError sdsf_serialize_binary(SdsfSerializer* sdsf, const char* name, const void* value, size_t size);
+SdsfSerializationError sdsf_serialize_binary_typed(SdsfSerializer* sdsf, const char* name, SdsfBinaryElementType type, const void* values, size_t count);
+SdsfSerializationError sdsf_serialize_binary_u8(SdsfSerializer* sdsf, const char* name, const uint8_t* values, size_t count);
+SdsfSerializationError sdsf_serialize_binary_i8(SdsfSerializer* sdsf, const char* name, const int8_t* values, size_t count);
+SdsfSerializationError sdsf_serialize_binary_u16(SdsfSerializer* sdsf, const char* name, const uint16_t* values, size_t count);
+SdsfSerializationError sdsf_serialize_binary_i16(SdsfSerializer* sdsf, const char* name, const int16_t* values, size_t count);
+SdsfSerializationError sdsf_serialize_binary_u32(SdsfSerializer* sdsf, const char* name, const uint32_t* values, size_t count);
+SdsfSerializationError sdsf_serialize_binary_i32(SdsfSerializer* sdsf, const char* name, const int32_t* values, size_t count);
+SdsfSerializationError sdsf_serialize_binary_u64(SdsfSerializer* sdsf, const char* name, const uint64_t* values, size_t count);
+SdsfSerializationError sdsf_serialize_binary_i64(SdsfSerializer* sdsf, const char* name, const int64_t* values, size_t count);
+SdsfSerializationError sdsf_serialize_binary_f32(SdsfSerializer* sdsf, const char* name, const float* values, size_t count);
+SdsfSerializationError sdsf_serialize_binary_f64(SdsfSerializer* sdsf, const char* name, const double* values, size_t count);
+SdsfSerializationError sdsf_serialize_tensor(SdsfSerializer* sdsf, const char* name, SdsfValueType elementType, const void* values, const size_t* shape, size_t rank);
 SdsfSerializationError sdsf_serialize_array_start(SdsfSerializer* sdsf, const char* name);
 SdsfSerializationError sdsf_serialize_array_end(SdsfSerializer* sdsf);
 SdsfSerializationError sdsf_serialize_composite_start(SdsfSerializer* sdsf, const char* name);
@@ -335,6 +906,14 @@ SdsfSerializationError sdsf_serialize_composite_end(SdsfSerializer* sdsf);
 SdsfSerializationError sdsf_serializer_end(SdsfSerializer* sdsf, SdsfSerializedResult* result);
 void sdsf_serialized_result_free(SdsfSerializedResult* sdsf);
 
+SdsfCodec sdsf_lz_codec(void);
+void sdsf_compressor_begin(SdsfCompressor* compressor, SdsfAllocator allocator, SdsfCodec codec, SdsfOutputSink output);
+SdsfOutputSink sdsf_compressor_sink(SdsfCompressor* compressor);
+bool sdsf_compressor_end(SdsfCompressor* compressor);
+
+SdsfTranscodingError sdsf_transcode_to_json(SdsfTranscoder* transcoder, const void* data, size_t dataSize, SdsfOutputSink output);
+SdsfTranscodingError sdsf_transcode_from_json(SdsfTranscoder* transcoder, const void* json, size_t jsonSize, SdsfOutputSink output);
+
 #define sdsf_get_error_message(obj) (obj).errorMsg
 
 #ifdef __cplusplus
@@ -354,6 +933,65 @@ extern "C" {
 
 #include <string.h>
 #include <stdlib.h>
+#include <stdio.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define _SDSF_SSE2
+#   include <emmintrin.h>
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#   define _SDSF_SSSE3
+#   include <tmmintrin.h>
+#elif defined(_SDSF_SSE2) && (defined(_MSC_VER) || ((defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))))
+//
+// SSSE3 isn't enabled at compile time, but compiler can still build SSSE3 functions, which are called only if cpu supports them
+//
+#   define _SDSF_SSSE3_DISPATCH
+#   include <tmmintrin.h>
+#endif
+
+#if defined(_SDSF_SSSE3_DISPATCH) && !defined(_MSC_VER)
+#   define _SDSF_TARGET_SSSE3 __attribute__((target("ssse3")))
+#else
+#   define _SDSF_TARGET_SSSE3
+#endif
+
+#ifdef _MSC_VER
+#   include <intrin.h>
+#endif
+
+#ifdef _WIN32
+//
+// Keep windows.h from pulling winsock, GDI and min/max macros into translation units which include this header
+//
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#       define _SDSF_UNDEF_WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#       define _SDSF_UNDEF_NOMINMAX
+#   endif
+#   include <windows.h>
+#   include <io.h>
+#   ifdef _SDSF_UNDEF_WIN32_LEAN_AND_MEAN
+#       undef WIN32_LEAN_AND_MEAN
+#       undef _SDSF_UNDEF_WIN32_LEAN_AND_MEAN
+#   endif
+#   ifdef _SDSF_UNDEF_NOMINMAX
+#       undef NOMINMAX
+#       undef _SDSF_UNDEF_NOMINMAX
+#   endif
+#else
+#   include <sched.h>
+#   include <pthread.h>
+#   include <unistd.h>
+#   include <fcntl.h>
+#   include <errno.h>
+#   include <sys/stat.h>
+#   include <sys/mman.h>
+#endif
 
 #ifdef _SDSF_INDENT_SIZE
 #   error User should not redefine _SDSF_INDENT_SIZE value
@@ -365,1125 +1003,7640 @@ extern "C" {
 #endif
 #define _SDSF_INDENT "    "
 
+//
+// Frame size is a part of compressed file format, so it can't be changed by user
+//
+#ifdef _SDSF_CODEC_FRAME_SIZE
+#   error User should not redefine _SDSF_CODEC_FRAME_SIZE value
+#endif
+#define _SDSF_CODEC_FRAME_SIZE 65536
+
+#ifdef _SDSF_CODEC_FRAME_HEADER_SIZE
+#   error User should not redefine _SDSF_CODEC_FRAME_HEADER_SIZE value
+#endif
+#define _SDSF_CODEC_FRAME_HEADER_SIZE 8
+
+#ifdef _SDSF_CODEC_MAGIC
+#   error User should not redefine _SDSF_CODEC_MAGIC value
+#endif
+#define _SDSF_CODEC_MAGIC "SDSZ"
+#define _SDSF_CODEC_MAGIC_SIZE 4
+
+#ifdef _SDSF_CODEC_TRAILER_MAGIC
+#   error User should not redefine _SDSF_CODEC_TRAILER_MAGIC value
+#endif
+#define _SDSF_CODEC_TRAILER_MAGIC "SDSB"
+#define _SDSF_CODEC_TRAILER_SIZE 28
+
+#ifdef _SDSF_LZ_HASH_BITS
+#   error User should not redefine _SDSF_LZ_HASH_BITS value
+#endif
+#define _SDSF_LZ_HASH_BITS 12
+#define _SDSF_LZ_MIN_MATCH 4
+#define _SDSF_LZ_LAST_LITERALS 5
+#define _SDSF_LZ_MATCH_START_LIMIT 12
+
 // ==============================================================================================================
 //
 //
-// Deserializer
+// Common
 //
 //
 // ==============================================================================================================
 
-typedef struct
-{
-    const char* ptr;
-    size_t size;
-} _SdsfComsumedString;
-
-typedef enum
-{
-    _SDSF_TOKEN_TYPE_INVALID,
-    _SDSF_TOKEN_TYPE_IDENTIFIER,
-    _SDSF_TOKEN_TYPE_RESERVED_SYMBOL,
-    _SDSF_TOKEN_TYPE_BOOL_LITERAL,
-    _SDSF_TOKEN_TYPE_INT_LITERAL,
-    _SDSF_TOKEN_TYPE_FLOAT_LITERAL,
-    _SDSF_TOKEN_TYPE_BINARY_LITERAL,
-    _SDSF_TOKEN_TYPE_STRING_LITERAL,
-} _SdsfTokenType;
-
-typedef enum
-{
-    _SDSF_STRING_LITERAL_NONE,
-    _SDSF_STRING_LITERAL_BEGIN,
-    _SDSF_STRING_LITERAL_END,
-} _SdsfStringLiteralState;
-
-typedef struct
+const char* _SDSF_BINARY_ELEMENT_TYPE_TAGS[] =
 {
-    const char* data;
-    size_t dataSize;
-    _SdsfStringLiteralState stringLiteralState;
-    size_t stringConsumePtr;
-} _SdsfTokenizerData;
+    "",
+    "u8",
+    "i8",
+    "u16",
+    "i16",
+    "u32",
+    "i32",
+    "u64",
+    "i64",
+    "f32",
+    "f64",
+};
 
-typedef struct
+const size_t _SDSF_BINARY_ELEMENT_TYPE_SIZES[] =
 {
-    const char* stringPtr;
-    size_t stringSize;
-    _SdsfTokenType tokenType;
-} _SdsfConsumedToken;
+    1,
+    1,
+    1,
+    2,
+    2,
+    4,
+    4,
+    8,
+    8,
+    4,
+    8,
+};
 
-inline bool _sdsf_is_skipped_char(char c)
+static inline uint32_t _sdsf_count_trailing_zeros(uint32_t value)
 {
-    return (c == ' ') || (c == '\n') || (c == '\r') || (c == '\t');
+    // value must not be zero
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctz(value);
+#endif
 }
 
-inline bool _sdsf_is_reserved_symbol(char c)
+static inline uint32_t _sdsf_count_trailing_zeros_64(uint64_t value)
 {
-    return
-        (c == ',') ||
-        (c == '[') ||
-        (c == ']') ||
-        (c == '{') ||
-        (c == '}') ||
-        (c == '\"') ||
-        (c == '@');
+    // value must not be zero
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (uint32_t)index;
+#elif defined(_MSC_VER)
+    return (uint32_t)value ? _sdsf_count_trailing_zeros((uint32_t)value) : 32 + _sdsf_count_trailing_zeros((uint32_t)(value >> 32));
+#else
+    return (uint32_t)__builtin_ctzll(value);
+#endif
 }
 
-inline bool _sdsf_is_number(char c)
+static inline bool _sdsf_is_big_endian_host()
 {
-    return c >= '0' && c <= '9';
+    const uint16_t value = 1;
+    return *((const uint8_t*)&value) == 0;
 }
 
-bool _sdsf_consume_string(const char* sourceBuffer, size_t sourceBufferSize, size_t* consumePtr, _SdsfComsumedString* result, bool isStringLiteral)
+//
+// Parses optional '-' sign followed by decimal digits. Unlike atoi/strtoull it never reads
+// past the provided string and reports overflow
+//
+bool _sdsf_parse_integer(const char* str, size_t size, bool* isNegative, uint64_t* magnitude)
 {
-    if (*consumePtr >= sourceBufferSize)
+    size_t it = 0;
+    *isNegative = size && str[0] == '-';
+    if (*isNegative)
+    {
+        it = 1;
+    }
+    if (it == size)
     {
         return false;
     }
 
-    size_t beginning;
-    if (!isStringLiteral)
+    uint64_t result = 0;
+    for (; it < size; it++)
     {
-        // Skip spaces and stuff
-        for (; *consumePtr < sourceBufferSize; *consumePtr += 1)
-        {
-            if (!_sdsf_is_skipped_char(sourceBuffer[*consumePtr])) break;
-        }
-
-        // Check reserved symbol
-        if (_sdsf_is_reserved_symbol(sourceBuffer[*consumePtr]))
-        {
-            result->ptr = sourceBuffer + *consumePtr;
-            result->size = 1;
-            *consumePtr += 1;
-            return true;
-        }
-
-        // Consume string until reserved or skip symbol
-        beginning = *consumePtr;
-        for (; *consumePtr < sourceBufferSize; *consumePtr += 1)
-        {
-            const char c = sourceBuffer[*consumePtr];
-            const bool isSkipped = _sdsf_is_skipped_char(c);
-            const bool isReserved = _sdsf_is_reserved_symbol(c);
-            if (isSkipped || isReserved) break;
-        }
-
-        // Zero size means we finished
-        const size_t size = *consumePtr - beginning;
-        if (!size)
+        const uint64_t digit = (uint64_t)(str[it] - '0');
+        if (digit > 9 || result > (UINT64_MAX - digit) / 10)
         {
             return false;
         }
-    }
-    else
-    {
-        beginning = *consumePtr;
-        for (; *consumePtr < sourceBufferSize; *consumePtr += 1)
-        {
-            const char c = sourceBuffer[*consumePtr];
-            if (c == '\"') break;
-        }
+        result = result * 10 + digit;
     }
 
-    result->ptr = sourceBuffer + beginning;
-    result->size = *consumePtr - beginning;
+    *magnitude = result;
     return true;
 }
 
-_SdsfTokenType _sdsf_match_string(SdsfDeserializedResult* sdsf, const _SdsfComsumedString* str)
+//
+// Number of significant digits which is always enough to round decimal literal to the nearest double
+//
+#define _SDSF_MAX_SIGNIFICANT_DIGITS 800
+
+//
+// Decimal floating point parser. Literals with up to 15 significant digits and small exponents (which is the vast majority
+// of literals in real files) are converted exactly using a single multiplication or division (Clinger's fast path).
+// Everything else goes through strtod
+//
+bool _sdsf_parse_double(const char* str, size_t size, double* result)
 {
-    if (!str->ptr || !str->size)
+    static const double powersOfTen[] =
     {
-        sdsf->errorMsg = "Tokenzer error - invalid string provided";
-        return _SDSF_TOKEN_TYPE_INVALID;
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+
+    size_t it = 0;
+    const bool isNegative = size && str[0] == '-';
+    if (isNegative)
+    {
+        it = 1;
     }
-    
-    if (str->size == 1)
+
+    uint64_t mantissa = 0;
+    size_t mantissaDigits = 0;
+    size_t digits = 0;
+    int64_t exponent = 0;
+    int64_t explicitExponent = 0;
+    bool dotFound = false;
+    for (; it < size; it++)
     {
-        const char c = *str->ptr;
-        const bool isReserved = _sdsf_is_reserved_symbol(c);
-        if (isReserved)
+        const char c = str[it];
+        if (c == '.')
         {
-            return _SDSF_TOKEN_TYPE_RESERVED_SYMBOL;
+            if (dotFound) return false;
+            dotFound = true;
+            continue;
         }
-        else
+        if (c < '0' || c > '9')
         {
-            if (_sdsf_is_number(c)) return _SDSF_TOKEN_TYPE_INT_LITERAL;
-            switch (c)
-            {
-                case 't':
-                case 'f': return _SDSF_TOKEN_TYPE_BOOL_LITERAL;
-                sdsf->errorMsg = "Tokenzer error - invalid bool literal";
-                default: return _SDSF_TOKEN_TYPE_INVALID;
-            }
+            break;
         }
-    }
-    else
-    {
-        typedef enum
+        digits += 1;
+        if (mantissa == 0 && c == '0')
         {
-            _POSSIBLE_IDENTIFIER     = 1 << 0,
-            _POSSIBLE_INT_LITERAL    = 1 << 1,
-            _POSSIBLE_FLOAT_LITERAL  = 1 << 2,
-            _POSSIBLE_BINARY_LITERAL = 1 << 3,
-        } _PossibilitySpaceValue;
-        int32_t possibilitySpace = 0;
-        bool dotFound = false;
-        bool dashFound = false;
-
-        const char firstChar = *str->ptr;
-        if (firstChar == 'b')
+            // Leading zeros are not significant
+            if (dotFound) exponent -= 1;
+            continue;
+        }
+        if (mantissaDigits < 19)
         {
-            possibilitySpace = _POSSIBLE_BINARY_LITERAL | _POSSIBLE_IDENTIFIER;
+            mantissa = mantissa * 10 + (uint64_t)(c - '0');
+            mantissaDigits += 1;
+            if (dotFound) exponent -= 1;
         }
-        else if (_sdsf_is_number(firstChar) || firstChar == '-')
+        else
         {
-            possibilitySpace = _POSSIBLE_INT_LITERAL | _POSSIBLE_FLOAT_LITERAL;
-            if (firstChar == '-') dashFound = true;
+            // Digit doesn't fit into mantissa, so it is dropped and fast path is not possible anymore
+            mantissaDigits += 1;
+            if (!dotFound) exponent += 1;
         }
-        else if (firstChar == '.' )
+    }
+    if (!digits)
+    {
+        return false;
+    }
+
+    if (it < size)
+    {
+        if (str[it] != 'e' && str[it] != 'E')
         {
-            possibilitySpace = _POSSIBLE_FLOAT_LITERAL;
-            dotFound = true;
+            return false;
         }
-        else if (_sdsf_is_skipped_char(firstChar) || _sdsf_is_reserved_symbol(firstChar))
+        it += 1;
+        bool isExponentNegative = false;
+        if (it < size && (str[it] == '-' || str[it] == '+'))
         {
-            sdsf->errorMsg = "Tokenzer error - unexpected character";
-            return _SDSF_TOKEN_TYPE_INVALID;
+            isExponentNegative = str[it] == '-';
+            it += 1;
         }
-        else
+        uint64_t explicitExponentValue = 0;
+        bool isExplicitExponentNegative = false;
+        if (!_sdsf_parse_integer(&str[it], size - it, &isExplicitExponentNegative, &explicitExponentValue) || isExplicitExponentNegative)
         {
-            possibilitySpace = _POSSIBLE_IDENTIFIER;
+            return false;
         }
-
-        for (size_t it = 1; it < str->size; it++)
+        if (explicitExponentValue > 100000)
         {
-            const char c = str->ptr[it];
-            if (_sdsf_is_number(c))
-            {
-                continue; // can be anything
-            }
+            explicitExponentValue = 100000;
+        }
+        explicitExponent = isExponentNegative ? -(int64_t)explicitExponentValue : (int64_t)explicitExponentValue;
+        exponent += explicitExponent;
+    }
 
-            if (_sdsf_is_skipped_char(c) || _sdsf_is_reserved_symbol(c))
-            {
-                sdsf->errorMsg = "Tokenzer error - unexpected character";
-                return _SDSF_TOKEN_TYPE_INVALID;
-            }
+    if (mantissa == 0)
+    {
+        *result = isNegative ? -0.0 : 0.0;
+        return true;
+    }
 
-            switch(c)
-            {
-                case '.':
-                {
-                    if (dotFound)
-                    {
-                        sdsf->errorMsg = "Tokenzer error - two '.' characters in single literal";
-                        return _SDSF_TOKEN_TYPE_INVALID;
-                    }
-                    // only floats can have '.'
-                    possibilitySpace &= _POSSIBLE_FLOAT_LITERAL;
-                    dotFound = true;
-                } break;
-                case '-':
-                {
-                    if (dashFound)
-                    {
-                        sdsf->errorMsg = "Tokenzer error - two '-' characters in single literal";
-                        return _SDSF_TOKEN_TYPE_INVALID;
-                    }
-                    // everything, but identifier can have '-'
-                    possibilitySpace &= ~_POSSIBLE_IDENTIFIER;
-                    dashFound = true;
-                } break;
-                default:
-                {
-                    // only identifier can have something other than number, dot or dash (binary literal 'b' prefix is checked earlier)
-                    possibilitySpace &= _POSSIBLE_IDENTIFIER;
-                } break;
-            }
-        }
+    if (mantissaDigits <= 15 && exponent >= -22 && exponent <= 22)
+    {
+        double value = (double)mantissa;
+        value = exponent < 0 ? value / powersOfTen[-exponent] : value * powersOfTen[exponent];
+        *result = isNegative ? -value : value;
+        return true;
+    }
 
-        if (possibilitySpace & _POSSIBLE_IDENTIFIER)
+    //
+    // Slow path : literal is rewritten as <significant digits>e<exponent>, so literal of any length fits into the buffer.
+    // Correct rounding never needs more than _SDSF_MAX_SIGNIFICANT_DIGITS digits, the rest only matters if it is non-zero,
+    // which is kept by appending single '1' digit
+    //
+    char buffer[_SDSF_MAX_SIGNIFICANT_DIGITS + 32];
+    size_t written = 0;
+    int64_t digitsExponent = 0;
+    bool isTruncated = false;
+    bool isSignificant = false;
+    bool isFraction = false;
+    if (isNegative)
+    {
+        buffer[written++] = '-';
+    }
+    for (it = isNegative ? 1 : 0; it < size; it++)
+    {
+        const char c = str[it];
+        if (c == '.')
         {
-            // It is possible to have both _POSSIBLE_IDENTIFIER and _POSSIBLE_BINARY_LITERAL in possibility space,
-            // but if we have _POSSIBLE_IDENTIFIER that means binary literal wasn't fully completed (it must have '-' symbol)
-            return _SDSF_TOKEN_TYPE_IDENTIFIER;
+            isFraction = true;
+            continue;
         }
-        if (possibilitySpace & _POSSIBLE_INT_LITERAL)
+        if (c < '0' || c > '9')
         {
-            // It is possible to have both _POSSIBLE_INT_LITERAL and _POSSIBLE_FLOAT_LITERAL in possibility space,
-            // but if we have _POSSIBLE_INT_LITERAL that means float literal wasn't fully completed (it must have '.' symbol)
-            return _SDSF_TOKEN_TYPE_INT_LITERAL;
+            break;
         }
-        if (possibilitySpace & _POSSIBLE_FLOAT_LITERAL)
+        if (!isSignificant && c == '0')
         {
-            return _SDSF_TOKEN_TYPE_FLOAT_LITERAL;
+            if (isFraction) digitsExponent -= 1;
+            continue;
         }
-        if (possibilitySpace & _POSSIBLE_BINARY_LITERAL)
+        isSignificant = true;
+        if (written < _SDSF_MAX_SIGNIFICANT_DIGITS)
         {
-            return _SDSF_TOKEN_TYPE_BINARY_LITERAL;
+            buffer[written++] = c;
+            if (isFraction) digitsExponent -= 1;
+        }
+        else
+        {
+            isTruncated |= c != '0';
+            if (!isFraction) digitsExponent += 1;
         }
     }
-
-    sdsf->errorMsg = "Tokenzer error - failed to match token";
-    return _SDSF_TOKEN_TYPE_INVALID;
+    if (isTruncated)
+    {
+        buffer[written++] = '1';
+        digitsExponent -= 1;
+    }
+    snprintf(buffer + written, sizeof(buffer) - written, "e%lld", (long long)(digitsExponent + explicitExponent));
+    *result = strtod(buffer, NULL);
+    return true;
 }
 
-bool _sdsf_consume_token(SdsfDeserializedResult* sdsf, _SdsfConsumedToken* result, _SdsfTokenizerData* data)
+//
+// Writes decimal representation of the value to the buffer (buffer must have at least 20 bytes). Returns number of written characters
+//
+size_t _sdsf_format_uint64(char* buffer, uint64_t value)
 {
-    _SdsfComsumedString consumedString;
-    if (!_sdsf_consume_string(data->data, data->dataSize, &data->stringConsumePtr, &consumedString, data->stringLiteralState == _SDSF_STRING_LITERAL_BEGIN))
+    static const char digitPairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+    char reversed[20];
+    char* end = reversed + sizeof(reversed);
+    char* ptr = end;
+    while (value >= 100)
     {
-        return false;
+        const size_t pair = (size_t)(value % 100) * 2;
+        value /= 100;
+        *--ptr = digitPairs[pair + 1];
+        *--ptr = digitPairs[pair];
     }
-
-    result->stringPtr = consumedString.ptr;
-    result->stringSize = consumedString.size;
-
-    if (data->stringLiteralState == _SDSF_STRING_LITERAL_BEGIN)
+    if (value >= 10)
     {
-        data->stringLiteralState = _SDSF_STRING_LITERAL_END;
-        result->tokenType = _SDSF_TOKEN_TYPE_STRING_LITERAL;
+        const size_t pair = (size_t)value * 2;
+        *--ptr = digitPairs[pair + 1];
+        *--ptr = digitPairs[pair];
     }
     else
     {
-        result->tokenType = _sdsf_match_string(sdsf, &consumedString);
-        if (result->tokenType == _SDSF_TOKEN_TYPE_RESERVED_SYMBOL && consumedString.ptr[0] == '\"')
-        {
-            if (data->stringLiteralState == _SDSF_STRING_LITERAL_NONE)
-            {
-                data->stringLiteralState = _SDSF_STRING_LITERAL_BEGIN;
-            }
-            else // (data->stringLiteralState == _SDSF_STRING_LITERAL_END)
-            {
-                data->stringLiteralState = _SDSF_STRING_LITERAL_NONE;
-            }
-        }
+        *--ptr = (char)('0' + value);
     }
 
-    return true;
+    const size_t length = (size_t)(end - ptr);
+    memcpy(buffer, ptr, length);
+    return length;
 }
 
-SdsfValue* _sdsf_val_array_add(SdsfValueArray* array, const SdsfAllocator* allocator)
+size_t _sdsf_format_int64(char* buffer, int64_t value)
 {
-    if (array->capacity == 0)
+    if (value < 0)
     {
-        array->ptr = (SdsfValue*)allocator->alloc(SDSF_VALUES_ARRAY_DEFAULT_CAPACITY * sizeof(SdsfValue), allocator->userData);
-        memset(array->ptr, 0, SDSF_VALUES_ARRAY_DEFAULT_CAPACITY * sizeof(SdsfValue));
-        array->size = 0;
-        array->capacity = SDSF_VALUES_ARRAY_DEFAULT_CAPACITY;
+        buffer[0] = '-';
+        return 1 + _sdsf_format_uint64(buffer + 1, (uint64_t)0 - (uint64_t)value);
     }
-    else if (array->size == array->capacity)
-    {
-        const size_t newCapacity = array->capacity * 2;
-        const size_t oldCapacity = array->capacity;
+    return _sdsf_format_uint64(buffer, (uint64_t)value);
+}
 
-        SdsfValue* const newMem = (SdsfValue*)allocator->alloc(newCapacity * sizeof(SdsfValue), allocator->userData);
-        memcpy(newMem, array->ptr, oldCapacity * sizeof(SdsfValue));
-        allocator->dealloc(array->ptr, oldCapacity * sizeof(SdsfValue), allocator->userData);
-        void* const toZero = newMem + oldCapacity;
-        memset(toZero, 0, (newCapacity - oldCapacity) * sizeof(SdsfValue));
-        
-        array->ptr = newMem;
-        array->capacity = newCapacity;
-    }
+static inline int32_t _sdsf_hex_digit_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
 
-    return &array->ptr[array->size++];
+static inline bool _sdsf_is_hex_float(const char* str, size_t size)
+{
+    const size_t signSize = (size && str[0] == '-') ? 1 : 0;
+    return size > signSize + 2 && str[signSize] == '0' && (str[signSize + 1] == 'x' || str[signSize + 1] == 'X');
 }
 
-void _sdsf_val_array_clear(SdsfValueArray* array, const SdsfAllocator* allocator)
+static inline uint64_t _sdsf_shift_right_round_even(uint64_t value, int32_t shift)
 {
-    if (array->capacity)
+    if (shift <= 0) return value;
+    if (shift > 64) return 0;
+    const uint64_t half = (uint64_t)1 << (shift - 1);
+    const uint64_t remainder = shift == 64 ? value : (value & ((half << 1) - 1));
+    uint64_t result = shift == 64 ? 0 : (value >> shift);
+    if (remainder > half || (remainder == half && (result & 1)))
     {
-        allocator->dealloc(array->ptr, array->capacity * sizeof(SdsfValue), allocator->userData);
+        result += 1;
     }
+    return result;
 }
 
-SdsfValue** _sdsf_val_ptr_array_add(SdsfValuePtrArray* array, const SdsfAllocator* allocator)
+//
+// Converts hexadecimal floating point literal ([-]0x<hex digits>[.<hex digits>]p<+|-><decimal digits>) to the bits of double (isDouble == true)
+// or float (isDouble == false). Values which are exactly representable in the target format are restored bit-exact, other values are rounded to nearest.
+// Exponent one above the maximum (p+1024 for doubles, p+128 for floats) is used to encode infinities and NaNs
+//
+bool _sdsf_parse_hex_float(const char* str, size_t size, bool isDouble, uint64_t* bits)
 {
-    if (array->capacity == 0)
+    const int32_t mantissaBits = isDouble ? 52 : 23;
+    const int32_t exponentBias = isDouble ? 1023 : 127;
+    const uint64_t maxBiasedExponent = isDouble ? 2047 : 255;
+
+    size_t it = 0;
+    const bool isNegative = size && str[0] == '-';
+    if (isNegative) it = 1;
+    if (!_sdsf_is_hex_float(str, size)) return false;
+    it += 2;
+
+    uint64_t mantissa = 0;
+    int64_t exponent = 0;
+    size_t digits = 0;
+    bool dotFound = false;
+    bool isInexact = false;
+    for (; it < size && str[it] != 'p' && str[it] != 'P'; it++)
     {
-        array->ptr = (SdsfValue**)allocator->alloc(SDSF_VALUES_PTR_ARRAY_DEFAULT_CAPACITY * sizeof(SdsfValue*), allocator->userData);
-        memset(array->ptr, 0, SDSF_VALUES_PTR_ARRAY_DEFAULT_CAPACITY * sizeof(SdsfValue*));
-        array->size = 0;
-        array->capacity = SDSF_VALUES_PTR_ARRAY_DEFAULT_CAPACITY;
+        if (str[it] == '.')
+        {
+            if (dotFound) return false;
+            dotFound = true;
+            continue;
+        }
+        const int32_t digit = _sdsf_hex_digit_value(str[it]);
+        if (digit < 0) return false;
+        digits += 1;
+        if (mantissa >> 60)
+        {
+            // Mantissa is full, digit can only affect rounding
+            isInexact |= digit != 0;
+            if (!dotFound) exponent += 4;
+            continue;
+        }
+        mantissa = (mantissa << 4) | (uint64_t)digit;
+        if (dotFound) exponent -= 4;
     }
-    else if (array->size == array->capacity)
-    {
-        const size_t newCapacity = array->capacity * 2;
-        const size_t oldCapacity = array->capacity;
+    if (!digits || it == size) return false;
 
-        SdsfValue** const newMem = (SdsfValue**)allocator->alloc(newCapacity * sizeof(SdsfValue*), allocator->userData);
-        memcpy(newMem, array->ptr, oldCapacity * sizeof(SdsfValue*));
-        allocator->dealloc(array->ptr, oldCapacity * sizeof(SdsfValue*), allocator->userData);
-        void* const toZero = newMem + oldCapacity;
-        memset(toZero, 0, (newCapacity - oldCapacity) * sizeof(SdsfValue*));
-        
-        array->ptr = newMem;
-        array->capacity = newCapacity;
+    it += 1;
+    bool isExponentNegative = false;
+    if (it < size && (str[it] == '-' || str[it] == '+'))
+    {
+        isExponentNegative = str[it] == '-';
+        it += 1;
     }
-
-    return &array->ptr[array->size++];
-}
-
-void _sdsf_val_ptr_array_clear(SdsfValuePtrArray* array, const SdsfAllocator* allocator)
-{
-    if (array->capacity)
+    bool isExplicitExponentNegative;
+    uint64_t explicitExponent;
+    if (!_sdsf_parse_integer(&str[it], size - it, &isExplicitExponentNegative, &explicitExponent) || isExplicitExponentNegative)
     {
-        allocator->dealloc(array->ptr, array->capacity * sizeof(SdsfValue*), allocator->userData);
+        return false;
     }
-}
+    if (explicitExponent > 100000) explicitExponent = 100000;
+    exponent += isExponentNegative ? -(int64_t)explicitExponent : (int64_t)explicitExponent;
 
-char* _sdsf_string_array_save(SdsfStringArray* array, const SdsfAllocator* allocator, const char* string, size_t stringLength)
-{
-    if (array->capacity == 0)
+    const uint64_t sign = isNegative ? ((uint64_t)1 << (isDouble ? 63 : 31)) : 0;
+    if (mantissa == 0)
     {
-        const size_t initialCapacity = (stringLength + 1) > SDSF_STRING_ARRAY_DEFAULT_CAPACITY ? (stringLength + 1) : SDSF_STRING_ARRAY_DEFAULT_CAPACITY;
-        array->ptr = allocator->alloc(initialCapacity, allocator->userData);
-        memset(array->ptr, 0, initialCapacity);
-        array->size = 0;
-        array->capacity = initialCapacity;
+        *bits = sign;
+        return true;
     }
-    else if ((array->size + stringLength + 1) >= array->capacity)
-    {
-        const size_t requiredCapacity = array->size + stringLength + 1;
-        const size_t doubledCapacity = array->capacity * 2;
-        const size_t newCapacity = (requiredCapacity > doubledCapacity) ? requiredCapacity : doubledCapacity;
-        const size_t oldCapacity = array->capacity;
+    // Sticky bit for dropped digits, so rounding stays correct
+    mantissa |= isInexact ? 1 : 0;
 
-        char* const newMem = (char*)allocator->alloc(newCapacity, allocator->userData);
-        memcpy(newMem, array->ptr, oldCapacity);
-        allocator->dealloc(array->ptr, oldCapacity, allocator->userData);
-        void* const toZero = newMem + oldCapacity;
-        memset(toZero, 0, newCapacity - oldCapacity);
-        
-        array->ptr = newMem;
-        array->capacity = newCapacity;
+    int32_t highestBit = 63;
+    while (!((mantissa >> highestBit) & 1)) highestBit -= 1;
+    const int64_t unbiasedExponent = exponent + highestBit;
+    const uint64_t hiddenBit = (uint64_t)1 << mantissaBits;
+
+    if (unbiasedExponent == exponentBias + 1)
+    {
+        // Infinity or NaN, fraction must be stored exactly
+        const int32_t shift = highestBit - mantissaBits;
+        const uint64_t fraction = shift >= 0 ? (mantissa >> shift) : (mantissa << -shift);
+        if (isInexact || (shift > 0 && (fraction << shift) != mantissa)) return false;
+        *bits = sign | (maxBiasedExponent << mantissaBits) | (fraction & (hiddenBit - 1));
+        return true;
     }
 
-    char* result = &array->ptr[array->size];
-    if (string)
+    uint64_t result;
+    if (unbiasedExponent >= 1 - exponentBias)
     {
-        memcpy(result, string, stringLength);
+        const int32_t shift = highestBit - mantissaBits;
+        const uint64_t significand = shift >= 0 ? _sdsf_shift_right_round_even(mantissa, shift) : (mantissa << -shift);
+        if (unbiasedExponent + exponentBias >= (int64_t)maxBiasedExponent) return false;
+        // If rounding overflows significand, carry naturally moves to the exponent
+        result = ((uint64_t)(unbiasedExponent + exponentBias) << mantissaBits) + (significand - hiddenBit);
     }
-    array->size += stringLength + 1;
+    else
+    {
+        // Subnormal value
+        const int64_t shift = (1 - exponentBias - mantissaBits) - exponent;
+        if (shift > 64) result = 0;
+        else result = shift >= 0 ? _sdsf_shift_right_round_even(mantissa, (int32_t)shift) : (mantissa << -shift);
+    }
+    if ((result >> mantissaBits) >= maxBiasedExponent) return false;
 
-    return result;
+    *bits = sign | result;
+    return true;
 }
 
-void _sdsf_string_array_clear(SdsfStringArray* array, const SdsfAllocator* allocator)
+//
+// Longest result of _sdsf_format_shortest : sign, 17 digits, dot, up to 5 leading zeros
+//
+#define _SDSF_FLOAT_STRING_CAPACITY 32
+
+//
+// Rounds first count digits half up (roundUp == true) or down. Returns 1 if rounding carries into a new leading digit
+//
+static inline int32_t _sdsf_round_digits(char* rounded, const char* digits, size_t count, bool roundUp)
 {
-    if (array->capacity)
+    memcpy(rounded, digits, count);
+    if (!roundUp)
+    {
+        return 0;
+    }
+    size_t it = count;
+    while (it && rounded[it - 1] == '9')
+    {
+        rounded[--it] = '0';
+    }
+    if (it)
     {
-        allocator->dealloc(array->ptr, array->capacity, allocator->userData);
+        rounded[it - 1] += 1;
+        return 0;
     }
+    rounded[0] = '1';
+    return 1;
 }
 
-SdsfDeserializationError sdsf_deserialize(SdsfDeserializedResult* sdsf, const void* data, size_t dataSize, SdsfAllocator allocator)
+static inline bool _sdsf_digits_read_back(const char* digits, size_t count, int32_t exponent, double magnitude, bool isDouble)
 {
-    _SdsfTokenizerData tokenizerData;
-    tokenizerData.data                  = (const char*)data;
-    tokenizerData.dataSize              = dataSize;
-    tokenizerData.stringLiteralState    = _SDSF_STRING_LITERAL_NONE;
-    tokenizerData.stringConsumePtr      = 0;
-
-    _SdsfConsumedToken token;
-    _SdsfConsumedToken previousToken = {0};
-
-    *sdsf = (SdsfDeserializedResult){0};
-    sdsf->allocator = allocator;
-
-    SdsfValuePtrArray* topLevelValues = &sdsf->topLevelValues;
-    SdsfValueArray* values = &sdsf->values;
-    SdsfStringArray* strings = &sdsf->strings;
-    SdsfValue* currentValue = NULL;
-
-    bool expectsBinaryDataBlob = false;
-    bool shouldRun = true;
+    char candidate[_SDSF_FLOAT_STRING_CAPACITY];
+    memcpy(candidate, digits, count);
+    candidate[count] = 'e';
+    const size_t candidateSize = count + 1 + _sdsf_format_int64(candidate + count + 1, exponent - (int32_t)(count - 1));
+    double parsed;
+    return _sdsf_parse_double(candidate, candidateSize, &parsed) && (isDouble ? parsed == magnitude : (float)parsed == (float)magnitude);
+}
 
-    while (shouldRun && _sdsf_consume_token(sdsf, &token, &tokenizerData))
+//
+// Prints finite float (isDouble == false) or double (isDouble == true) with the fewest significant digits which read back
+// to exactly the same value. Value is printed once with 9 or 17 significant digits (always enough to restore it), then these
+// digits are rounded to 6 or 15 digits and longer. Any decimal with at most 6 (float) or 15 (double) significant digits is
+// restored from a normal value, so if rounding to 6 or 15 digits reads back, it is the shortest one once trailing zeros are
+// removed. Subnormal values have less precision, so for them all roundings are tried.
+// Result always has a dot or an exponent, so it is never read as integer
+//
+size_t _sdsf_format_shortest(char* buffer, double value, bool isDouble)
+{
+    const size_t maxDigits = isDouble ? 17 : 9;
+    char printed[_SDSF_FLOAT_STRING_CAPACITY];
+    snprintf(printed, sizeof(printed), "%.*e", (int)maxDigits - 1, value);
+
+    // printed is [-]d.ddd...de[+-]dd
+    const bool isNegative = printed[0] == '-';
+    const char* const mantissa = printed + (isNegative ? 1 : 0);
+    char digits[17];
+    digits[0] = mantissa[0];
+    memcpy(digits + 1, mantissa + 2, maxDigits - 1);
+    int32_t exponent = atoi(mantissa + maxDigits + 2);
+    const double magnitude = isNegative ? -value : value;
+    // Smallest normal values are 1.17549435e-38 (float) and 2.2250738585072014e-308 (double)
+    const bool isNormal = exponent > (isDouble ? -308 : -38);
+
+    size_t digitCount = maxDigits;
+    for (size_t count = isNormal ? (isDouble ? 15 : 6) : 1; count < maxDigits; count++)
     {
-        if (token.tokenType == _SDSF_TOKEN_TYPE_INVALID)
+        char rounded[17];
+        int32_t roundedExponent = exponent + _sdsf_round_digits(rounded, digits, count, digits[count] >= '5');
+        bool isReadBack = _sdsf_digits_read_back(rounded, count, roundedExponent, magnitude, isDouble);
+        size_t zerosEnd = count + 1;
+        while (zerosEnd < maxDigits && digits[zerosEnd] == '0')
         {
-            // Error message is set in _sdsf_match_string
-            return SDSF_DESERIALIZATION_ERROR_TOKENIZER_FAILED;
+            zerosEnd += 1;
         }
-
-        if (token.tokenType == _SDSF_TOKEN_TYPE_IDENTIFIER)
+        if (!isReadBack && digits[count] == '5' && zerosEnd == maxDigits)
         {
-            if (currentValue)
-            {
-                if (currentValue->type == SDSF_VALUE_UNDEFINED)
-                {
-                    sdsf->errorMsg = "Unexpected identifier - got two identifiers in a row";
+            //
+            // Printed digits are rounded already, so value may be below the half way point even if remaining digits are 5000...
+            //
+            roundedExponent = exponent + _sdsf_round_digits(rounded, digits, count, false);
+            isReadBack = _sdsf_digits_read_back(rounded, count, roundedExponent, magnitude, isDouble);
+        }
+        if (isReadBack)
+        {
+            memcpy(digits, rounded, count);
+            exponent = roundedExponent;
+            digitCount = count;
+            break;
+        }
+    }
+    while (digitCount > 1 && digits[digitCount - 1] == '0')
+    {
+        digitCount -= 1;
+    }
+
+    size_t written = 0;
+    if (isNegative)
+    {
+        buffer[written++] = '-';
+    }
+    if (exponent < -5 || exponent > (int32_t)maxDigits - 1)
+    {
+        buffer[written++] = digits[0];
+        if (digitCount > 1)
+        {
+            buffer[written++] = '.';
+            memcpy(buffer + written, digits + 1, digitCount - 1);
+            written += digitCount - 1;
+        }
+        buffer[written++] = 'e';
+        written += _sdsf_format_int64(buffer + written, exponent);
+    }
+    else if (exponent < 0)
+    {
+        buffer[written++] = '0';
+        buffer[written++] = '.';
+        for (int32_t it = -1; it > exponent; it--)
+        {
+            buffer[written++] = '0';
+        }
+        memcpy(buffer + written, digits, digitCount);
+        written += digitCount;
+    }
+    else
+    {
+        const size_t integerCount = (size_t)exponent + 1;
+        for (size_t it = 0; it < integerCount; it++)
+        {
+            buffer[written++] = it < digitCount ? digits[it] : '0';
+        }
+        buffer[written++] = '.';
+        if (digitCount > integerCount)
+        {
+            memcpy(buffer + written, digits + integerCount, digitCount - integerCount);
+            written += digitCount - integerCount;
+        }
+        else
+        {
+            buffer[written++] = '0';
+        }
+    }
+    return written;
+}
+
+static inline size_t _sdsf_format_float(char* buffer, float value)
+{
+    return _sdsf_format_shortest(buffer, (double)value, false);
+}
+
+static inline size_t _sdsf_format_double(char* buffer, double value)
+{
+    return _sdsf_format_shortest(buffer, value, true);
+}
+
+//
+// Writes float (isDouble == false) or double (isDouble == true) bits as hexadecimal floating point literal.
+// Buffer must have at least 32 bytes. Returns number of written characters
+//
+size_t _sdsf_format_hex_float(char* buffer, uint64_t bits, bool isDouble)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    const int32_t mantissaBits = isDouble ? 52 : 23;
+    const int32_t exponentBias = isDouble ? 1023 : 127;
+    const uint64_t maxBiasedExponent = isDouble ? 2047 : 255;
+    // Fraction is written using whole hex digits, so float fraction (23 bits) is extended to 24 bits
+    const int32_t fractionDigits = isDouble ? 13 : 6;
+    const int32_t fractionShift = fractionDigits * 4 - mantissaBits;
+
+    const bool isNegative = (bits >> (isDouble ? 63 : 31)) & 1;
+    const uint64_t biasedExponent = (bits >> mantissaBits) & maxBiasedExponent;
+    uint64_t fraction = (bits & (((uint64_t)1 << mantissaBits) - 1)) << fractionShift;
+
+    size_t written = 0;
+    if (isNegative) buffer[written++] = '-';
+    buffer[written++] = '0';
+    buffer[written++] = 'x';
+
+    int64_t exponent;
+    if (biasedExponent == 0)
+    {
+        buffer[written++] = '0';
+        exponent = fraction ? 1 - exponentBias : 0;
+    }
+    else
+    {
+        buffer[written++] = '1';
+        exponent = (int64_t)biasedExponent - exponentBias;
+    }
+
+    if (fraction)
+    {
+        buffer[written++] = '.';
+        for (int32_t it = fractionDigits - 1; it >= 0 && fraction; it--)
+        {
+            buffer[written++] = hexDigits[(fraction >> (it * 4)) & 0xF];
+            fraction &= ((uint64_t)1 << (it * 4)) - 1;
+        }
+    }
+
+    buffer[written++] = 'p';
+    buffer[written++] = exponent < 0 ? '-' : '+';
+    written += _sdsf_format_uint64(&buffer[written], (uint64_t)(exponent < 0 ? -exponent : exponent));
+    return written;
+}
+
+//
+// All atomic operations are sequentially consistent
+//
+#ifdef _MSC_VER
+static inline int32_t _sdsf_atomic_add(volatile int32_t* value, int32_t addend)
+{
+    return (int32_t)_InterlockedExchangeAdd((volatile long*)value, (long)addend) + addend;
+}
+
+static inline int32_t _sdsf_atomic_load(volatile int32_t* value)
+{
+    return (int32_t)_InterlockedOr((volatile long*)value, 0);
+}
+
+static inline void _sdsf_atomic_store(volatile int32_t* value, int32_t newValue)
+{
+    _InterlockedExchange((volatile long*)value, (long)newValue);
+}
+
+static inline bool _sdsf_atomic_compare_exchange(volatile int32_t* value, int32_t expected, int32_t desired)
+{
+    return _InterlockedCompareExchange((volatile long*)value, (long)desired, (long)expected) == (long)expected;
+}
+
+static inline void* _sdsf_atomic_load_ptr(void* volatile* ptr)
+{
+    return _InterlockedCompareExchangePointer(ptr, NULL, NULL);
+}
+
+static inline void* _sdsf_atomic_exchange_ptr(void* volatile* ptr, void* newValue)
+{
+    return _InterlockedExchangePointer(ptr, newValue);
+}
+
+#else
+static inline int32_t _sdsf_atomic_add(volatile int32_t* value, int32_t addend)
+{
+    return __atomic_add_fetch(value, addend, __ATOMIC_SEQ_CST);
+}
+
+static inline int32_t _sdsf_atomic_load(volatile int32_t* value)
+{
+    return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+}
+
+static inline void _sdsf_atomic_store(volatile int32_t* value, int32_t newValue)
+{
+    __atomic_store_n(value, newValue, __ATOMIC_SEQ_CST);
+}
+
+static inline bool _sdsf_atomic_compare_exchange(volatile int32_t* value, int32_t expected, int32_t desired)
+{
+    return __atomic_compare_exchange_n(value, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static inline void* _sdsf_atomic_load_ptr(void* volatile* ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+}
+
+static inline void* _sdsf_atomic_exchange_ptr(void* volatile* ptr, void* newValue)
+{
+    return __atomic_exchange_n(ptr, newValue, __ATOMIC_SEQ_CST);
+}
+
+#endif
+
+//
+// Used in spin loops - first iterations only hint the cpu, then the rest of the time slice is given to other threads
+// (thread we are waiting for might be not running at all)
+//
+static inline void _sdsf_spin_wait(uint32_t* iteration)
+{
+    if ((*iteration)++ < 64)
+    {
+#if defined(_MSC_VER)
+        YieldProcessor();
+#elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+    else
+    {
+#ifdef _WIN32
+        SwitchToThread();
+#else
+        sched_yield();
+#endif
+    }
+}
+
+//
+// Minimal job system. _sdsf_parallel_for runs jobCount jobs on threadCount threads (calling thread is one of them),
+// threads take jobs one by one, so jobs should be coarse enough. Thread index can be used to access per-thread data
+//
+typedef void (*_SdsfJobProc)(void* context, size_t jobIndex, size_t threadIndex);
+
+typedef struct
+{
+    _SdsfJobProc        proc;
+    void*               context;
+    size_t              jobCount;
+    volatile int32_t    nextJob;
+} _SdsfJobQueue;
+
+#ifdef _WIN32
+typedef HANDLE _SdsfThread;
+#else
+typedef pthread_t _SdsfThread;
+#endif
+
+typedef struct
+{
+    _SdsfJobQueue*  queue;
+    size_t          threadIndex;
+    _SdsfThread     thread;
+} _SdsfWorker;
+
+size_t sdsf_hardware_thread_count()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors ? (size_t)info.dwNumberOfProcessors : 1;
+#else
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t)count : 1;
+#endif
+}
+
+void _sdsf_run_jobs(_SdsfJobQueue* queue, size_t threadIndex)
+{
+    while (true)
+    {
+        const size_t job = (size_t)(_sdsf_atomic_add(&queue->nextJob, 1) - 1);
+        if (job >= queue->jobCount)
+        {
+            break;
+        }
+        queue->proc(queue->context, job, threadIndex);
+    }
+}
+
+#ifdef _WIN32
+DWORD WINAPI _sdsf_worker_entry(LPVOID param)
+{
+    _SdsfWorker* const worker = (_SdsfWorker*)param;
+    _sdsf_run_jobs(worker->queue, worker->threadIndex);
+    return 0;
+}
+
+static inline bool _sdsf_thread_start(_SdsfWorker* worker)
+{
+    worker->thread = CreateThread(NULL, 0, _sdsf_worker_entry, worker, 0, NULL);
+    return worker->thread != NULL;
+}
+
+static inline void _sdsf_thread_join(_SdsfWorker* worker)
+{
+    WaitForSingleObject(worker->thread, INFINITE);
+    CloseHandle(worker->thread);
+}
+#else
+void* _sdsf_worker_entry(void* param)
+{
+    _SdsfWorker* const worker = (_SdsfWorker*)param;
+    _sdsf_run_jobs(worker->queue, worker->threadIndex);
+    return NULL;
+}
+
+static inline bool _sdsf_thread_start(_SdsfWorker* worker)
+{
+    return pthread_create(&worker->thread, NULL, _sdsf_worker_entry, worker) == 0;
+}
+
+static inline void _sdsf_thread_join(_SdsfWorker* worker)
+{
+    pthread_join(worker->thread, NULL);
+}
+#endif
+
+//
+// Mutex and condition variable pair for threads which wait for a long time (waiting thread sleeps instead of spinning).
+// Waiter checks its condition and waits with the lock taken, notifier changes the state before it takes the lock, so no wake up is lost
+//
+#ifdef _WIN32
+typedef struct
+{
+    SRWLOCK             lock;
+    CONDITION_VARIABLE  condition;
+} _SdsfSignal;
+
+static inline void _sdsf_signal_init(_SdsfSignal* signal)
+{
+    InitializeSRWLock(&signal->lock);
+    InitializeConditionVariable(&signal->condition);
+}
+
+static inline void _sdsf_signal_destroy(_SdsfSignal* signal) { }
+static inline void _sdsf_signal_lock(_SdsfSignal* signal) { AcquireSRWLockExclusive(&signal->lock); }
+static inline void _sdsf_signal_unlock(_SdsfSignal* signal) { ReleaseSRWLockExclusive(&signal->lock); }
+static inline void _sdsf_signal_wait(_SdsfSignal* signal) { SleepConditionVariableSRW(&signal->condition, &signal->lock, INFINITE, 0); }
+static inline void _sdsf_signal_notify_all(_SdsfSignal* signal) { WakeAllConditionVariable(&signal->condition); }
+#else
+typedef struct
+{
+    pthread_mutex_t     lock;
+    pthread_cond_t      condition;
+} _SdsfSignal;
+
+static inline void _sdsf_signal_init(_SdsfSignal* signal)
+{
+    pthread_mutex_init(&signal->lock, NULL);
+    pthread_cond_init(&signal->condition, NULL);
+}
+
+static inline void _sdsf_signal_destroy(_SdsfSignal* signal)
+{
+    pthread_cond_destroy(&signal->condition);
+    pthread_mutex_destroy(&signal->lock);
+}
+
+static inline void _sdsf_signal_lock(_SdsfSignal* signal) { pthread_mutex_lock(&signal->lock); }
+static inline void _sdsf_signal_unlock(_SdsfSignal* signal) { pthread_mutex_unlock(&signal->lock); }
+static inline void _sdsf_signal_wait(_SdsfSignal* signal) { pthread_cond_wait(&signal->condition, &signal->lock); }
+static inline void _sdsf_signal_notify_all(_SdsfSignal* signal) { pthread_cond_broadcast(&signal->condition); }
+#endif
+
+//
+// Minimal file reading. Files are read sequentially, except for binary data which event reader reads from the blob at the end of file
+//
+#ifdef _WIN32
+typedef HANDLE _SdsfFile;
+
+static inline bool _sdsf_file_open(const char* path, _SdsfFile* file, size_t* size)
+{
+    *file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (*file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(*file, &fileSize))
+    {
+        CloseHandle(*file);
+        return false;
+    }
+    *size = (size_t)fileSize.QuadPart;
+    return true;
+}
+
+bool _sdsf_file_read(_SdsfFile file, void* buffer, size_t size)
+{
+    while (size)
+    {
+        const DWORD toRead = size > 0x40000000 ? 0x40000000 : (DWORD)size;
+        DWORD wasRead;
+        if (!ReadFile(file, buffer, toRead, &wasRead, NULL) || wasRead == 0)
+        {
+            return false;
+        }
+        buffer = (char*)buffer + wasRead;
+        size -= wasRead;
+    }
+    return true;
+}
+
+static inline void _sdsf_file_close(_SdsfFile file)
+{
+    CloseHandle(file);
+}
+
+//
+// Reads until buffer is full or until the end of file. Pipes report the end of data as broken pipe error
+//
+bool _sdsf_file_read_up_to(_SdsfFile file, void* buffer, size_t size, size_t* wasReadTotal)
+{
+    *wasReadTotal = 0;
+    while (size)
+    {
+        const DWORD toRead = size > 0x40000000 ? 0x40000000 : (DWORD)size;
+        DWORD wasRead;
+        if (!ReadFile(file, buffer, toRead, &wasRead, NULL))
+        {
+            return GetLastError() == ERROR_BROKEN_PIPE;
+        }
+        if (wasRead == 0)
+        {
+            return true;
+        }
+        buffer = (char*)buffer + wasRead;
+        size -= wasRead;
+        *wasReadTotal += wasRead;
+    }
+    return true;
+}
+
+//
+// Reading with offset moves file pointer of synchronous handles, so it is restored after read
+//
+bool _sdsf_file_read_at(_SdsfFile file, void* buffer, size_t size, uint64_t offset, size_t* wasReadTotal)
+{
+    LARGE_INTEGER position;
+    LARGE_INTEGER zero = {0};
+    if (!SetFilePointerEx(file, zero, &position, FILE_CURRENT))
+    {
+        return false;
+    }
+    *wasReadTotal = 0;
+    bool isFine = true;
+    while (size)
+    {
+        const DWORD toRead = size > 0x40000000 ? 0x40000000 : (DWORD)size;
+        OVERLAPPED overlapped = {0};
+        overlapped.Offset = (DWORD)offset;
+        overlapped.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD wasRead;
+        if (!ReadFile(file, buffer, toRead, &wasRead, &overlapped))
+        {
+            isFine = GetLastError() == ERROR_HANDLE_EOF;
+            break;
+        }
+        if (wasRead == 0)
+        {
+            break;
+        }
+        buffer = (char*)buffer + wasRead;
+        size -= wasRead;
+        offset += wasRead;
+        *wasReadTotal += wasRead;
+    }
+    return SetFilePointerEx(file, position, NULL, FILE_BEGIN) && isFine;
+}
+
+//
+// Fails for pipes and other files which can't be read at offset
+//
+static inline bool _sdsf_file_size(_SdsfFile file, uint64_t* size)
+{
+    LARGE_INTEGER fileSize;
+    if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &fileSize))
+    {
+        return false;
+    }
+    *size = (uint64_t)fileSize.QuadPart;
+    return true;
+}
+
+static inline uint64_t _sdsf_file_position(_SdsfFile file)
+{
+    LARGE_INTEGER position;
+    LARGE_INTEGER zero = {0};
+    return SetFilePointerEx(file, zero, &position, FILE_CURRENT) ? (uint64_t)position.QuadPart : 0;
+}
+#else
+typedef int _SdsfFile;
+
+static inline bool _sdsf_file_open(const char* path, _SdsfFile* file, size_t* size)
+{
+    *file = open(path, O_RDONLY);
+    if (*file < 0)
+    {
+        return false;
+    }
+    struct stat fileStat;
+    if (fstat(*file, &fileStat) != 0)
+    {
+        close(*file);
+        return false;
+    }
+    *size = (size_t)fileStat.st_size;
+    return true;
+}
+
+bool _sdsf_file_read(_SdsfFile file, void* buffer, size_t size)
+{
+    while (size)
+    {
+        const ssize_t wasRead = read(file, buffer, size);
+        if (wasRead < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (wasRead <= 0)
+        {
+            return false;
+        }
+        buffer = (char*)buffer + wasRead;
+        size -= (size_t)wasRead;
+    }
+    return true;
+}
+
+static inline void _sdsf_file_close(_SdsfFile file)
+{
+    close(file);
+}
+
+//
+// Reads until buffer is full or until the end of file
+//
+bool _sdsf_file_read_up_to(_SdsfFile file, void* buffer, size_t size, size_t* wasReadTotal)
+{
+    *wasReadTotal = 0;
+    while (size)
+    {
+        const ssize_t wasRead = read(file, buffer, size);
+        if (wasRead < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (wasRead < 0)
+        {
+            return false;
+        }
+        if (wasRead == 0)
+        {
+            return true;
+        }
+        buffer = (char*)buffer + wasRead;
+        size -= (size_t)wasRead;
+        *wasReadTotal += (size_t)wasRead;
+    }
+    return true;
+}
+
+//
+// pread is not available in strict c mode, so file offset is moved and restored after read
+//
+bool _sdsf_file_read_at(_SdsfFile file, void* buffer, size_t size, uint64_t offset, size_t* wasReadTotal)
+{
+    const off_t position = lseek(file, 0, SEEK_CUR);
+    if (position < 0 || lseek(file, (off_t)offset, SEEK_SET) < 0)
+    {
+        return false;
+    }
+    const bool isFine = _sdsf_file_read_up_to(file, buffer, size, wasReadTotal);
+    return lseek(file, position, SEEK_SET) >= 0 && isFine;
+}
+
+//
+// Fails for pipes and other files which can't be read at offset
+//
+static inline bool _sdsf_file_size(_SdsfFile file, uint64_t* size)
+{
+    struct stat fileStat;
+    if (fstat(file, &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+    {
+        return false;
+    }
+    *size = (uint64_t)fileStat.st_size;
+    return true;
+}
+
+static inline uint64_t _sdsf_file_position(_SdsfFile file)
+{
+    const off_t position = lseek(file, 0, SEEK_CUR);
+    return position < 0 ? 0 : (uint64_t)position;
+}
+#endif
+
+//
+// Output file which is written through memory mapping (see sdsf_serializer_begin_mapped). File is resized before mapping grows,
+// because writing to mapped pages past the end of file is not allowed. Mapped data pointer and size are kept by the owner
+//
+#ifdef _WIN32
+typedef struct
+{
+    HANDLE  file;
+    HANDLE  mapping;
+    bool    isOpen;
+} _SdsfMappedOutput;
+
+static inline size_t _sdsf_page_size()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize ? (size_t)info.dwPageSize : 4096;
+}
+
+static inline bool _sdsf_mapped_output_open(_SdsfMappedOutput* output, const char* path)
+{
+    output->file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    output->mapping = NULL;
+    output->isOpen = output->file != INVALID_HANDLE_VALUE;
+    return output->isOpen;
+}
+
+//
+// Windows has no way to grow existing view, so file is mapped again (new mapping object grows the file)
+//
+bool _sdsf_mapped_output_resize(_SdsfMappedOutput* output, void** data, size_t oldSize, size_t size)
+{
+    if (*data)
+    {
+        UnmapViewOfFile(*data);
+        CloseHandle(output->mapping);
+        *data = NULL;
+    }
+    const uint64_t mappingSize = (uint64_t)size;
+    output->mapping = CreateFileMappingA(output->file, NULL, PAGE_READWRITE, (DWORD)(mappingSize >> 32), (DWORD)mappingSize, NULL);
+    if (!output->mapping)
+    {
+        return false;
+    }
+    *data = MapViewOfFile(output->mapping, FILE_MAP_WRITE, 0, 0, size);
+    if (!*data)
+    {
+        CloseHandle(output->mapping);
+        return false;
+    }
+    return true;
+}
+
+bool _sdsf_mapped_output_close(_SdsfMappedOutput* output, void* data, size_t mappedSize, size_t fileSize)
+{
+    if (data)
+    {
+        UnmapViewOfFile(data);
+        CloseHandle(output->mapping);
+    }
+    LARGE_INTEGER position;
+    position.QuadPart = (LONGLONG)fileSize;
+    const bool isTrimmed = SetFilePointerEx(output->file, position, NULL, FILE_BEGIN) && SetEndOfFile(output->file);
+    CloseHandle(output->file);
+    output->isOpen = false;
+    return isTrimmed;
+}
+#else
+//
+// unistd.h declares ftruncate only for POSIX.1-2001 and later (_POSIX_C_SOURCE >= 200112L, which is the default in gnu modes).
+// Without it file can't be resized, so mapped output is never opened
+//
+#if defined(_POSIX_VERSION) && _POSIX_VERSION >= 200112L
+#   define _SDSF_HAS_FTRUNCATE
+#endif
+
+typedef struct
+{
+    int     file;
+    bool    isOpen;
+} _SdsfMappedOutput;
+
+static inline bool _sdsf_truncate_file(int file, size_t size)
+{
+#ifdef _SDSF_HAS_FTRUNCATE
+    return ftruncate(file, (off_t)size) == 0;
+#else
+    (void)file;
+    (void)size;
+    return false;
+#endif
+}
+
+static inline size_t _sdsf_page_size()
+{
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    return pageSize > 0 ? (size_t)pageSize : 4096;
+}
+
+static inline bool _sdsf_mapped_output_open(_SdsfMappedOutput* output, const char* path)
+{
+#ifdef _SDSF_HAS_FTRUNCATE
+    output->file = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+#else
+    (void)path;
+    output->file = -1;
+#endif
+    output->isOpen = output->file >= 0;
+    return output->isOpen;
+}
+
+//
+// mremap can move mapping without copying pages, but it is available only on linux (with _GNU_SOURCE)
+//
+bool _sdsf_mapped_output_resize(_SdsfMappedOutput* output, void** data, size_t oldSize, size_t size)
+{
+    if (!_sdsf_truncate_file(output->file, size))
+    {
+        return false;
+    }
+#ifdef MREMAP_MAYMOVE
+    void* const mapped = *data
+        ? mremap(*data, oldSize, size, MREMAP_MAYMOVE)
+        : mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, output->file, 0);
+#else
+    if (*data)
+    {
+        munmap(*data, oldSize);
+        *data = NULL;
+    }
+    void* const mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, output->file, 0);
+#endif
+    if (mapped == MAP_FAILED)
+    {
+        return false;
+    }
+    *data = mapped;
+    return true;
+}
+
+bool _sdsf_mapped_output_close(_SdsfMappedOutput* output, void* data, size_t mappedSize, size_t fileSize)
+{
+    if (data)
+    {
+        munmap(data, mappedSize);
+    }
+    const bool isTrimmed = _sdsf_truncate_file(output->file, fileSize);
+    close(output->file);
+    output->isOpen = false;
+    return isTrimmed;
+}
+#endif
+
+//
+// Built-in codec is a simple lz77 codec with lz4-like block format. Block is a list of sequences, each sequence is:
+// token byte (literal count in high 4 bits, match length - 4 in low 4 bits), extra literal count bytes (if literal count is 15 or more),
+// literals, match offset (2 bytes, little endian) and extra match length bytes (if match length - 4 is 15 or more).
+// Extra length bytes are added until byte is not 255. Last sequence has only literals. Matches never end in the last _SDSF_LZ_LAST_LITERALS bytes
+//
+static inline uint32_t _sdsf_lz_read32(const uint8_t* ptr)
+{
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(uint32_t));
+    return value;
+}
+
+static inline uint32_t _sdsf_lz_hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - _SDSF_LZ_HASH_BITS);
+}
+
+static inline bool _sdsf_lz_write_length(uint8_t** out, const uint8_t* outEnd, size_t length)
+{
+    while (true)
+    {
+        if (*out == outEnd)
+        {
+            return false;
+        }
+        const uint8_t byte = length >= 255 ? 255 : (uint8_t)length;
+        *(*out)++ = byte;
+        length -= byte;
+        if (byte != 255)
+        {
+            return true;
+        }
+    }
+}
+
+bool _sdsf_lz_write_sequence(uint8_t** out, const uint8_t* outEnd, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength)
+{
+    if (*out == outEnd)
+    {
+        return false;
+    }
+    const size_t matchCode = matchLength ? matchLength - _SDSF_LZ_MIN_MATCH : 0;
+    uint8_t* const token = (*out)++;
+    *token = (uint8_t)(((literalCount < 15 ? literalCount : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+    if (literalCount >= 15 && !_sdsf_lz_write_length(out, outEnd, literalCount - 15))
+    {
+        return false;
+    }
+    if ((size_t)(outEnd - *out) < literalCount)
+    {
+        return false;
+    }
+    memcpy(*out, literals, literalCount);
+    *out += literalCount;
+    if (!matchLength)
+    {
+        return true;
+    }
+    if (outEnd - *out < 2)
+    {
+        return false;
+    }
+    *(*out)++ = (uint8_t)offset;
+    *(*out)++ = (uint8_t)(offset >> 8);
+    return matchCode < 15 || _sdsf_lz_write_length(out, outEnd, matchCode - 15);
+}
+
+size_t _sdsf_lz_compress(const void* src, size_t srcSize, void* dst, size_t dstCapacity, void* userData)
+{
+    (void)userData;
+    const uint8_t* const in = (const uint8_t*)src;
+    uint8_t* out = (uint8_t*)dst;
+    const uint8_t* const outEnd = out + dstCapacity;
+
+    uint32_t table[1 << _SDSF_LZ_HASH_BITS];
+    memset(table, 0, sizeof(table));
+
+    size_t anchor = 0;
+    size_t it = 0;
+    const size_t matchStartLimit = srcSize > _SDSF_LZ_MATCH_START_LIMIT ? srcSize - _SDSF_LZ_MATCH_START_LIMIT : 0;
+    while (it < matchStartLimit)
+    {
+        const uint32_t sequence = _sdsf_lz_read32(in + it);
+        const uint32_t hash = _sdsf_lz_hash(sequence);
+        const size_t candidate = table[hash];
+        table[hash] = (uint32_t)it;
+        if (candidate >= it || it - candidate > 0xFFFF || _sdsf_lz_read32(in + candidate) != sequence)
+        {
+            // Search step grows on data without matches
+            it += 1 + ((it - anchor) >> 6);
+            continue;
+        }
+
+        const size_t maxMatchLength = srcSize - _SDSF_LZ_LAST_LITERALS - it;
+        size_t matchLength = _SDSF_LZ_MIN_MATCH;
+        while (matchLength < maxMatchLength && in[candidate + matchLength] == in[it + matchLength])
+        {
+            matchLength += 1;
+        }
+        if (!_sdsf_lz_write_sequence(&out, outEnd, in + anchor, it - anchor, it - candidate, matchLength))
+        {
+            return 0;
+        }
+        it += matchLength;
+        anchor = it;
+    }
+    if (!_sdsf_lz_write_sequence(&out, outEnd, in + anchor, srcSize - anchor, 0, 0))
+    {
+        return 0;
+    }
+    return (size_t)(out - (uint8_t*)dst);
+}
+
+static inline bool _sdsf_lz_read_length(const uint8_t** in, const uint8_t* inEnd, size_t* length)
+{
+    while (true)
+    {
+        if (*in == inEnd)
+        {
+            return false;
+        }
+        const uint8_t byte = *(*in)++;
+        *length += byte;
+        if (byte != 255)
+        {
+            return true;
+        }
+    }
+}
+
+bool _sdsf_lz_decompress(const void* src, size_t srcSize, void* dst, size_t dstSize, void* userData)
+{
+    (void)userData;
+    const uint8_t* in = (const uint8_t*)src;
+    const uint8_t* const inEnd = in + srcSize;
+    uint8_t* out = (uint8_t*)dst;
+    const uint8_t* const outEnd = out + dstSize;
+    while (in < inEnd)
+    {
+        const uint8_t token = *in++;
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !_sdsf_lz_read_length(&in, inEnd, &literalCount))
+        {
+            return false;
+        }
+        if ((size_t)(inEnd - in) < literalCount || (size_t)(outEnd - out) < literalCount)
+        {
+            return false;
+        }
+        memcpy(out, in, literalCount);
+        out += literalCount;
+        in += literalCount;
+        if (in == inEnd)
+        {
+            break;
+        }
+
+        if (inEnd - in < 2)
+        {
+            return false;
+        }
+        const size_t offset = (size_t)in[0] | ((size_t)in[1] << 8);
+        in += 2;
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !_sdsf_lz_read_length(&in, inEnd, &matchLength))
+        {
+            return false;
+        }
+        matchLength += _SDSF_LZ_MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(out - (uint8_t*)dst) || (size_t)(outEnd - out) < matchLength)
+        {
+            return false;
+        }
+        // Match can overlap with itself (repeated pattern), so it is copied byte by byte in that case
+        const uint8_t* const match = out - offset;
+        if (offset >= matchLength)
+        {
+            memcpy(out, match, matchLength);
+        }
+        else
+        {
+            for (size_t it = 0; it < matchLength; it++)
+            {
+                out[it] = match[it];
+            }
+        }
+        out += matchLength;
+    }
+    return out == outEnd;
+}
+
+SdsfCodec sdsf_lz_codec(void)
+{
+    SdsfCodec codec;
+    codec.compress = _sdsf_lz_compress;
+    codec.decompress = _sdsf_lz_decompress;
+    codec.userData = NULL;
+    return codec;
+}
+
+static inline void _sdsf_codec_write_u32(uint8_t* ptr, uint32_t value)
+{
+    ptr[0] = (uint8_t)value;
+    ptr[1] = (uint8_t)(value >> 8);
+    ptr[2] = (uint8_t)(value >> 16);
+    ptr[3] = (uint8_t)(value >> 24);
+}
+
+static inline uint32_t _sdsf_codec_read_u32(const uint8_t* ptr)
+{
+    return (uint32_t)ptr[0] | ((uint32_t)ptr[1] << 8) | ((uint32_t)ptr[2] << 16) | ((uint32_t)ptr[3] << 24);
+}
+
+static inline void _sdsf_codec_write_u64(uint8_t* ptr, uint64_t value)
+{
+    _sdsf_codec_write_u32(ptr, (uint32_t)value);
+    _sdsf_codec_write_u32(ptr + 4, (uint32_t)(value >> 32));
+}
+
+static inline uint64_t _sdsf_codec_read_u64(const uint8_t* ptr)
+{
+    return (uint64_t)_sdsf_codec_read_u32(ptr) | ((uint64_t)_sdsf_codec_read_u32(ptr + 4) << 32);
+}
+
+//
+// Returns number of threads which were actually used. If some threads can't be started, their jobs are done by other threads
+//
+size_t _sdsf_parallel_for(size_t jobCount, size_t threadCount, _SdsfJobProc proc, void* context, const SdsfAllocator* allocator)
+{
+    threadCount = threadCount < jobCount ? threadCount : jobCount;
+    _SdsfJobQueue queue = { proc, context, jobCount, 0 };
+    const size_t workerCount = threadCount > 1 ? threadCount - 1 : 0;
+    _SdsfWorker* const workers = workerCount ? (_SdsfWorker*)allocator->alloc(workerCount * sizeof(_SdsfWorker), allocator->userData) : NULL;
+
+    size_t startedCount = 0;
+    for (; startedCount < workerCount; startedCount++)
+    {
+        workers[startedCount].queue = &queue;
+        workers[startedCount].threadIndex = startedCount + 1;
+        if (!_sdsf_thread_start(&workers[startedCount]))
+        {
+            break;
+        }
+    }
+
+    _sdsf_run_jobs(&queue, 0);
+
+    for (size_t it = 0; it < startedCount; it++)
+    {
+        _sdsf_thread_join(&workers[it]);
+    }
+    if (workers)
+    {
+        allocator->dealloc(workers, workerCount * sizeof(_SdsfWorker), allocator->userData);
+    }
+
+    return startedCount + 1;
+}
+
+void _sdsf_ensure_buffer_capacity(SdsfAllocator* allocator, void** buffer, size_t* capacity, size_t size, size_t additionalSize)
+{
+    const size_t initialCapacity = *capacity;
+    void* const initialBuffer = *buffer;
+    if ((initialCapacity - size) >= additionalSize)
+    {
+        return;
+    }
+
+    const size_t requiredCapacity = size + additionalSize;
+    const size_t doubledCapacity = initialCapacity * 2;
+    const size_t newCapacity = (requiredCapacity > doubledCapacity) ? requiredCapacity : doubledCapacity;
+
+    void* const newBuffer = allocator->alloc(newCapacity, allocator->userData);
+    if (size)
+    {
+        memcpy(newBuffer, initialBuffer, size);
+    }
+
+    if (initialBuffer)
+    {
+        allocator->dealloc(initialBuffer, initialCapacity, allocator->userData);
+    }
+    *buffer = newBuffer;
+    *capacity = newCapacity;
+}
+
+// ==============================================================================================================
+//
+//
+// Deserializer
+//
+//
+// ==============================================================================================================
+
+typedef struct
+{
+    const char* ptr;
+    size_t size;
+    bool hasEscapes;
+    bool hasNonAscii;
+} _SdsfComsumedString;
+
+typedef enum
+{
+    _SDSF_TOKEN_TYPE_INVALID,
+    _SDSF_TOKEN_TYPE_IDENTIFIER,
+    _SDSF_TOKEN_TYPE_RESERVED_SYMBOL,
+    _SDSF_TOKEN_TYPE_BOOL_LITERAL,
+    _SDSF_TOKEN_TYPE_INT_LITERAL,
+    _SDSF_TOKEN_TYPE_FLOAT_LITERAL,
+    _SDSF_TOKEN_TYPE_BINARY_LITERAL,
+    _SDSF_TOKEN_TYPE_STRING_LITERAL,
+} _SdsfTokenType;
+
+typedef enum
+{
+    _SDSF_STRING_LITERAL_NONE,
+    _SDSF_STRING_LITERAL_BEGIN,
+    _SDSF_STRING_LITERAL_END,
+} _SdsfStringLiteralState;
+
+typedef struct
+{
+    const char* data;
+    size_t dataSize;
+    _SdsfStringLiteralState stringLiteralState;
+    size_t stringConsumePtr;
+    bool validateUtf8;
+    bool hasInvalidUtf8;
+} _SdsfTokenizerData;
+
+typedef struct
+{
+    const char* stringPtr;
+    size_t stringSize;
+    _SdsfTokenType tokenType;
+    bool hasEscapes;
+} _SdsfConsumedToken;
+
+static inline bool _sdsf_is_skipped_char(char c)
+{
+    return (c == ' ') || (c == '\n') || (c == '\r') || (c == '\t');
+}
+
+static inline bool _sdsf_is_reserved_symbol(char c)
+{
+    return
+        (c == ',') ||
+        (c == '[') ||
+        (c == ']') ||
+        (c == '{') ||
+        (c == '}') ||
+        (c == '\"') ||
+        (c == '@');
+}
+
+static inline bool _sdsf_is_number(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+//
+// Returns index of the first '"' or '\\' character or size if there are no such characters.
+// This is the only thing string literals need to be scanned for, so it is done 16 (or 8) bytes at a time.
+// Bytes before the returned index are also checked for non-ascii characters, so utf-8 validation can skip ascii literals
+//
+static inline size_t _sdsf_find_quote_or_backslash_noting_non_ascii(const char* data, size_t size, bool* hasNonAscii)
+{
+    size_t it = 0;
+#ifdef _SDSF_SSE2
+    const __m128i quotes = _mm_set1_epi8('\"');
+    const __m128i backslashes = _mm_set1_epi8('\\');
+    uint32_t nonAsciiMask = 0;
+    for (; it + 16 <= size; it += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128((const __m128i*)(data + it));
+        const __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(chunk, quotes), _mm_cmpeq_epi8(chunk, backslashes));
+        const uint32_t mask = (uint32_t)_mm_movemask_epi8(matches);
+        if (mask)
+        {
+            const uint32_t beforeMatch = (mask & (0u - mask)) - 1;
+            *hasNonAscii |= (nonAsciiMask | ((uint32_t)_mm_movemask_epi8(chunk) & beforeMatch)) != 0;
+            return it + _sdsf_count_trailing_zeros(mask);
+        }
+        nonAsciiMask |= (uint32_t)_mm_movemask_epi8(chunk);
+    }
+    *hasNonAscii |= nonAsciiMask != 0;
+#else
+    const uint64_t ones = 0x0101010101010101ull;
+    const uint64_t highBits = 0x8080808080808080ull;
+    uint64_t nonAsciiBits = 0;
+    for (; it + 8 <= size; it += 8)
+    {
+        uint64_t chunk;
+        memcpy(&chunk, data + it, sizeof(chunk));
+        const uint64_t quotes = chunk ^ (ones * '\"');
+        const uint64_t backslashes = chunk ^ (ones * '\\');
+        const uint64_t hasZero = ((quotes - ones) & ~quotes) | ((backslashes - ones) & ~backslashes);
+        if (hasZero & highBits)
+        {
+            break;
+        }
+        nonAsciiBits |= chunk;
+    }
+    *hasNonAscii |= (nonAsciiBits & highBits) != 0;
+#endif
+    for (; it < size; it++)
+    {
+        if (data[it] == '\"' || data[it] == '\\')
+        {
+            return it;
+        }
+        *hasNonAscii |= (uint8_t)data[it] >= 0x80;
+    }
+    return size;
+}
+
+size_t _sdsf_find_quote_or_backslash(const char* data, size_t size)
+{
+    bool hasNonAscii = false;
+    return _sdsf_find_quote_or_backslash_noting_non_ascii(data, size, &hasNonAscii);
+}
+
+//
+// Returns index of the first '[' ']' '{' '}' '"' or '@' character or size if there are no such characters.
+// Used by sdsf_deserialize_parallel pre-scan to skip nested values without tokenizing them
+//
+size_t _sdsf_find_structural_char(const char* data, size_t size)
+{
+    size_t it = 0;
+#ifdef _SDSF_SSE2
+    const __m128i openBrackets = _mm_set1_epi8('[');
+    const __m128i closeBrackets = _mm_set1_epi8(']');
+    const __m128i openBraces = _mm_set1_epi8('{');
+    const __m128i closeBraces = _mm_set1_epi8('}');
+    const __m128i quotes = _mm_set1_epi8('\"');
+    const __m128i blobStarts = _mm_set1_epi8('@');
+    for (; it + 16 <= size; it += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128((const __m128i*)(data + it));
+        const __m128i brackets = _mm_or_si128(_mm_cmpeq_epi8(chunk, openBrackets), _mm_cmpeq_epi8(chunk, closeBrackets));
+        const __m128i braces = _mm_or_si128(_mm_cmpeq_epi8(chunk, openBraces), _mm_cmpeq_epi8(chunk, closeBraces));
+        const __m128i others = _mm_or_si128(_mm_cmpeq_epi8(chunk, quotes), _mm_cmpeq_epi8(chunk, blobStarts));
+        const uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(brackets, braces), others));
+        if (mask)
+        {
+            return it + _sdsf_count_trailing_zeros(mask);
+        }
+    }
+#endif
+    for (; it < size; it++)
+    {
+        const char c = data[it];
+        if (c == '[' || c == ']' || c == '{' || c == '}' || c == '\"' || c == '@')
+        {
+            return it;
+        }
+    }
+    return size;
+}
+
+//
+// Utf-8 validation using lookup algorithm by John Keiser and Daniel Lemire ("Validating UTF-8 In Less Than One Instruction Per Byte").
+// Every pair of consecutive bytes is classified by three 16-entry tables : high nibble of the first byte, low nibble of the first byte
+// and high nibble of the second byte. Each table entry is a set of errors which are possible for this nibble, so pair is invalid if all
+// three sets have a common bit. Missing third and fourth bytes of a sequence are found by looking two and three bytes back
+//
+typedef enum
+{
+    _SDSF_UTF8_TOO_SHORT        = 1 << 0, // leading byte is followed by another leading byte or by ascii
+    _SDSF_UTF8_TOO_LONG         = 1 << 1, // ascii is followed by continuation byte
+    _SDSF_UTF8_OVERLONG_3       = 1 << 2, // 1110_0000 100_____
+    _SDSF_UTF8_TOO_LARGE        = 1 << 3, // 1111_0100 1001____ and above
+    _SDSF_UTF8_SURROGATE        = 1 << 4, // 1110_1101 101_____
+    _SDSF_UTF8_OVERLONG_2       = 1 << 5, // 1100_000_ 10______
+    _SDSF_UTF8_TOO_LARGE_1000   = 1 << 6, // 1111_0101 1000____ and above
+    _SDSF_UTF8_OVERLONG_4       = 1 << 6, // 1111_0000 1000____
+    _SDSF_UTF8_TWO_CONTS        = 1 << 7, // two continuation bytes in a row (valid only as a part of 3 and 4 byte sequences)
+    _SDSF_UTF8_CARRY            = _SDSF_UTF8_TOO_SHORT | _SDSF_UTF8_TOO_LONG | _SDSF_UTF8_TWO_CONTS,
+} _SdsfUtf8Error;
+
+const uint8_t _SDSF_UTF8_BYTE_1_HIGH[16] =
+{
+    _SDSF_UTF8_TOO_LONG, _SDSF_UTF8_TOO_LONG, _SDSF_UTF8_TOO_LONG, _SDSF_UTF8_TOO_LONG,
+    _SDSF_UTF8_TOO_LONG, _SDSF_UTF8_TOO_LONG, _SDSF_UTF8_TOO_LONG, _SDSF_UTF8_TOO_LONG,
+    _SDSF_UTF8_TWO_CONTS, _SDSF_UTF8_TWO_CONTS, _SDSF_UTF8_TWO_CONTS, _SDSF_UTF8_TWO_CONTS,
+    _SDSF_UTF8_TOO_SHORT | _SDSF_UTF8_OVERLONG_2,
+    _SDSF_UTF8_TOO_SHORT,
+    _SDSF_UTF8_TOO_SHORT | _SDSF_UTF8_OVERLONG_3 | _SDSF_UTF8_SURROGATE,
+    _SDSF_UTF8_TOO_SHORT | _SDSF_UTF8_TOO_LARGE | _SDSF_UTF8_TOO_LARGE_1000 | _SDSF_UTF8_OVERLONG_4,
+};
+
+const uint8_t _SDSF_UTF8_BYTE_1_LOW[16] =
+{
+    _SDSF_UTF8_CARRY | _SDSF_UTF8_OVERLONG_3 | _SDSF_UTF8_OVERLONG_2 | _SDSF_UTF8_OVERLONG_4,
+    _SDSF_UTF8_CARRY | _SDSF_UTF8_OVERLONG_2,
+    _SDSF_UTF8_CARRY,
+    _SDSF_UTF8_CARRY,
+    _SDSF_UTF8_CARRY | _SDSF_UTF8_TOO_LARGE,
+    _SDSF_UTF8_CARRY | _SDSF_UTF8_TOO_LARGE | _SDSF_UTF8_TOO_LARGE_1000,
+    _SDSF_UTF8_CARRY | _SDSF_UTF8_TOO_LARGE | _SDSF_UTF8_TOO_LARGE_1000,
+    _SDSF_UTF8_CARRY | _SDSF_UTF8_TOO_LARGE | _SDSF_UTF8_TOO_LARGE_1000,
+    _SDSF_UTF8_CARRY | _SDSF_UTF8_TOO_LARGE | _SDSF_UTF8_TOO_LARGE_1000,
+    _SDSF_UTF8_CARRY | _SDSF_UTF8_TOO_LARGE | _SDSF_UTF8_TOO_LARGE_1000,
+    _SDSF_UTF8_CARRY | _SDSF_UTF8_TOO_LARGE | _SDSF_UTF8_TOO_LARGE_1000,
+    _SDSF_UTF8_CARRY | _SDSF_UTF8_TOO_LARGE | _SDSF_UTF8_TOO_LARGE_1000,
+    _SDSF_UTF8_CARRY | _SDSF_UTF8_TOO_LARGE | _SDSF_UTF8_TOO_LARGE_1000,
+    _SDSF_UTF8_CARRY | _SDSF_UTF8_TOO_LARGE | _SDSF_UTF8_TOO_LARGE_1000 | _SDSF_UTF8_SURROGATE,
+    _SDSF_UTF8_CARRY | _SDSF_UTF8_TOO_LARGE | _SDSF_UTF8_TOO_LARGE_1000,
+    _SDSF_UTF8_CARRY | _SDSF_UTF8_TOO_LARGE | _SDSF_UTF8_TOO_LARGE_1000,
+};
+
+const uint8_t _SDSF_UTF8_BYTE_2_HIGH[16] =
+{
+    _SDSF_UTF8_TOO_SHORT, _SDSF_UTF8_TOO_SHORT, _SDSF_UTF8_TOO_SHORT, _SDSF_UTF8_TOO_SHORT,
+    _SDSF_UTF8_TOO_SHORT, _SDSF_UTF8_TOO_SHORT, _SDSF_UTF8_TOO_SHORT, _SDSF_UTF8_TOO_SHORT,
+    _SDSF_UTF8_TOO_LONG | _SDSF_UTF8_OVERLONG_2 | _SDSF_UTF8_TWO_CONTS | _SDSF_UTF8_OVERLONG_3 | _SDSF_UTF8_TOO_LARGE_1000 | _SDSF_UTF8_OVERLONG_4,
+    _SDSF_UTF8_TOO_LONG | _SDSF_UTF8_OVERLONG_2 | _SDSF_UTF8_TWO_CONTS | _SDSF_UTF8_OVERLONG_3 | _SDSF_UTF8_TOO_LARGE,
+    _SDSF_UTF8_TOO_LONG | _SDSF_UTF8_OVERLONG_2 | _SDSF_UTF8_TWO_CONTS | _SDSF_UTF8_SURROGATE | _SDSF_UTF8_TOO_LARGE,
+    _SDSF_UTF8_TOO_LONG | _SDSF_UTF8_OVERLONG_2 | _SDSF_UTF8_TWO_CONTS | _SDSF_UTF8_SURROGATE | _SDSF_UTF8_TOO_LARGE,
+    _SDSF_UTF8_TOO_SHORT, _SDSF_UTF8_TOO_SHORT, _SDSF_UTF8_TOO_SHORT, _SDSF_UTF8_TOO_SHORT,
+};
+
+#if defined(_SDSF_SSSE3) || defined(_SDSF_SSSE3_DISPATCH)
+//
+// Checks 16 bytes at a time. Bytes before the data are treated as ascii and data is followed by at least one ascii byte,
+// so sequences cut by the start or by the end of data are reported as errors
+//
+_SDSF_TARGET_SSSE3 bool _sdsf_validate_utf8_lookup_ssse3(const char* data, size_t size)
+{
+    const __m128i byte1HighTable = _mm_loadu_si128((const __m128i*)_SDSF_UTF8_BYTE_1_HIGH);
+    const __m128i byte1LowTable = _mm_loadu_si128((const __m128i*)_SDSF_UTF8_BYTE_1_LOW);
+    const __m128i byte2HighTable = _mm_loadu_si128((const __m128i*)_SDSF_UTF8_BYTE_2_HIGH);
+    const __m128i lowNibbleMask = _mm_set1_epi8(0x0F);
+    const __m128i highBit = _mm_set1_epi8((char)0x80);
+    // Last three bytes of a block can't start sequences which are longer than the rest of the block
+    const __m128i incompleteThreshold = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+
+    __m128i error = _mm_setzero_si128();
+    __m128i previousBlock = _mm_setzero_si128();
+    __m128i previousIncomplete = _mm_setzero_si128();
+    char tail[16];
+    bool isLastBlock = false;
+    for (size_t it = 0; !isLastBlock; it += 16)
+    {
+        __m128i block;
+        if (it + 16 <= size)
+        {
+            block = _mm_loadu_si128((const __m128i*)(data + it));
+        }
+        else
+        {
+            // Zero padding works as the trailing ascii byte
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, data + it, size - it);
+            block = _mm_loadu_si128((const __m128i*)tail);
+            isLastBlock = true;
+        }
+
+        if (_mm_movemask_epi8(block) == 0)
+        {
+            error = _mm_or_si128(error, previousIncomplete);
+            previousIncomplete = _mm_setzero_si128();
+            previousBlock = block;
+            continue;
+        }
+
+        const __m128i previous1 = _mm_alignr_epi8(block, previousBlock, 15);
+        const __m128i previous2 = _mm_alignr_epi8(block, previousBlock, 14);
+        const __m128i previous3 = _mm_alignr_epi8(block, previousBlock, 13);
+
+        const __m128i byte1High = _mm_shuffle_epi8(byte1HighTable, _mm_and_si128(_mm_srli_epi16(previous1, 4), lowNibbleMask));
+        const __m128i byte1Low = _mm_shuffle_epi8(byte1LowTable, _mm_and_si128(previous1, lowNibbleMask));
+        const __m128i byte2High = _mm_shuffle_epi8(byte2HighTable, _mm_and_si128(_mm_srli_epi16(block, 4), lowNibbleMask));
+        const __m128i specialCases = _mm_and_si128(_mm_and_si128(byte1High, byte1Low), byte2High);
+
+        // Third and fourth bytes of a sequence must be continuation bytes, which is the only case of TWO_CONTS bit being valid
+        const __m128i isThirdByte = _mm_subs_epu8(previous2, _mm_set1_epi8((char)(0xE0 - 0x80)));
+        const __m128i isFourthByte = _mm_subs_epu8(previous3, _mm_set1_epi8((char)(0xF0 - 0x80)));
+        const __m128i mustBeContinuation = _mm_and_si128(_mm_or_si128(isThirdByte, isFourthByte), highBit);
+
+        error = _mm_or_si128(error, _mm_xor_si128(mustBeContinuation, specialCases));
+        previousIncomplete = _mm_subs_epu8(block, incompleteThreshold);
+        previousBlock = block;
+    }
+
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+#endif
+
+#ifndef _SDSF_SSSE3
+//
+// Same tables, but one byte at a time. Single ascii byte after the data is enough to report unfinished sequence
+//
+bool _sdsf_validate_utf8_lookup_scalar(const char* data, size_t size)
+{
+    uint8_t previous1 = 0;
+    uint8_t previous2 = 0;
+    uint8_t previous3 = 0;
+    uint8_t error = 0;
+    for (size_t it = 0; it <= size; it++)
+    {
+        const uint8_t current = it < size ? (uint8_t)data[it] : 0;
+        const uint8_t specialCases = _SDSF_UTF8_BYTE_1_HIGH[previous1 >> 4] & _SDSF_UTF8_BYTE_1_LOW[previous1 & 0x0F] & _SDSF_UTF8_BYTE_2_HIGH[current >> 4];
+        const uint8_t mustBeContinuation = (previous2 >= 0xE0 || previous3 >= 0xF0) ? 0x80 : 0;
+        error |= specialCases ^ mustBeContinuation;
+        previous3 = previous2;
+        previous2 = previous1;
+        previous1 = current;
+    }
+    return error == 0;
+}
+#endif
+
+#ifdef _SDSF_SSSE3_DISPATCH
+//
+// 0 - cpu wasn't checked yet, 1 - SSSE3 is not supported, 2 - SSSE3 is supported
+//
+volatile int32_t _sdsf_ssse3_support = 0;
+
+static inline bool _sdsf_cpu_has_ssse3()
+{
+    int32_t support = _sdsf_atomic_load(&_sdsf_ssse3_support);
+    if (!support)
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        support = (info[2] & (1 << 9)) ? 2 : 1;
+#else
+        __builtin_cpu_init();
+        support = __builtin_cpu_supports("ssse3") ? 2 : 1;
+#endif
+        _sdsf_atomic_store(&_sdsf_ssse3_support, support);
+    }
+    return support == 2;
+}
+#endif
+
+bool _sdsf_validate_utf8_lookup(const char* data, size_t size)
+{
+#if defined(_SDSF_SSSE3)
+    return _sdsf_validate_utf8_lookup_ssse3(data, size);
+#elif defined(_SDSF_SSSE3_DISPATCH)
+    return _sdsf_cpu_has_ssse3() ? _sdsf_validate_utf8_lookup_ssse3(data, size) : _sdsf_validate_utf8_lookup_scalar(data, size);
+#else
+    return _sdsf_validate_utf8_lookup_scalar(data, size);
+#endif
+}
+
+//
+// Identifiers and literals are the only tokens which can have non-ascii characters and most of them don't have any.
+// So ascii prefix is skipped first and the rest of the token goes through the lookup algorithm
+//
+bool _sdsf_validate_utf8(const char* data, size_t size)
+{
+    size_t it = 0;
+#ifdef _SDSF_SSE2
+    for (; it + 16 <= size; it += 16)
+    {
+        if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(data + it))))
+        {
+            break;
+        }
+    }
+#endif
+    for (; it + 8 <= size; it += 8)
+    {
+        uint64_t chunk;
+        memcpy(&chunk, data + it, sizeof(chunk));
+        if (chunk & 0x8080808080808080ull)
+        {
+            break;
+        }
+    }
+    for (; it < size; it++)
+    {
+        if ((uint8_t)data[it] >= 0x80)
+        {
+            return _sdsf_validate_utf8_lookup(data + it, size - it);
+        }
+    }
+    return true;
+}
+
+static inline size_t _sdsf_encode_utf8(uint32_t codepoint, char* buffer)
+{
+    if (codepoint < 0x80)
+    {
+        buffer[0] = (char)codepoint;
+        return 1;
+    }
+    if (codepoint < 0x800)
+    {
+        buffer[0] = (char)(0xC0 | (codepoint >> 6));
+        buffer[1] = (char)(0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+    if (codepoint < 0x10000)
+    {
+        buffer[0] = (char)(0xE0 | (codepoint >> 12));
+        buffer[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        buffer[2] = (char)(0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+    buffer[0] = (char)(0xF0 | (codepoint >> 18));
+    buffer[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+    buffer[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+    buffer[3] = (char)(0x80 | (codepoint & 0x3F));
+    return 4;
+}
+
+static inline bool _sdsf_parse_utf16_code_unit(const char* str, size_t size, uint32_t* result)
+{
+    // str points to the XXXX part of the \uXXXX sequence
+    if (size < 4)
+    {
+        return false;
+    }
+    uint32_t value = 0;
+    for (size_t it = 0; it < 4; it++)
+    {
+        const int32_t digit = _sdsf_hex_digit_value(str[it]);
+        if (digit < 0)
+        {
+            return false;
+        }
+        value = (value << 4) | (uint32_t)digit;
+    }
+    *result = value;
+    return true;
+}
+
+//
+// Unescapes string literal. Unescaped string is never longer than the source, so destination must have at least sourceSize bytes.
+// Returns false if string has invalid escape sequence
+//
+bool _sdsf_unescape_string(const char* source, size_t sourceSize, char* destination, size_t* destinationSize)
+{
+    size_t written = 0;
+    size_t it = 0;
+    while (it < sourceSize)
+    {
+        const size_t plainSize = _sdsf_find_quote_or_backslash(source + it, sourceSize - it);
+        memcpy(destination + written, source + it, plainSize);
+        written += plainSize;
+        it += plainSize;
+        if (it == sourceSize)
+        {
+            break;
+        }
+        if (it + 1 == sourceSize)
+        {
+            return false;
+        }
+
+        const char escaped = source[it + 1];
+        it += 2;
+        switch (escaped)
+        {
+            case '\"':  destination[written++] = '\"';  break;
+            case '\\': destination[written++] = '\\'; break;
+            case '/':   destination[written++] = '/';   break;
+            case 'b':   destination[written++] = '\b';  break;
+            case 'f':   destination[written++] = '\f';  break;
+            case 'n':   destination[written++] = '\n';  break;
+            case 'r':   destination[written++] = '\r';  break;
+            case 't':   destination[written++] = '\t';  break;
+            case 'u':
+            {
+                uint32_t codepoint;
+                if (!_sdsf_parse_utf16_code_unit(source + it, sourceSize - it, &codepoint) || codepoint == 0)
+                {
+                    return false;
+                }
+                it += 4;
+                if (codepoint >= 0xD800 && codepoint <= 0xDBFF)
+                {
+                    // High surrogate must be followed by the low one
+                    uint32_t lowSurrogate;
+                    if (sourceSize - it < 6 || source[it] != '\\' || source[it + 1] != 'u' ||
+                        !_sdsf_parse_utf16_code_unit(source + it + 2, sourceSize - it - 2, &lowSurrogate) ||
+                        lowSurrogate < 0xDC00 || lowSurrogate > 0xDFFF)
+                    {
+                        return false;
+                    }
+                    it += 6;
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                }
+                else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF)
+                {
+                    return false;
+                }
+                written += _sdsf_encode_utf8(codepoint, destination + written);
+            } break;
+            default: return false;
+        }
+    }
+
+    *destinationSize = written;
+    return true;
+}
+
+bool _sdsf_consume_string(const char* sourceBuffer, size_t sourceBufferSize, size_t* consumePtr, _SdsfComsumedString* result, bool isStringLiteral)
+{
+    if (*consumePtr >= sourceBufferSize)
+    {
+        return false;
+    }
+
+    size_t beginning;
+    if (!isStringLiteral)
+    {
+        // Skip spaces and stuff
+        for (; *consumePtr < sourceBufferSize; *consumePtr += 1)
+        {
+            if (!_sdsf_is_skipped_char(sourceBuffer[*consumePtr])) break;
+        }
+        if (*consumePtr == sourceBufferSize)
+        {
+            return false;
+        }
+
+        // Check reserved symbol
+        if (_sdsf_is_reserved_symbol(sourceBuffer[*consumePtr]))
+        {
+            result->ptr = sourceBuffer + *consumePtr;
+            result->size = 1;
+            result->hasEscapes = false;
+            result->hasNonAscii = false;
+            *consumePtr += 1;
+            return true;
+        }
+
+        // Consume string until reserved or skip symbol
+        beginning = *consumePtr;
+        uint8_t highBits = 0;
+        for (; *consumePtr < sourceBufferSize; *consumePtr += 1)
+        {
+            const char c = sourceBuffer[*consumePtr];
+            const bool isSkipped = _sdsf_is_skipped_char(c);
+            const bool isReserved = _sdsf_is_reserved_symbol(c);
+            if (isSkipped || isReserved) break;
+            highBits |= (uint8_t)c;
+        }
+        result->hasNonAscii = highBits >= 0x80;
+
+        // Zero size means we finished
+        const size_t size = *consumePtr - beginning;
+        if (!size)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // Consume string until '"' character which is not escaped
+        beginning = *consumePtr;
+        result->hasEscapes = false;
+        result->hasNonAscii = false;
+        while (*consumePtr < sourceBufferSize)
+        {
+            *consumePtr += _sdsf_find_quote_or_backslash_noting_non_ascii(sourceBuffer + *consumePtr, sourceBufferSize - *consumePtr, &result->hasNonAscii);
+            if (*consumePtr == sourceBufferSize || sourceBuffer[*consumePtr] == '\"') break;
+            // Skip backslash and escaped character
+            result->hasEscapes = true;
+            *consumePtr += 2;
+        }
+        if (*consumePtr > sourceBufferSize)
+        {
+            *consumePtr = sourceBufferSize;
+        }
+    }
+
+    result->ptr = sourceBuffer + beginning;
+    result->size = *consumePtr - beginning;
+    if (!isStringLiteral)
+    {
+        result->hasEscapes = false;
+    }
+    return true;
+}
+
+_SdsfTokenType _sdsf_match_hex_float(const char** errorMsg, const _SdsfComsumedString* str)
+{
+    // Literal is expected to be [-]0x<hex digits>[.<hex digits>]p[+|-]<decimal digits>[d]
+    size_t it = (str->ptr[0] == '-' ? 1 : 0) + 2;
+    size_t digits = 0;
+    bool dotFound = false;
+    for (; it < str->size && str->ptr[it] != 'p' && str->ptr[it] != 'P'; it++)
+    {
+        const char c = str->ptr[it];
+        if (c == '.' && !dotFound)
+        {
+            dotFound = true;
+        }
+        else if (_sdsf_hex_digit_value(c) >= 0)
+        {
+            digits += 1;
+        }
+        else
+        {
+            *errorMsg = "Tokenzer error - unexpected character in hexadecimal floating point literal";
+            return _SDSF_TOKEN_TYPE_INVALID;
+        }
+    }
+    if (!digits || it == str->size)
+    {
+        *errorMsg = "Tokenzer error - hexadecimal floating point literal must have digits and 'p' exponent";
+        return _SDSF_TOKEN_TYPE_INVALID;
+    }
+
+    it += 1;
+    if (it < str->size && (str->ptr[it] == '-' || str->ptr[it] == '+'))
+    {
+        it += 1;
+    }
+    size_t exponentDigits = 0;
+    for (; it < str->size && _sdsf_is_number(str->ptr[it]); it++)
+    {
+        exponentDigits += 1;
+    }
+    if (it < str->size && str->ptr[it] == 'd')
+    {
+        it += 1;
+    }
+    if (!exponentDigits || it != str->size)
+    {
+        *errorMsg = "Tokenzer error - invalid exponent of hexadecimal floating point literal";
+        return _SDSF_TOKEN_TYPE_INVALID;
+    }
+
+    return _SDSF_TOKEN_TYPE_FLOAT_LITERAL;
+}
+
+_SdsfTokenType _sdsf_match_string(const char** errorMsg, const _SdsfComsumedString* str)
+{
+    if (!str->ptr || !str->size)
+    {
+        *errorMsg = "Tokenzer error - invalid string provided";
+        return _SDSF_TOKEN_TYPE_INVALID;
+    }
+    
+    if (str->size == 1)
+    {
+        const char c = *str->ptr;
+        const bool isReserved = _sdsf_is_reserved_symbol(c);
+        if (isReserved)
+        {
+            return _SDSF_TOKEN_TYPE_RESERVED_SYMBOL;
+        }
+        else
+        {
+            if (_sdsf_is_number(c)) return _SDSF_TOKEN_TYPE_INT_LITERAL;
+            switch (c)
+            {
+                case 't':
+                case 'f': return _SDSF_TOKEN_TYPE_BOOL_LITERAL;
+                *errorMsg = "Tokenzer error - invalid bool literal";
+                default: return _SDSF_TOKEN_TYPE_INVALID;
+            }
+        }
+    }
+    else
+    {
+        typedef enum
+        {
+            _POSSIBLE_IDENTIFIER     = 1 << 0,
+            _POSSIBLE_INT_LITERAL    = 1 << 1,
+            _POSSIBLE_FLOAT_LITERAL  = 1 << 2,
+            _POSSIBLE_BINARY_LITERAL = 1 << 3,
+        } _PossibilitySpaceValue;
+        int32_t possibilitySpace = 0;
+        bool dotFound = false;
+        bool dashFound = false;
+        bool colonFound = false;
+        bool tagFound = false;
+        bool exponentFound = false;
+
+        if (_sdsf_is_hex_float(str->ptr, str->size))
+        {
+            return _sdsf_match_hex_float(errorMsg, str);
+        }
+
+        const char firstChar = *str->ptr;
+        if (firstChar == 'b')
+        {
+            possibilitySpace = _POSSIBLE_BINARY_LITERAL | _POSSIBLE_IDENTIFIER;
+        }
+        else if (_sdsf_is_number(firstChar) || firstChar == '-')
+        {
+            possibilitySpace = _POSSIBLE_INT_LITERAL | _POSSIBLE_FLOAT_LITERAL;
+            if (firstChar == '-') dashFound = true;
+        }
+        else if (firstChar == '.' )
+        {
+            possibilitySpace = _POSSIBLE_FLOAT_LITERAL;
+            dotFound = true;
+        }
+        else if (_sdsf_is_skipped_char(firstChar) || _sdsf_is_reserved_symbol(firstChar))
+        {
+            *errorMsg = "Tokenzer error - unexpected character";
+            return _SDSF_TOKEN_TYPE_INVALID;
+        }
+        else
+        {
+            possibilitySpace = _POSSIBLE_IDENTIFIER;
+        }
+
+        for (size_t it = 1; it < str->size; it++)
+        {
+            const char c = str->ptr[it];
+            if (_sdsf_is_number(c))
+            {
+                continue; // can be anything
+            }
+
+            if (_sdsf_is_skipped_char(c) || _sdsf_is_reserved_symbol(c))
+            {
+                *errorMsg = "Tokenzer error - unexpected character";
+                return _SDSF_TOKEN_TYPE_INVALID;
+            }
+
+            if (possibilitySpace & (_POSSIBLE_INT_LITERAL | _POSSIBLE_FLOAT_LITERAL))
+            {
+                const char previous = str->ptr[it - 1];
+                if ((c == 'e' || c == 'E') && !exponentFound)
+                {
+                    // only floats can have exponent
+                    possibilitySpace &= _POSSIBLE_FLOAT_LITERAL;
+                    exponentFound = true;
+                    continue;
+                }
+                if ((c == '-' || c == '+') && (previous == 'e' || previous == 'E'))
+                {
+                    // exponent sign
+                    continue;
+                }
+                if ((c == 'l' || c == 'u') && it == str->size - 1)
+                {
+                    // only integers can have 64 bit integer suffix
+                    possibilitySpace &= _POSSIBLE_INT_LITERAL;
+                    continue;
+                }
+                if (c == 'd' && it == str->size - 1)
+                {
+                    // double suffix makes any number a floating point literal
+                    possibilitySpace &= _POSSIBLE_FLOAT_LITERAL;
+                    continue;
+                }
+            }
+
+            switch(c)
+            {
+                case '.':
+                {
+                    if (dotFound)
+                    {
+                        *errorMsg = "Tokenzer error - two '.' characters in single literal";
+                        return _SDSF_TOKEN_TYPE_INVALID;
+                    }
+                    if (exponentFound)
+                    {
+                        *errorMsg = "Tokenzer error - '.' character after exponent";
+                        return _SDSF_TOKEN_TYPE_INVALID;
+                    }
+                    // only floats can have '.'
+                    possibilitySpace &= _POSSIBLE_FLOAT_LITERAL;
+                    dotFound = true;
+                } break;
+                case '-':
+                {
+                    if (dashFound)
+                    {
+                        *errorMsg = "Tokenzer error - two '-' characters in single literal";
+                        return _SDSF_TOKEN_TYPE_INVALID;
+                    }
+                    // everything, but identifier can have '-'
+                    possibilitySpace &= ~_POSSIBLE_IDENTIFIER;
+                    if (tagFound && !colonFound)
+                    {
+                        // element type tag of binary literal must end with ':' character
+                        possibilitySpace &= ~_POSSIBLE_BINARY_LITERAL;
+                    }
+                    dashFound = true;
+                } break;
+                default:
+                {
+                    // typed binary literal can have element type tag between 'b' prefix and ':' character (bf32:0-16)
+                    // (tag is checked against known element types when token is converted to value)
+                    if ((possibilitySpace & _POSSIBLE_BINARY_LITERAL) && !colonFound && !dashFound && (c == ':' || (c >= 'a' && c <= 'z')))
+                    {
+                        colonFound = c == ':';
+                        tagFound = true;
+                        break;
+                    }
+                    // only identifier can have something other than number, dot or dash (binary literal 'b' prefix is checked earlier)
+                    possibilitySpace &= _POSSIBLE_IDENTIFIER;
+                } break;
+            }
+        }
+
+        if (possibilitySpace & _POSSIBLE_IDENTIFIER)
+        {
+            // It is possible to have both _POSSIBLE_IDENTIFIER and _POSSIBLE_BINARY_LITERAL in possibility space,
+            // but if we have _POSSIBLE_IDENTIFIER that means binary literal wasn't fully completed (it must have '-' symbol)
+            return _SDSF_TOKEN_TYPE_IDENTIFIER;
+        }
+        if (possibilitySpace & _POSSIBLE_INT_LITERAL)
+        {
+            // It is possible to have both _POSSIBLE_INT_LITERAL and _POSSIBLE_FLOAT_LITERAL in possibility space,
+            // but if we have _POSSIBLE_INT_LITERAL that means float literal wasn't fully completed (it must have '.' symbol)
+            return _SDSF_TOKEN_TYPE_INT_LITERAL;
+        }
+        if (possibilitySpace & _POSSIBLE_FLOAT_LITERAL)
+        {
+            return _SDSF_TOKEN_TYPE_FLOAT_LITERAL;
+        }
+        if (possibilitySpace & _POSSIBLE_BINARY_LITERAL)
+        {
+            return _SDSF_TOKEN_TYPE_BINARY_LITERAL;
+        }
+    }
+
+    *errorMsg = "Tokenzer error - failed to match token";
+    return _SDSF_TOKEN_TYPE_INVALID;
+}
+
+bool _sdsf_consume_token(const char** errorMsg, _SdsfConsumedToken* result, _SdsfTokenizerData* data)
+{
+    _SdsfComsumedString consumedString;
+    if (!_sdsf_consume_string(data->data, data->dataSize, &data->stringConsumePtr, &consumedString, data->stringLiteralState == _SDSF_STRING_LITERAL_BEGIN))
+    {
+        return false;
+    }
+
+    result->stringPtr = consumedString.ptr;
+    result->stringSize = consumedString.size;
+    result->hasEscapes = consumedString.hasEscapes;
+
+    // Ascii tokens are always valid, so only tokens where consume noticed non-ascii bytes go through validation
+    if (data->validateUtf8 && consumedString.hasNonAscii && !_sdsf_validate_utf8(consumedString.ptr, consumedString.size))
+    {
+        *errorMsg = "Tokenizer error - invalid utf-8 sequence";
+        data->hasInvalidUtf8 = true;
+        result->tokenType = _SDSF_TOKEN_TYPE_INVALID;
+        return true;
+    }
+
+    if (data->stringLiteralState == _SDSF_STRING_LITERAL_BEGIN)
+    {
+        data->stringLiteralState = _SDSF_STRING_LITERAL_END;
+        result->tokenType = _SDSF_TOKEN_TYPE_STRING_LITERAL;
+    }
+    else
+    {
+        result->tokenType = _sdsf_match_string(errorMsg, &consumedString);
+        if (result->tokenType == _SDSF_TOKEN_TYPE_RESERVED_SYMBOL && consumedString.ptr[0] == '\"')
+        {
+            if (data->stringLiteralState == _SDSF_STRING_LITERAL_NONE)
+            {
+                data->stringLiteralState = _SDSF_STRING_LITERAL_BEGIN;
+            }
+            else // (data->stringLiteralState == _SDSF_STRING_LITERAL_END)
+            {
+                data->stringLiteralState = _SDSF_STRING_LITERAL_NONE;
+            }
+        }
+    }
+
+    return true;
+}
+
+//
+// Values and strings are allocated in blocks which are never moved, so pointers to values and strings stay valid while
+// the result is being built. Each block starts with _SdsfBlockHeader, blocks are linked from the newest one to the oldest one.
+// SdsfValueArray and SdsfStringArray point to the data of the newest block (and store its size)
+//
+typedef struct
+{
+    void* previous;     // header of the previous block
+    size_t capacity;    // in elements
+    size_t size;        // in elements, set when newer block is linked after this one
+} _SdsfBlockHeader;
+
+static inline _SdsfBlockHeader* _sdsf_block_header(void* blockData)
+{
+    return blockData ? ((_SdsfBlockHeader*)blockData) - 1 : NULL;
+}
+
+void* _sdsf_block_alloc(void* previousBlockData, size_t previousBlockSize, size_t capacity, size_t elementSize, const SdsfAllocator* allocator)
+{
+    _SdsfBlockHeader* const header = (_SdsfBlockHeader*)allocator->alloc(sizeof(_SdsfBlockHeader) + capacity * elementSize, allocator->userData);
+    header->previous = _sdsf_block_header(previousBlockData);
+    header->capacity = capacity;
+    header->size = 0;
+    if (header->previous)
+    {
+        ((_SdsfBlockHeader*)header->previous)->size = previousBlockSize;
+    }
+    memset(header + 1, 0, capacity * elementSize);
+    return header + 1;
+}
+
+//
+// Links the oldest block of the newer chain to the newest block of the older chain. After that newer chain owns all blocks
+//
+void _sdsf_blocks_link(void* newerChainData, void* olderChainData, size_t olderChainSize)
+{
+    _SdsfBlockHeader* const olderHeader = _sdsf_block_header(olderChainData);
+    if (!olderHeader)
+    {
+        return;
+    }
+    _SdsfBlockHeader* oldestHeader = _sdsf_block_header(newerChainData);
+    while (oldestHeader->previous)
+    {
+        oldestHeader = (_SdsfBlockHeader*)oldestHeader->previous;
+    }
+    olderHeader->size = olderChainSize;
+    oldestHeader->previous = olderHeader;
+}
+
+void _sdsf_blocks_free(void* lastBlockData, size_t elementSize, const SdsfAllocator* allocator)
+{
+    _SdsfBlockHeader* header = _sdsf_block_header(lastBlockData);
+    while (header)
+    {
+        _SdsfBlockHeader* const previous = (_SdsfBlockHeader*)header->previous;
+        allocator->dealloc(header, sizeof(_SdsfBlockHeader) + header->capacity * elementSize, allocator->userData);
+        header = previous;
+    }
+}
+
+SdsfValue* _sdsf_val_array_add(SdsfValueArray* array, const SdsfAllocator* allocator)
+{
+    if (array->size == array->capacity)
+    {
+        const size_t newCapacity = array->capacity ? array->capacity * 2 : SDSF_VALUES_ARRAY_DEFAULT_CAPACITY;
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_VALUES);
+        array->ptr = (SdsfValue*)_sdsf_block_alloc(array->ptr, array->size, newCapacity, sizeof(SdsfValue), allocator);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+        array->size = 0;
+        array->capacity = newCapacity;
+    }
+
+    return &array->ptr[array->size++];
+}
+
+void _sdsf_val_array_clear(SdsfValueArray* array, const SdsfAllocator* allocator)
+{
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_VALUES);
+    _sdsf_blocks_free(array->ptr, sizeof(SdsfValue), allocator);
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+}
+
+SdsfValue** _sdsf_val_ptr_array_add(SdsfValuePtrArray* array, const SdsfAllocator* allocator)
+{
+    if (array->capacity == 0)
+    {
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_CHILD_POINTERS);
+        array->ptr = (SdsfValue**)allocator->alloc(SDSF_VALUES_PTR_ARRAY_DEFAULT_CAPACITY * sizeof(SdsfValue*), allocator->userData);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+        memset(array->ptr, 0, SDSF_VALUES_PTR_ARRAY_DEFAULT_CAPACITY * sizeof(SdsfValue*));
+        array->size = 0;
+        array->capacity = SDSF_VALUES_PTR_ARRAY_DEFAULT_CAPACITY;
+    }
+    else if (array->size == array->capacity)
+    {
+        const size_t newCapacity = array->capacity * 2;
+        const size_t oldCapacity = array->capacity;
+
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_CHILD_POINTERS);
+        SdsfValue** const newMem = (SdsfValue**)allocator->alloc(newCapacity * sizeof(SdsfValue*), allocator->userData);
+        memcpy(newMem, array->ptr, oldCapacity * sizeof(SdsfValue*));
+        allocator->dealloc(array->ptr, oldCapacity * sizeof(SdsfValue*), allocator->userData);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+        void* const toZero = newMem + oldCapacity;
+        memset(toZero, 0, (newCapacity - oldCapacity) * sizeof(SdsfValue*));
+        
+        array->ptr = newMem;
+        array->capacity = newCapacity;
+    }
+
+    return &array->ptr[array->size++];
+}
+
+void _sdsf_val_ptr_array_clear(SdsfValuePtrArray* array, const SdsfAllocator* allocator)
+{
+    if (array->capacity)
+    {
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_CHILD_POINTERS);
+        allocator->dealloc(array->ptr, array->capacity * sizeof(SdsfValue*), allocator->userData);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+    }
+}
+
+char* _sdsf_string_array_save(SdsfStringArray* array, const SdsfAllocator* allocator, const char* string, size_t stringLength)
+{
+    if ((array->capacity - array->size) < (stringLength + 1))
+    {
+        // Rest of the current block is left unused
+        const size_t requiredCapacity = stringLength + 1;
+        const size_t doubledCapacity = array->capacity ? array->capacity * 2 : SDSF_STRING_ARRAY_DEFAULT_CAPACITY;
+        const size_t newCapacity = (requiredCapacity > doubledCapacity) ? requiredCapacity : doubledCapacity;
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_STRINGS);
+        array->ptr = (char*)_sdsf_block_alloc(array->ptr, array->size, newCapacity, 1, allocator);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+        array->size = 0;
+        array->capacity = newCapacity;
+    }
+
+    char* result = &array->ptr[array->size];
+    if (string)
+    {
+        memcpy(result, string, stringLength);
+    }
+    array->size += stringLength + 1;
+
+    return result;
+}
+
+void _sdsf_string_array_clear(SdsfStringArray* array, const SdsfAllocator* allocator)
+{
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_STRINGS);
+    _sdsf_blocks_free(array->ptr, 1, allocator);
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+}
+
+//
+// Short strings are stored in SdsfValue::asStringInline instead of the string array. Last byte of the buffer
+// stores (_SDSF_INLINE_STRING_CAPACITY - size), so for strings of the maximum size it is also a null terminator
+//
+#define _SDSF_INLINE_STRING_CAPACITY 15
+
+static inline void _sdsf_finish_inline_string(SdsfValue* value, size_t size)
+{
+    value->asStringInline[size] = 0;
+    value->asStringInline[_SDSF_INLINE_STRING_CAPACITY] = (char)(_SDSF_INLINE_STRING_CAPACITY - size);
+    value->asString = value->asStringInline;
+}
+
+bool _sdsf_match_binary_element_type(const char* tag, size_t tagSize, SdsfBinaryElementType* type, bool* isBigEndian)
+{
+    *isBigEndian = false;
+    if (tagSize > 2)
+    {
+        const char* const suffix = &tag[tagSize - 2];
+        if (suffix[0] == 'b' && suffix[1] == 'e')
+        {
+            *isBigEndian = true;
+            tagSize -= 2;
+        }
+        else if (suffix[0] == 'l' && suffix[1] == 'e')
+        {
+            tagSize -= 2;
+        }
+    }
+
+    for (size_t it = SDSF_BINARY_U8; it <= SDSF_BINARY_F64; it++)
+    {
+        const char* const typeTag = _SDSF_BINARY_ELEMENT_TYPE_TAGS[it];
+        if (strlen(typeTag) == tagSize && memcmp(typeTag, tag, tagSize) == 0)
+        {
+            *type = (SdsfBinaryElementType)it;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//
+// Converts bool, int, float and binary literal tokens to the value. String literals are handled by the caller,
+// because unescaped string must be stored somewhere
+//
+SdsfDeserializationError _sdsf_convert_literal(const _SdsfConsumedToken* token, SdsfValue* value, const char** errorMsg)
+{
+    switch (token->tokenType)
+    {
+        case _SDSF_TOKEN_TYPE_BOOL_LITERAL:
+        {
+            value->asBool = token->stringPtr[0] == 't' ? true : false;
+            value->type = SDSF_VALUE_BOOL;
+        } break;
+        case _SDSF_TOKEN_TYPE_INT_LITERAL:
+        {
+            //
+            // Integers without suffix are stored as int32_t when possible and promoted to 64 bit integers otherwise
+            //
+            const char suffix = token->stringPtr[token->stringSize - 1];
+            const bool hasSuffix = suffix == 'l' || suffix == 'u';
+            bool isNegative;
+            uint64_t magnitude;
+            if (!_sdsf_parse_integer(token->stringPtr, token->stringSize - (hasSuffix ? 1 : 0), &isNegative, &magnitude))
+            {
+                *errorMsg = "Invalid integer literal - value is out of range";
+                return SDSF_DESERIALIZATION_ERROR_INVALID_NUMERIC_LITERAL;
+            }
+
+            const uint64_t int32Limit = isNegative ? ((uint64_t)INT32_MAX + 1) : (uint64_t)INT32_MAX;
+            const uint64_t int64Limit = isNegative ? ((uint64_t)INT64_MAX + 1) : (uint64_t)INT64_MAX;
+            if (suffix == 'u' || (!hasSuffix && !isNegative && magnitude > int64Limit))
+            {
+                if (isNegative)
+                {
+                    *errorMsg = "Invalid integer literal - unsigned value can't be negative";
+                    return SDSF_DESERIALIZATION_ERROR_INVALID_NUMERIC_LITERAL;
+                }
+                value->asUint64 = magnitude;
+                value->type = SDSF_VALUE_UINT64;
+            }
+            else if (suffix == 'l' || magnitude > int32Limit)
+            {
+                if (magnitude > int64Limit)
+                {
+                    *errorMsg = "Invalid integer literal - value is out of range";
+                    return SDSF_DESERIALIZATION_ERROR_INVALID_NUMERIC_LITERAL;
+                }
+                value->asInt64 = isNegative ? (int64_t)((uint64_t)0 - magnitude) : (int64_t)magnitude;
+                value->type = SDSF_VALUE_INT64;
+            }
+            else
+            {
+                value->asInt = isNegative ? (int32_t)(0 - (int64_t)magnitude) : (int32_t)magnitude;
+                value->type = SDSF_VALUE_INT;
+            }
+        } break;
+        case _SDSF_TOKEN_TYPE_FLOAT_LITERAL:
+        {
+            const bool isDouble = token->stringPtr[token->stringSize - 1] == 'd';
+            const size_t literalSize = token->stringSize - (isDouble ? 1 : 0);
+            if (_sdsf_is_hex_float(token->stringPtr, literalSize))
+            {
+                uint64_t bits;
+                if (!_sdsf_parse_hex_float(token->stringPtr, literalSize, isDouble, &bits))
+                {
+                    *errorMsg = "Invalid hexadecimal floating point literal - value is out of range";
+                    return SDSF_DESERIALIZATION_ERROR_INVALID_NUMERIC_LITERAL;
+                }
+                if (isDouble)
+                {
+                    memcpy(&value->asDouble, &bits, sizeof(double));
+                    value->type = SDSF_VALUE_DOUBLE;
+                }
+                else
+                {
+                    const uint32_t floatBits = (uint32_t)bits;
+                    memcpy(&value->asFloat, &floatBits, sizeof(float));
+                    value->type = SDSF_VALUE_FLOAT;
+                }
+                break;
+            }
+
+            double parsed;
+            if (!_sdsf_parse_double(token->stringPtr, literalSize, &parsed))
+            {
+                *errorMsg = "Invalid floating point literal";
+                return SDSF_DESERIALIZATION_ERROR_INVALID_NUMERIC_LITERAL;
+            }
+
+            if (isDouble)
+            {
+                value->asDouble = parsed;
+                value->type = SDSF_VALUE_DOUBLE;
+            }
+            else
+            {
+                value->asFloat = (float)parsed;
+                value->type = SDSF_VALUE_FLOAT;
+            }
+        } break;
+        case _SDSF_TOKEN_TYPE_BINARY_LITERAL:
+        {
+            //
+            // If tokenizer produces _SDSF_TOKEN_TYPE_BINARY_LITERAL token that means:
+            //  - string starts with 'b' character, so we can skip it
+            //  - string can have element type tag, which ends with ':' character
+            //  - string has only one dash '-' symbol
+            //  - string has two numbers divided by the dash
+            //  - string size is at leas 4 characters (minimum binary literal is b0-0)
+            //
+            const char* string = token->stringPtr;
+            const char* const colon = (const char*)memchr(string, ':', token->stringSize);
+            SdsfBinaryElementType elementType = SDSF_BINARY_RAW;
+            bool isBigEndian = false;
+            if (colon)
+            {
+                if (!_sdsf_match_binary_element_type(&string[1], colon - &string[1], &elementType, &isBigEndian))
+                {
+                    *errorMsg = "Invalid binary literal : unknown element type tag";
+                    return SDSF_DESERIALIZATION_ERROR_INVALID_BINARY_LITERAL;
+                }
+            }
+            else if (!_sdsf_is_number(string[1]))
+            {
+                *errorMsg = "Invalid binary literal : element type tag must end with ':' character";
+                return SDSF_DESERIALIZATION_ERROR_INVALID_BINARY_LITERAL;
+            }
+
+            const char* const fromString = colon ? colon + 1 : &string[1];
+            const char* const dash = (const char*)memchr(fromString, '-', token->stringSize - (fromString - string));
+            const char* const toString = dash + 1;
+            const char* const end = string + token->stringSize;
+            bool isFromNegative;
+            bool isToNegative;
+            uint64_t from;
+            uint64_t to;
+            if (!dash ||
+                !_sdsf_parse_integer(fromString, dash - fromString, &isFromNegative, &from) ||
+                !_sdsf_parse_integer(toString, end - toString, &isToNegative, &to) ||
+                isFromNegative || isToNegative || to > SIZE_MAX)
+            {
+                *errorMsg = "Invalid binary literal : \"from\" and \"to\" must be non-negative integers";
+                return SDSF_DESERIALIZATION_ERROR_INVALID_BINARY_LITERAL;
+            }
+
+            if (to < from)
+            {
+                *errorMsg = "Invalid binary literal : \"to\" must be always equal or bigger than \"from\"";
+                return SDSF_DESERIALIZATION_ERROR_INVALID_BINARY_LITERAL;
+            }
+            if ((to - from) % _SDSF_BINARY_ELEMENT_TYPE_SIZES[elementType])
+            {
+                *errorMsg = "Invalid binary literal : size of typed binary value must be a multiple of element size";
+                return SDSF_DESERIALIZATION_ERROR_INVALID_BINARY_LITERAL;
+            }
+
+            value->asBinary.dataOffset = (size_t)from;
+            value->asBinary.dataSize = (size_t)(to - from);
+            value->asBinary.elementType = elementType;
+            value->asBinary.isBigEndian = isBigEndian;
+            value->type = SDSF_VALUE_BINARY;
+        } break;
+        default:
+        {
+            *errorMsg = "Unexpected token - expected bool, int, float or binary literal";
+            return SDSF_DESERIALIZATION_ERROR_TOKENIZER_FAILED;
+        }
+    }
+
+    return SDSF_DESERIALIZATION_ERROR_ALL_FINE;
+}
+
+//
+// Packed array buffer capacity is not stored anywhere - it is always the smallest power of two which fits all elements
+// (but not less than _SDSF_PACKED_ARRAY_MIN_CAPACITY bytes), so it can be computed from the number of elements
+//
+#define _SDSF_PACKED_ARRAY_MIN_CAPACITY 16
+
+static inline size_t _sdsf_packed_element_size(SdsfValueType type)
+{
+    switch (type)
+    {
+        case SDSF_VALUE_INT:    return sizeof(int32_t);
+        case SDSF_VALUE_FLOAT:  return sizeof(float);
+        case SDSF_VALUE_INT64:  return sizeof(int64_t);
+        case SDSF_VALUE_UINT64: return sizeof(uint64_t);
+        case SDSF_VALUE_DOUBLE: return sizeof(double);
+        default:                return 0;
+    }
+}
+
+static inline size_t _sdsf_packed_array_capacity(SdsfValueType elementType, size_t size)
+{
+    const size_t dataSize = elementType == SDSF_VALUE_BOOL ? (size + 7) / 8 : size * _sdsf_packed_element_size(elementType);
+    size_t capacity = _SDSF_PACKED_ARRAY_MIN_CAPACITY;
+    while (capacity < dataSize)
+    {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+//
+// Adds element to the packed array. Empty arrays are converted to packed arrays here
+// Returns false if element can't be stored in the packed array (array must be unpacked in that case)
+//
+bool _sdsf_packed_array_push(SdsfValue* array, const SdsfValue* element, const SdsfAllocator* allocator)
+{
+    if (array->type == SDSF_VALUE_ARRAY)
+    {
+        if (element->type != SDSF_VALUE_BOOL && !_sdsf_packed_element_size(element->type))
+        {
+            return false;
+        }
+        array->type = SDSF_VALUE_PACKED_ARRAY;
+        array->asPackedArray.elementType = element->type;
+        array->asPackedArray.data = NULL;
+        array->asPackedArray.size = 0;
+    }
+    if (element->type != array->asPackedArray.elementType)
+    {
+        return false;
+    }
+
+    const SdsfValueType elementType = array->asPackedArray.elementType;
+    const size_t size = array->asPackedArray.size;
+    const size_t capacity = _sdsf_packed_array_capacity(elementType, size);
+    const size_t newCapacity = _sdsf_packed_array_capacity(elementType, size + 1);
+    if (!array->asPackedArray.data || capacity != newCapacity)
+    {
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_VALUES);
+        void* const newData = allocator->alloc(newCapacity, allocator->userData);
+        memset(newData, 0, newCapacity);
+        if (array->asPackedArray.data)
+        {
+            memcpy(newData, array->asPackedArray.data, capacity);
+            allocator->dealloc(array->asPackedArray.data, capacity, allocator->userData);
+        }
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+        array->asPackedArray.data = newData;
+    }
+
+    uint8_t* const data = (uint8_t*)array->asPackedArray.data;
+    if (elementType == SDSF_VALUE_BOOL)
+    {
+        if (element->asBool)
+        {
+            data[size / 8] |= (uint8_t)(1 << (size % 8));
+        }
+    }
+    else
+    {
+        // All numeric members of the union start at the same address
+        const size_t elementSize = _sdsf_packed_element_size(elementType);
+        memcpy(data + size * elementSize, &element->asInt64, elementSize);
+    }
+    array->asPackedArray.size = size + 1;
+
+    return true;
+}
+
+//
+// Converts packed array back to the regular array with SdsfValue for each member
+//
+void _sdsf_unpack_array(SdsfValue* array, SdsfValueArray* values, const SdsfAllocator* allocator)
+{
+    const SdsfValueType elementType = array->asPackedArray.elementType;
+    void* const data = array->asPackedArray.data;
+    const size_t size = array->asPackedArray.size;
+
+    array->type = SDSF_VALUE_ARRAY;
+    array->asArray.childs = (SdsfValuePtrArray){0};
+    for (size_t it = 0; it < size; it++)
+    {
+        SdsfValue* const child = _sdsf_val_array_add(values, allocator);
+        SdsfValue** const childPtr = _sdsf_val_ptr_array_add(&array->asArray.childs, allocator);
+        *childPtr = child;
+        child->parent = array;
+        child->type = elementType;
+        if (elementType == SDSF_VALUE_BOOL)
+        {
+            child->asBool = (((const uint8_t*)data)[it / 8] >> (it % 8)) & 1;
+        }
+        else
+        {
+            const size_t elementSize = _sdsf_packed_element_size(elementType);
+            memcpy(&child->asInt64, ((const uint8_t*)data) + it * elementSize, elementSize);
+        }
+    }
+
+    if (data)
+    {
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_VALUES);
+        allocator->dealloc(data, _sdsf_packed_array_capacity(elementType, size), allocator->userData);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+    }
+}
+
+//
+// Character classes of 64 bytes, one bit per byte. Bytes past the end of data are in no class
+//
+typedef struct
+{
+    uint64_t    spaces;
+    uint64_t    commas;
+    uint64_t    minuses;
+    uint64_t    numberChars;
+} _SdsfNumberBlock;
+
+//
+// Number characters are digits and '-', plus '.', 'e', 'E' and '+' if withFraction is true, plus 'd' if withSuffix is true.
+// Done 16 bytes at a time with SSE2
+//
+static inline void _sdsf_classify_number_block(_SdsfNumberBlock* block, const char* data, size_t size, bool withFraction, bool withSuffix)
+{
+    char padded[64];
+    if (size < 64)
+    {
+        memset(padded, 0, sizeof(padded));
+        memcpy(padded, data, size);
+        data = padded;
+    }
+
+    block->spaces = 0;
+    block->commas = 0;
+    block->minuses = 0;
+    block->numberChars = 0;
+#ifdef _SDSF_SSE2
+    const __m128i zeros = _mm_set1_epi8('0');
+    const __m128i nines = _mm_set1_epi8(9);
+    const __m128i spaces = _mm_set1_epi8(' ');
+    const __m128i newLines = _mm_set1_epi8('\n');
+    const __m128i carriageReturns = _mm_set1_epi8('\r');
+    const __m128i tabs = _mm_set1_epi8('\t');
+    const __m128i commas = _mm_set1_epi8(',');
+    const __m128i minuses = _mm_set1_epi8('-');
+    const __m128i dots = _mm_set1_epi8('.');
+    const __m128i lowerExponents = _mm_set1_epi8('e');
+    const __m128i upperExponents = _mm_set1_epi8('E');
+    const __m128i pluses = _mm_set1_epi8('+');
+    const __m128i suffixes = _mm_set1_epi8(withSuffix ? 'd' : '.');
+    for (size_t it = 0; it < 64; it += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128((const __m128i*)(data + it));
+        const __m128i digitValues = _mm_sub_epi8(chunk, zeros);
+        const __m128i chunkMinuses = _mm_cmpeq_epi8(chunk, minuses);
+        __m128i numberChars = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(digitValues, nines), digitValues), chunkMinuses);
+        if (withFraction)
+        {
+            const __m128i exponents = _mm_or_si128(_mm_cmpeq_epi8(chunk, lowerExponents), _mm_cmpeq_epi8(chunk, upperExponents));
+            const __m128i others = _mm_or_si128(_mm_cmpeq_epi8(chunk, dots), _mm_or_si128(_mm_cmpeq_epi8(chunk, pluses), _mm_cmpeq_epi8(chunk, suffixes)));
+            numberChars = _mm_or_si128(numberChars, _mm_or_si128(exponents, others));
+        }
+        const __m128i lineBreaks = _mm_or_si128(_mm_cmpeq_epi8(chunk, newLines), _mm_cmpeq_epi8(chunk, carriageReturns));
+        const __m128i skipped = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, spaces), _mm_cmpeq_epi8(chunk, tabs)), lineBreaks);
+        block->numberChars |= (uint64_t)(uint32_t)_mm_movemask_epi8(numberChars) << it;
+        block->spaces |= (uint64_t)(uint32_t)_mm_movemask_epi8(skipped) << it;
+        block->commas |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, commas)) << it;
+        block->minuses |= (uint64_t)(uint32_t)_mm_movemask_epi8(chunkMinuses) << it;
+    }
+#else
+    for (size_t it = 0; it < 64; it++)
+    {
+        const char c = data[it];
+        const bool isNumberChar = _sdsf_is_number(c) || c == '-' ||
+            (withFraction && (c == '.' || c == 'e' || c == 'E' || c == '+')) || (withSuffix && c == 'd');
+        block->numberChars |= (uint64_t)isNumberChar << it;
+        block->spaces |= (uint64_t)_sdsf_is_skipped_char(c) << it;
+        block->commas |= (uint64_t)(c == ',') << it;
+        block->minuses |= (uint64_t)(c == '-') << it;
+    }
+#endif
+}
+
+//
+// Converts up to 8 decimal digits at once. Digits are loaded as a single little endian word and combined with multiplications :
+// 8 single digits -> 4 two digit numbers -> 2 four digit numbers -> 8 digit number. 8 bytes must be readable
+//
+static inline uint32_t _sdsf_parse_eight_digits(const char* digits, size_t digitCount)
+{
+    uint64_t word;
+    memcpy(&word, digits, sizeof(word));
+    word = (word & 0x0F0F0F0F0F0F0F0Full) << (8 * (8 - digitCount));
+    word = (word * 10 + (word >> 8)) & 0x00FF00FF00FF00FFull;
+    word = (word * 100 + (word >> 16)) & 0x0000FFFF0000FFFFull;
+    word = (word * 10000 + (word >> 32)) & 0x00000000FFFFFFFFull;
+    return (uint32_t)word;
+}
+
+//
+// Converts single member found by _sdsf_find_number_members (integer members are already checked to have only digits after the sign).
+// Returns false if member is not a plain decimal literal of elementType
+//
+static inline bool _sdsf_convert_number_member(const char* data, size_t size, size_t literalStart, size_t literalEnd, SdsfValueType elementType, void* element)
+{
+    const bool isNegative = data[literalStart] == '-';
+    const size_t numberStart = literalStart + (isNegative ? 1 : 0);
+    size_t numberEnd = literalEnd;
+    if (elementType == SDSF_VALUE_DOUBLE)
+    {
+        if (data[literalEnd - 1] != 'd')
+        {
+            return false;
+        }
+        numberEnd -= 1;
+    }
+    if (numberEnd == numberStart)
+    {
+        return false;
+    }
+
+    if (elementType == SDSF_VALUE_INT)
+    {
+        const size_t digitCount = numberEnd - numberStart;
+        const char* const digits = data + numberStart;
+        if (digitCount > 10)
+        {
+            return false;
+        }
+        const bool canRunSwar = !_sdsf_is_big_endian_host();
+        uint64_t magnitude = 0;
+        if (canRunSwar && digitCount >= 8)
+        {
+            for (size_t digit = 0; digit < digitCount - 8; digit++)
+            {
+                magnitude = magnitude * 10 + (uint64_t)(digits[digit] - '0');
+            }
+            magnitude = magnitude * 100000000 + _sdsf_parse_eight_digits(digits + digitCount - 8, 8);
+        }
+        else if (canRunSwar && numberStart + 8 <= size)
+        {
+            magnitude = _sdsf_parse_eight_digits(digits, digitCount);
+        }
+        else
+        {
+            for (size_t digit = 0; digit < digitCount; digit++)
+            {
+                magnitude = magnitude * 10 + (uint64_t)(digits[digit] - '0');
+            }
+        }
+        if (magnitude > (isNegative ? (uint64_t)INT32_MAX + 1 : (uint64_t)INT32_MAX))
+        {
+            return false;
+        }
+        const int32_t value = isNegative ? (int32_t)(0 - (int64_t)magnitude) : (int32_t)magnitude;
+        memcpy(element, &value, sizeof(int32_t));
+        return true;
+    }
+
+    //
+    // Without 'd' suffix number is a float literal only if it has '.' or exponent
+    //
+    bool isFloatLiteral = elementType == SDSF_VALUE_DOUBLE;
+    for (size_t digit = numberStart; digit < numberEnd && !isFloatLiteral; digit++)
+    {
+        isFloatLiteral = data[digit] == '.' || data[digit] == 'e' || data[digit] == 'E';
+    }
+    double value;
+    if (!isFloatLiteral || !_sdsf_parse_double(data + literalStart, numberEnd - literalStart, &value))
+    {
+        return false;
+    }
+    if (elementType == SDSF_VALUE_DOUBLE)
+    {
+        memcpy(element, &value, sizeof(double));
+    }
+    else
+    {
+        const float floatValue = (float)value;
+        memcpy(element, &floatValue, sizeof(float));
+    }
+    return true;
+}
+
+//
+// Structural pass of the bulk kernel. Starting at position (right after a member), finds up to maxCount following members which are
+// separated by a single ',' and spaces and consist of number characters only. Every member must be followed by a space or reserved character.
+// Data is classified 64 bytes at a time : member starts and ends are edges of number character bit mask (carried over from the previous
+// block), and gap between the end of one member and the start of the next one must be spaces with exactly one comma.
+// Member boundaries are written to starts and ends, returns number of found members
+//
+size_t _sdsf_find_number_members(const char* data, size_t size, size_t position, SdsfValueType elementType, size_t* starts, size_t* ends, size_t maxCount)
+{
+    const bool withFraction = elementType != SDSF_VALUE_INT;
+    const bool withSuffix = elementType == SDSF_VALUE_DOUBLE;
+    size_t count = 0;
+    size_t memberStart = 0;
+    bool isInMember = false;
+    bool hasGapComma = false;
+    uint64_t previousNumberChar = 0;
+    for (size_t blockStart = position; count < maxCount && blockStart < size; blockStart += 64)
+    {
+        _SdsfNumberBlock block;
+        _sdsf_classify_number_block(&block, data + blockStart, size - blockStart, withFraction, withSuffix);
+        const uint64_t shifted = (block.numberChars << 1) | previousNumberChar;
+        const uint64_t memberStarts = block.numberChars & ~shifted;
+        const uint64_t memberEnds = ~block.numberChars & shifted;
+        const uint64_t separators = block.spaces | block.commas;
+        previousNumberChar = block.numberChars >> 63;
+
+        uint32_t cursor = 0;
+        while (count < maxCount)
+        {
+            if (!isInMember)
+            {
+                // Bytes past the end of data are not separators, so gap which reaches the end of data stops the pass
+                const uint64_t nextStarts = memberStarts & (~0ull << cursor);
+                const uint64_t gap = (~0ull << cursor) & (nextStarts ? (nextStarts & (0 - nextStarts)) - 1 : ~0ull);
+                const uint64_t gapCommas = gap & block.commas;
+                if ((gap & ~separators) || (gapCommas & (gapCommas - 1)) || (gapCommas && hasGapComma))
+                {
+                    return count;
+                }
+                hasGapComma |= gapCommas != 0;
+                if (!nextStarts)
+                {
+                    break;
+                }
+                if (!hasGapComma)
+                {
+                    return count;
+                }
+                cursor = _sdsf_count_trailing_zeros_64(nextStarts);
+                memberStart = blockStart + cursor;
+                isInMember = true;
+                hasGapComma = false;
+            }
+
+            // Integers can have '-' only as the first character
+            const uint32_t firstDigit = memberStart >= blockStart ? (uint32_t)(memberStart - blockStart) + 1 : 0;
+            const uint64_t digitBits = firstDigit < 64 ? ~0ull << firstDigit : 0;
+            const uint64_t nextEnds = memberEnds & (~0ull << cursor);
+            const uint64_t memberBits = digitBits & (nextEnds ? (nextEnds & (0 - nextEnds)) - 1 : ~0ull);
+            if (!withFraction && (block.minuses & memberBits))
+            {
+                return count;
+            }
+            if (!nextEnds)
+            {
+                break;
+            }
+
+            cursor = _sdsf_count_trailing_zeros_64(nextEnds);
+            const size_t memberEnd = blockStart + cursor;
+            if (memberEnd >= size || (!((separators >> cursor) & 1) && !_sdsf_is_reserved_symbol(data[memberEnd])))
+            {
+                return count;
+            }
+            starts[count] = memberStart;
+            ends[count] = memberEnd;
+            count += 1;
+            isInMember = false;
+        }
+    }
+    return count;
+}
+
+//
+// Number of members found by a single structural pass of the bulk kernel
+//
+#define _SDSF_NUMBER_BATCH_SIZE 64
+
+//
+// Bulk kernel for packed numeric arrays. Starting right after an array member, converts following members while they are separated
+// by ',' and are plain decimal literals of elementType (SDSF_VALUE_INT, SDSF_VALUE_FLOAT or SDSF_VALUE_DOUBLE with 'd' suffix).
+// Members are processed in batches : structural pass finds boundaries of a batch of members using character class bit masks
+// (16 bytes at a time with SSE2), then the whole batch is converted.
+// Up to maxCount members are written to elements, count is set to the number of converted members. Returns number of consumed bytes
+// (up to the end of the last converted member). Anything else (other literals, hexadecimal floats, malformed literals, end of array,
+// member which is not followed by any character) stops the kernel and is left for the tokenizer, so results and errors are the same as without it
+//
+size_t _sdsf_convert_numbers(const char* data, size_t size, SdsfValueType elementType, void* elements, size_t maxCount, size_t* count)
+{
+    *count = 0;
+    if (elementType != SDSF_VALUE_INT && elementType != SDSF_VALUE_FLOAT && elementType != SDSF_VALUE_DOUBLE)
+    {
+        return 0;
+    }
+
+    const size_t elementSize = _sdsf_packed_element_size(elementType);
+    size_t starts[_SDSF_NUMBER_BATCH_SIZE];
+    size_t ends[_SDSF_NUMBER_BATCH_SIZE];
+    size_t consumed = 0;
+    while (*count < maxCount)
+    {
+        const size_t batchMax = maxCount - *count < _SDSF_NUMBER_BATCH_SIZE ? maxCount - *count : _SDSF_NUMBER_BATCH_SIZE;
+        const size_t found = _sdsf_find_number_members(data, size, consumed, elementType, starts, ends, batchMax);
+        size_t converted = 0;
+        while (converted < found && _sdsf_convert_number_member(data, size, starts[converted], ends[converted], elementType, (uint8_t*)elements + (*count + converted) * elementSize))
+        {
+            converted += 1;
+        }
+        if (converted)
+        {
+            consumed = ends[converted - 1];
+            *count += converted;
+        }
+        if (converted < batchMax)
+        {
+            break;
+        }
+    }
+
+    return consumed;
+}
+
+//
+// Appends count numeric elements to the packed array (array must be packed already)
+//
+void _sdsf_packed_array_append(SdsfValue* array, const void* elements, size_t count, const SdsfAllocator* allocator)
+{
+    const SdsfValueType elementType = array->asPackedArray.elementType;
+    const size_t elementSize = _sdsf_packed_element_size(elementType);
+    const size_t size = array->asPackedArray.size;
+    const size_t capacity = _sdsf_packed_array_capacity(elementType, size);
+    const size_t newCapacity = _sdsf_packed_array_capacity(elementType, size + count);
+    if (capacity != newCapacity)
+    {
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_VALUES);
+        void* const newData = allocator->alloc(newCapacity, allocator->userData);
+        memset(newData, 0, newCapacity);
+        memcpy(newData, array->asPackedArray.data, capacity);
+        allocator->dealloc(array->asPackedArray.data, capacity, allocator->userData);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+        array->asPackedArray.data = newData;
+    }
+    memcpy((uint8_t*)array->asPackedArray.data + size * elementSize, elements, count * elementSize);
+    array->asPackedArray.size = size + count;
+}
+
+//
+// Runs _sdsf_convert_numbers after a member of the packed array was added. Returns number of consumed bytes
+//
+size_t _sdsf_convert_packed_numbers(SdsfValue* array, const char* data, size_t size, const SdsfAllocator* allocator)
+{
+    uint64_t batch[64];
+    size_t consumed = 0;
+    while (true)
+    {
+        size_t count;
+        consumed += _sdsf_convert_numbers(data + consumed, size - consumed, array->asPackedArray.elementType, batch, sizeof(batch) / sizeof(batch[0]), &count);
+        if (count)
+        {
+            _sdsf_packed_array_append(array, batch, count, allocator);
+        }
+        if (count < sizeof(batch) / sizeof(batch[0]))
+        {
+            break;
+        }
+    }
+    return consumed;
+}
+
+static inline size_t _sdsf_tensor_count(const size_t* shape, size_t rank)
+{
+    size_t count = 1;
+    for (size_t it = 0; it < rank; it++)
+    {
+        count *= shape[it];
+    }
+    return count;
+}
+
+static inline size_t _sdsf_tensor_allocation_size(const SdsfValue* tensor)
+{
+    const size_t count = _sdsf_tensor_count(tensor->asTensor.shape, tensor->asTensor.rank);
+    return tensor->asTensor.rank * sizeof(size_t) + count * _sdsf_packed_element_size(tensor->asTensor.elementType);
+}
+
+void _sdsf_free_packed_storage(SdsfValue* value, const SdsfAllocator* allocator)
+{
+    if (value->type == SDSF_VALUE_PACKED_ARRAY && value->asPackedArray.data)
+    {
+        const size_t capacity = _sdsf_packed_array_capacity(value->asPackedArray.elementType, value->asPackedArray.size);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_VALUES);
+        allocator->dealloc(value->asPackedArray.data, capacity, allocator->userData);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+    }
+    else if (value->type == SDSF_VALUE_TENSOR)
+    {
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_VALUES);
+        allocator->dealloc(value->asTensor.shape, _sdsf_tensor_allocation_size(value), allocator->userData);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+    }
+}
+
+//
+// Converts array of numeric packed arrays (or tensors) of the same element type and shape to a single tensor
+// Rows are left in the values array as undefined values
+//
+void _sdsf_try_fold_tensor(SdsfValue* array, const SdsfAllocator* allocator)
+{
+    SdsfValuePtrArray* const rows = &array->asArray.childs;
+    SdsfTensor row;
+    if (rows->size == 0 || !sdsf_array_as_tensor(rows->ptr[0], &row))
+    {
+        return;
+    }
+
+    const SdsfTensor firstRow = row;
+    for (size_t it = 1; it < rows->size; it++)
+    {
+        if (!sdsf_array_as_tensor(rows->ptr[it], &row) ||
+            row.elementType != firstRow.elementType ||
+            row.rank != firstRow.rank ||
+            memcmp(row.shape, firstRow.shape, firstRow.rank * sizeof(size_t)) != 0)
+        {
+            return;
+        }
+    }
+
+    const size_t rank = firstRow.rank + 1;
+    const size_t rowDataSize = firstRow.count * _sdsf_packed_element_size(firstRow.elementType);
+    const size_t shapeSize = rank * sizeof(size_t);
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_VALUES);
+    uint8_t* const memory = (uint8_t*)allocator->alloc(shapeSize + rows->size * rowDataSize, allocator->userData);
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+    size_t* const shape = (size_t*)memory;
+    uint8_t* const data = memory + shapeSize;
+    shape[0] = rows->size;
+    memcpy(&shape[1], firstRow.shape, firstRow.rank * sizeof(size_t));
+
+    for (size_t it = 0; it < rows->size; it++)
+    {
+        SdsfValue* const rowValue = rows->ptr[it];
+        sdsf_array_as_tensor(rowValue, &row);
+        memcpy(data + it * rowDataSize, row.data, rowDataSize);
+        _sdsf_free_packed_storage(rowValue, allocator);
+        rowValue->type = SDSF_VALUE_UNDEFINED;
+    }
+    _sdsf_val_ptr_array_clear(rows, allocator);
+
+    array->type = SDSF_VALUE_TENSOR;
+    array->asTensor.elementType = firstRow.elementType;
+    array->asTensor.rank = (uint32_t)rank;
+    array->asTensor.shape = shape;
+    array->asTensor.data = data;
+}
+
+SdsfDeserializationError sdsf_deserialize(SdsfDeserializedResult* sdsf, const void* data, size_t dataSize, SdsfAllocator allocator)
+{
+    return sdsf_deserialize_with_flags(sdsf, data, dataSize, allocator, 0);
+}
+
+//
+// Single producer single consumer ring of tokens for sdsf_deserialize_pipelined. Tokenizer thread publishes tokens in batches
+// (single atomic store per batch), builder thread takes them in batches too. Producer and consumer fields are kept on separate cache lines
+//
+#define _SDSF_TOKEN_RING_CAPACITY 4096
+#define _SDSF_TOKEN_RING_BATCH_SIZE 64
+
+typedef struct
+{
+    _SdsfConsumedToken*     tokens;
+    const char*             errorMsg;           // tokenizer error, valid when consumer gets invalid token
+    bool                    hasInvalidUtf8;
+    volatile int32_t        isFinished;         // producer won't publish any more tokens
+    volatile int32_t        isStopped;          // consumer doesn't need any more tokens
+    char                    padding0[64];
+    volatile int32_t        head;               // number of published tokens (wraps around)
+    uint32_t                producerCachedTail;
+    char                    padding1[64];
+    volatile int32_t        tail;               // number of consumed tokens (wraps around)
+    uint32_t                consumerTail;
+    uint32_t                consumerCachedHead;
+} _SdsfTokenRing;
+
+void _sdsf_token_ring_produce(_SdsfTokenRing* ring, _SdsfTokenizerData* tokenizerData)
+{
+    uint32_t head = 0;
+    bool isFinished = false;
+    while (!isFinished)
+    {
+        uint32_t spinIteration = 0;
+        while (_SDSF_TOKEN_RING_CAPACITY - (head - ring->producerCachedTail) < _SDSF_TOKEN_RING_BATCH_SIZE)
+        {
+            if (_sdsf_atomic_load(&ring->isStopped))
+            {
+                return;
+            }
+            _sdsf_spin_wait(&spinIteration);
+            ring->producerCachedTail = (uint32_t)_sdsf_atomic_load(&ring->tail);
+        }
+
+        for (size_t it = 0; it < _SDSF_TOKEN_RING_BATCH_SIZE && !isFinished; it++)
+        {
+            _SdsfConsumedToken* const token = &ring->tokens[head & (_SDSF_TOKEN_RING_CAPACITY - 1)];
+            if (!_sdsf_consume_token(&ring->errorMsg, token, tokenizerData))
+            {
+                isFinished = true;
+                break;
+            }
+            head += 1;
+            // Nothing is tokenized after an error and after the start of binary data blob
+            isFinished =
+                token->tokenType == _SDSF_TOKEN_TYPE_INVALID ||
+                (token->tokenType == _SDSF_TOKEN_TYPE_RESERVED_SYMBOL && token->stringPtr[0] == '@');
+        }
+        ring->hasInvalidUtf8 = tokenizerData->hasInvalidUtf8;
+        _sdsf_atomic_store(&ring->head, (int32_t)head);
+        if (_sdsf_atomic_load(&ring->isStopped))
+        {
+            break;
+        }
+    }
+    _sdsf_atomic_store(&ring->isFinished, 1);
+}
+
+bool _sdsf_token_ring_consume(_SdsfTokenRing* ring, const char** errorMsg, _SdsfConsumedToken* token, _SdsfTokenizerData* tokenizerData)
+{
+    if (ring->consumerTail == ring->consumerCachedHead)
+    {
+        _sdsf_atomic_store(&ring->tail, (int32_t)ring->consumerTail);
+        uint32_t spinIteration = 0;
+        while ((ring->consumerCachedHead = (uint32_t)_sdsf_atomic_load(&ring->head)) == ring->consumerTail)
+        {
+            // Head is published before the finish flag, so it must be checked once again
+            if (_sdsf_atomic_load(&ring->isFinished) && (uint32_t)_sdsf_atomic_load(&ring->head) == ring->consumerTail)
+            {
+                return false;
+            }
+            _sdsf_spin_wait(&spinIteration);
+        }
+    }
+
+    *token = ring->tokens[ring->consumerTail & (_SDSF_TOKEN_RING_CAPACITY - 1)];
+    ring->consumerTail += 1;
+    if ((ring->consumerTail % _SDSF_TOKEN_RING_BATCH_SIZE) == 0)
+    {
+        _sdsf_atomic_store(&ring->tail, (int32_t)ring->consumerTail);
+    }
+    if (token->tokenType == _SDSF_TOKEN_TYPE_INVALID)
+    {
+        *errorMsg = ring->errorMsg;
+        tokenizerData->hasInvalidUtf8 = ring->hasInvalidUtf8;
+    }
+    return true;
+}
+
+//
+// File which is being read by another thread (see sdsf_load_file). Data is published in chunks, only the number of loaded chunks is atomic.
+// Deserializing thread sleeps on the signal while it waits for the next chunk (disk reads are too slow for spinning)
+//
+typedef struct
+{
+    _SdsfFile           file;
+    char*               data;
+    size_t              dataSize;
+    volatile int32_t    loadedChunkCount;
+    volatile int32_t    isFailed;
+    volatile int32_t    isStopped;
+    _SdsfSignal         signal;
+} _SdsfFileLoader;
+
+static inline void _sdsf_file_loader_publish(_SdsfFileLoader* loader, volatile int32_t* value, int32_t newValue)
+{
+    _sdsf_atomic_store(value, newValue);
+    _sdsf_signal_lock(&loader->signal);
+    _sdsf_signal_notify_all(&loader->signal);
+    _sdsf_signal_unlock(&loader->signal);
+}
+
+void _sdsf_file_loader_job(void* context, size_t jobIndex, size_t threadIndex)
+{
+    (void)jobIndex;
+    (void)threadIndex;
+    _SdsfFileLoader* const loader = (_SdsfFileLoader*)context;
+    int32_t chunkCount = 0;
+    for (size_t offset = 0; offset < loader->dataSize; offset += SDSF_LOADER_CHUNK_SIZE)
+    {
+        const size_t chunkSize = (loader->dataSize - offset) < SDSF_LOADER_CHUNK_SIZE ? (loader->dataSize - offset) : SDSF_LOADER_CHUNK_SIZE;
+        if (_sdsf_atomic_load(&loader->isStopped))
+        {
+            return;
+        }
+        if (!_sdsf_file_read(loader->file, loader->data + offset, chunkSize))
+        {
+            _sdsf_file_loader_publish(loader, &loader->isFailed, 1);
+            return;
+        }
+        _sdsf_file_loader_publish(loader, &loader->loadedChunkCount, ++chunkCount);
+    }
+}
+
+static inline size_t _sdsf_file_loader_loaded_size(_SdsfFileLoader* loader)
+{
+    const size_t loadedSize = (size_t)_sdsf_atomic_load(&loader->loadedChunkCount) * SDSF_LOADER_CHUNK_SIZE;
+    return loadedSize < loader->dataSize ? loadedSize : loader->dataSize;
+}
+
+//
+// Tokenizer is resumable - if token touches the end of loaded data (so it might be incomplete), tokenizer state is restored and token is
+// consumed again when more data is loaded. To keep long tokens from being rescanned after every chunk, loaded data must at least double
+// since the token start. Binary data blob token is returned only when the whole file is loaded (blob is copied right away)
+//
+bool _sdsf_file_loader_consume_token(_SdsfFileLoader* loader, const char** errorMsg, _SdsfConsumedToken* token, _SdsfTokenizerData* tokenizerData)
+{
+    size_t requiredSize = 0;
+    while (true)
+    {
+        if (_sdsf_file_loader_loaded_size(loader) < requiredSize)
+        {
+            _sdsf_signal_lock(&loader->signal);
+            while (_sdsf_file_loader_loaded_size(loader) < requiredSize && !_sdsf_atomic_load(&loader->isFailed))
+            {
+                _sdsf_signal_wait(&loader->signal);
+            }
+            _sdsf_signal_unlock(&loader->signal);
+        }
+
+        const size_t loadedSize = _sdsf_file_loader_loaded_size(loader);
+
+        const _SdsfTokenizerData snapshot = *tokenizerData;
+        tokenizerData->dataSize = loadedSize;
+        const bool hasToken = _sdsf_consume_token(errorMsg, token, tokenizerData);
+        if (loadedSize == loader->dataSize || _sdsf_atomic_load(&loader->isFailed))
+        {
+            return hasToken;
+        }
+        const bool isBlobStart = hasToken && token->tokenType == _SDSF_TOKEN_TYPE_RESERVED_SYMBOL && token->stringPtr[0] == '@';
+        if (hasToken && tokenizerData->stringConsumePtr < loadedSize && !isBlobStart)
+        {
+            return true;
+        }
+
+        *tokenizerData = snapshot;
+        const size_t doubledSize = snapshot.stringConsumePtr + 2 * (loadedSize - snapshot.stringConsumePtr);
+        requiredSize = isBlobStart ? loader->dataSize : (doubledSize > loadedSize ? doubledSize : loadedSize + 1);
+        requiredSize = requiredSize < loader->dataSize ? requiredSize : loader->dataSize;
+    }
+}
+
+//
+// Source of tokens for _sdsf_deserialize. Data is tokenized right away if source is NULL
+//
+typedef struct
+{
+    _SdsfTokenRing*     ring;       // tokens are produced by another thread (see sdsf_deserialize_pipelined)
+    _SdsfFileLoader*    loader;     // data is being loaded by another thread (see sdsf_load_file)
+} _SdsfTokenSource;
+
+static inline bool _sdsf_next_token(const char** errorMsg, _SdsfConsumedToken* token, _SdsfTokenizerData* tokenizerData, const _SdsfTokenSource* source)
+{
+    if (source && source->ring)
+    {
+        return _sdsf_token_ring_consume(source->ring, errorMsg, token, tokenizerData);
+    }
+    if (source && source->loader)
+    {
+        return _sdsf_file_loader_consume_token(source->loader, errorMsg, token, tokenizerData);
+    }
+    return _sdsf_consume_token(errorMsg, token, tokenizerData);
+}
+
+//
+// hasBinaryValues is set to true if text has binary literals (used by sdsf_deserialize_parallel to check binary data blob)
+//
+SdsfDeserializationError _sdsf_deserialize(SdsfDeserializedResult* sdsf, const void* data, size_t dataSize, SdsfAllocator allocator, uint32_t flags, bool* hasBinaryValues, const _SdsfTokenSource* source)
+{
+    *hasBinaryValues = false;
+
+    _SdsfTokenizerData tokenizerData;
+    tokenizerData.data                  = (const char*)data;
+    tokenizerData.dataSize              = dataSize;
+    tokenizerData.stringLiteralState    = _SDSF_STRING_LITERAL_NONE;
+    tokenizerData.stringConsumePtr      = 0;
+    tokenizerData.validateUtf8          = (flags & SDSF_DESERIALIZER_FLAG_VALIDATE_UTF8) != 0;
+    tokenizerData.hasInvalidUtf8        = false;
+
+    _SdsfConsumedToken token;
+    _SdsfConsumedToken previousToken = {0};
+
+    *sdsf = (SdsfDeserializedResult){0};
+    sdsf->allocator = allocator;
+
+    SdsfValuePtrArray* topLevelValues = &sdsf->topLevelValues;
+    SdsfValueArray* values = &sdsf->values;
+    SdsfStringArray* strings = &sdsf->strings;
+    SdsfValue* currentValue = NULL;
+
+    const bool packArrays = (flags & SDSF_DESERIALIZER_FLAG_PACK_ARRAYS) != 0;
+    bool expectsBinaryDataBlob = false;
+    bool shouldRun = true;
+
+    while (shouldRun && _sdsf_next_token(&sdsf->errorMsg, &token, &tokenizerData, source))
+    {
+        if (token.tokenType == _SDSF_TOKEN_TYPE_INVALID)
+        {
+            // Error message is set in _sdsf_match_string or in _sdsf_consume_token
+            return tokenizerData.hasInvalidUtf8 ? SDSF_DESERIALIZATION_ERROR_INVALID_UTF8 : SDSF_DESERIALIZATION_ERROR_TOKENIZER_FAILED;
+        }
+
+        if (token.tokenType == _SDSF_TOKEN_TYPE_IDENTIFIER)
+        {
+            if (currentValue)
+            {
+                if (currentValue->type == SDSF_VALUE_UNDEFINED)
+                {
+                    sdsf->errorMsg = "Unexpected identifier - got two identifiers in a row";
+                    return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_IDENTIFIER;
+                }
+                if (currentValue->type != SDSF_VALUE_COMPOSITE)
+                {
+                    sdsf->errorMsg = "Unexpected identifier - only composite values can have named childs";
                     return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_IDENTIFIER;
                 }
-                if (currentValue->type != SDSF_VALUE_COMPOSITE)
+            }
+
+            SdsfValue* const val = _sdsf_val_array_add(values, &allocator);
+            val->parent = currentValue;
+            val->name = _sdsf_string_array_save(strings, &allocator, token.stringPtr, token.stringSize);
+
+            if (currentValue)
+            {
+                SdsfValue** const ptr = _sdsf_val_ptr_array_add(&currentValue->asComposite.childs, &allocator);
+                *ptr = val;
+            }
+            else
+            {
+                SdsfValue** const ptr = _sdsf_val_ptr_array_add(topLevelValues, &allocator);
+                *ptr = val;
+            }
+            
+            currentValue = val;
+        }
+        else if (token.tokenType == _SDSF_TOKEN_TYPE_RESERVED_SYMBOL)
+        {
+            switch (token.stringPtr[0])
+            {
+                case ',':
+                {
+                    if (!currentValue || (currentValue->type != SDSF_VALUE_ARRAY && currentValue->type != SDSF_VALUE_PACKED_ARRAY))
+                    {
+                        sdsf->errorMsg = "Unexpected ',' character - commas can be used in arrays only";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
+                    }
+                    if (currentValue->type == SDSF_VALUE_ARRAY && currentValue->asArray.childs.size == 0)
+                    {
+                        sdsf->errorMsg = "Unexpected ',' character - commas must be used only after first array child";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
+                    }
+                    if (previousToken.tokenType == _SDSF_TOKEN_TYPE_RESERVED_SYMBOL && previousToken.stringPtr[0] == ',')
+                    {
+                        sdsf->errorMsg = "Unexpected ',' character - can't have multiple commas in a row";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
+                    }
+                    // @NOTE : comma doesn't allocate new values, new value is allocated when processing literals or creating composites/arrays
+                } break;
+
+                case ']':
+                {
+                    if (!currentValue || (currentValue->type != SDSF_VALUE_ARRAY && currentValue->type != SDSF_VALUE_PACKED_ARRAY))
+                    {
+                        sdsf->errorMsg = "Unexpected ']' character - only arrays can end with this symbol";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
+                    }
+                    if (packArrays && currentValue->type == SDSF_VALUE_ARRAY)
+                    {
+                        _sdsf_try_fold_tensor(currentValue, &allocator);
+                    }
+                    currentValue = currentValue->parent;
+                } break;
+
+                case '}':
+                {
+                    if (!currentValue || currentValue->type != SDSF_VALUE_COMPOSITE)
+                    {
+                        sdsf->errorMsg = "Unexpected '}' character - only composites can end with this symbol";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
+                    }
+                    currentValue = currentValue->parent;
+                } break;
+
+                case '[':
+                {
+                    if (!currentValue)
+                    {
+                        sdsf->errorMsg = "Unexpected '[' character - new array value can be created only after identifier or as child of another array";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
+                    }
+                    if (currentValue->type == SDSF_VALUE_PACKED_ARRAY)
+                    {
+                        _sdsf_unpack_array(currentValue, values, &allocator);
+                    }
+                    if (currentValue->type == SDSF_VALUE_UNDEFINED)
+                    {
+                        // Array with an identifier
+                        currentValue->type = SDSF_VALUE_ARRAY;
+                    }
+                    else if (currentValue->type == SDSF_VALUE_ARRAY)
+                    {
+                        // Array in array
+                        SdsfValue* const newChild = _sdsf_val_array_add(values, &allocator);
+                        SdsfValue** const newChildPtr = _sdsf_val_ptr_array_add(&currentValue->asArray.childs, &allocator);
+                        *newChildPtr = newChild;
+                        newChild->parent = currentValue;
+                        currentValue = newChild;
+                        currentValue->type = SDSF_VALUE_ARRAY;
+                    }
+                    else
+                    {
+                        sdsf->errorMsg = "New array value can be created only after identifier or in the another array";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
+                    }
+                } break;
+
+                case '{':
+                {
+                    if (!currentValue)
+                    {
+                        sdsf->errorMsg = "Unexpected '[' character - new composite value can be created only after identifier or as child of the array";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
+                    }
+                    if (currentValue->type == SDSF_VALUE_PACKED_ARRAY)
+                    {
+                        _sdsf_unpack_array(currentValue, values, &allocator);
+                    }
+                    if (currentValue->type == SDSF_VALUE_UNDEFINED)
+                    {
+                        // Composite with an identifier
+                        currentValue->type = SDSF_VALUE_COMPOSITE;
+                    }
+                    else if (currentValue->type == SDSF_VALUE_ARRAY)
+                    {
+                        // Composite in an array
+                        SdsfValue* const newChild = _sdsf_val_array_add(values, &allocator);
+                        SdsfValue** const newChildPtr = _sdsf_val_ptr_array_add(&currentValue->asArray.childs, &allocator);
+                        *newChildPtr = newChild;
+                        newChild->parent = currentValue;
+                        currentValue = newChild;
+                        currentValue->type = SDSF_VALUE_COMPOSITE;
+                    }
+                    else
+                    {
+                        sdsf->errorMsg = "Unexpected '[' character - new composite value can be created only after identifier or as child of the array";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
+                    }
+                } break;
+
+                case '\"':
+                {
+                    // Nothing
+                } break;
+
+                case '@':
+                {
+                    if (!expectsBinaryDataBlob)
+                    {
+                        sdsf->errorMsg = "Unexpected binary data blob - no binary literals were used";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_BINARY_DATA_BLOB;
+                    }
+
+                    const size_t blobStart = (size_t)(token.stringPtr - tokenizerData.data) + 1;
+                    const size_t binaryDataSize = tokenizerData.dataSize - blobStart;
+                    if (binaryDataSize)
+                    {
+                        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_BINARY_DATA);
+                        void* const memory = allocator.alloc(binaryDataSize, allocator.userData);
+                        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+                        sdsf->binaryData = memory;
+                        sdsf->binaryDataSize = binaryDataSize;
+                        const void* const from = tokenizerData.data + blobStart;
+                        memcpy(memory, from, binaryDataSize);
+                    }
+
+                    // Binary data blob is always in the end of file
+                    shouldRun = false;
+                } break;
+            }
+        }
+        else
+        {
+            if (!currentValue)
+            {
+                sdsf->errorMsg = "Values must be associated with identifier or array";
+                return SDSF_DESERIALIZATION_ERROR_EXPECTED_IDENTIFIER;
+            }
+
+            if (currentValue->type == SDSF_VALUE_PACKED_ARRAY || (packArrays && currentValue->type == SDSF_VALUE_ARRAY && currentValue->asArray.childs.size == 0))
+            {
+                //
+                // Array stays packed while all members are literals of the same packable type
+                //
+                if (token.tokenType != _SDSF_TOKEN_TYPE_STRING_LITERAL)
+                {
+                    SdsfValue element = {0};
+                    const SdsfDeserializationError literalError = _sdsf_convert_literal(&token, &element, &sdsf->errorMsg);
+                    if (literalError)
+                    {
+                        return literalError;
+                    }
+                    if (_sdsf_packed_array_push(currentValue, &element, &allocator))
+                    {
+                        // Following plain numbers are converted in bulk, without the tokenizer
+                        if (!(source && source->ring) && currentValue->asPackedArray.elementType != SDSF_VALUE_BOOL)
+                        {
+                            tokenizerData.stringConsumePtr += _sdsf_convert_packed_numbers(currentValue, tokenizerData.data + tokenizerData.stringConsumePtr,
+                                tokenizerData.dataSize - tokenizerData.stringConsumePtr, &allocator);
+                        }
+                        previousToken = token;
+                        continue;
+                    }
+                }
+                if (currentValue->type == SDSF_VALUE_PACKED_ARRAY)
+                {
+                    _sdsf_unpack_array(currentValue, values, &allocator);
+                }
+            }
+
+            SdsfValue* valueToUpdate = NULL;
+            if (currentValue->type == SDSF_VALUE_ARRAY)
+            {
+                valueToUpdate = _sdsf_val_array_add(values, &allocator);
+                valueToUpdate->parent = currentValue;
+                SdsfValue** const ptr = _sdsf_val_ptr_array_add(&currentValue->asArray.childs, &allocator);
+                *ptr = valueToUpdate;
+            }
+            else
+            {
+                if (!currentValue->name)
+                {
+                    sdsf->errorMsg = "Unexpected unnamed value. Only arrays can have values without names";
+                    return SDSF_DESERIALIZATION_ERROR_EXPECTED_IDENTIFIER;
+                }
+                valueToUpdate = currentValue;
+                currentValue = currentValue->parent;
+            }
+
+            if (token.tokenType != _SDSF_TOKEN_TYPE_STRING_LITERAL)
+            {
+                const SdsfDeserializationError literalError = _sdsf_convert_literal(&token, valueToUpdate, &sdsf->errorMsg);
+                if (literalError)
+                {
+                    return literalError;
+                }
+                if (valueToUpdate->type == SDSF_VALUE_BINARY)
+                {
+                    expectsBinaryDataBlob = true;
+                }
+            }
+            else
+            {
+                if (token.stringSize <= _SDSF_INLINE_STRING_CAPACITY)
+                {
+                    size_t stringSize = token.stringSize;
+                    if (!token.hasEscapes)
+                    {
+                        memcpy(valueToUpdate->asStringInline, token.stringPtr, stringSize);
+                    }
+                    else if (!_sdsf_unescape_string(token.stringPtr, token.stringSize, valueToUpdate->asStringInline, &stringSize))
+                    {
+                        sdsf->errorMsg = "Invalid string literal - unknown or incomplete escape sequence";
+                        return SDSF_DESERIALIZATION_ERROR_INVALID_STRING_LITERAL;
+                    }
+                    _sdsf_finish_inline_string(valueToUpdate, stringSize);
+                }
+                else if (!token.hasEscapes)
+                {
+                    valueToUpdate->asString = _sdsf_string_array_save(strings, &allocator, token.stringPtr, token.stringSize);
+                }
+                else
+                {
+                    // Unescaped string is never longer than the literal, unused bytes are returned back to the string array
+                    char* const string = _sdsf_string_array_save(strings, &allocator, NULL, token.stringSize);
+                    size_t unescapedSize;
+                    if (!_sdsf_unescape_string(token.stringPtr, token.stringSize, string, &unescapedSize))
+                    {
+                        sdsf->errorMsg = "Invalid string literal - unknown or incomplete escape sequence";
+                        return SDSF_DESERIALIZATION_ERROR_INVALID_STRING_LITERAL;
+                    }
+                    strings->size -= token.stringSize - unescapedSize;
+                    valueToUpdate->asString = string;
+                }
+                valueToUpdate->type = SDSF_VALUE_STRING;
+            }
+        }
+
+        previousToken = token;
+    }
+
+    *hasBinaryValues = expectsBinaryDataBlob;
+    return SDSF_DESERIALIZATION_ERROR_ALL_FINE;
+}
+
+SdsfDeserializationError sdsf_deserialize_with_flags(SdsfDeserializedResult* sdsf, const void* data, size_t dataSize, SdsfAllocator allocator, uint32_t flags)
+{
+    bool hasBinaryValues;
+    return _sdsf_deserialize(sdsf, data, dataSize, allocator, flags, &hasBinaryValues, NULL);
+}
+
+typedef struct
+{
+    _SdsfTokenRing*     ring;
+    _SdsfTokenizerData* tokenizerData;
+} _SdsfTokenizerJobContext;
+
+void _sdsf_tokenizer_job(void* context, size_t jobIndex, size_t threadIndex)
+{
+    (void)jobIndex;
+    (void)threadIndex;
+    const _SdsfTokenizerJobContext* const tokenizer = (const _SdsfTokenizerJobContext*)context;
+    _sdsf_token_ring_produce(tokenizer->ring, tokenizer->tokenizerData);
+}
+
+SdsfDeserializationError sdsf_deserialize_pipelined(SdsfDeserializedResult* sdsf, const void* data, size_t dataSize, SdsfAllocator allocator, uint32_t flags)
+{
+    if (dataSize < SDSF_PARALLEL_MIN_RANGE_SIZE)
+    {
+        return sdsf_deserialize_with_flags(sdsf, data, dataSize, allocator, flags);
+    }
+
+    _SdsfTokenizerData tokenizerData;
+    tokenizerData.data                  = (const char*)data;
+    tokenizerData.dataSize              = dataSize;
+    tokenizerData.stringLiteralState    = _SDSF_STRING_LITERAL_NONE;
+    tokenizerData.stringConsumePtr      = 0;
+    tokenizerData.validateUtf8          = (flags & SDSF_DESERIALIZER_FLAG_VALIDATE_UTF8) != 0;
+    tokenizerData.hasInvalidUtf8        = false;
+
+    _SdsfTokenRing ring = {0};
+    ring.tokens = (_SdsfConsumedToken*)allocator.alloc(_SDSF_TOKEN_RING_CAPACITY * sizeof(_SdsfConsumedToken), allocator.userData);
+
+    //
+    // Tokenizer gets a dedicated thread - both sides wait for each other, so they can't be run one after another.
+    // If thread can't be started, data is deserialized on the calling thread
+    //
+    _SdsfTokenizerJobContext context = { &ring, &tokenizerData };
+    _SdsfJobQueue queue = { _sdsf_tokenizer_job, &context, 1, 0 };
+    _SdsfWorker worker;
+    worker.queue = &queue;
+    worker.threadIndex = 1;
+    if (!_sdsf_thread_start(&worker))
+    {
+        allocator.dealloc(ring.tokens, _SDSF_TOKEN_RING_CAPACITY * sizeof(_SdsfConsumedToken), allocator.userData);
+        return sdsf_deserialize_with_flags(sdsf, data, dataSize, allocator, flags);
+    }
+
+    bool hasBinaryValues;
+    const _SdsfTokenSource source = { &ring, NULL };
+    const SdsfDeserializationError error = _sdsf_deserialize(sdsf, data, dataSize, allocator, flags, &hasBinaryValues, &source);
+    _sdsf_atomic_store(&ring.isStopped, 1);
+    _sdsf_thread_join(&worker);
+
+    allocator.dealloc(ring.tokens, _SDSF_TOKEN_RING_CAPACITY * sizeof(_SdsfConsumedToken), allocator.userData);
+    return error;
+}
+
+SdsfDeserializationError sdsf_load_file(SdsfDeserializedResult* sdsf, const char* path, SdsfAllocator allocator, uint32_t flags)
+{
+    _SdsfFileLoader loader = {0};
+    if (!_sdsf_file_open(path, &loader.file, &loader.dataSize))
+    {
+        *sdsf = (SdsfDeserializedResult){0};
+        sdsf->allocator = allocator;
+        sdsf->errorMsg = "Failed to open file";
+        return SDSF_DESERIALIZATION_ERROR_READ_FAILED;
+    }
+    loader.data = loader.dataSize ? (char*)allocator.alloc(loader.dataSize, allocator.userData) : NULL;
+    _sdsf_signal_init(&loader.signal);
+
+    //
+    // If reading thread can't be started, file is read on the calling thread before deserialization
+    //
+    _SdsfJobQueue queue = { _sdsf_file_loader_job, &loader, 1, 0 };
+    _SdsfWorker worker;
+    worker.queue = &queue;
+    worker.threadIndex = 1;
+    const bool isThreadStarted = loader.dataSize && _sdsf_thread_start(&worker);
+    if (!isThreadStarted)
+    {
+        _sdsf_run_jobs(&queue, 0);
+    }
+
+    bool hasBinaryValues;
+    const _SdsfTokenSource source = { NULL, &loader };
+    SdsfDeserializationError error = _sdsf_deserialize(sdsf, loader.data, loader.dataSize, allocator, flags, &hasBinaryValues, &source);
+    _sdsf_atomic_store(&loader.isStopped, 1);
+    if (isThreadStarted)
+    {
+        _sdsf_thread_join(&worker);
+    }
+    if (_sdsf_atomic_load(&loader.isFailed))
+    {
+        sdsf->errorMsg = "Failed to read file";
+        error = SDSF_DESERIALIZATION_ERROR_READ_FAILED;
+    }
+
+    _sdsf_signal_destroy(&loader.signal);
+    _sdsf_file_close(loader.file);
+    if (loader.data)
+    {
+        allocator.dealloc(loader.data, loader.dataSize, allocator.userData);
+    }
+    return error;
+}
+
+typedef struct
+{
+    SdsfDeserializedResult*     results;
+    SdsfDeserializationError*   errors;
+    const char* const*          paths;
+    const SdsfAllocator*        allocators;
+    uint32_t                    flags;
+} _SdsfLoadFilesContext;
+
+void _sdsf_load_files_job(void* context, size_t jobIndex, size_t threadIndex)
+{
+    const _SdsfLoadFilesContext* const files = (const _SdsfLoadFilesContext*)context;
+    files->errors[jobIndex] = sdsf_load_file(&files->results[jobIndex], files->paths[jobIndex], files->allocators[threadIndex], files->flags);
+}
+
+SdsfDeserializationError sdsf_load_files(SdsfDeserializedResult* results, SdsfDeserializationError* errors, const char* const* paths, size_t count, const SdsfAllocator* allocators, size_t threadCount, uint32_t flags)
+{
+    const _SdsfLoadFilesContext context = { results, errors, paths, allocators, flags };
+    _sdsf_parallel_for(count, threadCount ? threadCount : 1, _sdsf_load_files_job, (void*)&context, &allocators[0]);
+
+    for (size_t it = 0; it < count; it++)
+    {
+        if (errors[it])
+        {
+            return errors[it];
+        }
+    }
+    return SDSF_DESERIALIZATION_ERROR_ALL_FINE;
+}
+
+typedef struct
+{
+    SdsfDeserializedResult*     results;
+    SdsfDeserializationError*   errors;
+    const SdsfInput*            inputs;
+    const SdsfAllocator*        allocators;
+    uint32_t                    flags;
+} _SdsfDeserializeManyContext;
+
+void _sdsf_deserialize_many_job(void* context, size_t jobIndex, size_t threadIndex)
+{
+    const _SdsfDeserializeManyContext* const many = (const _SdsfDeserializeManyContext*)context;
+    const SdsfInput* const input = &many->inputs[jobIndex];
+    many->errors[jobIndex] = sdsf_deserialize_with_flags(&many->results[jobIndex], input->data, input->dataSize, many->allocators[threadIndex], many->flags);
+}
+
+SdsfDeserializationError sdsf_deserialize_many(SdsfDeserializedResult* results, SdsfDeserializationError* errors, const SdsfInput* inputs, size_t count, const SdsfAllocator* allocators, size_t threadCount, uint32_t flags)
+{
+    const _SdsfDeserializeManyContext context = { results, errors, inputs, allocators, flags };
+    _sdsf_parallel_for(count, threadCount ? threadCount : 1, _sdsf_deserialize_many_job, (void*)&context, &allocators[0]);
+
+    for (size_t it = 0; it < count; it++)
+    {
+        if (errors[it])
+        {
+            return errors[it];
+        }
+    }
+    return SDSF_DESERIALIZATION_ERROR_ALL_FINE;
+}
+
+//
+// Range of text parsed by a single thread. If arrayEnd is not 0, range ends right after the opening bracket of a large flat array
+// (arrayEnd is the offset of its closing bracket) and array members are parsed separately by all threads (see _sdsf_parse_large_array)
+//
+typedef struct
+{
+    size_t start;
+    size_t end;
+    size_t arrayEnd;
+} _SdsfTextRange;
+
+//
+// Pre-scan for sdsf_deserialize_parallel. Text is split only before top level identifiers, so every range can be parsed on its own.
+// Top level tokens are skipped one by one (identifiers are the tokens with even index), nested values are skipped with _sdsf_find_structural_char.
+// Top level arrays without nested arrays, composites and strings which are at least minArraySize bytes long get ranges of their own
+// (minArraySize of 0 disables that). Scan stops at the binary data blob, textSize is set to the offset of '@' character (or to dataSize
+// if there is no blob). Returns number of ranges
+//
+size_t _sdsf_split_top_level_values(const char* data, size_t dataSize, size_t minRangeSize, size_t minArraySize, _SdsfTextRange* ranges, size_t maxRanges, size_t* textSize)
+{
+    size_t rangeCount = 1;
+    size_t nextSplit = minRangeSize;
+    size_t topLevelTokenCount = 0;
+    size_t identifierStart = 0;
+    size_t depth = 0;
+    size_t it = 0;
+    ranges[0] = (_SdsfTextRange){0};
+
+    while (it < dataSize)
+    {
+        const char c = data[it];
+        if (depth == 0)
+        {
+            if (_sdsf_is_skipped_char(c) || c == ',' || c == ']' || c == '}')
+            {
+                // Misplaced symbols are reported by the parser of the range
+                it += 1;
+                continue;
+            }
+            if (c == '@')
+            {
+                break;
+            }
+            if ((topLevelTokenCount % 2) == 0)
+            {
+                identifierStart = it;
+                if (it >= nextSplit && rangeCount < maxRanges)
+                {
+                    ranges[rangeCount - 1].end = it;
+                    ranges[rangeCount++] = (_SdsfTextRange){ it, 0, 0 };
+                    nextSplit = it + minRangeSize;
+                }
+            }
+            topLevelTokenCount += 1;
+            if (c == '{')
+            {
+                depth = 1;
+                it += 1;
+                continue;
+            }
+            if (c == '[')
+            {
+                const size_t arrayStart = it;
+                it += 1 + _sdsf_find_structural_char(data + it + 1, dataSize - it - 1);
+                const bool isLargeFlatArray = minArraySize && (topLevelTokenCount % 2) == 0 &&
+                    it < dataSize && data[it] == ']' && (it - arrayStart) >= minArraySize && (rangeCount + 2) <= maxRanges;
+                if (isLargeFlatArray)
+                {
+                    if (ranges[rangeCount - 1].start != identifierStart)
+                    {
+                        ranges[rangeCount - 1].end = identifierStart;
+                        ranges[rangeCount++] = (_SdsfTextRange){ identifierStart, 0, 0 };
+                    }
+                    ranges[rangeCount - 1].end = arrayStart + 1;
+                    ranges[rangeCount - 1].arrayEnd = it;
+                    ranges[rangeCount++] = (_SdsfTextRange){ it + 1, 0, 0 };
+                    nextSplit = it + 1 + minRangeSize;
+                    it += 1;
+                }
+                else
+                {
+                    // Everything between the bracket and the first structural character was skipped already
+                    depth = 1;
+                }
+                continue;
+            }
+            if (c != '\"')
+            {
+                while (it < dataSize && !_sdsf_is_skipped_char(data[it]) && !_sdsf_is_reserved_symbol(data[it]))
+                {
+                    it += 1;
+                }
+                continue;
+            }
+        }
+        else
+        {
+            it += _sdsf_find_structural_char(data + it, dataSize - it);
+            if (it == dataSize || data[it] == '@')
+            {
+                break;
+            }
+            if (data[it] == '[' || data[it] == '{')
+            {
+                depth += 1;
+                it += 1;
+                continue;
+            }
+            if (data[it] == ']' || data[it] == '}')
+            {
+                depth -= 1;
+                it += 1;
+                continue;
+            }
+        }
+
+        // String literal
+        it += 1;
+        while (it < dataSize)
+        {
+            it += _sdsf_find_quote_or_backslash(data + it, dataSize - it);
+            if (it < dataSize && data[it] == '\\')
+            {
+                it += 2;
+                continue;
+            }
+            it += 1;
+            break;
+        }
+    }
+
+    *textSize = it < dataSize ? it : dataSize;
+    ranges[rangeCount - 1].end = *textSize;
+    return rangeCount;
+}
+
+//
+// Consumes single member of a numeric array. Returns false if member is not a numeric literal
+//
+bool _sdsf_consume_array_number(const char* data, size_t dataSize, size_t* consumePtr, SdsfValue* element)
+{
+    _SdsfComsumedString string;
+    if (!_sdsf_consume_string(data, dataSize, consumePtr, &string, false))
+    {
+        return false;
+    }
+
+    const char* errorMsg;
+    _SdsfConsumedToken token;
+    token.stringPtr = string.ptr;
+    token.stringSize = string.size;
+    token.hasEscapes = false;
+    token.tokenType = _sdsf_match_string(&errorMsg, &string);
+    if (token.tokenType != _SDSF_TOKEN_TYPE_INT_LITERAL && token.tokenType != _SDSF_TOKEN_TYPE_FLOAT_LITERAL)
+    {
+        return false;
+    }
+    return _sdsf_convert_literal(&token, element, &errorMsg) == SDSF_DESERIALIZATION_ERROR_ALL_FINE;
+}
+
+//
+// Members of a large array are split into chunks at ',' characters. Chunks are processed twice - first pass counts members of each chunk
+// (number of ',' characters), second pass converts members straight to their place in the packed array buffer
+//
+typedef struct
+{
+    const char*         data;
+    size_t              arrayEnd;
+    size_t*             chunkStarts;    // chunk i ends at the start of chunk i + 1, last chunk ends at arrayEnd
+    size_t*             chunkElements;  // first pass : number of members in chunk, second pass : index of the first member of chunk
+    bool*               isChunkFailed;
+    size_t              chunkCount;
+    SdsfValueType       elementType;
+    uint8_t*            elements;
+} _SdsfLargeArrayContext;
+
+void _sdsf_count_large_array_chunk_job(void* context, size_t jobIndex, size_t threadIndex)
+{
+    (void)threadIndex;
+    const _SdsfLargeArrayContext* const array = (const _SdsfLargeArrayContext*)context;
+    const bool isLastChunk = (jobIndex + 1) == array->chunkCount;
+    const char* it = array->data + array->chunkStarts[jobIndex];
+    const char* const end = array->data + (isLastChunk ? array->arrayEnd : array->chunkStarts[jobIndex + 1]);
+
+    size_t count = isLastChunk ? 1 : 0;
+    while ((it = (const char*)memchr(it, ',', end - it)) != NULL)
+    {
+        count += 1;
+        it += 1;
+    }
+    array->chunkElements[jobIndex] = count;
+}
+
+void _sdsf_parse_large_array_chunk_job(void* context, size_t jobIndex, size_t threadIndex)
+{
+    (void)threadIndex;
+    const _SdsfLargeArrayContext* const array = (const _SdsfLargeArrayContext*)context;
+    const bool isLastChunk = (jobIndex + 1) == array->chunkCount;
+    const size_t end = isLastChunk ? array->arrayEnd : array->chunkStarts[jobIndex + 1];
+    const size_t elementSize = _sdsf_packed_element_size(array->elementType);
+    const size_t lastElement = array->chunkElements[jobIndex + 1];
+    size_t element = array->chunkElements[jobIndex];
+    size_t consumePtr = array->chunkStarts[jobIndex];
+
+    //
+    // Chunks which are not last end with ',' character, so every member is followed by ','
+    //
+    bool isFailed = false;
+    while (!isFailed && element < lastElement)
+    {
+        SdsfValue value;
+        isFailed = !_sdsf_consume_array_number(array->data, end, &consumePtr, &value) || value.type != array->elementType;
+        if (!isFailed)
+        {
+            memcpy(array->elements + element * elementSize, &value.asInt64, elementSize);
+            element += 1;
+
+            size_t convertedCount;
+            consumePtr += _sdsf_convert_numbers(array->data + consumePtr, end - consumePtr, array->elementType,
+                array->elements + element * elementSize, lastElement - element, &convertedCount);
+            element += convertedCount;
+        }
+
+        _SdsfComsumedString separator;
+        const bool hasSeparator = _sdsf_consume_string(array->data, end, &consumePtr, &separator, false);
+        if (hasSeparator && (separator.size != 1 || separator.ptr[0] != ','))
+        {
+            isFailed = true;
+        }
+        else if (hasSeparator == (isLastChunk && element == lastElement))
+        {
+            isFailed = true;
+        }
+    }
+    array->isChunkFailed[jobIndex] = isFailed;
+}
+
+//
+// Parses members of a large flat array (text between arrayStart and arrayEnd) on threadCount threads straight into the packed array
+// buffer. Returns false if array can't be stored as packed numeric array or if it has any errors - such arrays must be parsed
+// as usual (that also gives the same error as sdsf_deserialize_with_flags)
+//
+bool _sdsf_parse_large_array(SdsfValue* value, const char* data, size_t arrayStart, size_t arrayEnd, size_t threadCount, const SdsfAllocator* allocator)
+{
+    SdsfValue firstElement;
+    size_t consumePtr = arrayStart;
+    if (!_sdsf_consume_array_number(data, arrayEnd, &consumePtr, &firstElement) || !_sdsf_packed_element_size(firstElement.type))
+    {
+        return false;
+    }
+
+    const size_t maxChunks = threadCount * 4;
+    const size_t chunkSize = ((arrayEnd - arrayStart) / maxChunks) > SDSF_PARALLEL_MIN_RANGE_SIZE ? ((arrayEnd - arrayStart) / maxChunks) : SDSF_PARALLEL_MIN_RANGE_SIZE;
+    const size_t memorySize = maxChunks * sizeof(size_t) + (maxChunks + 1) * sizeof(size_t) + maxChunks * sizeof(bool);
+    void* const memory = allocator->alloc(memorySize, allocator->userData);
+
+    _SdsfLargeArrayContext context;
+    context.data            = data;
+    context.arrayEnd        = arrayEnd;
+    context.chunkStarts     = (size_t*)memory;
+    context.chunkElements   = context.chunkStarts + maxChunks;
+    context.isChunkFailed   = (bool*)(context.chunkElements + maxChunks + 1);
+    context.chunkCount      = 1;
+    context.elementType     = firstElement.type;
+    context.chunkStarts[0]  = arrayStart;
+    while (context.chunkCount < maxChunks)
+    {
+        const size_t target = context.chunkStarts[context.chunkCount - 1] + chunkSize;
+        const char* const separator = target < arrayEnd ? (const char*)memchr(data + target, ',', arrayEnd - target) : NULL;
+        if (!separator)
+        {
+            break;
+        }
+        context.chunkStarts[context.chunkCount++] = (size_t)(separator - data) + 1;
+    }
+
+    _sdsf_parallel_for(context.chunkCount, threadCount, _sdsf_count_large_array_chunk_job, &context, allocator);
+
+    size_t elementCount = 0;
+    for (size_t it = 0; it < context.chunkCount; it++)
+    {
+        const size_t chunkElementCount = context.chunkElements[it];
+        context.chunkElements[it] = elementCount;
+        elementCount += chunkElementCount;
+    }
+    context.chunkElements[context.chunkCount] = elementCount;
+
+    const size_t capacity = _sdsf_packed_array_capacity(context.elementType, elementCount);
+    context.elements = (uint8_t*)allocator->alloc(capacity, allocator->userData);
+    memset(context.elements, 0, capacity);
+
+    _sdsf_parallel_for(context.chunkCount, threadCount, _sdsf_parse_large_array_chunk_job, &context, allocator);
+
+    bool isFailed = false;
+    for (size_t it = 0; it < context.chunkCount; it++)
+    {
+        isFailed = isFailed || context.isChunkFailed[it];
+    }
+    allocator->dealloc(memory, memorySize, allocator->userData);
+
+    if (isFailed)
+    {
+        allocator->dealloc(context.elements, capacity, allocator->userData);
+        return false;
+    }
+
+    value->type = SDSF_VALUE_PACKED_ARRAY;
+    value->asPackedArray.elementType = context.elementType;
+    value->asPackedArray.data = context.elements;
+    value->asPackedArray.size = elementCount;
+    return true;
+}
+
+typedef struct
+{
+    SdsfDeserializedResult*     parts;
+    SdsfDeserializationError*   errors;
+    bool*                       hasBinaryValues;
+    const char*                 data;
+    const _SdsfTextRange*       ranges;
+    SdsfAllocator               allocator;
+    uint32_t                    flags;
+} _SdsfDeserializeParallelContext;
+
+void _sdsf_deserialize_parallel_job(void* context, size_t jobIndex, size_t threadIndex)
+{
+    (void)threadIndex;
+    const _SdsfDeserializeParallelContext* const parallel = (const _SdsfDeserializeParallelContext*)context;
+    const _SdsfTextRange* const range = &parallel->ranges[jobIndex];
+    parallel->errors[jobIndex] = _sdsf_deserialize(&parallel->parts[jobIndex], parallel->data + range->start, range->end - range->start,
+        parallel->allocator, parallel->flags, &parallel->hasBinaryValues[jobIndex], NULL);
+}
+
+SdsfDeserializationError sdsf_deserialize_parallel(SdsfDeserializedResult* sdsf, const void* data, size_t dataSize, SdsfAllocator allocator, size_t threadCount, uint32_t flags)
+{
+    if (threadCount < 2 || dataSize < 2 * SDSF_PARALLEL_MIN_RANGE_SIZE)
+    {
+        return sdsf_deserialize_with_flags(sdsf, data, dataSize, allocator, flags);
+    }
+
+    //
+    // Few ranges per thread, so threads which got simple ranges can take more of them.
+    // Large arrays are split between threads only if they can be packed
+    //
+    const size_t maxRanges = threadCount * 4;
+    const size_t rangeSize = (dataSize / maxRanges) > SDSF_PARALLEL_MIN_RANGE_SIZE ? (dataSize / maxRanges) : SDSF_PARALLEL_MIN_RANGE_SIZE;
+    const size_t minArraySize = (flags & SDSF_DESERIALIZER_FLAG_PACK_ARRAYS) ? 2 * SDSF_PARALLEL_MIN_RANGE_SIZE : 0;
+    const size_t memorySize = maxRanges * (sizeof(SdsfDeserializedResult) + sizeof(_SdsfTextRange) + sizeof(SdsfDeserializationError) + sizeof(bool));
+    void* const memory = allocator.alloc(memorySize, allocator.userData);
+
+    _SdsfDeserializeParallelContext context;
+    context.parts           = (SdsfDeserializedResult*)memory;
+    context.ranges          = (const _SdsfTextRange*)(context.parts + maxRanges);
+    context.errors          = (SdsfDeserializationError*)(context.ranges + maxRanges);
+    context.hasBinaryValues = (bool*)(context.errors + maxRanges);
+    context.data            = (const char*)data;
+    context.allocator       = allocator;
+    context.flags           = flags;
+
+    size_t textSize;
+    const size_t rangeCount = _sdsf_split_top_level_values(context.data, dataSize, rangeSize, minArraySize, (_SdsfTextRange*)context.ranges, maxRanges, &textSize);
+
+    _sdsf_parallel_for(rangeCount, threadCount, _sdsf_deserialize_parallel_job, &context, &allocator);
+
+    //
+    // Ranges which end with a large array have this array as their last top level value (empty, because closing bracket is not in range)
+    // If array can't be parsed in parallel, range is parsed once again together with the array
+    //
+    for (size_t it = 0; it < rangeCount; it++)
+    {
+        const _SdsfTextRange* const range = &context.ranges[it];
+        SdsfDeserializedResult* const part = &context.parts[it];
+        if (!range->arrayEnd || context.errors[it])
+        {
+            continue;
+        }
+        SdsfValue* const array = part->topLevelValues.size ? part->topLevelValues.ptr[part->topLevelValues.size - 1] : NULL;
+        const bool isParsed = array && array->type == SDSF_VALUE_ARRAY && array->asArray.childs.size == 0 &&
+            _sdsf_parse_large_array(array, context.data, range->end, range->arrayEnd, threadCount, &allocator);
+        if (!isParsed)
+        {
+            sdsf_deserialized_result_free(part);
+            context.errors[it] = _sdsf_deserialize(part, context.data + range->start, range->arrayEnd + 1 - range->start,
+                allocator, flags, &context.hasBinaryValues[it], NULL);
+        }
+    }
+
+    //
+    // Blocks of every part are linked after the blocks of the previous part, so result owns all of them.
+    // Parts are joined even if some of them failed, because result must be freed anyway
+    //
+    *sdsf = (SdsfDeserializedResult){0};
+    sdsf->allocator = allocator;
+
+    SdsfDeserializationError error = SDSF_DESERIALIZATION_ERROR_ALL_FINE;
+    bool hasBinaryValues = false;
+    for (size_t it = 0; it < rangeCount; it++)
+    {
+        SdsfDeserializedResult* const part = &context.parts[it];
+        if (!error && context.errors[it])
+        {
+            error = context.errors[it];
+            sdsf->errorMsg = part->errorMsg;
+        }
+        hasBinaryValues = hasBinaryValues || context.hasBinaryValues[it];
+
+        for (size_t valueIt = 0; valueIt < part->topLevelValues.size; valueIt++)
+        {
+            *_sdsf_val_ptr_array_add(&sdsf->topLevelValues, &allocator) = part->topLevelValues.ptr[valueIt];
+        }
+        _sdsf_val_ptr_array_clear(&part->topLevelValues, &allocator);
+
+        if (part->values.ptr)
+        {
+            _sdsf_blocks_link(part->values.ptr, sdsf->values.ptr, sdsf->values.size);
+            sdsf->values = part->values;
+        }
+        if (part->strings.ptr)
+        {
+            _sdsf_blocks_link(part->strings.ptr, sdsf->strings.ptr, sdsf->strings.size);
+            sdsf->strings = part->strings;
+        }
+    }
+    allocator.dealloc(memory, memorySize, allocator.userData);
+
+    if (!error && textSize < dataSize)
+    {
+        if (!hasBinaryValues)
+        {
+            sdsf->errorMsg = "Unexpected binary data blob - no binary literals were used";
+            return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_BINARY_DATA_BLOB;
+        }
+
+        const size_t blobStart = textSize + 1;
+        const size_t binaryDataSize = dataSize - blobStart;
+        if (binaryDataSize)
+        {
+            SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_BINARY_DATA);
+            sdsf->binaryData = allocator.alloc(binaryDataSize, allocator.userData);
+            SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+            sdsf->binaryDataSize = binaryDataSize;
+            memcpy(sdsf->binaryData, context.data + blobStart, binaryDataSize);
+        }
+    }
+
+    return error;
+}
+
+void sdsf_deserialized_result_free(SdsfDeserializedResult* sdsf)
+{
+    _SdsfBlockHeader* header = _sdsf_block_header(sdsf->values.ptr);
+    size_t blockSize = sdsf->values.size;
+    while (header)
+    {
+        SdsfValue* const blockValues = (SdsfValue*)(header + 1);
+        for (size_t it = 0; it < blockSize; it++)
+        {
+            SdsfValue* const value = &blockValues[it];
+            if (value->type == SDSF_VALUE_COMPOSITE)
+            {
+                _sdsf_val_ptr_array_clear(&value->asComposite.childs, &sdsf->allocator);
+            }
+            else if (value->type == SDSF_VALUE_ARRAY)
+            {
+                _sdsf_val_ptr_array_clear(&value->asArray.childs, &sdsf->allocator);
+            }
+            else
+            {
+                _sdsf_free_packed_storage(value, &sdsf->allocator);
+            }
+        }
+        header = (_SdsfBlockHeader*)header->previous;
+        blockSize = header ? header->size : 0;
+    }
+    _sdsf_val_ptr_array_clear(&sdsf->topLevelValues, &sdsf->allocator);
+    _sdsf_val_array_clear(&sdsf->values, &sdsf->allocator);
+    _sdsf_string_array_clear(&sdsf->strings, &sdsf->allocator);
+
+    if (sdsf->binaryData && sdsf->binaryDataSize)
+    {
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_BINARY_DATA);
+        sdsf->allocator.dealloc(sdsf->binaryData, sdsf->binaryDataSize, sdsf->allocator.userData);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+    }
+}
+
+size_t sdsf_string_size(const SdsfValue* value)
+{
+    if (value->asString == value->asStringInline)
+    {
+        return _SDSF_INLINE_STRING_CAPACITY - (size_t)(uint8_t)value->asStringInline[_SDSF_INLINE_STRING_CAPACITY];
+    }
+    return strlen(value->asString);
+}
+
+const void* sdsf_binary_as_typed(const SdsfDeserializedResult* sdsf, const SdsfValue* value, SdsfBinaryElementType type, size_t* count)
+{
+    *count = 0;
+    if (!value || value->type != SDSF_VALUE_BINARY || value->asBinary.elementType != type)
+    {
+        return NULL;
+    }
+    const size_t elementSize = _SDSF_BINARY_ELEMENT_TYPE_SIZES[type];
+    if (elementSize > 1 && value->asBinary.isBigEndian != _sdsf_is_big_endian_host())
+    {
+        // Byte order doesn't matter for single byte elements
+        return NULL;
+    }
+
+    const size_t offset = value->asBinary.dataOffset;
+    const size_t size = value->asBinary.dataSize;
+    if (!sdsf->binaryData || offset > sdsf->binaryDataSize || size > (sdsf->binaryDataSize - offset))
+    {
+        return NULL;
+    }
+
+    const char* const data = ((const char*)sdsf->binaryData) + offset;
+    if (((uintptr_t)data) % elementSize)
+    {
+        return NULL;
+    }
+
+    *count = size / elementSize;
+    return data;
+}
+
+#define _SDSF_DEFINE_BINARY_ACCESSOR(suffix, cType, elementType)                                                \
+    const cType* sdsf_binary_as_##suffix(const SdsfDeserializedResult* sdsf, const SdsfValue* value, size_t* count) \
+    {                                                                                                           \
+        return (const cType*)sdsf_binary_as_typed(sdsf, value, elementType, count);                             \
+    }
+
+_SDSF_DEFINE_BINARY_ACCESSOR(u8,  uint8_t,  SDSF_BINARY_U8)
+_SDSF_DEFINE_BINARY_ACCESSOR(i8,  int8_t,   SDSF_BINARY_I8)
+_SDSF_DEFINE_BINARY_ACCESSOR(u16, uint16_t, SDSF_BINARY_U16)
+_SDSF_DEFINE_BINARY_ACCESSOR(i16, int16_t,  SDSF_BINARY_I16)
+_SDSF_DEFINE_BINARY_ACCESSOR(u32, uint32_t, SDSF_BINARY_U32)
+_SDSF_DEFINE_BINARY_ACCESSOR(i32, int32_t,  SDSF_BINARY_I32)
+_SDSF_DEFINE_BINARY_ACCESSOR(u64, uint64_t, SDSF_BINARY_U64)
+_SDSF_DEFINE_BINARY_ACCESSOR(i64, int64_t,  SDSF_BINARY_I64)
+_SDSF_DEFINE_BINARY_ACCESSOR(f32, float,    SDSF_BINARY_F32)
+_SDSF_DEFINE_BINARY_ACCESSOR(f64, double,   SDSF_BINARY_F64)
+
+#undef _SDSF_DEFINE_BINARY_ACCESSOR
+
+bool sdsf_packed_array_get(const SdsfValue* array, size_t index, SdsfValue* element)
+{
+    if (!array || array->type != SDSF_VALUE_PACKED_ARRAY || index >= array->asPackedArray.size)
+    {
+        return false;
+    }
+
+    const SdsfValueType elementType = array->asPackedArray.elementType;
+    const uint8_t* const data = (const uint8_t*)array->asPackedArray.data;
+    *element = (SdsfValue){0};
+    element->type = elementType;
+    if (elementType == SDSF_VALUE_BOOL)
+    {
+        element->asBool = (data[index / 8] >> (index % 8)) & 1;
+    }
+    else
+    {
+        const size_t elementSize = _sdsf_packed_element_size(elementType);
+        memcpy(&element->asInt64, data + index * elementSize, elementSize);
+    }
+    return true;
+}
+
+const void* sdsf_packed_array_as_typed(const SdsfValue* array, SdsfValueType elementType, size_t* count)
+{
+    *count = 0;
+    if (!array || array->type != SDSF_VALUE_PACKED_ARRAY || array->asPackedArray.elementType != elementType)
+    {
+        return NULL;
+    }
+    *count = array->asPackedArray.size;
+    return array->asPackedArray.data;
+}
+
+#define _SDSF_DEFINE_PACKED_ARRAY_ACCESSOR(suffix, cType, elementType)                  \
+    const cType* sdsf_packed_array_as_##suffix(const SdsfValue* array, size_t* count)   \
+    {                                                                                   \
+        return (const cType*)sdsf_packed_array_as_typed(array, elementType, count);     \
+    }
+
+_SDSF_DEFINE_PACKED_ARRAY_ACCESSOR(bits,   uint8_t,  SDSF_VALUE_BOOL)
+_SDSF_DEFINE_PACKED_ARRAY_ACCESSOR(int,    int32_t,  SDSF_VALUE_INT)
+_SDSF_DEFINE_PACKED_ARRAY_ACCESSOR(float,  float,    SDSF_VALUE_FLOAT)
+_SDSF_DEFINE_PACKED_ARRAY_ACCESSOR(int64,  int64_t,  SDSF_VALUE_INT64)
+_SDSF_DEFINE_PACKED_ARRAY_ACCESSOR(uint64, uint64_t, SDSF_VALUE_UINT64)
+_SDSF_DEFINE_PACKED_ARRAY_ACCESSOR(double, double,   SDSF_VALUE_DOUBLE)
+
+#undef _SDSF_DEFINE_PACKED_ARRAY_ACCESSOR
+
+bool sdsf_array_as_tensor(const SdsfValue* array, SdsfTensor* tensor)
+{
+    *tensor = (SdsfTensor){0};
+    if (!array)
+    {
+        return false;
+    }
+    if (array->type == SDSF_VALUE_TENSOR)
+    {
+        tensor->elementType = array->asTensor.elementType;
+        tensor->rank = array->asTensor.rank;
+        tensor->shape = array->asTensor.shape;
+        tensor->data = array->asTensor.data;
+        tensor->count = _sdsf_tensor_count(array->asTensor.shape, array->asTensor.rank);
+        return true;
+    }
+    if (array->type == SDSF_VALUE_PACKED_ARRAY && array->asPackedArray.elementType != SDSF_VALUE_BOOL)
+    {
+        // Packed array is a tensor with a single dimension
+        tensor->elementType = array->asPackedArray.elementType;
+        tensor->rank = 1;
+        tensor->shape = &array->asPackedArray.size;
+        tensor->data = array->asPackedArray.data;
+        tensor->count = array->asPackedArray.size;
+        return true;
+    }
+    return false;
+}
+
+static inline size_t _sdsf_column_element_size(SdsfValueType type)
+{
+    switch (type)
+    {
+        case SDSF_VALUE_BOOL:   return sizeof(bool);
+        case SDSF_VALUE_INT:    return sizeof(int32_t);
+        case SDSF_VALUE_FLOAT:  return sizeof(float);
+        case SDSF_VALUE_INT64:  return sizeof(int64_t);
+        case SDSF_VALUE_UINT64: return sizeof(uint64_t);
+        case SDSF_VALUE_DOUBLE: return sizeof(double);
+        case SDSF_VALUE_STRING: return sizeof(const char*);
+        default:                return 0;
+    }
+}
+
+//
+// Stores value to the column if types match. Lossless conversions (int to int64, float to double, etc.) are allowed
+//
+bool _sdsf_store_column_value(SdsfColumn* column, size_t row, const SdsfValue* value)
+{
+    switch (column->type)
+    {
+        case SDSF_VALUE_BOOL:
+        {
+            if (value->type != SDSF_VALUE_BOOL) return false;
+            ((bool*)column->data)[row] = value->asBool;
+        } break;
+        case SDSF_VALUE_INT:
+        {
+            if (value->type != SDSF_VALUE_INT) return false;
+            ((int32_t*)column->data)[row] = value->asInt;
+        } break;
+        case SDSF_VALUE_FLOAT:
+        {
+            if (value->type != SDSF_VALUE_FLOAT) return false;
+            ((float*)column->data)[row] = value->asFloat;
+        } break;
+        case SDSF_VALUE_INT64:
+        {
+            if (value->type == SDSF_VALUE_INT)          ((int64_t*)column->data)[row] = value->asInt;
+            else if (value->type == SDSF_VALUE_INT64)   ((int64_t*)column->data)[row] = value->asInt64;
+            else return false;
+        } break;
+        case SDSF_VALUE_UINT64:
+        {
+            if (value->type == SDSF_VALUE_UINT64)                           ((uint64_t*)column->data)[row] = value->asUint64;
+            else if (value->type == SDSF_VALUE_INT && value->asInt >= 0)     ((uint64_t*)column->data)[row] = (uint64_t)value->asInt;
+            else if (value->type == SDSF_VALUE_INT64 && value->asInt64 >= 0) ((uint64_t*)column->data)[row] = (uint64_t)value->asInt64;
+            else return false;
+        } break;
+        case SDSF_VALUE_DOUBLE:
+        {
+            if (value->type == SDSF_VALUE_DOUBLE)       ((double*)column->data)[row] = value->asDouble;
+            else if (value->type == SDSF_VALUE_FLOAT)   ((double*)column->data)[row] = value->asFloat;
+            else if (value->type == SDSF_VALUE_INT)     ((double*)column->data)[row] = value->asInt;
+            else return false;
+        } break;
+        case SDSF_VALUE_STRING:
+        {
+            if (value->type != SDSF_VALUE_STRING) return false;
+            ((const char**)column->data)[row] = value->asString;
+        } break;
+        default:
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//
+// Elements of entity tables usually have the same childs in the same order, so child index found for the previous
+// element is checked first and full search is done only if it doesn't match
+//
+static inline const SdsfValue* _sdsf_find_child_cached(const SdsfValuePtrArray* childs, const char* name, size_t* cachedIndex)
+{
+    if (*cachedIndex < childs->size && strcmp(childs->ptr[*cachedIndex]->name, name) == 0)
+    {
+        return childs->ptr[*cachedIndex];
+    }
+    for (size_t it = 0; it < childs->size; it++)
+    {
+        if (strcmp(childs->ptr[it]->name, name) == 0)
+        {
+            *cachedIndex = it;
+            return childs->ptr[it];
+        }
+    }
+    return NULL;
+}
+
+SdsfColumnsError sdsf_array_to_columns(SdsfColumns* result, const SdsfValue* array, const SdsfColumnSpec* specs, size_t specCount, SdsfAllocator allocator)
+{
+    *result = (SdsfColumns){0};
+    result->allocator = allocator;
+
+    if (!array || array->type != SDSF_VALUE_ARRAY)
+    {
+        result->errorMsg = "Columns can be extracted only from array value";
+        return SDSF_COLUMNS_ERROR_NOT_AN_ARRAY;
+    }
+    for (size_t it = 0; it < specCount; it++)
+    {
+        if (!specs[it].name || !_sdsf_column_element_size(specs[it].type))
+        {
+            result->errorMsg = "Column must have a name and bool, int, float, int64, uint64, double or string type";
+            return SDSF_COLUMNS_ERROR_UNSUPPORTED_COLUMN_TYPE;
+        }
+    }
+    if (!specCount)
+    {
+        return SDSF_COLUMNS_ERROR_ALL_FINE;
+    }
+
+    const size_t rowCount = array->asArray.childs.size;
+    const size_t validitySize = (rowCount + 7) / 8;
+    result->rowCount = rowCount;
+    result->columnCount = specCount;
+    result->columns = (SdsfColumn*)allocator.alloc(specCount * sizeof(SdsfColumn), allocator.userData);
+    for (size_t it = 0; it < specCount; it++)
+    {
+        SdsfColumn* const column = &result->columns[it];
+        const size_t dataSize = rowCount * _sdsf_column_element_size(specs[it].type);
+        column->name = specs[it].name;
+        column->type = specs[it].type;
+        column->data = rowCount ? allocator.alloc(dataSize, allocator.userData) : NULL;
+        column->validity = rowCount ? (uint8_t*)allocator.alloc(validitySize, allocator.userData) : NULL;
+        column->nullCount = 0;
+        if (rowCount)
+        {
+            memset(column->data, 0, dataSize);
+            memset(column->validity, 0, validitySize);
+        }
+    }
+
+    size_t* const cachedIndices = (size_t*)allocator.alloc(specCount * sizeof(size_t), allocator.userData);
+    memset(cachedIndices, 0, specCount * sizeof(size_t));
+
+    for (size_t row = 0; row < rowCount; row++)
+    {
+        //
+        // Non-composite elements have no childs, so they become rows without values
+        //
+        const SdsfValue* const element = array->asArray.childs.ptr[row];
+        const bool isComposite = element->type == SDSF_VALUE_COMPOSITE;
+        for (size_t it = 0; it < specCount; it++)
+        {
+            SdsfColumn* const column = &result->columns[it];
+            const SdsfValue* const child = isComposite ? _sdsf_find_child_cached(&element->asComposite.childs, column->name, &cachedIndices[it]) : NULL;
+            if (child && _sdsf_store_column_value(column, row, child))
+            {
+                column->validity[row / 8] |= (uint8_t)(1 << (row % 8));
+            }
+            else
+            {
+                column->nullCount += 1;
+            }
+        }
+    }
+
+    allocator.dealloc(cachedIndices, specCount * sizeof(size_t), allocator.userData);
+    return SDSF_COLUMNS_ERROR_ALL_FINE;
+}
+
+bool sdsf_column_is_valid(const SdsfColumn* column, size_t row)
+{
+    return (column->validity[row / 8] >> (row % 8)) & 1;
+}
+
+SdsfSharedDocument* sdsf_share_result(SdsfDeserializedResult* result)
+{
+    const SdsfAllocator allocator = result->allocator;
+    SdsfSharedDocument* const document = (SdsfSharedDocument*)allocator.alloc(sizeof(SdsfSharedDocument), allocator.userData);
+    document->result = *result;
+    document->refCount = 1;
+    *result = (SdsfDeserializedResult){0};
+    return document;
+}
+
+void sdsf_shared_document_retain(SdsfSharedDocument* document)
+{
+    _sdsf_atomic_add(&document->refCount, 1);
+}
+
+void sdsf_shared_document_release(SdsfSharedDocument* document)
+{
+    if (document && _sdsf_atomic_add(&document->refCount, -1) == 0)
+    {
+        const SdsfAllocator allocator = document->result.allocator;
+        sdsf_deserialized_result_free(&document->result);
+        allocator.dealloc(document, sizeof(SdsfSharedDocument), allocator.userData);
+    }
+}
+
+//
+// Slot works like sleepable rcu. Reader is registered in one of two reader counters (selected by the current epoch) only while
+// it loads the document pointer and retains the document. Publisher swaps the pointer, switches the epoch and waits until
+// readers of the previous epoch are gone - after that nobody can hold the old pointer without a reference, so slot's reference
+// can be released. Document itself is freed when the last reader releases it
+//
+SdsfSharedDocument* sdsf_document_slot_acquire(SdsfDocumentSlot* slot)
+{
+    //
+    // Epoch is checked again after registration. Otherwise reader which was suspended between epoch read and registration
+    // could register in the counter which publisher doesn't wait for anymore
+    //
+    volatile int32_t* readerCount;
+    while (true)
+    {
+        const int32_t epoch = _sdsf_atomic_load(&slot->epoch);
+        readerCount = &slot->readerCounts[epoch & 1];
+        _sdsf_atomic_add(readerCount, 1);
+        if (_sdsf_atomic_load(&slot->epoch) == epoch)
+        {
+            break;
+        }
+        _sdsf_atomic_add(readerCount, -1);
+    }
+    SdsfSharedDocument* const document = (SdsfSharedDocument*)_sdsf_atomic_load_ptr((void* volatile*)&slot->document);
+    if (document)
+    {
+        sdsf_shared_document_retain(document);
+    }
+    _sdsf_atomic_add(readerCount, -1);
+    return document;
+}
+
+void sdsf_document_slot_publish(SdsfDocumentSlot* slot, SdsfSharedDocument* document)
+{
+    if (document)
+    {
+        sdsf_shared_document_retain(document);
+    }
+
+    // Publishers are serialized, readers are never blocked
+    uint32_t spinIteration = 0;
+    while (!_sdsf_atomic_compare_exchange(&slot->isPublishing, 0, 1))
+    {
+        _sdsf_spin_wait(&spinIteration);
+    }
+
+    SdsfSharedDocument* const previous = (SdsfSharedDocument*)_sdsf_atomic_exchange_ptr((void* volatile*)&slot->document, document);
+    const int32_t previousEpoch = _sdsf_atomic_add(&slot->epoch, 1) - 1;
+    spinIteration = 0;
+    while (_sdsf_atomic_load(&slot->readerCounts[previousEpoch & 1]) != 0)
+    {
+        _sdsf_spin_wait(&spinIteration);
+    }
+
+    _sdsf_atomic_store(&slot->isPublishing, 0);
+    sdsf_shared_document_release(previous);
+}
+
+void sdsf_columns_free(SdsfColumns* columns)
+{
+    const SdsfAllocator allocator = columns->allocator;
+    const size_t validitySize = (columns->rowCount + 7) / 8;
+    for (size_t it = 0; it < columns->columnCount; it++)
+    {
+        SdsfColumn* const column = &columns->columns[it];
+        if (column->data)
+        {
+            allocator.dealloc(column->data, columns->rowCount * _sdsf_column_element_size(column->type), allocator.userData);
+        }
+        if (column->validity)
+        {
+            allocator.dealloc(column->validity, validitySize, allocator.userData);
+        }
+    }
+    if (columns->columns)
+    {
+        allocator.dealloc(columns->columns, columns->columnCount * sizeof(SdsfColumn), allocator.userData);
+    }
+    *columns = (SdsfColumns){0};
+}
+
+//
+// Binary data blob is at the end of file, but binary values are reported by the event reader as soon as they are read.
+// So the blob is found with a separate scan, which skips string literals (they can have '@' characters in them).
+// Scan is done only once and only if file has binary values. Scan can be continued in the next piece of data,
+// state keeps track of unfinished string literal (skip is non-zero if escape sequence is split between pieces)
+//
+typedef struct
+{
+    bool    isInString;
+    size_t  skip;
+} _SdsfBlobScanState;
+
+bool _sdsf_scan_binary_data_blob(const char* data, size_t dataSize, _SdsfBlobScanState* state, size_t* blobOffset)
+{
+    size_t it = state->skip;
+    while (it < dataSize)
+    {
+        if (state->isInString)
+        {
+            it += _sdsf_find_quote_or_backslash(data + it, dataSize - it);
+            if (it >= dataSize)
+            {
+                break;
+            }
+            if (data[it] == '\\')
+            {
+                it += 2;
+                continue;
+            }
+            it += 1;
+            state->isInString = false;
+            continue;
+        }
+        const char c = data[it++];
+        if (c == '@')
+        {
+            *blobOffset = it;
+            return true;
+        }
+        state->isInString = c == '\"';
+    }
+    state->skip = it - dataSize;
+    return false;
+}
+
+static inline bool _sdsf_find_binary_data_blob(const char* data, size_t dataSize, size_t from, size_t* blobOffset)
+{
+    _SdsfBlobScanState state = { false, from };
+    return _sdsf_scan_binary_data_blob(data, dataSize, &state, blobOffset);
+}
+
+//
+// Reads frames written by SdsfCompressor. Frames are read either sequentially or at given file offset
+// (second decoder reads binary data blob at the end of file while the first one stays where it is)
+//
+typedef struct
+{
+    SdsfCodec                   codec;
+    _SdsfFile                   file;
+    bool                        isReadAt;
+    uint64_t                    fileOffset;     // file offset of the current frame header
+    uint64_t                    nextFileOffset;
+    uint64_t                    rawOffset;      // decompressed offset of the current frame
+    char*                       frame;
+    size_t                      frameSize;
+    size_t                      frameConsumed;
+    char*                       packedFrame;
+    bool                        isEnd;
+    SdsfDeserializationError    error;
+    const char*                 errorMsg;
+} _SdsfDecoder;
+
+void _sdsf_decoder_begin(_SdsfDecoder* decoder, SdsfAllocator* allocator, SdsfCodec codec, _SdsfFile file, bool isReadAt, uint64_t fileOffset)
+{
+    *decoder = (_SdsfDecoder){0};
+    decoder->codec          = codec;
+    decoder->file           = file;
+    decoder->isReadAt       = isReadAt;
+    decoder->fileOffset     = fileOffset;
+    decoder->nextFileOffset = fileOffset;
+    decoder->frame          = (char*)allocator->alloc(_SDSF_CODEC_FRAME_SIZE, allocator->userData);
+    decoder->packedFrame    = (char*)allocator->alloc(_SDSF_CODEC_FRAME_SIZE, allocator->userData);
+}
+
+void _sdsf_decoder_end(_SdsfDecoder* decoder, SdsfAllocator* allocator)
+{
+    if (decoder->frame)
+    {
+        allocator->dealloc(decoder->frame, _SDSF_CODEC_FRAME_SIZE, allocator->userData);
+        allocator->dealloc(decoder->packedFrame, _SDSF_CODEC_FRAME_SIZE, allocator->userData);
+    }
+    *decoder = (_SdsfDecoder){0};
+}
+
+static inline bool _sdsf_decoder_fail(_SdsfDecoder* decoder, SdsfDeserializationError error, const char* errorMsg)
+{
+    decoder->error = error;
+    decoder->errorMsg = errorMsg;
+    return false;
+}
+
+bool _sdsf_decoder_read_file(_SdsfDecoder* decoder, void* buffer, size_t size)
+{
+    size_t wasRead;
+    const bool isRead = decoder->isReadAt
+        ? _sdsf_file_read_at(decoder->file, buffer, size, decoder->nextFileOffset, &wasRead)
+        : _sdsf_file_read_up_to(decoder->file, buffer, size, &wasRead);
+    if (!isRead)
+    {
+        return _sdsf_decoder_fail(decoder, SDSF_DESERIALIZATION_ERROR_READ_FAILED, "Failed to read file");
+    }
+    if (wasRead != size)
+    {
+        return _sdsf_decoder_fail(decoder, SDSF_DESERIALIZATION_ERROR_DECOMPRESSION_FAILED, "Compressed data is truncated");
+    }
+    decoder->nextFileOffset += size;
+    return true;
+}
+
+bool _sdsf_decoder_next_frame(_SdsfDecoder* decoder)
+{
+    decoder->rawOffset += decoder->frameSize;
+    decoder->fileOffset = decoder->nextFileOffset;
+    decoder->frameSize = 0;
+    decoder->frameConsumed = 0;
+
+    uint8_t header[_SDSF_CODEC_FRAME_HEADER_SIZE];
+    if (!_sdsf_decoder_read_file(decoder, header, sizeof(header)))
+    {
+        return false;
+    }
+    const size_t frameSize = _sdsf_codec_read_u32(header);
+    const size_t packedSize = _sdsf_codec_read_u32(header + 4);
+    if (frameSize == 0)
+    {
+        decoder->isEnd = true;
+        return true;
+    }
+    if (frameSize > _SDSF_CODEC_FRAME_SIZE || packedSize > frameSize)
+    {
+        return _sdsf_decoder_fail(decoder, SDSF_DESERIALIZATION_ERROR_DECOMPRESSION_FAILED, "Compressed data is corrupted - invalid frame header");
+    }
+
+    const bool isStored = packedSize == frameSize;
+    if (!_sdsf_decoder_read_file(decoder, isStored ? decoder->frame : decoder->packedFrame, packedSize))
+    {
+        return false;
+    }
+    if (!isStored && !decoder->codec.decompress(decoder->packedFrame, packedSize, decoder->frame, frameSize, decoder->codec.userData))
+    {
+        return _sdsf_decoder_fail(decoder, SDSF_DESERIALIZATION_ERROR_DECOMPRESSION_FAILED, "Compressed data is corrupted - codec failed to decompress frame");
+    }
+    decoder->frameSize = frameSize;
+    return true;
+}
+
+//
+// Reads until buffer is full or until the end of compressed stream
+//
+bool _sdsf_decoder_read_up_to(_SdsfDecoder* decoder, void* buffer, size_t size, size_t* wasReadTotal)
+{
+    *wasReadTotal = 0;
+    while (size)
+    {
+        if (decoder->frameConsumed == decoder->frameSize)
+        {
+            if (decoder->isEnd)
+            {
+                return true;
+            }
+            if (!_sdsf_decoder_next_frame(decoder))
+            {
+                return false;
+            }
+            continue;
+        }
+        const size_t frameLeft = decoder->frameSize - decoder->frameConsumed;
+        const size_t copySize = size < frameLeft ? size : frameLeft;
+        memcpy(buffer, decoder->frame + decoder->frameConsumed, copySize);
+        decoder->frameConsumed += copySize;
+        buffer = (char*)buffer + copySize;
+        size -= copySize;
+        *wasReadTotal += copySize;
+    }
+    return true;
+}
+
+typedef struct
+{
+    uint64_t rawOffset;
+    uint64_t fileOffset;
+} _SdsfFrameEntry;
+
+//
+// Sliding window over file for sdsf_read_events_from_fd. Tokenizer works on the window as on usual data. If token touches the end of window
+// (so it might be incomplete), tokenizer state is restored, consumed data is dropped from the window start and window is filled again.
+// Window grows only if a single token doesn't fit into it. Binary data is read from the blob only when it is not in the window already.
+// If file is compressed, window is filled by decoder and all offsets are offsets in decompressed data. Blob frames are listed once
+// from the stream trailer (when the blob is searched) and read by the second decoder
+//
+typedef struct
+{
+    SdsfAllocator               allocator;
+    _SdsfFile                   file;
+    _SdsfDecoder*               decoder;
+    char*                       data;
+    size_t                      dataSize;
+    size_t                      capacity;
+    uint64_t                    dataOffset;             // file offset of the first byte of window
+    uint64_t                    streamOffset;           // file offset of compressed stream start
+    uint64_t                    fileSize;               // known only after binary data blob search
+    uint64_t                    blobOffset;
+    void*                       binaryBuffer;
+    size_t                      binaryBufferCapacity;
+    _SdsfDecoder                blobDecoder;
+    void*                       blobFrames;             // _SdsfFrameEntry's from the frame with blob start to the end of file
+    size_t                      blobFrameCount;
+    size_t                      blobFramesCapacity;     // in bytes
+    bool                        isEndOfFile;
+    bool                        isBlobReached;
+    SdsfDeserializationError    error;
+    const char*                 errorMsg;
+} _SdsfInputWindow;
+
+bool _sdsf_input_window_fill(_SdsfInputWindow* window, _SdsfTokenizerData* tokenizerData)
+{
+    const size_t consumedSize = tokenizerData->stringConsumePtr;
+    if (consumedSize)
+    {
+        memmove(window->data, window->data + consumedSize, window->dataSize - consumedSize);
+        window->dataSize -= consumedSize;
+        window->dataOffset += consumedSize;
+        tokenizerData->stringConsumePtr = 0;
+    }
+    else
+    {
+        // Window is full and has a single unfinished token
+        _sdsf_ensure_buffer_capacity(&window->allocator, (void**)&window->data, &window->capacity, window->dataSize, 1);
+    }
+
+    size_t wasRead;
+    char* const freeSpace = window->data + window->dataSize;
+    const size_t freeSize = window->capacity - window->dataSize;
+    if (window->decoder && !_sdsf_decoder_read_up_to(window->decoder, freeSpace, freeSize, &wasRead))
+    {
+        window->error = window->decoder->error;
+        window->errorMsg = window->decoder->errorMsg;
+        return false;
+    }
+    if (!window->decoder && !_sdsf_file_read_up_to(window->file, freeSpace, freeSize, &wasRead))
+    {
+        window->error = SDSF_DESERIALIZATION_ERROR_READ_FAILED;
+        window->errorMsg = "Failed to read file";
+        return false;
+    }
+    window->dataSize += wasRead;
+    window->isEndOfFile = window->dataSize < window->capacity;
+    tokenizerData->data = window->data;
+    tokenizerData->dataSize = window->dataSize;
+    return true;
+}
+
+bool _sdsf_input_window_consume_token(_SdsfInputWindow* window, const char** errorMsg, _SdsfConsumedToken* token, _SdsfTokenizerData* tokenizerData)
+{
+    while (!window->isBlobReached)
+    {
+        const _SdsfTokenizerData snapshot = *tokenizerData;
+        const char* const errorMsgSnapshot = *errorMsg;
+        const bool hasToken = _sdsf_consume_token(errorMsg, token, tokenizerData);
+        if (hasToken && token->tokenType == _SDSF_TOKEN_TYPE_RESERVED_SYMBOL && token->stringPtr[0] == '@')
+        {
+            // Nothing after the blob start is tokenized, so there is no need to read it
+            window->isBlobReached = true;
+            return true;
+        }
+        if (window->isEndOfFile || (hasToken && tokenizerData->stringConsumePtr < window->dataSize))
+        {
+            return hasToken;
+        }
+
+        // Token cut by the window end can look malformed (incomplete utf-8 sequence, etc.), its error message is dropped as well
+        *tokenizerData = snapshot;
+        *errorMsg = errorMsgSnapshot;
+        if (!_sdsf_input_window_fill(window, tokenizerData))
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+//
+// Blob position is taken from the compressed stream trailer (see _sdsf_compressor_flush). Only frame headers are read
+// from the frame with blob start to the end of stream, nothing is decompressed
+//
+bool _sdsf_input_window_read_blob_trailer(_SdsfInputWindow* window, uint64_t compressedSize, uint64_t minBlobOffset, bool isFoundInWindow)
+{
+    const uint64_t streamEnd = compressedSize - _SDSF_CODEC_TRAILER_SIZE;
+    uint8_t trailer[_SDSF_CODEC_TRAILER_SIZE];
+    size_t wasRead;
+    if (compressedSize < window->streamOffset + _SDSF_CODEC_MAGIC_SIZE + _SDSF_CODEC_FRAME_HEADER_SIZE + _SDSF_CODEC_TRAILER_SIZE ||
+        !_sdsf_file_read_at(window->file, trailer, sizeof(trailer), streamEnd, &wasRead) || wasRead != sizeof(trailer) ||
+        memcmp(trailer + 24, _SDSF_CODEC_TRAILER_MAGIC, 4) != 0)
+    {
+        return false;
+    }
+
+    const uint64_t blobOffset = _sdsf_codec_read_u64(trailer);
+    uint64_t rawOffset = _sdsf_codec_read_u64(trailer + 8);
+    uint64_t fileOffset = window->streamOffset + _sdsf_codec_read_u64(trailer + 16);
+    if (blobOffset < minBlobOffset || blobOffset < rawOffset || (isFoundInWindow && blobOffset != window->blobOffset))
+    {
+        return false;
+    }
+
+    window->blobFrameCount = 0;
+    for (;;)
+    {
+        uint8_t header[_SDSF_CODEC_FRAME_HEADER_SIZE];
+        if (fileOffset > streamEnd - sizeof(header) || !_sdsf_file_read_at(window->file, header, sizeof(header), fileOffset, &wasRead) || wasRead != sizeof(header))
+        {
+            window->blobFrameCount = 0;
+            return false;
+        }
+        const size_t frameSize = _sdsf_codec_read_u32(header);
+        const size_t packedSize = _sdsf_codec_read_u32(header + 4);
+        if (frameSize == 0)
+        {
+            break;
+        }
+        if (frameSize > _SDSF_CODEC_FRAME_SIZE || packedSize > frameSize)
+        {
+            window->blobFrameCount = 0;
+            return false;
+        }
+
+        const size_t framesSize = window->blobFrameCount * sizeof(_SdsfFrameEntry);
+        _sdsf_ensure_buffer_capacity(&window->allocator, &window->blobFrames, &window->blobFramesCapacity, framesSize, sizeof(_SdsfFrameEntry));
+        _SdsfFrameEntry* const entry = &((_SdsfFrameEntry*)window->blobFrames)[window->blobFrameCount++];
+        entry->rawOffset = rawOffset;
+        entry->fileOffset = fileOffset;
+        rawOffset += frameSize;
+        fileOffset += sizeof(header) + packedSize;
+    }
+    if (blobOffset > rawOffset)
+    {
+        window->blobFrameCount = 0;
+        return false;
+    }
+
+    window->blobOffset = blobOffset;
+    window->fileSize = rawOffset;
+    return true;
+}
+
+//
+// Compressed stream without trailer (written with data appended after it) is decoded from the current frame to the end,
+// frames are remembered starting from the one with blob start
+//
+bool _sdsf_input_window_find_compressed_blob(_SdsfInputWindow* window, _SdsfBlobScanState* state, bool isFoundInWindow)
+{
+    _SdsfDecoder* const decoder = &window->blobDecoder;
+    _sdsf_decoder_begin(decoder, &window->allocator, window->decoder->codec, window->file, true, window->decoder->fileOffset);
+    decoder->rawOffset = window->decoder->rawOffset;
+
+    const uint64_t windowEnd = window->dataOffset + window->dataSize;
+    bool isFound = isFoundInWindow;
+    while (_sdsf_decoder_next_frame(decoder) && !decoder->isEnd)
+    {
+        if (!isFound)
+        {
+            window->blobFrameCount = 0;
+        }
+        const size_t framesSize = window->blobFrameCount * sizeof(_SdsfFrameEntry);
+        _sdsf_ensure_buffer_capacity(&window->allocator, &window->blobFrames, &window->blobFramesCapacity, framesSize, sizeof(_SdsfFrameEntry));
+        _SdsfFrameEntry* const entry = &((_SdsfFrameEntry*)window->blobFrames)[window->blobFrameCount++];
+        entry->rawOffset = decoder->rawOffset;
+        entry->fileOffset = decoder->fileOffset;
+
+        // Start of the current frame can be in the window already
+        const size_t skip = windowEnd > decoder->rawOffset ? (size_t)(windowEnd - decoder->rawOffset) : 0;
+        size_t blobOffset = 0;
+        if (!isFound && skip < decoder->frameSize && _sdsf_scan_binary_data_blob(decoder->frame + skip, decoder->frameSize - skip, state, &blobOffset))
+        {
+            isFound = true;
+            window->blobOffset = decoder->rawOffset + skip + blobOffset;
+        }
+    }
+    window->fileSize = decoder->rawOffset;
+    return isFound && decoder->isEnd;
+}
+
+//
+// Blob is searched in the rest of the window and then in the rest of file (read at offset, so window stays where it is).
+// Compressed stream has blob position in its trailer
+//
+bool _sdsf_input_window_find_binary_data_blob(_SdsfInputWindow* window, size_t from)
+{
+    _SdsfBlobScanState state = { false, from };
+    size_t blobOffset = 0;
+    const bool isFoundInWindow = _sdsf_scan_binary_data_blob(window->data, window->dataSize, &state, &blobOffset);
+    if (isFoundInWindow)
+    {
+        window->blobOffset = window->dataOffset + blobOffset;
+    }
+    if (window->isEndOfFile)
+    {
+        window->fileSize = window->dataOffset + window->dataSize;
+        return isFoundInWindow;
+    }
+    if (!_sdsf_file_size(window->file, &window->fileSize))
+    {
+        return false;
+    }
+    if (window->decoder && _sdsf_input_window_read_blob_trailer(window, window->fileSize, window->dataOffset + from, isFoundInWindow))
+    {
+        _sdsf_decoder_begin(&window->blobDecoder, &window->allocator, window->decoder->codec, window->file, true, 0);
+        return true;
+    }
+    if (window->decoder)
+    {
+        return _sdsf_input_window_find_compressed_blob(window, &state, isFoundInWindow);
+    }
+    if (isFoundInWindow)
+    {
+        return true;
+    }
+
+    SdsfAllocator* const allocator = &window->allocator;
+    char* const chunk = (char*)allocator->alloc(window->capacity, allocator->userData);
+    uint64_t offset = window->dataOffset + window->dataSize;
+    bool isFound = false;
+    while (!isFound && offset < window->fileSize)
+    {
+        size_t chunkSize;
+        if (!_sdsf_file_read_at(window->file, chunk, window->capacity, offset, &chunkSize) || chunkSize == 0)
+        {
+            break;
+        }
+        isFound = _sdsf_scan_binary_data_blob(chunk, chunkSize, &state, &blobOffset);
+        if (isFound)
+        {
+            window->blobOffset = offset + blobOffset;
+        }
+        offset += chunkSize;
+    }
+    allocator->dealloc(chunk, window->capacity, allocator->userData);
+    return isFound;
+}
+
+//
+// Copies decompressed data which is outside of the window. Decoder moves to another frame only if data is not in the current frame
+// (binary values usually go one after another)
+//
+bool _sdsf_input_window_read_compressed(_SdsfInputWindow* window, char* buffer, uint64_t start, size_t size)
+{
+    _SdsfDecoder* const decoder = &window->blobDecoder;
+    const _SdsfFrameEntry* const frames = (const _SdsfFrameEntry*)window->blobFrames;
+    if (!window->blobFrameCount)
+    {
+        return false;
+    }
+    if (start < decoder->rawOffset || start >= decoder->rawOffset + decoder->frameSize)
+    {
+        size_t first = 0;
+        size_t last = window->blobFrameCount;
+        while (last - first > 1)
+        {
+            const size_t middle = (first + last) / 2;
+            if (frames[middle].rawOffset <= start)
+            {
+                first = middle;
+            }
+            else
+            {
+                last = middle;
+            }
+        }
+        decoder->isEnd = false;
+        decoder->frameSize = 0;
+        decoder->rawOffset = frames[first].rawOffset;
+        decoder->nextFileOffset = frames[first].fileOffset;
+        if (!_sdsf_decoder_next_frame(decoder))
+        {
+            return false;
+        }
+    }
+    while (size)
+    {
+        if (decoder->isEnd || start < decoder->rawOffset)
+        {
+            return false;
+        }
+        const size_t frameStart = (size_t)(start - decoder->rawOffset);
+        const size_t frameLeft = decoder->frameSize - frameStart;
+        const size_t copySize = size < frameLeft ? size : frameLeft;
+        memcpy(buffer, decoder->frame + frameStart, copySize);
+        buffer += copySize;
+        start += copySize;
+        size -= copySize;
+        if (size && !_sdsf_decoder_next_frame(decoder))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const void* _sdsf_input_window_binary_data(_SdsfInputWindow* window, size_t offset, size_t size)
+{
+    const uint64_t blobSize = window->fileSize - window->blobOffset;
+    if (offset > blobSize || size > blobSize - offset)
+    {
+        return NULL;
+    }
+    uint64_t start = window->blobOffset + offset;
+    if (start >= window->dataOffset && start - window->dataOffset <= window->dataSize && size <= window->dataSize - (start - window->dataOffset))
+    {
+        return window->data + (start - window->dataOffset);
+    }
+
+    // Buffer is never empty, so empty binary values have valid pointer too
+    _sdsf_ensure_buffer_capacity(&window->allocator, &window->binaryBuffer, &window->binaryBufferCapacity, 0, size ? size : 1);
+    char* buffer = (char*)window->binaryBuffer;
+    if (window->decoder)
+    {
+        // Beginning of binary data can be in the window, the rest is always in blob frames
+        const uint64_t windowEnd = window->dataOffset + window->dataSize;
+        if (start >= window->dataOffset && start < windowEnd)
+        {
+            const size_t windowPart = (size_t)(windowEnd - start);
+            memcpy(buffer, window->data + (start - window->dataOffset), windowPart);
+            buffer += windowPart;
+            start += windowPart;
+            size -= windowPart;
+        }
+        return _sdsf_input_window_read_compressed(window, buffer, start, size) ? window->binaryBuffer : NULL;
+    }
+
+    size_t wasRead;
+    if (!_sdsf_file_read_at(window->file, buffer, size, start, &wasRead) || wasRead != size)
+    {
+        return NULL;
+    }
+    return buffer;
+}
+
+static inline bool _sdsf_emit_event(SdsfEventReader* reader, SdsfEventSink sink, const SdsfEvent* event)
+{
+    if (!sink.handle(event, sink.userData))
+    {
+        reader->errorMsg = "Reading was stopped by event sink";
+        return false;
+    }
+    return true;
+}
+
+//
+// Data is read through the window if window is not NULL (data and dataSize are the window's data in that case)
+//
+SdsfDeserializationError _sdsf_read_events(SdsfEventReader* reader, const char* data, size_t dataSize, SdsfEventSink sink, uint32_t flags, _SdsfInputWindow* window)
+{
+    _SdsfTokenizerData tokenizerData;
+    tokenizerData.data                  = data;
+    tokenizerData.dataSize              = dataSize;
+    tokenizerData.stringLiteralState    = _SDSF_STRING_LITERAL_NONE;
+    tokenizerData.stringConsumePtr      = 0;
+    tokenizerData.validateUtf8          = (flags & SDSF_DESERIALIZER_FLAG_VALIDATE_UTF8) != 0;
+    tokenizerData.hasInvalidUtf8        = false;
+
+    _SdsfConsumedToken token;
+    SdsfAllocator* const allocator = &reader->allocator;
+
+    // Previous token is not kept, because window can be moved before the next token
+    bool isAfterComma = false;
+    bool hasPendingName = false;
+    bool expectsBinaryDataBlob = false;
+    bool isBinaryDataBlobFound = false;
+    size_t binaryDataBlobOffset = 0;
+
+    while (window
+        ? _sdsf_input_window_consume_token(window, &reader->errorMsg, &token, &tokenizerData)
+        : _sdsf_consume_token(&reader->errorMsg, &token, &tokenizerData))
+    {
+        if (token.tokenType == _SDSF_TOKEN_TYPE_INVALID)
+        {
+            // Error message is set in _sdsf_match_string or in _sdsf_consume_token
+            return tokenizerData.hasInvalidUtf8 ? SDSF_DESERIALIZATION_ERROR_INVALID_UTF8 : SDSF_DESERIALIZATION_ERROR_TOKENIZER_FAILED;
+        }
+
+        _SdsfEventReaderScope* const scopes = (_SdsfEventReaderScope*)reader->scopes;
+        _SdsfEventReaderScope* const scope = reader->scopesSize ? &scopes[reader->scopesSize - 1] : NULL;
+
+        SdsfEvent event = {0};
+        event.depth = reader->scopesSize;
+
+        if (token.tokenType == _SDSF_TOKEN_TYPE_IDENTIFIER)
+        {
+            if (hasPendingName)
+            {
+                reader->errorMsg = "Unexpected identifier - got two identifiers in a row";
+                return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_IDENTIFIER;
+            }
+            if (scope && scope->type != SDSF_VALUE_COMPOSITE)
+            {
+                reader->errorMsg = "Unexpected identifier - only composite values can have named childs";
+                return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_IDENTIFIER;
+            }
+
+            // Names are copied because events must have null-terminated names
+            _sdsf_ensure_buffer_capacity(allocator, &reader->nameBuffer, &reader->nameBufferCapacity, 0, token.stringSize + 1);
+            char* const name = (char*)reader->nameBuffer;
+            memcpy(name, token.stringPtr, token.stringSize);
+            name[token.stringSize] = '\0';
+            hasPendingName = true;
+        }
+        else if (token.tokenType == _SDSF_TOKEN_TYPE_RESERVED_SYMBOL)
+        {
+            const char symbol = token.stringPtr[0];
+            switch (symbol)
+            {
+                case ',':
+                {
+                    if (!scope || scope->type != SDSF_VALUE_ARRAY)
+                    {
+                        reader->errorMsg = "Unexpected ',' character - commas can be used in arrays only";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
+                    }
+                    if (scope->childCount == 0)
+                    {
+                        reader->errorMsg = "Unexpected ',' character - commas must be used only after first array child";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
+                    }
+                    if (isAfterComma)
+                    {
+                        reader->errorMsg = "Unexpected ',' character - can't have multiple commas in a row";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
+                    }
+                } break;
+
+                case ']':
+                case '}':
+                {
+                    const SdsfValueType type = symbol == ']' ? SDSF_VALUE_ARRAY : SDSF_VALUE_COMPOSITE;
+                    if (hasPendingName || !scope || scope->type != type)
+                    {
+                        reader->errorMsg = symbol == ']'
+                            ? "Unexpected ']' character - only arrays can end with this symbol"
+                            : "Unexpected '}' character - only composites can end with this symbol";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
+                    }
+                    reader->scopesSize -= 1;
+
+                    event.type = symbol == ']' ? SDSF_EVENT_ARRAY_END : SDSF_EVENT_COMPOSITE_END;
+                    event.value.type = type;
+                    event.depth = reader->scopesSize;
+                    if (!_sdsf_emit_event(reader, sink, &event))
+                    {
+                        return SDSF_DESERIALIZATION_ERROR_STOPPED_BY_EVENT_SINK;
+                    }
+                } break;
+
+                case '[':
+                case '{':
+                {
+                    if (hasPendingName)
+                    {
+                        event.value.name = (const char*)reader->nameBuffer;
+                        hasPendingName = false;
+                    }
+                    else if (scope && scope->type == SDSF_VALUE_ARRAY)
+                    {
+                        scope->childCount += 1;
+                    }
+                    else
+                    {
+                        reader->errorMsg = symbol == '['
+                            ? "Unexpected '[' character - new array value can be created only after identifier or as child of another array"
+                            : "Unexpected '{' character - new composite value can be created only after identifier or as child of the array";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
+                    }
+
+                    const SdsfValueType type = symbol == '[' ? SDSF_VALUE_ARRAY : SDSF_VALUE_COMPOSITE;
+                    const size_t scopesSizeBytes = reader->scopesSize * sizeof(_SdsfEventReaderScope);
+                    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_STACK);
+                    _sdsf_ensure_buffer_capacity(allocator, &reader->scopes, &reader->scopesCapacity, scopesSizeBytes, sizeof(_SdsfEventReaderScope));
+                    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+                    _SdsfEventReaderScope* const newScope = &((_SdsfEventReaderScope*)reader->scopes)[reader->scopesSize++];
+                    newScope->type = type;
+                    newScope->childCount = 0;
+
+                    event.type = symbol == '[' ? SDSF_EVENT_ARRAY_BEGIN : SDSF_EVENT_COMPOSITE_BEGIN;
+                    event.value.type = type;
+                    if (!_sdsf_emit_event(reader, sink, &event))
+                    {
+                        return SDSF_DESERIALIZATION_ERROR_STOPPED_BY_EVENT_SINK;
+                    }
+                } break;
+
+                case '\"':
+                {
+                    // Nothing
+                } break;
+
+                case '@':
+                {
+                    if (!expectsBinaryDataBlob)
+                    {
+                        reader->errorMsg = "Unexpected binary data blob - no binary literals were used";
+                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_BINARY_DATA_BLOB;
+                    }
+
+                    // Binary data blob is always in the end of file
+                    tokenizerData.stringConsumePtr = tokenizerData.dataSize;
+                } break;
+            }
+        }
+        else
+        {
+            if (hasPendingName)
+            {
+                event.value.name = (const char*)reader->nameBuffer;
+                hasPendingName = false;
+            }
+            else if (scope && scope->type == SDSF_VALUE_ARRAY)
+            {
+                scope->childCount += 1;
+            }
+            else
+            {
+                reader->errorMsg = scope
+                    ? "Unexpected unnamed value. Only arrays can have values without names"
+                    : "Values must be associated with identifier or array";
+                return SDSF_DESERIALIZATION_ERROR_EXPECTED_IDENTIFIER;
+            }
+
+            if (token.tokenType == _SDSF_TOKEN_TYPE_STRING_LITERAL)
+            {
+                _sdsf_ensure_buffer_capacity(allocator, &reader->stringBuffer, &reader->stringBufferCapacity, 0, token.stringSize + 1);
+                char* const string = (char*)reader->stringBuffer;
+                size_t stringSize = token.stringSize;
+                if (!token.hasEscapes)
+                {
+                    memcpy(string, token.stringPtr, token.stringSize);
+                }
+                else if (!_sdsf_unescape_string(token.stringPtr, token.stringSize, string, &stringSize))
                 {
-                    sdsf->errorMsg = "Unexpected identifier - only composite values can have named childs";
-                    return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_IDENTIFIER;
+                    reader->errorMsg = "Invalid string literal - unknown or incomplete escape sequence";
+                    return SDSF_DESERIALIZATION_ERROR_INVALID_STRING_LITERAL;
+                }
+                string[stringSize] = '\0';
+                event.value.asString = string;
+                event.value.type = SDSF_VALUE_STRING;
+                event.stringSize = stringSize;
+            }
+            else
+            {
+                const SdsfDeserializationError literalError = _sdsf_convert_literal(&token, &event.value, &reader->errorMsg);
+                if (literalError)
+                {
+                    return literalError;
+                }
+            }
+
+            if (event.value.type == SDSF_VALUE_BINARY)
+            {
+                if (!expectsBinaryDataBlob)
+                {
+                    expectsBinaryDataBlob = true;
+                    isBinaryDataBlobFound = window
+                        ? _sdsf_input_window_find_binary_data_blob(window, tokenizerData.stringConsumePtr)
+                        : _sdsf_find_binary_data_blob(data, dataSize, tokenizerData.stringConsumePtr, &binaryDataBlobOffset);
+                }
+                const size_t blobSize = dataSize - binaryDataBlobOffset;
+                const size_t offset = event.value.asBinary.dataOffset;
+                if (isBinaryDataBlobFound && window)
+                {
+                    event.binaryData = _sdsf_input_window_binary_data(window, offset, event.value.asBinary.dataSize);
+                }
+                else if (isBinaryDataBlobFound && offset <= blobSize && event.value.asBinary.dataSize <= blobSize - offset)
+                {
+                    event.binaryData = data + binaryDataBlobOffset + offset;
                 }
             }
 
-            SdsfValue* const val = _sdsf_val_array_add(values, &allocator);
-            val->parent = currentValue;
-            val->name = _sdsf_string_array_save(strings, &allocator, token.stringPtr, token.stringSize);
+            event.type = SDSF_EVENT_VALUE;
+            if (!_sdsf_emit_event(reader, sink, &event))
+            {
+                return SDSF_DESERIALIZATION_ERROR_STOPPED_BY_EVENT_SINK;
+            }
+        }
+
+        isAfterComma = token.tokenType == _SDSF_TOKEN_TYPE_RESERVED_SYMBOL && token.stringPtr[0] == ',';
+    }
+
+    if (window && window->error)
+    {
+        reader->errorMsg = window->errorMsg;
+        return window->error;
+    }
+    if (hasPendingName || reader->scopesSize)
+    {
+        reader->errorMsg = "Unexpected end of data - identifier without value or unfinished array or composite";
+        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_END_OF_DATA;
+    }
+
+    return SDSF_DESERIALIZATION_ERROR_ALL_FINE;
+}
+
+void _sdsf_event_reader_reset(SdsfEventReader* reader)
+{
+    const SdsfAllocator allocator = reader->allocator;
+    if (reader->nameBuffer)
+    {
+        allocator.dealloc(reader->nameBuffer, reader->nameBufferCapacity, allocator.userData);
+    }
+    if (reader->stringBuffer)
+    {
+        allocator.dealloc(reader->stringBuffer, reader->stringBufferCapacity, allocator.userData);
+    }
+    if (reader->scopes)
+    {
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_STACK);
+        allocator.dealloc(reader->scopes, reader->scopesCapacity, allocator.userData);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+    }
+
+    const char* const errorMsg = reader->errorMsg;
+    *reader = (SdsfEventReader){0};
+    reader->allocator = allocator;
+    reader->errorMsg = errorMsg;
+}
+
+SdsfDeserializationError sdsf_read_events(SdsfEventReader* reader, const void* data, size_t dataSize, SdsfAllocator allocator, SdsfEventSink sink, uint32_t flags)
+{
+    *reader = (SdsfEventReader){0};
+    reader->allocator = allocator;
+
+    const SdsfDeserializationError error = _sdsf_read_events(reader, (const char*)data, dataSize, sink, flags, NULL);
+    _sdsf_event_reader_reset(reader);
+
+    return error;
+}
+
+SdsfDeserializationError _sdsf_read_events_from_fd(SdsfEventReader* reader, int fd, size_t windowSize, const SdsfCodec* codec, SdsfAllocator allocator, SdsfEventSink sink, uint32_t flags)
+{
+    *reader = (SdsfEventReader){0};
+    reader->allocator = allocator;
+
+    _SdsfInputWindow window = {0};
+    window.allocator = allocator;
+#ifdef _WIN32
+    window.file = (HANDLE)_get_osfhandle(fd);
+#else
+    window.file = fd;
+#endif
+    window.dataOffset = _sdsf_file_position(window.file);
+    window.capacity = windowSize ? windowSize : SDSF_EVENT_READER_WINDOW_SIZE;
+    window.data = (char*)allocator.alloc(window.capacity, allocator.userData);
+
+    SdsfDeserializationError error = SDSF_DESERIALIZATION_ERROR_ALL_FINE;
+    _SdsfDecoder decoder = {0};
+    if (codec)
+    {
+        // Offsets of compressed file are offsets in decompressed data
+        _sdsf_decoder_begin(&decoder, &window.allocator, *codec, window.file, false, window.dataOffset);
+        window.decoder = &decoder;
+        window.streamOffset = window.dataOffset;
+        window.dataOffset = 0;
+
+        char magic[_SDSF_CODEC_MAGIC_SIZE];
+        if (!_sdsf_decoder_read_file(&decoder, magic, sizeof(magic)))
+        {
+            reader->errorMsg = decoder.errorMsg;
+            error = decoder.error;
+        }
+        else if (memcmp(magic, _SDSF_CODEC_MAGIC, sizeof(magic)) != 0)
+        {
+            reader->errorMsg = "Compressed data is corrupted - data was not written by SdsfCompressor";
+            error = SDSF_DESERIALIZATION_ERROR_DECOMPRESSION_FAILED;
+        }
+        decoder.fileOffset = decoder.nextFileOffset;
+    }
+
+    if (!error)
+    {
+        error = _sdsf_read_events(reader, window.data, 0, sink, flags, &window);
+    }
+    _sdsf_event_reader_reset(reader);
+
+    allocator.dealloc(window.data, window.capacity, allocator.userData);
+    if (window.binaryBuffer)
+    {
+        allocator.dealloc(window.binaryBuffer, window.binaryBufferCapacity, allocator.userData);
+    }
+    if (window.blobFrames)
+    {
+        allocator.dealloc(window.blobFrames, window.blobFramesCapacity, allocator.userData);
+    }
+    _sdsf_decoder_end(&window.blobDecoder, &window.allocator);
+    _sdsf_decoder_end(&decoder, &window.allocator);
+
+    return error;
+}
+
+SdsfDeserializationError sdsf_read_events_from_fd(SdsfEventReader* reader, int fd, size_t windowSize, SdsfAllocator allocator, SdsfEventSink sink, uint32_t flags)
+{
+    return _sdsf_read_events_from_fd(reader, fd, windowSize, NULL, allocator, sink, flags);
+}
+
+SdsfDeserializationError sdsf_read_compressed_events_from_fd(SdsfEventReader* reader, int fd, size_t windowSize, SdsfCodec codec, SdsfAllocator allocator, SdsfEventSink sink, uint32_t flags)
+{
+    return _sdsf_read_events_from_fd(reader, fd, windowSize, &codec, allocator, sink, flags);
+}
+
+// ==============================================================================================================
+//
+//
+// Serializer
+//
+//
+// ==============================================================================================================
+
+void _sdsf_push_to_stack(SdsfSerializer* sdsf, _SdsfSerializerStackEntry entry)
+{
+    if (sdsf->stackSize >= sdsf->stackCapacity)
+    {
+        const size_t newCapacity = sdsf->stackCapacity * 2;
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_STACK);
+        _SdsfSerializerStackEntry* const newMem = (_SdsfSerializerStackEntry*)sdsf->allocator.alloc(sizeof(_SdsfSerializerStackEntry) * newCapacity, sdsf->allocator.userData);
+        memcpy(newMem, sdsf->stack, sizeof(_SdsfSerializerStackEntry) * sdsf->stackCapacity);
+        sdsf->allocator.dealloc(sdsf->stack, sizeof(_SdsfSerializerStackEntry) * sdsf->stackCapacity, sdsf->allocator.userData);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+        sdsf->stack = newMem;
+        sdsf->stackCapacity = newCapacity;
+    }
+    sdsf->stack[sdsf->stackSize++] = entry;
+}
+
+static inline _SdsfSerializerStackEntry _sdsf_pop_from_stack(SdsfSerializer* sdsf)
+{
+    return sdsf->stackSize ? sdsf->stack[--sdsf->stackSize] : _SDSF_SERIALIZER_IN_NOTHING;
+}
+
+static inline _SdsfSerializerStackEntry _sdsf_peek_stack(SdsfSerializer* sdsf)
+{
+    if (sdsf->stackSize)
+    {
+        return sdsf->stack[sdsf->stackSize - 1];
+    }
+    else
+    {
+        return _SDSF_SERIALIZER_IN_NOTHING;
+    }
+}
+
+//
+// Streaming serializer writes main buffer to the output when it is full, so main buffer never grows
+// (unless single push is bigger than the whole buffer)
+//
+void _sdsf_flush_main_buffer(SdsfSerializer* sdsf)
+{
+    if (sdsf->mainBufferSize && !sdsf->isOutputFailed)
+    {
+        sdsf->isOutputFailed = !sdsf->output.write(sdsf->mainBuffer, sdsf->mainBufferSize, sdsf->output.userData);
+    }
+    sdsf->mainBufferSize = 0;
+}
+
+//
+// Mapped main buffer starts from SDSF_SERIALIZER_MAIN_BUFFER_DEFAULT_CAPACITY rounded up to page size and doubles, but doesn't grow
+// by more than SDSF_SERIALIZER_MAPPED_FILE_GROWTH at once (unless a single push needs more). If file can't be grown, nothing is written
+// anymore (error is reported by sdsf_serializer_end)
+//
+bool _sdsf_grow_mapped_main_buffer(SdsfSerializer* sdsf, size_t dataSize)
+{
+    _SdsfMappedOutput* const output = (_SdsfMappedOutput*)sdsf->mappedOutput;
+    if (!output->isOpen)
+    {
+        return false;
+    }
+
+    const size_t pageSize = _sdsf_page_size();
+    const size_t requiredCapacity = sdsf->mainBufferSize + dataSize;
+    const size_t growth = sdsf->mainBufferCapacity < SDSF_SERIALIZER_MAPPED_FILE_GROWTH ? sdsf->mainBufferCapacity : SDSF_SERIALIZER_MAPPED_FILE_GROWTH;
+    size_t newCapacity = sdsf->mainBufferCapacity ? sdsf->mainBufferCapacity + growth : SDSF_SERIALIZER_MAIN_BUFFER_DEFAULT_CAPACITY;
+    newCapacity = newCapacity > requiredCapacity ? newCapacity : requiredCapacity;
+    newCapacity = (newCapacity + pageSize - 1) / pageSize * pageSize;
+    if (!_sdsf_mapped_output_resize(output, &sdsf->mainBuffer, sdsf->mainBufferCapacity, newCapacity))
+    {
+        _sdsf_mapped_output_close(output, sdsf->mainBuffer, sdsf->mainBufferCapacity, 0);
+        sdsf->mainBuffer = NULL;
+        sdsf->mainBufferCapacity = 0;
+        sdsf->mainBufferSize = 0;
+        sdsf->isOutputFailed = true;
+        return false;
+    }
+    sdsf->mainBufferCapacity = newCapacity;
+    return true;
+}
+
+static inline void _sdsf_push_to_main_buffer(SdsfSerializer* sdsf, const void* data, size_t dataSize)
+{
+    if (sdsf->output.write && (sdsf->mainBufferCapacity - sdsf->mainBufferSize) < dataSize)
+    {
+        _sdsf_flush_main_buffer(sdsf);
+    }
+    if (sdsf->mappedOutput)
+    {
+        if ((sdsf->mainBufferCapacity - sdsf->mainBufferSize) < dataSize && !_sdsf_grow_mapped_main_buffer(sdsf, dataSize))
+        {
+            return;
+        }
+    }
+    else
+    {
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_SERIALIZER_BUFFERS);
+        _sdsf_ensure_buffer_capacity(&sdsf->allocator, &sdsf->mainBuffer, &sdsf->mainBufferCapacity, sdsf->mainBufferSize, dataSize);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+    }
+    char* const buffer = ((char*)sdsf->mainBuffer) + sdsf->mainBufferSize;
+    memcpy(buffer, data, dataSize);
+    sdsf->mainBufferSize += dataSize;
+}
+
+static inline void _sdsf_push_to_binary_buffer(SdsfSerializer* sdsf, const void* data, size_t dataSize)
+{
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_SERIALIZER_BUFFERS);
+    _sdsf_ensure_buffer_capacity(&sdsf->allocator, &sdsf->binaryDataBuffer, &sdsf->binaryDataBufferCapacity, sdsf->binaryDataBufferSize, dataSize);
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+    void* const buffer = ((char*)sdsf->binaryDataBuffer) + sdsf->binaryDataBufferSize;
+    memcpy(buffer, data, dataSize);
+    sdsf->binaryDataBufferSize += dataSize;
+}
+
+static inline void _sdsf_push_indent(SdsfSerializer* sdsf)
+{
+    for (size_t it = 0; it < sdsf->stackSize; it++)
+    {
+        _sdsf_push_to_main_buffer(sdsf, _SDSF_INDENT, _SDSF_INDENT_SIZE);
+    }
+}
+
+static inline SdsfSerializationError _sdsf_begin_value(SdsfSerializer* sdsf, const char* name)
+{
+    const bool isInArray = _sdsf_peek_stack(sdsf) == _SDSF_SERIALIZER_IN_ARRAY;
+    if (!isInArray && !name)
+    {
+        sdsf->errorMsg = "Only arrays can have unnamed children";
+        return SDSF_SERIALIZATION_ERROR_NO_NAME_PROVIDED;
+    }
+
+    if (name && _sdsf_is_number(name[0]))
+    {
+        sdsf->errorMsg = "Indentifiers can't start with number";
+        return SDSF_SERIALIZATION_ERROR_INVALID_NAME;
+    }
+
+    const size_t nameLength = name ? strlen(name) : 0;
+    if (name && nameLength < 2)
+    {
+        sdsf->errorMsg = "Identifiers must have at least two characters, single characters are read as bool or int literals";
+        return SDSF_SERIALIZATION_ERROR_INVALID_NAME;
+    }
+    for (size_t it = 0; it < nameLength; it++)
+    {
+        const char c = name[it];
+        if (_sdsf_is_skipped_char(c) || _sdsf_is_reserved_symbol(c))
+        {
+            sdsf->errorMsg = "Identifiers can't have special or skip-characters";
+            return SDSF_SERIALIZATION_ERROR_INVALID_NAME;
+        }
+        if (c == '.' || c == '-')
+        {
+            sdsf->errorMsg = "Identifiers can't have '.' and ',' characters";
+            return SDSF_SERIALIZATION_ERROR_INVALID_NAME;
+        }
+        if (c == '\0')
+        {
+            sdsf->errorMsg = "Identifiers can't have '\\0' characters";
+            return SDSF_SERIALIZATION_ERROR_INVALID_NAME;
+        }
+    }
+
+    _sdsf_push_indent(sdsf);
+    if (!isInArray)
+    {
+        _sdsf_push_to_main_buffer(sdsf, name, nameLength);
+        _sdsf_push_to_main_buffer(sdsf, " ", 1);
+    }
+
+    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+}
+
+static inline void _sdsf_end_value(SdsfSerializer* sdsf)
+{
+    if (_sdsf_peek_stack(sdsf) == _SDSF_SERIALIZER_IN_ARRAY)
+    {
+        _sdsf_push_to_main_buffer(sdsf, ",\r\n", 3);
+    }
+    else
+    {
+        _sdsf_push_to_main_buffer(sdsf, "\r\n", 2);
+    }
+}
+
+SdsfSerializer sdsf_serializer_begin(SdsfAllocator allocator)
+{
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_SERIALIZER_BUFFERS);
+    char* const stagingBuffer1 = (char*)allocator.alloc(SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, allocator.userData);
+    char* const stagingBuffer2 = (char*)allocator.alloc(SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, allocator.userData);
+    void* const buffer = allocator.alloc(SDSF_SERIALIZER_MAIN_BUFFER_DEFAULT_CAPACITY, allocator.userData);
+    void* const binaryDataBuffer = allocator.alloc(SDSF_SERIALIZER_BINARY_DATA_BUFFER_DEFAULT_CAPACITY, allocator.userData);
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_STACK);
+    _SdsfSerializerStackEntry* const stack = (_SdsfSerializerStackEntry*)allocator.alloc(sizeof(_SdsfSerializerStackEntry) * SDSF_SERIALIZER_STACK_DEFAULT_CAPACITY, allocator.userData);
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+
+    SdsfSerializer result = {0};
+    result.allocator                = allocator;
+    result.stagingBuffer1           = stagingBuffer1;
+    result.stagingBuffer2           = stagingBuffer2;
+    result.stack                    = stack;
+    result.stackSize                = 0;
+    result.stackCapacity            = SDSF_SERIALIZER_STACK_DEFAULT_CAPACITY;
+    result.binaryDataBuffer         = binaryDataBuffer;
+    result.binaryDataBufferSize     = 0;
+    result.binaryDataBufferCapacity = SDSF_SERIALIZER_BINARY_DATA_BUFFER_DEFAULT_CAPACITY;
+    result.mainBuffer               = buffer;
+    result.mainBufferSize           = 0;
+    result.mainBufferCapacity       = SDSF_SERIALIZER_MAIN_BUFFER_DEFAULT_CAPACITY;
+    return result;
+}
+
+SdsfSerializer sdsf_serializer_begin_streaming(SdsfAllocator allocator, SdsfOutputSink output)
+{
+    SdsfSerializer result = sdsf_serializer_begin(allocator);
+    result.output = output;
+    return result;
+}
+
+SdsfSerializer sdsf_serializer_begin_mapped(SdsfAllocator allocator, const char* path)
+{
+    SdsfSerializer result = sdsf_serializer_begin(allocator);
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_SERIALIZER_BUFFERS);
+    allocator.dealloc(result.mainBuffer, result.mainBufferCapacity, allocator.userData);
+    result.mainBuffer = NULL;
+    result.mainBufferCapacity = 0;
+
+    // File is mapped on the first write
+    _SdsfMappedOutput* const output = (_SdsfMappedOutput*)allocator.alloc(sizeof(_SdsfMappedOutput), allocator.userData);
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+    result.mappedOutput = output;
+    result.isOutputFailed = !_sdsf_mapped_output_open(output, path);
+    return result;
+}
+
+SdsfSerializationError sdsf_serialize_bool(SdsfSerializer* sdsf, const char* name, bool value)
+{
+    const SdsfSerializationError beginValueError = _sdsf_begin_value(sdsf, name);
+    if (beginValueError)
+    {
+        return beginValueError;
+    }
+    
+    _sdsf_push_to_main_buffer(sdsf, value ? "t" : "f", 1);
+    _sdsf_end_value(sdsf);
+
+    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+}
+
+SdsfSerializationError _sdsf_serialize_literal(SdsfSerializer* sdsf, const char* name, const char* literal, size_t literalSize)
+{
+    const SdsfSerializationError beginValueError = _sdsf_begin_value(sdsf, name);
+    if (beginValueError)
+    {
+        return beginValueError;
+    }
+
+    _sdsf_push_to_main_buffer(sdsf, literal, literalSize);
+    _sdsf_end_value(sdsf);
+
+    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+}
+
+SdsfSerializationError sdsf_serialize_int(SdsfSerializer* sdsf, const char* name, int32_t value)
+{
+    const size_t written = _sdsf_format_int64(sdsf->stagingBuffer1, value);
+    return _sdsf_serialize_literal(sdsf, name, sdsf->stagingBuffer1, written);
+}
+
+SdsfSerializationError sdsf_serialize_int64(SdsfSerializer* sdsf, const char* name, int64_t value)
+{
+    size_t written = _sdsf_format_int64(sdsf->stagingBuffer1, value);
+    sdsf->stagingBuffer1[written++] = 'l';
+    return _sdsf_serialize_literal(sdsf, name, sdsf->stagingBuffer1, written);
+}
+
+SdsfSerializationError sdsf_serialize_uint64(SdsfSerializer* sdsf, const char* name, uint64_t value)
+{
+    size_t written = _sdsf_format_uint64(sdsf->stagingBuffer1, value);
+    sdsf->stagingBuffer1[written++] = 'u';
+    return _sdsf_serialize_literal(sdsf, name, sdsf->stagingBuffer1, written);
+}
+
+SdsfSerializationError sdsf_serialize_float(SdsfSerializer* sdsf, const char* name, float value)
+{
+    if (sdsf->flags & SDSF_SERIALIZER_FLAG_HEX_FLOATS)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(float));
+        const size_t written = _sdsf_format_hex_float(sdsf->stagingBuffer1, bits, false);
+        return _sdsf_serialize_literal(sdsf, name, sdsf->stagingBuffer1, written);
+    }
+
+    if (value != value || value - value != 0.0f || SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY < _SDSF_FLOAT_STRING_CAPACITY)
+    {
+        sdsf->errorMsg = "Unable to convert float to string. Value must be finite. Consider increasing SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY";
+        return SDSF_SERIALIZATION_ERROR_UNABLE_TO_CONVERT_VALUE_TO_STRING;
+    }
+
+    const size_t written = _sdsf_format_float(sdsf->stagingBuffer1, value);
+    return _sdsf_serialize_literal(sdsf, name, sdsf->stagingBuffer1, written);
+}
+
+SdsfSerializationError sdsf_serialize_double(SdsfSerializer* sdsf, const char* name, double value)
+{
+    if (sdsf->flags & SDSF_SERIALIZER_FLAG_HEX_FLOATS)
+    {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(double));
+        size_t written = _sdsf_format_hex_float(sdsf->stagingBuffer1, bits, true);
+        sdsf->stagingBuffer1[written++] = 'd';
+        return _sdsf_serialize_literal(sdsf, name, sdsf->stagingBuffer1, written);
+    }
+
+    if (value != value || value - value != 0.0 || SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY < _SDSF_FLOAT_STRING_CAPACITY + 1)
+    {
+        sdsf->errorMsg = "Unable to convert double to string. Value must be finite. Consider increasing SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY";
+        return SDSF_SERIALIZATION_ERROR_UNABLE_TO_CONVERT_VALUE_TO_STRING;
+    }
+
+    size_t written = _sdsf_format_double(sdsf->stagingBuffer1, value);
+    sdsf->stagingBuffer1[written++] = 'd';
+    return _sdsf_serialize_literal(sdsf, name, sdsf->stagingBuffer1, written);
+}
+
+SdsfSerializationError sdsf_serialize_string(SdsfSerializer* sdsf, const char* name, const char* value)
+{
+    if (!value)
+    {
+        sdsf->errorMsg = "Unable to serialize string - value is null";
+        return SDSF_SERIALIZATION_ERROR_NO_VALUE_PROVIDED;
+    }
+
+    const SdsfSerializationError beginValueError = _sdsf_begin_value(sdsf, name);
+    if (beginValueError)
+    {
+        return beginValueError;
+    }
+
+    _sdsf_push_to_main_buffer(sdsf, "\"", 1);
+    const size_t valueLength = strlen(value);
+    size_t it = 0;
+    while (it < valueLength)
+    {
+        // Only '"' and '\\' characters must be escaped, everything in between is written as is
+        const size_t plainSize = _sdsf_find_quote_or_backslash(value + it, valueLength - it);
+        _sdsf_push_to_main_buffer(sdsf, value + it, plainSize);
+        it += plainSize;
+        if (it < valueLength)
+        {
+            _sdsf_push_to_main_buffer(sdsf, value[it] == '\"' ? "\\\"" : "\\\\", 2);
+            it += 1;
+        }
+    }
+    _sdsf_push_to_main_buffer(sdsf, "\"", 1);
+    _sdsf_end_value(sdsf);
+
+    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+}
+
+//
+// Writes string literal which is already escaped (used by transcoder, json strings have the same escape sequences)
+//
+SdsfSerializationError _sdsf_serialize_escaped_string(SdsfSerializer* sdsf, const char* name, const char* value, size_t valueSize)
+{
+    const SdsfSerializationError beginValueError = _sdsf_begin_value(sdsf, name);
+    if (beginValueError)
+    {
+        return beginValueError;
+    }
+
+    _sdsf_push_to_main_buffer(sdsf, "\"", 1);
+    _sdsf_push_to_main_buffer(sdsf, value, valueSize);
+    _sdsf_push_to_main_buffer(sdsf, "\"", 1);
+    _sdsf_end_value(sdsf);
+
+    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+}
+
+SdsfSerializationError _sdsf_serialize_binary(SdsfSerializer* sdsf, const char* name, SdsfBinaryElementType type, const void* value, size_t size)
+{
+    //
+    // Typed binary values are aligned to the element size, so they can be accessed in place after deserialization
+    //
+    const size_t elementSize = _SDSF_BINARY_ELEMENT_TYPE_SIZES[type];
+    const size_t padding = (elementSize - (sdsf->binaryDataBufferSize % elementSize)) % elementSize;
+    const size_t from = sdsf->binaryDataBufferSize + padding;
+    const size_t to = from + size;
+
+    const int written1 = snprintf(sdsf->stagingBuffer1, SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, "%zu", from);
+    if (written1 < 0 || written1 >= SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY)
+    {
+        sdsf->errorMsg = "Unable to convert first binary offset to string. Consider increasing SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY";
+        return SDSF_SERIALIZATION_ERROR_UNABLE_TO_CONVERT_VALUE_TO_STRING;
+    }
+
+    const int written2 = snprintf(sdsf->stagingBuffer2, SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, "%zu", to);
+    if (written2 < 0 || written2 >= SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY)
+    {
+        sdsf->errorMsg = "Unable to convert second binary offset to string. Consider increasing SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY";
+        return SDSF_SERIALIZATION_ERROR_UNABLE_TO_CONVERT_VALUE_TO_STRING;
+    }
+
+    const SdsfSerializationError beginValueError = _sdsf_begin_value(sdsf, name);
+    if (beginValueError)
+    {
+        return beginValueError;
+    }
+
+    if (padding)
+    {
+        const uint64_t zeros = 0;
+        _sdsf_push_to_binary_buffer(sdsf, &zeros, padding);
+    }
+    if (value && size)
+    {
+        _sdsf_push_to_binary_buffer(sdsf, value, size);
+    }
+
+    _sdsf_push_to_main_buffer(sdsf, "b", 1);
+    if (type != SDSF_BINARY_RAW)
+    {
+        const char* const tag = _SDSF_BINARY_ELEMENT_TYPE_TAGS[type];
+        _sdsf_push_to_main_buffer(sdsf, tag, strlen(tag));
+        if (elementSize > 1 && _sdsf_is_big_endian_host())
+        {
+            _sdsf_push_to_main_buffer(sdsf, "be", 2);
+        }
+        _sdsf_push_to_main_buffer(sdsf, ":", 1);
+    }
+    _sdsf_push_to_main_buffer(sdsf, sdsf->stagingBuffer1, (size_t)written1);
+    _sdsf_push_to_main_buffer(sdsf, "-", 1);
+    _sdsf_push_to_main_buffer(sdsf, sdsf->stagingBuffer2, (size_t)written2);
+    _sdsf_end_value(sdsf);
+
+    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+}
 
-            if (currentValue)
-            {
-                SdsfValue** const ptr = _sdsf_val_ptr_array_add(&currentValue->asComposite.childs, &allocator);
-                *ptr = val;
-            }
-            else
-            {
-                SdsfValue** const ptr = _sdsf_val_ptr_array_add(topLevelValues, &allocator);
-                *ptr = val;
-            }
-            
-            currentValue = val;
-        }
-        else if (token.tokenType == _SDSF_TOKEN_TYPE_RESERVED_SYMBOL)
-        {
-            switch (token.stringPtr[0])
-            {
-                case ',':
-                {
-                    if (!currentValue || currentValue->type != SDSF_VALUE_ARRAY)
-                    {
-                        sdsf->errorMsg = "Unexpected ',' character - commas can be used in arrays only";
-                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
-                    }
-                    if (currentValue->asArray.childs.size == 0)
-                    {
-                        sdsf->errorMsg = "Unexpected ',' character - commas must be used only after first array child";
-                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
-                    }
-                    if (previousToken.tokenType == _SDSF_TOKEN_TYPE_RESERVED_SYMBOL && previousToken.stringPtr[0] == ',')
-                    {
-                        sdsf->errorMsg = "Unexpected ',' character - can't have multiple commas in a row";
-                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
-                    }
-                    // @NOTE : comma doesn't allocate new values, new value is allocated when processing literals or creating composites/arrays
-                } break;
+SdsfSerializationError sdsf_serialize_binary(SdsfSerializer* sdsf, const char* name, const void* value, size_t size)
+{
+    return _sdsf_serialize_binary(sdsf, name, SDSF_BINARY_RAW, value, size);
+}
 
-                case ']':
-                {
-                    if (!currentValue || currentValue->type != SDSF_VALUE_ARRAY)
-                    {
-                        sdsf->errorMsg = "Unexpected ']' character - only arrays can end with this symbol";
-                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
-                    }
-                    currentValue = currentValue->parent;
-                } break;
+SdsfSerializationError _sdsf_serialize_binary_elements(SdsfSerializer* sdsf, const char* name, SdsfBinaryElementType type, const void* values, size_t count)
+{
+    const size_t elementSize = _SDSF_BINARY_ELEMENT_TYPE_SIZES[type];
+    if (count > SIZE_MAX / elementSize)
+    {
+        sdsf->errorMsg = "Binary value size in bytes doesn't fit into size_t";
+        return SDSF_SERIALIZATION_ERROR_INVALID_BINARY;
+    }
+    return _sdsf_serialize_binary(sdsf, name, type, values, count * elementSize);
+}
 
-                case '}':
-                {
-                    if (!currentValue || currentValue->type != SDSF_VALUE_COMPOSITE)
-                    {
-                        sdsf->errorMsg = "Unexpected '}' character - only composites can end with this symbol";
-                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
-                    }
-                    currentValue = currentValue->parent;
-                } break;
+SdsfSerializationError sdsf_serialize_binary_typed(SdsfSerializer* sdsf, const char* name, SdsfBinaryElementType type, const void* values, size_t count)
+{
+    if ((uint32_t)type > SDSF_BINARY_F64)
+    {
+        sdsf->errorMsg = "Invalid binary element type";
+        return SDSF_SERIALIZATION_ERROR_INVALID_BINARY;
+    }
+    return _sdsf_serialize_binary_elements(sdsf, name, type, values, count);
+}
 
-                case '[':
-                {
-                    if (!currentValue)
-                    {
-                        sdsf->errorMsg = "Unexpected '[' character - new array value can be created only after identifier or as child of another array";
-                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
-                    }
-                    if (currentValue->type == SDSF_VALUE_UNDEFINED)
-                    {
-                        // Array with an identifier
-                        currentValue->type = SDSF_VALUE_ARRAY;
-                    }
-                    else if (currentValue->type == SDSF_VALUE_ARRAY)
-                    {
-                        // Array in array
-                        SdsfValue* const newChild = _sdsf_val_array_add(values, &allocator);
-                        SdsfValue** const newChildPtr = _sdsf_val_ptr_array_add(&currentValue->asArray.childs, &allocator);
-                        *newChildPtr = newChild;
-                        newChild->parent = currentValue;
-                        currentValue = newChild;
-                        currentValue->type = SDSF_VALUE_ARRAY;
-                    }
-                    else
-                    {
-                        sdsf->errorMsg = "New array value can be created only after identifier or in the another array";
-                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
-                    }
-                } break;
+#define _SDSF_DEFINE_BINARY_SERIALIZER(suffix, cType, elementType)                                                          \
+    SdsfSerializationError sdsf_serialize_binary_##suffix(SdsfSerializer* sdsf, const char* name, const cType* values, size_t count) \
+    {                                                                                                                       \
+        return _sdsf_serialize_binary_elements(sdsf, name, elementType, values, count);                                     \
+    }
 
-                case '{':
-                {
-                    if (!currentValue)
-                    {
-                        sdsf->errorMsg = "Unexpected '[' character - new composite value can be created only after identifier or as child of the array";
-                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
-                    }
-                    if (currentValue->type == SDSF_VALUE_UNDEFINED)
-                    {
-                        // Composite with an identifier
-                        currentValue->type = SDSF_VALUE_COMPOSITE;
-                    }
-                    else if (currentValue->type == SDSF_VALUE_ARRAY)
-                    {
-                        // Composite in an array
-                        SdsfValue* const newChild = _sdsf_val_array_add(values, &allocator);
-                        SdsfValue** const newChildPtr = _sdsf_val_ptr_array_add(&currentValue->asArray.childs, &allocator);
-                        *newChildPtr = newChild;
-                        newChild->parent = currentValue;
-                        currentValue = newChild;
-                        currentValue->type = SDSF_VALUE_COMPOSITE;
-                    }
-                    else
-                    {
-                        sdsf->errorMsg = "Unexpected '[' character - new composite value can be created only after identifier or as child of the array";
-                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_RESERVED_SYMBOL;
-                    }
-                } break;
+_SDSF_DEFINE_BINARY_SERIALIZER(u8,  uint8_t,  SDSF_BINARY_U8)
+_SDSF_DEFINE_BINARY_SERIALIZER(i8,  int8_t,   SDSF_BINARY_I8)
+_SDSF_DEFINE_BINARY_SERIALIZER(u16, uint16_t, SDSF_BINARY_U16)
+_SDSF_DEFINE_BINARY_SERIALIZER(i16, int16_t,  SDSF_BINARY_I16)
+_SDSF_DEFINE_BINARY_SERIALIZER(u32, uint32_t, SDSF_BINARY_U32)
+_SDSF_DEFINE_BINARY_SERIALIZER(i32, int32_t,  SDSF_BINARY_I32)
+_SDSF_DEFINE_BINARY_SERIALIZER(u64, uint64_t, SDSF_BINARY_U64)
+_SDSF_DEFINE_BINARY_SERIALIZER(i64, int64_t,  SDSF_BINARY_I64)
+_SDSF_DEFINE_BINARY_SERIALIZER(f32, float,    SDSF_BINARY_F32)
+_SDSF_DEFINE_BINARY_SERIALIZER(f64, double,   SDSF_BINARY_F64)
 
-                case '\"':
-                {
-                    // Nothing
-                } break;
+#undef _SDSF_DEFINE_BINARY_SERIALIZER
 
-                case '@':
-                {
-                    if (!expectsBinaryDataBlob)
-                    {
-                        sdsf->errorMsg = "Unexpected binary data blob - no binary literals were used";
-                        return SDSF_DESERIALIZATION_ERROR_UNEXPECTED_BINARY_DATA_BLOB;
-                    }
+SdsfSerializationError _sdsf_serialize_tensor_rec(SdsfSerializer* sdsf, const char* name, SdsfValueType elementType, const uint8_t** values, const size_t* shape, size_t rank)
+{
+    const SdsfSerializationError arrayError = sdsf_serialize_array_start(sdsf, name);
+    if (arrayError)
+    {
+        return arrayError;
+    }
 
-                    const size_t binaryDataSize = tokenizerData.dataSize - tokenizerData.stringConsumePtr;
-                    if (binaryDataSize)
-                    {
-                        void* const memory = allocator.alloc(binaryDataSize, allocator.userData);
-                        sdsf->binaryData = memory;
-                        sdsf->binaryDataSize = binaryDataSize;
-                        const void* const from = tokenizerData.data + tokenizerData.stringConsumePtr;
-                        memcpy(memory, from, binaryDataSize);
-                    }
+    const size_t elementSize = _sdsf_packed_element_size(elementType);
+    for (size_t it = 0; it < shape[0]; it++)
+    {
+        if (rank > 1)
+        {
+            _sdsf_serialize_tensor_rec(sdsf, NULL, elementType, values, shape + 1, rank - 1);
+            continue;
+        }
 
-                    // Binary data blob is always in the end of file
-                    shouldRun = false;
-                } break;
-            }
+        // Values are copied because tensor data is not required to be aligned
+        SdsfValue element;
+        memcpy(&element.asInt64, *values, elementSize);
+        *values += elementSize;
+        switch (elementType)
+        {
+            case SDSF_VALUE_INT:    sdsf_serialize_int(sdsf, NULL, element.asInt); break;
+            case SDSF_VALUE_FLOAT:  sdsf_serialize_float(sdsf, NULL, element.asFloat); break;
+            case SDSF_VALUE_INT64:  sdsf_serialize_int64(sdsf, NULL, element.asInt64); break;
+            case SDSF_VALUE_UINT64: sdsf_serialize_uint64(sdsf, NULL, element.asUint64); break;
+            case SDSF_VALUE_DOUBLE: sdsf_serialize_double(sdsf, NULL, element.asDouble); break;
+            default: break;
         }
-        else
+    }
+
+    return sdsf_serialize_array_end(sdsf);
+}
+
+SdsfSerializationError sdsf_serialize_tensor(SdsfSerializer* sdsf, const char* name, SdsfValueType elementType, const void* values, const size_t* shape, size_t rank)
+{
+    if (!_sdsf_packed_element_size(elementType) || !shape || !rank)
+    {
+        sdsf->errorMsg = "Tensor must have int, float, int64, uint64 or double element type and at least one dimension";
+        return SDSF_SERIALIZATION_ERROR_INVALID_TENSOR;
+    }
+
+    const size_t count = _sdsf_tensor_count(shape, rank);
+    if (count && !values)
+    {
+        sdsf->errorMsg = "Tensor values are not provided";
+        return SDSF_SERIALIZATION_ERROR_NO_VALUE_PROVIDED;
+    }
+
+    //
+    // All checks are done before anything is written, so failed call doesn't leave unfinished arrays
+    //
+    if (elementType == SDSF_VALUE_DOUBLE)
+    {
+        for (size_t it = 0; it < count; it++)
         {
-            if (!currentValue)
+            double value;
+            memcpy(&value, ((const uint8_t*)values) + it * sizeof(double), sizeof(double));
+            if (value != value || value - value != 0.0)
             {
-                sdsf->errorMsg = "Values must be associated with identifier or array";
-                return SDSF_DESERIALIZATION_ERROR_EXPECTED_IDENTIFIER;
+                sdsf->errorMsg = "Unable to convert double to string. Value must be finite";
+                return SDSF_SERIALIZATION_ERROR_UNABLE_TO_CONVERT_VALUE_TO_STRING;
             }
+        }
+    }
 
-            SdsfValue* valueToUpdate = NULL;
-            if (currentValue->type == SDSF_VALUE_ARRAY)
-            {
-                valueToUpdate = _sdsf_val_array_add(values, &allocator);
-                valueToUpdate->parent = currentValue;
-                SdsfValue** const ptr = _sdsf_val_ptr_array_add(&currentValue->asArray.childs, &allocator);
-                *ptr = valueToUpdate;
-            }
-            else
-            {
-                if (!currentValue->name)
-                {
-                    sdsf->errorMsg = "Unexpected unnamed value. Only arrays can have values without names";
-                    return SDSF_DESERIALIZATION_ERROR_EXPECTED_IDENTIFIER;
-                }
-                valueToUpdate = currentValue;
-                currentValue = currentValue->parent;
-            }
+    const uint8_t* valuesPtr = (const uint8_t*)values;
+    return _sdsf_serialize_tensor_rec(sdsf, name, elementType, &valuesPtr, shape, rank);
+}
 
-            switch (token.tokenType)
-            {
-                case _SDSF_TOKEN_TYPE_BOOL_LITERAL:
-                {
-                    valueToUpdate->asBool = token.stringPtr[0] == 't' ? true : false;
-                    valueToUpdate->type = SDSF_VALUE_BOOL;
-                } break;
-                case _SDSF_TOKEN_TYPE_INT_LITERAL:
-                {
-                    valueToUpdate->asInt = atoi(token.stringPtr);
-                    valueToUpdate->type = SDSF_VALUE_INT;
-                } break;
-                case _SDSF_TOKEN_TYPE_FLOAT_LITERAL:
-                {
-                    valueToUpdate->asFloat = (float)atof(token.stringPtr);
-                    valueToUpdate->type = SDSF_VALUE_FLOAT;
-                } break;
-                case _SDSF_TOKEN_TYPE_BINARY_LITERAL:
-                {
-                    //
-                    // If tokenizer produces _SDSF_TOKEN_TYPE_BINARY_LITERAL token that means:
-                    //  - string starts with 'b' character, so we can skip it
-                    //  - string has only one dash '-' symbol
-                    //  - string has two numbers divided by the dash
-                    //  - string size is at leas 4 characters (minimum binary literal is b0-0)
-                    //
-                    const char* string = token.stringPtr;
-                    const size_t from = strtoull(&string[1], NULL, 10);
-                    for (size_t it = 1; it < token.stringSize; it++)
-                    {
-                        if (string[it] == '-')
-                        {
-                            string = &string[it + 1];
-                        }
-                    }
-                    const size_t to = strtoull(string, NULL, 10);
+SdsfSerializationError sdsf_serialize_array_start(SdsfSerializer* sdsf, const char* name)
+{
+    const SdsfSerializationError beginValueError = _sdsf_begin_value(sdsf, name);
+    if (beginValueError)
+    {
+        return beginValueError;
+    }
+
+    _sdsf_push_to_main_buffer(sdsf, "[\r\n", 3);
+    _sdsf_push_to_stack(sdsf, _SDSF_SERIALIZER_IN_ARRAY);
+
+    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+}
+
+SdsfSerializationError sdsf_serialize_array_end(SdsfSerializer* sdsf)
+{
+    const _SdsfSerializerStackEntry entry = _sdsf_pop_from_stack(sdsf);
+    if (entry != _SDSF_SERIALIZER_IN_ARRAY)
+    {
+        sdsf->errorMsg = "Trying to end array, but currently serializer is in another state (in composite, or not in anyrhing)";
+        return SDSF_SERIALIZATION_ERROR_UNABLE_TO_END_ARRAY;
+    }
+
+    _sdsf_push_indent(sdsf);
+    _sdsf_push_to_main_buffer(sdsf, "]", 1);
+    _sdsf_end_value(sdsf);
+
+    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+}
+
+SdsfSerializationError sdsf_serialize_composite_start(SdsfSerializer* sdsf, const char* name)
+{
+    const SdsfSerializationError beginValueError = _sdsf_begin_value(sdsf, name);
+    if (beginValueError)
+    {
+        return beginValueError;
+    }
+
+    _sdsf_push_to_main_buffer(sdsf, "{\r\n", 3);
+    _sdsf_push_to_stack(sdsf, _SDSF_SERIALIZER_IN_COMPOSITE);
+
+    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+}
+
+SdsfSerializationError sdsf_serialize_composite_end(SdsfSerializer* sdsf)
+{
+    const _SdsfSerializerStackEntry entry = _sdsf_pop_from_stack(sdsf);
+    if (entry != _SDSF_SERIALIZER_IN_COMPOSITE)
+    {
+        sdsf->errorMsg = "Trying to end composite, but currently serializer is in another state (in array, or not in anyrhing)";
+        return SDSF_SERIALIZATION_ERROR_UNABLE_TO_END_COMPOSITE;
+    }
 
-                    if (to < from)
-                    {
-                        sdsf->errorMsg = "Invalid binary literal : \"to\" must be always equal or bigger than \"from\"";
-                        return SDSF_DESERIALIZATION_ERROR_INVALID_BINARY_LITERAL;
-                    }
+    _sdsf_push_indent(sdsf);
+    _sdsf_push_to_main_buffer(sdsf, "}", 1);
+    _sdsf_end_value(sdsf);
 
-                    valueToUpdate->asBinary.dataOffset = from;
-                    valueToUpdate->asBinary.dataSize = to - from;
-                    valueToUpdate->type = SDSF_VALUE_BINARY;
-                    expectsBinaryDataBlob = true;
-                } break;
-                case _SDSF_TOKEN_TYPE_STRING_LITERAL:
-                {
-                    valueToUpdate->asString = _sdsf_string_array_save(strings, &allocator, token.stringPtr, token.stringSize);
-                    valueToUpdate->type = SDSF_VALUE_STRING;
-                } break;
+    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+}
+
+SdsfSerializationError sdsf_serializer_end(SdsfSerializer* sdsf, SdsfSerializedResult* result)
+{
+    SdsfSerializationError error = SDSF_SERIALIZATION_ERROR_ALL_FINE;
+    if (sdsf->stackSize != 0)
+    {
+        sdsf->errorMsg = "Not all composites/arrays were finished";
+        error = SDSF_SERIALIZATION_ERROR_UNFINISHED_ARRAY_OR_COMPOSITE_VALUES;
+    }
+
+    if (!error && sdsf->binaryDataBuffer && sdsf->binaryDataBufferSize)
+    {
+        _sdsf_push_to_main_buffer(sdsf, "\r\n@", 3);
+        if (sdsf->output.write)
+        {
+            // Binary data is written straight to the output, without copying it to the main buffer
+            _sdsf_flush_main_buffer(sdsf);
+            if (!sdsf->isOutputFailed)
+            {
+                sdsf->isOutputFailed = !sdsf->output.write(sdsf->binaryDataBuffer, sdsf->binaryDataBufferSize, sdsf->output.userData);
             }
         }
+        else
+        {
+            _sdsf_push_to_main_buffer(sdsf, sdsf->binaryDataBuffer, sdsf->binaryDataBufferSize);
+        }
+    }
 
-        previousToken = token;
+    _SdsfMappedOutput* const mappedOutput = (_SdsfMappedOutput*)sdsf->mappedOutput;
+    if (mappedOutput)
+    {
+        // File is trimmed to the size of written data, so nothing is copied or written here
+        if (mappedOutput->isOpen && !_sdsf_mapped_output_close(mappedOutput, sdsf->mainBuffer, sdsf->mainBufferCapacity, sdsf->mainBufferSize))
+        {
+            sdsf->isOutputFailed = true;
+        }
+        if (!error && sdsf->isOutputFailed)
+        {
+            sdsf->errorMsg = "Unable to write serialized data to the mapped file";
+            error = SDSF_SERIALIZATION_ERROR_OUTPUT_FAILED;
+        }
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_SERIALIZER_BUFFERS);
+        sdsf->allocator.dealloc(mappedOutput, sizeof(_SdsfMappedOutput), sdsf->allocator.userData);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+        sdsf->mainBuffer = NULL;
+        sdsf->mainBufferCapacity = 0;
     }
-    
-    return SDSF_DESERIALIZATION_ERROR_ALL_FINE;
-}
 
-void sdsf_deserialized_result_free(SdsfDeserializedResult* sdsf)
-{
-    for (size_t it = 0; it < sdsf->values.size; it++)
+    if (sdsf->output.write)
     {
-        SdsfValue* const value = &sdsf->values.ptr[it];
-        if (value->type == SDSF_VALUE_COMPOSITE)
+        if (!error)
         {
-            _sdsf_val_ptr_array_clear(&value->asComposite.childs, &sdsf->allocator);
+            _sdsf_flush_main_buffer(sdsf);
         }
-        else if (value->type == SDSF_VALUE_ARRAY)
+        if (!error && sdsf->isOutputFailed)
         {
-            _sdsf_val_ptr_array_clear(&value->asArray.childs, &sdsf->allocator);
+            sdsf->errorMsg = "Unable to write serialized data to the output";
+            error = SDSF_SERIALIZATION_ERROR_OUTPUT_FAILED;
         }
     }
-    _sdsf_val_array_clear(&sdsf->values, &sdsf->allocator);
-    _sdsf_string_array_clear(&sdsf->strings, &sdsf->allocator);
 
-    if (sdsf->binaryData && sdsf->binaryDataSize)
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_SERIALIZER_BUFFERS);
+    if (sdsf->stagingBuffer1)
     {
-        sdsf->allocator.dealloc(sdsf->binaryData, sdsf->binaryDataSize, sdsf->allocator.userData);
+        sdsf->allocator.dealloc(sdsf->stagingBuffer1, SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, sdsf->allocator.userData);
+    }
+
+    if (sdsf->stagingBuffer2)
+    {
+        sdsf->allocator.dealloc(sdsf->stagingBuffer2, SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, sdsf->allocator.userData);
+    }
+
+    if (sdsf->binaryDataBuffer && sdsf->binaryDataBufferCapacity)
+    {
+        sdsf->allocator.dealloc(sdsf->binaryDataBuffer, sdsf->binaryDataBufferCapacity, sdsf->allocator.userData);
+    }
+
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_STACK);
+    if (sdsf->stack && sdsf->stackCapacity)
+    {
+        sdsf->allocator.dealloc(sdsf->stack, sizeof(_SdsfSerializerStackEntry) * sdsf->stackCapacity, sdsf->allocator.userData);
     }
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_SERIALIZER_BUFFERS);
+    
+    if (!error && !sdsf->output.write && !mappedOutput)
+    {
+        *result = (SdsfSerializedResult) { sdsf->allocator, sdsf->mainBuffer, sdsf->mainBufferSize, sdsf->mainBufferCapacity };
+    }
+    else
+    {
+        // Everything was already written to the output (or serialization failed), so main buffer is not needed anymore
+        if (sdsf->mainBuffer && sdsf->mainBufferCapacity)
+        {
+            sdsf->allocator.dealloc(sdsf->mainBuffer, sdsf->mainBufferCapacity, sdsf->allocator.userData);
+        }
+        *result = (SdsfSerializedResult) {0};
+    }
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+    const char* const errorMsg = sdsf->errorMsg;
+    *sdsf = (SdsfSerializer) {0};
+    sdsf->errorMsg = errorMsg;
+
+    return error; 
+}
+
+void sdsf_serialized_result_free(SdsfSerializedResult* sdsf)
+{
+    if (sdsf->buffer && sdsf->bufferCapacity)
+    {
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_SERIALIZER_BUFFERS);
+        sdsf->allocator.dealloc(sdsf->buffer, sdsf->bufferCapacity, sdsf->allocator.userData);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+    }
+    *sdsf = (SdsfSerializedResult) {0};
 }
 
-// ==============================================================================================================
-//
-//
-// Serializer
 //
+// Compressor splits output into frames of _SDSF_CODEC_FRAME_SIZE bytes. Each frame is written with 8 byte header
+// (decompressed size and compressed size, both are little endian uint32). If codec can't make frame smaller, frame is stored as is
+// (compressed size is equal to decompressed size in that case). Stream starts with _SDSF_CODEC_MAGIC and ends with empty frame header.
+// If data has binary data blob, empty frame header is followed by the trailer, so reader can seek to the blob without decompressing
+// everything before it. Trailer is _SDSF_CODEC_TRAILER_SIZE bytes : decompressed blob offset, decompressed offset of the frame with
+// blob start, offset of that frame header from the stream start (all are little endian uint64) and _SDSF_CODEC_TRAILER_MAGIC
 //
-// ==============================================================================================================
-
-void _sdsf_ensure_buffer_capacity(SdsfAllocator* allocator, void** buffer, size_t* capacity, size_t size, size_t additionalSize)
+bool _sdsf_compressor_flush(SdsfCompressor* compressor)
 {
-    const size_t initialCapacity = *capacity;
-    void* const initialBuffer = *buffer;
-    if ((initialCapacity - size) >= additionalSize)
+    if (!compressor->frameSize || compressor->isOutputFailed)
     {
-        return;
+        return !compressor->isOutputFailed;
     }
 
-    const size_t requiredCapacity = size + additionalSize;
-    const size_t doubledCapacity = initialCapacity * 2;
-    const size_t newCapacity = (requiredCapacity > doubledCapacity) ? requiredCapacity : doubledCapacity;
+    const size_t frameSize = compressor->frameSize;
+    const size_t packedSize = compressor->codec.compress(compressor->frame, frameSize, compressor->packedFrame, frameSize - 1, compressor->codec.userData);
+    const bool isStored = packedSize == 0 || packedSize >= frameSize;
+    uint8_t header[_SDSF_CODEC_FRAME_HEADER_SIZE];
+    _sdsf_codec_write_u32(header, (uint32_t)frameSize);
+    _sdsf_codec_write_u32(header + 4, (uint32_t)(isStored ? frameSize : packedSize));
 
-    void* const newBuffer = allocator->alloc(newCapacity, allocator->userData);
-    memcpy(newBuffer, initialBuffer, size);
+    const SdsfOutputSink output = compressor->output;
+    compressor->isOutputFailed = !output.write(header, sizeof(header), output.userData)
+        || !output.write(isStored ? compressor->frame : compressor->packedFrame, isStored ? frameSize : packedSize, output.userData);
 
-    allocator->dealloc(initialBuffer, initialCapacity, allocator->userData);
-    *buffer = newBuffer;
-    *capacity = newCapacity;
+    if (compressor->isBlobFound && !compressor->isBlobFrameWritten && compressor->blobOffset < compressor->rawOffset + frameSize)
+    {
+        compressor->isBlobFrameWritten  = true;
+        compressor->blobFrameRawOffset  = compressor->rawOffset;
+        compressor->blobFrameFileOffset = compressor->fileOffset;
+    }
+    compressor->rawOffset += frameSize;
+    compressor->fileOffset += sizeof(header) + (isStored ? frameSize : packedSize);
+    compressor->frameSize = 0;
+    return !compressor->isOutputFailed;
 }
 
-void _sdsf_push_to_stack(SdsfSerializer* sdsf, _SdsfSerializerStackEntry entry)
+bool _sdsf_compressor_write(const void* data, size_t dataSize, void* userData)
 {
-    if (sdsf->stackSize >= sdsf->stackCapacity)
+    SdsfCompressor* const compressor = (SdsfCompressor*)userData;
+    while (dataSize && !compressor->isOutputFailed)
     {
-        const size_t newCapacity = sdsf->stackCapacity * 2;
-        _SdsfSerializerStackEntry* const newMem = (_SdsfSerializerStackEntry*)sdsf->allocator.alloc(sizeof(_SdsfSerializerStackEntry) * newCapacity, sdsf->allocator.userData);
-        memcpy(newMem, sdsf->stack, sizeof(_SdsfSerializerStackEntry) * sdsf->stackCapacity);
-        sdsf->allocator.dealloc(sdsf->stack, sizeof(_SdsfSerializerStackEntry) * sdsf->stackCapacity, sdsf->allocator.userData);
-        sdsf->stack = newMem;
-        sdsf->stackCapacity = newCapacity;
+        const size_t freeSize = _SDSF_CODEC_FRAME_SIZE - compressor->frameSize;
+        const size_t copySize = dataSize < freeSize ? dataSize : freeSize;
+        if (!compressor->isBlobFound)
+        {
+            // Same scan as the reader does, so both agree on the blob start
+            _SdsfBlobScanState state = { compressor->isBlobScanInString, compressor->blobScanSkip };
+            size_t blobOffset;
+            if (_sdsf_scan_binary_data_blob((const char*)data, copySize, &state, &blobOffset))
+            {
+                compressor->isBlobFound = true;
+                compressor->blobOffset = compressor->rawOffset + compressor->frameSize + blobOffset;
+            }
+            compressor->isBlobScanInString = state.isInString;
+            compressor->blobScanSkip = state.skip;
+        }
+        memcpy(compressor->frame + compressor->frameSize, data, copySize);
+        compressor->frameSize += copySize;
+        data = (const char*)data + copySize;
+        dataSize -= copySize;
+        if (compressor->frameSize == _SDSF_CODEC_FRAME_SIZE)
+        {
+            _sdsf_compressor_flush(compressor);
+        }
     }
-    sdsf->stack[sdsf->stackSize++] = entry;
+    return !compressor->isOutputFailed;
 }
 
-inline _SdsfSerializerStackEntry _sdsf_pop_from_stack(SdsfSerializer* sdsf)
+void sdsf_compressor_begin(SdsfCompressor* compressor, SdsfAllocator allocator, SdsfCodec codec, SdsfOutputSink output)
 {
-    return sdsf->stackSize ? sdsf->stack[--sdsf->stackSize] : _SDSF_SERIALIZER_IN_NOTHING;
+    *compressor = (SdsfCompressor){0};
+    compressor->allocator       = allocator;
+    compressor->codec           = codec;
+    compressor->output          = output;
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_SERIALIZER_BUFFERS);
+    compressor->frame           = (char*)allocator.alloc(_SDSF_CODEC_FRAME_SIZE, allocator.userData);
+    compressor->packedFrame     = (char*)allocator.alloc(_SDSF_CODEC_FRAME_SIZE, allocator.userData);
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+    compressor->isOutputFailed  = !output.write(_SDSF_CODEC_MAGIC, _SDSF_CODEC_MAGIC_SIZE, output.userData);
+    compressor->fileOffset      = _SDSF_CODEC_MAGIC_SIZE;
 }
 
-inline _SdsfSerializerStackEntry _sdsf_peek_stack(SdsfSerializer* sdsf)
+SdsfOutputSink sdsf_compressor_sink(SdsfCompressor* compressor)
 {
-    if (sdsf->stackSize)
-    {
-        return sdsf->stack[sdsf->stackSize - 1];
-    }
-    else
+    SdsfOutputSink sink;
+    sink.write = _sdsf_compressor_write;
+    sink.userData = compressor;
+    return sink;
+}
+
+bool sdsf_compressor_end(SdsfCompressor* compressor)
+{
+    const uint8_t endHeader[_SDSF_CODEC_FRAME_HEADER_SIZE] = {0};
+    bool isFine = _sdsf_compressor_flush(compressor) && compressor->output.write(endHeader, sizeof(endHeader), compressor->output.userData);
+    if (isFine && compressor->isBlobFound)
     {
-        return _SDSF_SERIALIZER_IN_NOTHING;
+        // Empty blob starts at the end of stream
+        if (!compressor->isBlobFrameWritten)
+        {
+            compressor->blobFrameRawOffset  = compressor->rawOffset;
+            compressor->blobFrameFileOffset = compressor->fileOffset;
+        }
+        uint8_t trailer[_SDSF_CODEC_TRAILER_SIZE];
+        _sdsf_codec_write_u64(trailer, compressor->blobOffset);
+        _sdsf_codec_write_u64(trailer + 8, compressor->blobFrameRawOffset);
+        _sdsf_codec_write_u64(trailer + 16, compressor->blobFrameFileOffset);
+        memcpy(trailer + 24, _SDSF_CODEC_TRAILER_MAGIC, 4);
+        isFine = compressor->output.write(trailer, sizeof(trailer), compressor->output.userData);
     }
+
+    const SdsfAllocator allocator = compressor->allocator;
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_SERIALIZER_BUFFERS);
+    allocator.dealloc(compressor->frame, _SDSF_CODEC_FRAME_SIZE, allocator.userData);
+    allocator.dealloc(compressor->packedFrame, _SDSF_CODEC_FRAME_SIZE, allocator.userData);
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+    *compressor = (SdsfCompressor){0};
+    return isFine;
 }
 
-inline void _sdsf_push_to_main_buffer(SdsfSerializer* sdsf, const void* data, size_t dataSize)
+// ==============================================================================================================
+//
+//
+// Transcoder
+//
+//
+// ==============================================================================================================
+
+const char _SDSF_BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static inline int32_t _sdsf_base64_digit_value(char c)
 {
-    _sdsf_ensure_buffer_capacity(&sdsf->allocator, &sdsf->mainBuffer, &sdsf->mainBufferCapacity, sdsf->mainBufferSize, dataSize);
-    char* const buffer = ((char*)sdsf->mainBuffer) + sdsf->mainBufferSize;
-    memcpy(buffer, data, dataSize);
-    sdsf->mainBufferSize += dataSize;
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
 }
 
-inline void _sdsf_push_to_binary_buffer(SdsfSerializer* sdsf, const void* data, size_t dataSize)
+//
+// Decodes padded base64 text. Destination can be the same memory as source, because decoded data is always shorter
+//
+bool _sdsf_base64_decode(const char* source, size_t sourceSize, uint8_t* destination, size_t* destinationSize)
 {
-    _sdsf_ensure_buffer_capacity(&sdsf->allocator, &sdsf->binaryDataBuffer, &sdsf->binaryDataBufferCapacity, sdsf->binaryDataBufferSize, dataSize);
-    void* const buffer = ((char*)sdsf->binaryDataBuffer) + sdsf->binaryDataBufferSize;
-    memcpy(buffer, data, dataSize);
-    sdsf->binaryDataBufferSize += dataSize;
+    if (sourceSize % 4)
+    {
+        return false;
+    }
+
+    size_t written = 0;
+    for (size_t it = 0; it < sourceSize; it += 4)
+    {
+        const bool isLastGroup = it + 4 == sourceSize;
+        const size_t padding = isLastGroup ? (source[it + 3] == '=') + (source[it + 2] == '=') : 0;
+        uint32_t group = 0;
+        for (size_t digit = 0; digit < 4; digit++)
+        {
+            const int32_t value = digit < 4 - padding ? _sdsf_base64_digit_value(source[it + digit]) : 0;
+            if (value < 0)
+            {
+                return false;
+            }
+            group = (group << 6) | (uint32_t)value;
+        }
+        destination[written++] = (uint8_t)(group >> 16);
+        if (padding < 2) destination[written++] = (uint8_t)(group >> 8);
+        if (padding < 1) destination[written++] = (uint8_t)group;
+    }
+
+    *destinationSize = written;
+    return true;
 }
 
-inline void _sdsf_push_indent(SdsfSerializer* sdsf)
+typedef struct
 {
-    for (size_t it = 0; it < sdsf->stackSize; it++)
+    SdsfTranscoder*         transcoder;
+    SdsfOutputSink          output;
+    char*                   buffer;
+    size_t                  bufferSize;
+    size_t                  sidecarSize;
+    bool                    needsComma;
+    SdsfTranscodingError    error;
+} _SdsfJsonWriter;
+
+void _sdsf_json_flush(_SdsfJsonWriter* writer)
+{
+    if (writer->bufferSize && !writer->error && !writer->output.write(writer->buffer, writer->bufferSize, writer->output.userData))
     {
-        _sdsf_push_to_main_buffer(sdsf, _SDSF_INDENT, _SDSF_INDENT_SIZE);
+        writer->transcoder->errorMsg = "Unable to write json to the output";
+        writer->error = SDSF_TRANSCODING_ERROR_OUTPUT_FAILED;
     }
+    writer->bufferSize = 0;
 }
 
-inline SdsfSerializationError _sdsf_begin_value(SdsfSerializer* sdsf, const char* name)
+void _sdsf_json_write(_SdsfJsonWriter* writer, const void* data, size_t dataSize)
 {
-    const bool isInArray = _sdsf_peek_stack(sdsf) == _SDSF_SERIALIZER_IN_ARRAY;
-    if (!isInArray && !name)
+    if (SDSF_TRANSCODER_OUTPUT_BUFFER_CAPACITY - writer->bufferSize < dataSize)
     {
-        sdsf->errorMsg = "Only arrays can have unnamed children";
-        return SDSF_SERIALIZATION_ERROR_NO_NAME_PROVIDED;
+        _sdsf_json_flush(writer);
     }
-
-    if (_sdsf_is_number(name[0]))
+    if (dataSize >= SDSF_TRANSCODER_OUTPUT_BUFFER_CAPACITY)
     {
-        sdsf->errorMsg = "Indentifiers can't start with number";
-        return SDSF_SERIALIZATION_ERROR_INVALID_NAME;
+        if (!writer->error && !writer->output.write(data, dataSize, writer->output.userData))
+        {
+            writer->transcoder->errorMsg = "Unable to write json to the output";
+            writer->error = SDSF_TRANSCODING_ERROR_OUTPUT_FAILED;
+        }
+        return;
     }
+    memcpy(writer->buffer + writer->bufferSize, data, dataSize);
+    writer->bufferSize += dataSize;
+}
 
-    const size_t nameLength = strlen(name);
-    for (size_t it = 0; it < nameLength; it++)
+void _sdsf_json_write_string(_SdsfJsonWriter* writer, const char* string, size_t stringSize)
+{
+    _sdsf_json_write(writer, "\"", 1);
+    size_t it = 0;
+    while (it < stringSize)
     {
-        const char c = name[it];
-        if (_sdsf_is_skipped_char(c) || _sdsf_is_reserved_symbol(c))
+        const size_t plainBegin = it;
+        while (it < stringSize && (uint8_t)string[it] >= 0x20 && string[it] != '\"' && string[it] != '\\')
         {
-            sdsf->errorMsg = "Identifiers can't have special or skip-characters";
-            return SDSF_SERIALIZATION_ERROR_INVALID_NAME;
+            it += 1;
         }
-        if (c == '.' || c == '-')
+        _sdsf_json_write(writer, string + plainBegin, it - plainBegin);
+        if (it == stringSize)
         {
-            sdsf->errorMsg = "Identifiers can't have '.' and ',' characters";
-            return SDSF_SERIALIZATION_ERROR_INVALID_NAME;
+            break;
         }
-        if (c == '\0')
+
+        const char c = string[it++];
+        switch (c)
         {
-            sdsf->errorMsg = "Identifiers can't have '\\0' characters";
-            return SDSF_SERIALIZATION_ERROR_INVALID_NAME;
+            case '\"': _sdsf_json_write(writer, "\\\"", 2); break;
+            case '\\': _sdsf_json_write(writer, "\\\\", 2); break;
+            case '\b': _sdsf_json_write(writer, "\\b", 2); break;
+            case '\f': _sdsf_json_write(writer, "\\f", 2); break;
+            case '\n': _sdsf_json_write(writer, "\\n", 2); break;
+            case '\r': _sdsf_json_write(writer, "\\r", 2); break;
+            case '\t': _sdsf_json_write(writer, "\\t", 2); break;
+            default:
+            {
+                const char escape[6] = { '\\', 'u', '0', '0', "0123456789abcdef"[(c >> 4) & 0xF], "0123456789abcdef"[c & 0xF] };
+                _sdsf_json_write(writer, escape, sizeof(escape));
+            } break;
         }
     }
+    _sdsf_json_write(writer, "\"", 1);
+}
 
-    _sdsf_push_indent(sdsf);
-    if (!isInArray)
+void _sdsf_json_write_base64(_SdsfJsonWriter* writer, const uint8_t* data, size_t dataSize)
+{
+    char encoded[64];
+    size_t encodedSize = 0;
+    for (size_t it = 0; it < dataSize; it += 3)
     {
-        _sdsf_push_to_main_buffer(sdsf, name, nameLength);
-        _sdsf_push_to_main_buffer(sdsf, " ", 1);
+        const size_t groupSize = dataSize - it < 3 ? dataSize - it : 3;
+        uint32_t group = (uint32_t)data[it] << 16;
+        if (groupSize > 1) group |= (uint32_t)data[it + 1] << 8;
+        if (groupSize > 2) group |= (uint32_t)data[it + 2];
+        encoded[encodedSize++] = _SDSF_BASE64_ALPHABET[(group >> 18) & 0x3F];
+        encoded[encodedSize++] = _SDSF_BASE64_ALPHABET[(group >> 12) & 0x3F];
+        encoded[encodedSize++] = groupSize > 1 ? _SDSF_BASE64_ALPHABET[(group >> 6) & 0x3F] : '=';
+        encoded[encodedSize++] = groupSize > 2 ? _SDSF_BASE64_ALPHABET[group & 0x3F] : '=';
+        if (encodedSize == sizeof(encoded))
+        {
+            _sdsf_json_write(writer, encoded, encodedSize);
+            encodedSize = 0;
+        }
     }
-
-    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+    _sdsf_json_write(writer, encoded, encodedSize);
 }
 
-inline void _sdsf_end_value(SdsfSerializer* sdsf)
+void _sdsf_json_write_binary(_SdsfJsonWriter* writer, const SdsfEvent* event)
 {
-    if (_sdsf_peek_stack(sdsf) == _SDSF_SERIALIZER_IN_ARRAY)
+    const SdsfValue* const value = &event->value;
+    char number[32];
+    if (writer->transcoder->flags & SDSF_TRANSCODER_FLAG_BINARY_SIDECAR)
     {
-        _sdsf_push_to_main_buffer(sdsf, ",\r\n", 3);
+        const SdsfOutputSink sidecar = writer->transcoder->sidecarOutput;
+        if (value->asBinary.dataSize && !sidecar.write(event->binaryData, value->asBinary.dataSize, sidecar.userData))
+        {
+            writer->transcoder->errorMsg = "Unable to write binary data to the sidecar output";
+            writer->error = SDSF_TRANSCODING_ERROR_OUTPUT_FAILED;
+            return;
+        }
+        _sdsf_json_write(writer, "{\"$binaryRef\":[", 15);
+        _sdsf_json_write(writer, number, _sdsf_format_uint64(number, writer->sidecarSize));
+        _sdsf_json_write(writer, ",", 1);
+        _sdsf_json_write(writer, number, _sdsf_format_uint64(number, value->asBinary.dataSize));
+        _sdsf_json_write(writer, "]", 1);
+        writer->sidecarSize += value->asBinary.dataSize;
     }
     else
     {
-        _sdsf_push_to_main_buffer(sdsf, "\r\n", 2);
+        _sdsf_json_write(writer, "{\"$binary\":\"", 12);
+        _sdsf_json_write_base64(writer, (const uint8_t*)event->binaryData, value->asBinary.dataSize);
+        _sdsf_json_write(writer, "\"", 1);
+    }
+
+    const SdsfBinaryElementType type = value->asBinary.elementType;
+    if (type != SDSF_BINARY_RAW)
+    {
+        const char* const tag = _SDSF_BINARY_ELEMENT_TYPE_TAGS[type];
+        _sdsf_json_write(writer, ",\"$type\":\"", 10);
+        _sdsf_json_write(writer, tag, strlen(tag));
+        if (value->asBinary.isBigEndian && _SDSF_BINARY_ELEMENT_TYPE_SIZES[type] > 1)
+        {
+            _sdsf_json_write(writer, "be", 2);
+        }
+        _sdsf_json_write(writer, "\"", 1);
     }
+    _sdsf_json_write(writer, "}", 1);
 }
 
-SdsfSerializer sdsf_serializer_begin(SdsfAllocator allocator)
+bool _sdsf_json_handle_event(const SdsfEvent* event, void* userData)
 {
-    char* const stagingBuffer1 = (char*)allocator.alloc(SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, allocator.userData);
-    char* const stagingBuffer2 = (char*)allocator.alloc(SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, allocator.userData);
-    _SdsfSerializerStackEntry* const stack = (_SdsfSerializerStackEntry*)allocator.alloc(sizeof(_SdsfSerializerStackEntry) * SDSF_SERIALIZER_STACK_DEFAULT_CAPACITY, allocator.userData);
-    void* const buffer = allocator.alloc(SDSF_SERIALIZER_MAIN_BUFFER_DEFAULT_CAPACITY, allocator.userData);
-    void* const binaryDataBuffer = allocator.alloc(SDSF_SERIALIZER_BINARY_DATA_BUFFER_DEFAULT_CAPACITY, allocator.userData);
+    _SdsfJsonWriter* const writer = (_SdsfJsonWriter*)userData;
+    if (event->type == SDSF_EVENT_ARRAY_END || event->type == SDSF_EVENT_COMPOSITE_END)
+    {
+        _sdsf_json_write(writer, event->type == SDSF_EVENT_ARRAY_END ? "]" : "}", 1);
+        writer->needsComma = true;
+        return !writer->error;
+    }
 
-    SdsfSerializer result = {0};
-    result.allocator                = allocator;
-    result.stagingBuffer1           = stagingBuffer1;
-    result.stagingBuffer2           = stagingBuffer2;
-    result.stack                    = stack;
-    result.stackSize                = 0;
-    result.stackCapacity            = SDSF_SERIALIZER_STACK_DEFAULT_CAPACITY;
-    result.binaryDataBuffer         = binaryDataBuffer;
-    result.binaryDataBufferSize     = 0;
-    result.binaryDataBufferCapacity = SDSF_SERIALIZER_BINARY_DATA_BUFFER_DEFAULT_CAPACITY;
-    result.mainBuffer               = buffer;
-    result.mainBufferSize           = 0;
-    result.mainBufferCapacity       = SDSF_SERIALIZER_MAIN_BUFFER_DEFAULT_CAPACITY;
-    return result;
-}
+    if (writer->needsComma)
+    {
+        _sdsf_json_write(writer, ",", 1);
+    }
+    if (event->value.name)
+    {
+        _sdsf_json_write_string(writer, event->value.name, strlen(event->value.name));
+        _sdsf_json_write(writer, ":", 1);
+    }
 
-SdsfSerializationError sdsf_serialize_bool(SdsfSerializer* sdsf, const char* name, bool value)
-{
-    const SdsfSerializationError beginValueError = _sdsf_begin_value(sdsf, name);
-    if (beginValueError)
+    writer->needsComma = event->type == SDSF_EVENT_VALUE;
+    if (event->type == SDSF_EVENT_ARRAY_BEGIN || event->type == SDSF_EVENT_COMPOSITE_BEGIN)
     {
-        return beginValueError;
+        _sdsf_json_write(writer, event->type == SDSF_EVENT_ARRAY_BEGIN ? "[" : "{", 1);
+        return !writer->error;
+    }
+
+    const SdsfValue* const value = &event->value;
+    char number[32];
+    switch (value->type)
+    {
+        case SDSF_VALUE_BOOL:
+        {
+            _sdsf_json_write(writer, value->asBool ? "true" : "false", value->asBool ? 4 : 5);
+        } break;
+        case SDSF_VALUE_INT:
+        {
+            _sdsf_json_write(writer, number, _sdsf_format_int64(number, value->asInt));
+        } break;
+        case SDSF_VALUE_INT64:
+        {
+            _sdsf_json_write(writer, number, _sdsf_format_int64(number, value->asInt64));
+        } break;
+        case SDSF_VALUE_UINT64:
+        {
+            _sdsf_json_write(writer, number, _sdsf_format_uint64(number, value->asUint64));
+        } break;
+        case SDSF_VALUE_FLOAT:
+        case SDSF_VALUE_DOUBLE:
+        {
+            const double asDouble = value->type == SDSF_VALUE_FLOAT ? (double)value->asFloat : value->asDouble;
+            if (asDouble != asDouble || asDouble - asDouble != 0.0)
+            {
+                writer->transcoder->errorMsg = "Json can't store infinities and NaNs";
+                writer->error = SDSF_TRANSCODING_ERROR_UNSUPPORTED_VALUE;
+                return false;
+            }
+            //
+            // Shortest digits which read back to the same float or double. Integral values keep the fraction
+            // (1.0 instead of 1), otherwise they are read back as integers
+            //
+            const size_t written = value->type == SDSF_VALUE_FLOAT ? _sdsf_format_float(number, value->asFloat) : _sdsf_format_double(number, asDouble);
+            _sdsf_json_write(writer, number, written);
+        } break;
+        case SDSF_VALUE_STRING:
+        {
+            _sdsf_json_write_string(writer, value->asString, event->stringSize);
+        } break;
+        case SDSF_VALUE_BINARY:
+        {
+            if (!event->binaryData && value->asBinary.dataSize)
+            {
+                writer->transcoder->errorMsg = "Binary value points outside of the binary data blob";
+                writer->error = SDSF_TRANSCODING_ERROR_INVALID_BINARY;
+                return false;
+            }
+            _sdsf_json_write_binary(writer, event);
+        } break;
+        default:
+        {
+            writer->transcoder->errorMsg = "Unexpected value type";
+            writer->error = SDSF_TRANSCODING_ERROR_UNSUPPORTED_VALUE;
+        } break;
     }
-    
-    _sdsf_push_to_main_buffer(sdsf, value ? "t" : "f", 1);
-    _sdsf_end_value(sdsf);
 
-    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+    return !writer->error;
 }
 
-SdsfSerializationError sdsf_serialize_int(SdsfSerializer* sdsf, const char* name, int32_t value)
+SdsfTranscodingError sdsf_transcode_to_json(SdsfTranscoder* transcoder, const void* data, size_t dataSize, SdsfOutputSink output)
 {
-    const int written = snprintf(sdsf->stagingBuffer1, SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, "%d", value);
-    if (written < 0 || written >= SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY)
+    transcoder->errorMsg = NULL;
+    if ((transcoder->flags & SDSF_TRANSCODER_FLAG_BINARY_SIDECAR) && !transcoder->sidecarOutput.write)
     {
-        sdsf->errorMsg = "Unable to convert integer to string. Consider increasing SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY";
-        return SDSF_SERIALIZATION_ERROR_UNABLE_TO_CONVERT_VALUE_TO_STRING;
+        transcoder->errorMsg = "SDSF_TRANSCODER_FLAG_BINARY_SIDECAR is set, but sidecar output is not provided";
+        return SDSF_TRANSCODING_ERROR_OUTPUT_FAILED;
     }
 
-    const SdsfSerializationError beginValueError = _sdsf_begin_value(sdsf, name);
-    if (beginValueError)
+    const SdsfAllocator allocator = transcoder->allocator;
+    _SdsfJsonWriter writer = {0};
+    writer.transcoder = transcoder;
+    writer.output = output;
+    writer.buffer = (char*)allocator.alloc(SDSF_TRANSCODER_OUTPUT_BUFFER_CAPACITY, allocator.userData);
+
+    //
+    // Json strings must be valid utf-8, so sdsf is always validated
+    //
+    _sdsf_json_write(&writer, "{", 1);
+    SdsfEventReader reader;
+    const SdsfEventSink sink = { _sdsf_json_handle_event, &writer };
+    const SdsfDeserializationError readError = sdsf_read_events(&reader, data, dataSize, allocator, sink, SDSF_DESERIALIZER_FLAG_VALIDATE_UTF8);
+    if (readError && readError != SDSF_DESERIALIZATION_ERROR_STOPPED_BY_EVENT_SINK)
     {
-        return beginValueError;
+        transcoder->errorMsg = reader.errorMsg;
+        writer.error = SDSF_TRANSCODING_ERROR_INVALID_SDSF;
+    }
+    if (!writer.error)
+    {
+        _sdsf_json_write(&writer, "}", 1);
+        _sdsf_json_flush(&writer);
     }
 
-    _sdsf_push_to_main_buffer(sdsf, sdsf->stagingBuffer1, (size_t)written);
-    _sdsf_end_value(sdsf);
-
-    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+    allocator.dealloc(writer.buffer, SDSF_TRANSCODER_OUTPUT_BUFFER_CAPACITY, allocator.userData);
+    return writer.error;
 }
 
-SdsfSerializationError sdsf_serialize_float(SdsfSerializer* sdsf, const char* name, float value)
+typedef struct
 {
-    const int written = snprintf(sdsf->stagingBuffer1, SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, "%f", value);
-    if (written < 0 || written >= SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY)
-    {
-        sdsf->errorMsg = "Unable to convert float to string. Consider increasing SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY";
-        return SDSF_SERIALIZATION_ERROR_UNABLE_TO_CONVERT_VALUE_TO_STRING;
-    }
-
-    const SdsfSerializationError error = _sdsf_begin_value(sdsf, name);
-    if (error)
+    SdsfTranscoder*         transcoder;
+    const char*             json;
+    size_t                  jsonSize;
+    size_t                  it;
+    SdsfSerializer          serializer;
+    void*                   keyBuffer;
+    size_t                  keyBufferCapacity;
+    void*                   scratchBuffer;
+    size_t                  scratchBufferCapacity;
+    void*                   stack;
+    size_t                  stackSize;
+    size_t                  stackCapacity;
+} _SdsfJsonReader;
+
+static inline void _sdsf_json_skip_whitespace(_SdsfJsonReader* reader)
+{
+    while (reader->it < reader->jsonSize && _sdsf_is_skipped_char(reader->json[reader->it]))
     {
-        return error;
+        reader->it += 1;
     }
+}
 
-    _sdsf_push_to_main_buffer(sdsf, sdsf->stagingBuffer1, (size_t)written);
-    _sdsf_end_value(sdsf);
+static inline SdsfTranscodingError _sdsf_json_error(_SdsfJsonReader* reader, SdsfTranscodingError error, const char* errorMsg)
+{
+    reader->transcoder->errorMsg = errorMsg;
+    return error;
+}
 
-    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+static inline SdsfTranscodingError _sdsf_json_serializer_error(_SdsfJsonReader* reader, SdsfSerializationError error)
+{
+    return error ? _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_SERIALIZATION_FAILED, reader->serializer.errorMsg) : SDSF_TRANSCODING_ERROR_ALL_FINE;
 }
 
-SdsfSerializationError sdsf_serialize_string(SdsfSerializer* sdsf, const char* name, const char* value)
+static inline bool _sdsf_json_consume_char(_SdsfJsonReader* reader, char c)
 {
-    if (!value)
+    _sdsf_json_skip_whitespace(reader);
+    if (reader->it < reader->jsonSize && reader->json[reader->it] == c)
     {
-        sdsf->errorMsg = "Unable to serialize string - value is null";
-        return SDSF_SERIALIZATION_ERROR_NO_VALUE_PROVIDED;
+        reader->it += 1;
+        return true;
     }
+    return false;
+}
 
-    const SdsfSerializationError beginValueError = _sdsf_begin_value(sdsf, name);
-    if (beginValueError)
+//
+// Finds the end of string which starts at the current position. Result is the string contents, escape sequences are left as is
+//
+bool _sdsf_json_scan_string(_SdsfJsonReader* reader, const char** string, size_t* stringSize, bool* hasEscapes)
+{
+    if (!_sdsf_json_consume_char(reader, '\"'))
     {
-        return beginValueError;
+        return false;
     }
 
-    _sdsf_push_to_main_buffer(sdsf, "\"", 1);
-    const size_t valueLength = strlen(value);
-    _sdsf_push_to_main_buffer(sdsf, value, valueLength);
-    _sdsf_push_to_main_buffer(sdsf, "\"", 1);
-    _sdsf_end_value(sdsf);
+    const size_t begin = reader->it;
+    *hasEscapes = false;
+    while (reader->it < reader->jsonSize)
+    {
+        reader->it += _sdsf_find_quote_or_backslash(reader->json + reader->it, reader->jsonSize - reader->it);
+        if (reader->it >= reader->jsonSize)
+        {
+            break;
+        }
+        if (reader->json[reader->it] == '\\')
+        {
+            *hasEscapes = true;
+            reader->it += 2;
+            continue;
+        }
 
-    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+        *string = reader->json + begin;
+        *stringSize = reader->it - begin;
+        reader->it += 1;
+        return true;
+    }
+    return false;
 }
 
-SdsfSerializationError sdsf_serialize_binary(SdsfSerializer* sdsf, const char* name, const void* value, size_t size)
+//
+// Unescapes string to the buffer and adds null terminator
+//
+char* _sdsf_json_unescape(_SdsfJsonReader* reader, void** buffer, size_t* bufferCapacity, const char* string, size_t stringSize, bool hasEscapes, size_t* unescapedSize)
 {
-    const size_t from = sdsf->binaryDataBufferSize;
-    const size_t to = from + size;
-
-    const int written1 = snprintf(sdsf->stagingBuffer1, SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, "%zu", from);
-    if (written1 < 0 || written1 >= SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY)
+    _sdsf_ensure_buffer_capacity(&reader->transcoder->allocator, buffer, bufferCapacity, 0, stringSize + 1);
+    char* const result = (char*)*buffer;
+    *unescapedSize = stringSize;
+    if (!hasEscapes)
     {
-        sdsf->errorMsg = "Unable to convert first binary offset to string. Consider increasing SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY";
-        return SDSF_SERIALIZATION_ERROR_UNABLE_TO_CONVERT_VALUE_TO_STRING;
+        memcpy(result, string, stringSize);
     }
-
-    const int written2 = snprintf(sdsf->stagingBuffer2, SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, "%zu", to);
-    if (written2 < 0 || written2 >= SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY)
+    else if (!_sdsf_unescape_string(string, stringSize, result, unescapedSize))
     {
-        sdsf->errorMsg = "Unable to convert second binary offset to string. Consider increasing SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY";
-        return SDSF_SERIALIZATION_ERROR_UNABLE_TO_CONVERT_VALUE_TO_STRING;
+        return NULL;
     }
+    result[*unescapedSize] = '\0';
+    return result;
+}
 
-    const SdsfSerializationError beginValueError = _sdsf_begin_value(sdsf, name);
-    if (beginValueError)
+bool _sdsf_json_scan_number(_SdsfJsonReader* reader, const char** number, size_t* numberSize, bool* isInteger)
+{
+    _sdsf_json_skip_whitespace(reader);
+    const char* const json = reader->json;
+    const size_t size = reader->jsonSize;
+    const size_t begin = reader->it;
+    size_t it = begin;
+
+    if (it < size && json[it] == '-') it += 1;
+    if (it >= size || !_sdsf_is_number(json[it])) return false;
+    if (json[it] == '0') it += 1;
+    else while (it < size && _sdsf_is_number(json[it])) it += 1;
+
+    *isInteger = true;
+    if (it < size && json[it] == '.')
     {
-        return beginValueError;
+        it += 1;
+        if (it >= size || !_sdsf_is_number(json[it])) return false;
+        while (it < size && _sdsf_is_number(json[it])) it += 1;
+        *isInteger = false;
     }
-
-    if (value && size)
+    if (it < size && (json[it] == 'e' || json[it] == 'E'))
     {
-        _sdsf_push_to_binary_buffer(sdsf, value, size);
+        it += 1;
+        if (it < size && (json[it] == '+' || json[it] == '-')) it += 1;
+        if (it >= size || !_sdsf_is_number(json[it])) return false;
+        while (it < size && _sdsf_is_number(json[it])) it += 1;
+        *isInteger = false;
     }
 
-    _sdsf_push_to_main_buffer(sdsf, "b", 1);
-    _sdsf_push_to_main_buffer(sdsf, sdsf->stagingBuffer1, (size_t)written1);
-    _sdsf_push_to_main_buffer(sdsf, "-", 1);
-    _sdsf_push_to_main_buffer(sdsf, sdsf->stagingBuffer2, (size_t)written2);
-    _sdsf_end_value(sdsf);
-
-    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+    *number = json + begin;
+    *numberSize = it - begin;
+    reader->it = it;
+    return true;
 }
 
-SdsfSerializationError sdsf_serialize_array_start(SdsfSerializer* sdsf, const char* name)
+SdsfTranscodingError _sdsf_json_transcode_number(_SdsfJsonReader* reader, const char* name)
 {
-    const SdsfSerializationError beginValueError = _sdsf_begin_value(sdsf, name);
-    if (beginValueError)
+    const char* number;
+    size_t numberSize;
+    bool isInteger;
+    if (!_sdsf_json_scan_number(reader, &number, &numberSize, &isInteger))
     {
-        return beginValueError;
+        return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_JSON, "Invalid json number");
     }
 
-    _sdsf_push_to_main_buffer(sdsf, "[\r\n", 3);
-    _sdsf_push_to_stack(sdsf, _SDSF_SERIALIZER_IN_ARRAY);
+    //
+    // Integers are stored using the smallest sdsf type which can hold them, everything else is stored as double
+    //
+    bool isNegative;
+    uint64_t magnitude;
+    if (isInteger && _sdsf_parse_integer(number, numberSize, &isNegative, &magnitude))
+    {
+        SdsfSerializationError error;
+        if (magnitude <= (isNegative ? (uint64_t)INT32_MAX + 1 : (uint64_t)INT32_MAX))
+        {
+            error = sdsf_serialize_int(&reader->serializer, name, isNegative ? (int32_t)(0 - (int64_t)magnitude) : (int32_t)magnitude);
+        }
+        else if (magnitude <= (isNegative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX))
+        {
+            error = sdsf_serialize_int64(&reader->serializer, name, isNegative ? (int64_t)((uint64_t)0 - magnitude) : (int64_t)magnitude);
+        }
+        else if (!isNegative)
+        {
+            error = sdsf_serialize_uint64(&reader->serializer, name, magnitude);
+        }
+        else
+        {
+            return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_UNSUPPORTED_VALUE, "Negative integer doesn't fit into int64_t");
+        }
+        return _sdsf_json_serializer_error(reader, error);
+    }
 
-    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+    double value;
+    if (!_sdsf_parse_double(number, numberSize, &value))
+    {
+        return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_UNSUPPORTED_VALUE, "Unable to convert json number to double");
+    }
+    return _sdsf_json_serializer_error(reader, sdsf_serialize_double(&reader->serializer, name, value));
 }
 
-SdsfSerializationError sdsf_serialize_array_end(SdsfSerializer* sdsf)
+//
+// {"$binary": "<base64>", "$type": "<tag>"} and {"$binaryRef": [offset, size], "$type": "<tag>"} objects are stored as binary values.
+// "$type" is optional. Opening '{' and the first key are already consumed
+//
+SdsfTranscodingError _sdsf_json_transcode_binary(_SdsfJsonReader* reader, const char* name, bool isReference)
 {
-    const _SdsfSerializerStackEntry entry = _sdsf_pop_from_stack(sdsf);
-    if (entry != _SDSF_SERIALIZER_IN_ARRAY)
+    SdsfAllocator* const allocator = &reader->transcoder->allocator;
+    if (!_sdsf_json_consume_char(reader, ':'))
     {
-        sdsf->errorMsg = "Trying to end array, but currently serializer is in another state (in composite, or not in anyrhing)";
-        return SDSF_SERIALIZATION_ERROR_UNABLE_TO_END_ARRAY;
+        return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_JSON, "Expected ':' character after key");
     }
 
-    _sdsf_push_indent(sdsf);
-    _sdsf_push_to_main_buffer(sdsf, "]", 1);
-    _sdsf_end_value(sdsf);
-
-    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
-}
-
-SdsfSerializationError sdsf_serialize_composite_start(SdsfSerializer* sdsf, const char* name)
-{
-    const SdsfSerializationError beginValueError = _sdsf_begin_value(sdsf, name);
-    if (beginValueError)
+    const uint8_t* data = NULL;
+    size_t dataSize = 0;
+    if (isReference)
     {
-        return beginValueError;
+        uint64_t reference[2];
+        for (size_t it = 0; it < 2; it++)
+        {
+            const char* number;
+            size_t numberSize;
+            bool isInteger;
+            bool isNegative;
+            if (!_sdsf_json_consume_char(reader, it == 0 ? '[' : ',') ||
+                !_sdsf_json_scan_number(reader, &number, &numberSize, &isInteger) ||
+                !isInteger || !_sdsf_parse_integer(number, numberSize, &isNegative, &reference[it]) || isNegative)
+            {
+                return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_BINARY, "\"$binaryRef\" must be an array of two non-negative integers");
+            }
+        }
+        if (!_sdsf_json_consume_char(reader, ']'))
+        {
+            return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_BINARY, "\"$binaryRef\" must be an array of two non-negative integers");
+        }
+        if (!reader->transcoder->sidecarData || reference[0] > reader->transcoder->sidecarDataSize || reference[1] > reader->transcoder->sidecarDataSize - reference[0])
+        {
+            return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_BINARY, "\"$binaryRef\" points outside of the sidecar data");
+        }
+        data = (const uint8_t*)reader->transcoder->sidecarData + reference[0];
+        dataSize = (size_t)reference[1];
+    }
+    else
+    {
+        const char* text;
+        size_t textSize;
+        bool hasEscapes;
+        if (!_sdsf_json_scan_string(reader, &text, &textSize, &hasEscapes))
+        {
+            return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_BINARY, "\"$binary\" must be a base64 string");
+        }
+        // Base64 text is decoded in place, scratch buffer gets text first
+        size_t unescapedSize;
+        const char* const unescaped = _sdsf_json_unescape(reader, &reader->scratchBuffer, &reader->scratchBufferCapacity, text, textSize, hasEscapes, &unescapedSize);
+        if (!unescaped || !_sdsf_base64_decode(unescaped, unescapedSize, (uint8_t*)reader->scratchBuffer, &dataSize))
+        {
+            return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_BINARY, "\"$binary\" must be a base64 string");
+        }
+        data = (const uint8_t*)reader->scratchBuffer;
     }
 
-    _sdsf_push_to_main_buffer(sdsf, "{\r\n", 3);
-    _sdsf_push_to_stack(sdsf, _SDSF_SERIALIZER_IN_COMPOSITE);
+    SdsfBinaryElementType type = SDSF_BINARY_RAW;
+    bool isBigEndian = false;
+    if (_sdsf_json_consume_char(reader, ','))
+    {
+        const char* key;
+        size_t keySize;
+        const char* tag;
+        size_t tagSize;
+        bool hasEscapes;
+        if (!_sdsf_json_scan_string(reader, &key, &keySize, &hasEscapes) || keySize != 5 || memcmp(key, "$type", 5) != 0 ||
+            !_sdsf_json_consume_char(reader, ':') || !_sdsf_json_scan_string(reader, &tag, &tagSize, &hasEscapes) ||
+            !_sdsf_match_binary_element_type(tag, tagSize, &type, &isBigEndian))
+        {
+            return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_BINARY, "Binary object can only have \"$type\" key with known element type tag");
+        }
+    }
+    if (!_sdsf_json_consume_char(reader, '}'))
+    {
+        return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_BINARY, "Binary object can only have \"$type\" key with known element type tag");
+    }
 
-    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
-}
+    const size_t elementSize = _SDSF_BINARY_ELEMENT_TYPE_SIZES[type];
+    if (dataSize % elementSize)
+    {
+        return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_BINARY, "Size of typed binary value must be a multiple of element size");
+    }
 
-SdsfSerializationError sdsf_serialize_composite_end(SdsfSerializer* sdsf)
-{
-    const _SdsfSerializerStackEntry entry = _sdsf_pop_from_stack(sdsf);
-    if (entry != _SDSF_SERIALIZER_IN_COMPOSITE)
+    //
+    // Serializer always writes host byte order, so data in the other byte order is swapped
+    //
+    if (elementSize > 1 && isBigEndian != _sdsf_is_big_endian_host())
     {
-        sdsf->errorMsg = "Trying to end composite, but currently serializer is in another state (in array, or not in anyrhing)";
-        return SDSF_SERIALIZATION_ERROR_UNABLE_TO_END_COMPOSITE;
+        if (data != reader->scratchBuffer)
+        {
+            _sdsf_ensure_buffer_capacity(allocator, &reader->scratchBuffer, &reader->scratchBufferCapacity, 0, dataSize);
+            memcpy(reader->scratchBuffer, data, dataSize);
+            data = (const uint8_t*)reader->scratchBuffer;
+        }
+        uint8_t* const bytes = (uint8_t*)reader->scratchBuffer;
+        for (size_t element = 0; element < dataSize; element += elementSize)
+        {
+            for (size_t it = 0; it < elementSize / 2; it++)
+            {
+                const uint8_t tmp = bytes[element + it];
+                bytes[element + it] = bytes[element + elementSize - 1 - it];
+                bytes[element + elementSize - 1 - it] = tmp;
+            }
+        }
     }
 
-    _sdsf_push_indent(sdsf);
-    _sdsf_push_to_main_buffer(sdsf, "}", 1);
-    _sdsf_end_value(sdsf);
+    return _sdsf_json_serializer_error(reader, sdsf_serialize_binary_typed(&reader->serializer, name, type, data, dataSize / elementSize));
+}
 
-    return SDSF_SERIALIZATION_ERROR_ALL_FINE;
+static inline void _sdsf_json_push_scope(_SdsfJsonReader* reader, char scope)
+{
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_STACK);
+    _sdsf_ensure_buffer_capacity(&reader->transcoder->allocator, &reader->stack, &reader->stackCapacity, reader->stackSize, 1);
+    SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
+    ((char*)reader->stack)[reader->stackSize++] = scope;
 }
 
-SdsfSerializationError sdsf_serializer_end(SdsfSerializer* sdsf, SdsfSerializedResult* result)
+//
+// Transcodes single value. Arrays and objects are only started here, their contents are processed by the main loop
+//
+SdsfTranscodingError _sdsf_json_transcode_value(_SdsfJsonReader* reader, const char* name)
 {
-    SdsfSerializationError error = SDSF_SERIALIZATION_ERROR_ALL_FINE;
-    if (sdsf->stackSize != 0)
+    _sdsf_json_skip_whitespace(reader);
+    if (reader->it >= reader->jsonSize)
     {
-        sdsf->errorMsg = "Not all composites/arrays were finished";
-        error = SDSF_SERIALIZATION_ERROR_UNFINISHED_ARRAY_OR_COMPOSITE_VALUES;
+        return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_JSON, "Unexpected end of json - expected value");
     }
 
-    if (!error && sdsf->binaryDataBuffer && sdsf->binaryDataBufferSize)
+    const char* const json = reader->json + reader->it;
+    const size_t remaining = reader->jsonSize - reader->it;
+    switch (json[0])
     {
-        _sdsf_push_to_main_buffer(sdsf, "\r\n@", 3);
-        _sdsf_push_to_main_buffer(sdsf, sdsf->binaryDataBuffer, sdsf->binaryDataBufferSize);
+        case '{':
+        {
+            reader->it += 1;
+            const size_t keyPosition = reader->it;
+            const char* key;
+            size_t keySize;
+            bool hasEscapes;
+            if (_sdsf_json_scan_string(reader, &key, &keySize, &hasEscapes))
+            {
+                if (keySize == 7 && memcmp(key, "$binary", 7) == 0)
+                {
+                    return _sdsf_json_transcode_binary(reader, name, false);
+                }
+                if (keySize == 10 && memcmp(key, "$binaryRef", 10) == 0)
+                {
+                    return _sdsf_json_transcode_binary(reader, name, true);
+                }
+            }
+            reader->it = keyPosition;
+            _sdsf_json_push_scope(reader, '{');
+            return _sdsf_json_serializer_error(reader, sdsf_serialize_composite_start(&reader->serializer, name));
+        }
+        case '[':
+        {
+            reader->it += 1;
+            _sdsf_json_push_scope(reader, '[');
+            return _sdsf_json_serializer_error(reader, sdsf_serialize_array_start(&reader->serializer, name));
+        }
+        case '\"':
+        {
+            const char* string;
+            size_t stringSize;
+            bool hasEscapes;
+            if (!_sdsf_json_scan_string(reader, &string, &stringSize, &hasEscapes))
+            {
+                return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_JSON, "Unterminated json string");
+            }
+            if (hasEscapes)
+            {
+                // Json and sdsf have the same escape sequences, so string is written as is after validation
+                size_t unescapedSize;
+                if (!_sdsf_json_unescape(reader, &reader->scratchBuffer, &reader->scratchBufferCapacity, string, stringSize, true, &unescapedSize))
+                {
+                    return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_JSON, "Invalid json string - unknown or incomplete escape sequence");
+                }
+            }
+            return _sdsf_json_serializer_error(reader, _sdsf_serialize_escaped_string(&reader->serializer, name, string, stringSize));
+        }
+        case 't':
+        case 'f':
+        {
+            const bool value = json[0] == 't';
+            const size_t literalSize = value ? 4 : 5;
+            if (remaining < literalSize || memcmp(json, value ? "true" : "false", literalSize) != 0)
+            {
+                return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_JSON, "Invalid json literal");
+            }
+            reader->it += literalSize;
+            return _sdsf_json_serializer_error(reader, sdsf_serialize_bool(&reader->serializer, name, value));
+        }
+        case 'n':
+        {
+            if (remaining < 4 || memcmp(json, "null", 4) != 0)
+            {
+                return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_JSON, "Invalid json literal");
+            }
+            return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_UNSUPPORTED_VALUE, "Sdsf has no null values");
+        }
+        default:
+        {
+            return _sdsf_json_transcode_number(reader, name);
+        }
     }
+}
 
-    if (sdsf->stagingBuffer1)
+SdsfTranscodingError _sdsf_transcode_from_json(_SdsfJsonReader* reader)
+{
+    //
+    // Top level json object becomes the list of top level sdsf values
+    //
+    if (!_sdsf_json_consume_char(reader, '{'))
     {
-        sdsf->allocator.dealloc(sdsf->stagingBuffer1, SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, sdsf->allocator.userData);
+        return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_UNSUPPORTED_VALUE, "Top level json value must be an object");
     }
+    _sdsf_json_push_scope(reader, '{');
 
-    if (sdsf->stagingBuffer2)
+    bool isFirstChild = true;
+    while (reader->stackSize)
     {
-        sdsf->allocator.dealloc(sdsf->stagingBuffer2, SDSF_SERIALIZER_STAGING_BUFFER_CAPACITY, sdsf->allocator.userData);
+        const char scope = ((const char*)reader->stack)[reader->stackSize - 1];
+        const char scopeEnd = scope == '{' ? '}' : ']';
+        if (_sdsf_json_consume_char(reader, scopeEnd))
+        {
+            reader->stackSize -= 1;
+            isFirstChild = false;
+            if (reader->stackSize)
+            {
+                const SdsfSerializationError error = scope == '{'
+                    ? sdsf_serialize_composite_end(&reader->serializer)
+                    : sdsf_serialize_array_end(&reader->serializer);
+                if (error)
+                {
+                    return _sdsf_json_serializer_error(reader, error);
+                }
+            }
+            continue;
+        }
+        if (!isFirstChild && !_sdsf_json_consume_char(reader, ','))
+        {
+            return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_JSON, "Expected ',' character or end of array or object");
+        }
+
+        const char* name = NULL;
+        if (scope == '{')
+        {
+            const char* key;
+            size_t keySize;
+            bool hasEscapes;
+            size_t nameSize;
+            if (!_sdsf_json_scan_string(reader, &key, &keySize, &hasEscapes))
+            {
+                return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_JSON, "Expected object key");
+            }
+            name = _sdsf_json_unescape(reader, &reader->keyBuffer, &reader->keyBufferCapacity, key, keySize, hasEscapes, &nameSize);
+            if (!name)
+            {
+                return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_JSON, "Invalid json string - unknown or incomplete escape sequence");
+            }
+            if (!_sdsf_json_consume_char(reader, ':'))
+            {
+                return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_JSON, "Expected ':' character after key");
+            }
+        }
+
+        const size_t stackSize = reader->stackSize;
+        const SdsfTranscodingError error = _sdsf_json_transcode_value(reader, name);
+        if (error)
+        {
+            return error;
+        }
+        isFirstChild = reader->stackSize != stackSize;
     }
 
-    if (sdsf->binaryDataBuffer && sdsf->binaryDataBufferCapacity)
+    _sdsf_json_skip_whitespace(reader);
+    if (reader->it != reader->jsonSize)
     {
-        sdsf->allocator.dealloc(sdsf->binaryDataBuffer, sdsf->binaryDataBufferCapacity, sdsf->allocator.userData);
+        return _sdsf_json_error(reader, SDSF_TRANSCODING_ERROR_INVALID_JSON, "Unexpected characters after the end of top level object");
     }
+    return SDSF_TRANSCODING_ERROR_ALL_FINE;
+}
 
-    if (sdsf->stack && sdsf->stackCapacity)
+SdsfTranscodingError sdsf_transcode_from_json(SdsfTranscoder* transcoder, const void* json, size_t jsonSize, SdsfOutputSink output)
+{
+    transcoder->errorMsg = NULL;
+    const SdsfAllocator allocator = transcoder->allocator;
+
+    _SdsfJsonReader reader = {0};
+    reader.transcoder = transcoder;
+    reader.json = (const char*)json;
+    reader.jsonSize = jsonSize;
+    reader.serializer = sdsf_serializer_begin_streaming(allocator, output);
+
+    SdsfTranscodingError error = _sdsf_transcode_from_json(&reader);
+
+    // Serializer must be ended anyway to free its memory, unfinished values are not an error if json was invalid
+    SdsfSerializedResult result;
+    const SdsfSerializationError serializationError = sdsf_serializer_end(&reader.serializer, &result);
+    if (!error && serializationError)
     {
-        sdsf->allocator.dealloc(sdsf->stack, sizeof(_SdsfSerializerStackEntry) * sdsf->stackCapacity, sdsf->allocator.userData);
+        transcoder->errorMsg = reader.serializer.errorMsg;
+        error = serializationError == SDSF_SERIALIZATION_ERROR_OUTPUT_FAILED ? SDSF_TRANSCODING_ERROR_OUTPUT_FAILED : SDSF_TRANSCODING_ERROR_SERIALIZATION_FAILED;
     }
-    
-    if (!error)
+
+    if (reader.keyBuffer)
     {
-        *result = (SdsfSerializedResult) { sdsf->allocator, sdsf->mainBuffer, sdsf->mainBufferSize, sdsf->mainBufferCapacity };
+        allocator.dealloc(reader.keyBuffer, reader.keyBufferCapacity, allocator.userData);
     }
-    else
+    if (reader.scratchBuffer)
     {
-        *result = (SdsfSerializedResult) {0};
+        allocator.dealloc(reader.scratchBuffer, reader.scratchBufferCapacity, allocator.userData);
     }
-    *sdsf = (SdsfSerializer) {0};
-
-    return error; 
-}
-
-void sdsf_serialized_result_free(SdsfSerializedResult* sdsf)
-{
-    if (sdsf->buffer && sdsf->bufferCapacity)
+    if (reader.stack)
     {
-        sdsf->allocator.dealloc(sdsf->buffer, sdsf->bufferCapacity, sdsf->allocator.userData);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_STACK);
+        allocator.dealloc(reader.stack, reader.stackCapacity, allocator.userData);
+        SDSF_ALLOCATION_SITE_HOOK(SDSF_ALLOCATION_SITE_OTHER);
     }
-    *sdsf = (SdsfSerializedResult) {0};
+
+    return error;
 }
 
 #ifdef __cplusplus
@@ -1,8 +1,18 @@
+//
+// @NOTE : mapped serializer output needs ftruncate, which is declared only with posix declarations enabled
+//
+#define _DEFAULT_SOURCE
 
 #define SDSF_IMPL
-#include "..\simple_data_storage_format.h"
+#include "../simple_data_storage_format.h"
 
 #include <stdio.h>
+#include <fcntl.h>
+#ifdef _WIN32
+#   include <io.h>
+#else
+#   include <unistd.h>
+#endif
 
 typedef struct
 {
@@ -37,6 +47,11 @@ void dealloc(void* ptr, size_t size, void* _)
     free(ptr);
 }
 
+bool write_to_stdout(const void* data, size_t dataSize, void* _)
+{
+    return fwrite(data, 1, dataSize, stdout) == dataSize;
+}
+
 void print_value_rec(const SdsfValue* value, size_t depth)
 {
     for (size_t it = 0; it < depth; it++) printf("   ");
@@ -47,8 +62,24 @@ void print_value_rec(const SdsfValue* value, size_t depth)
         case SDSF_VALUE_BOOL:   { printf("%s", value->asBool ? "true" : "false"); } break;
         case SDSF_VALUE_INT:    { printf("%d", value->asInt); } break;
         case SDSF_VALUE_FLOAT:  { printf("%f", value->asFloat); } break;
+        case SDSF_VALUE_INT64:  { printf("%lld", (long long)value->asInt64); } break;
+        case SDSF_VALUE_UINT64: { printf("%llu", (unsigned long long)value->asUint64); } break;
+        case SDSF_VALUE_DOUBLE: { printf("%.17g", value->asDouble); } break;
         case SDSF_VALUE_STRING: { printf("%s", value->asString); } break;
-        case SDSF_VALUE_BINARY: { printf("From %zu, size %zu", value->asBinary.dataOffset, value->asBinary.dataSize); } break;
+        case SDSF_VALUE_BINARY: { printf("From %zu, size %zu, type %s", value->asBinary.dataOffset, value->asBinary.dataSize, SDSF_BINARY_ELEMENT_TYPE_TO_STR[value->asBinary.elementType]); } break;
+        case SDSF_VALUE_PACKED_ARRAY: { printf("%zu elements of type %s", value->asPackedArray.size, SDSF_VALUE_TYPE_TO_STR[value->asPackedArray.elementType]); } break;
+        case SDSF_VALUE_TENSOR:
+        {
+            SdsfTensor tensor;
+            sdsf_array_as_tensor(value, &tensor);
+            printf("%zu elements of type %s, shape", tensor.count, SDSF_VALUE_TYPE_TO_STR[tensor.elementType]);
+            for (size_t it = 0; it < tensor.rank; it++) printf(" %zu", tensor.shape[it]);
+            if (tensor.elementType == SDSF_VALUE_FLOAT)
+            {
+                printf(", data");
+                for (size_t it = 0; it < tensor.count; it++) printf(" %f", ((const float*)tensor.data)[it]);
+            }
+        } break;
     }
     printf("\n");
 
@@ -66,12 +97,24 @@ void print_value_rec(const SdsfValue* value, size_t depth)
             print_value_rec(value->asArray.childs.ptr[it], depth + 1);
         }
     }
+    else if (value->type == SDSF_VALUE_PACKED_ARRAY)
+    {
+        SdsfValue element;
+        for (size_t it = 0; sdsf_packed_array_get(value, it, &element); it++)
+        {
+            print_value_rec(&element, depth + 1);
+        }
+    }
 }
 
 void deserialize_and_print(const void* data, size_t dataSize, SdsfAllocator allocator)
 {
     SdsfDeserializedResult dr = {0};
-    const SdsfDeserializationError error = sdsf_deserialize(&dr, data, dataSize, allocator);
+    //
+    // @NOTE : with SDSF_DESERIALIZER_FLAG_PACK_ARRAYS arrays of same-typed numbers or bools
+    // are stored as SDSF_VALUE_PACKED_ARRAY values instead of one SdsfValue per element
+    //
+    const SdsfDeserializationError error = sdsf_deserialize_with_flags(&dr, data, dataSize, allocator, SDSF_DESERIALIZER_FLAG_VALIDATE_UTF8 | SDSF_DESERIALIZER_FLAG_PACK_ARRAYS);
 
     if (error)
     {
@@ -89,15 +132,1055 @@ void deserialize_and_print(const void* data, size_t dataSize, SdsfAllocator allo
     sdsf_deserialized_result_free(&dr);
 }
 
+const SdsfValue* find_child(const SdsfValuePtrArray* childs, const char* name)
+{
+    for (size_t it = 0; it < childs->size; it++)
+    {
+        if (strcmp(childs->ptr[it]->name, name) == 0) return childs->ptr[it];
+    }
+    return NULL;
+}
+
+void extract_and_print_columns(const void* data, size_t dataSize, SdsfAllocator allocator)
+{
+    SdsfDeserializedResult dr = {0};
+    const SdsfDeserializationError error = sdsf_deserialize(&dr, data, dataSize, allocator);
+    const SdsfValue* const settings = error ? NULL : find_child(&dr.topLevelValues, "settings");
+    const SdsfValue* const array = settings ? find_child(&settings->asComposite.childs, "composite_array") : NULL;
+
+    //
+    // @NOTE : members of composite_array have "val" child of different types, so only
+    // int values go to the int column and the rest are marked as null
+    //
+    const SdsfColumnSpec specs[] =
+    {
+        { "val", SDSF_VALUE_INT },
+        { "antother_val", SDSF_VALUE_DOUBLE },
+    };
+    SdsfColumns columns = {0};
+    const SdsfColumnsError columnsError = sdsf_array_to_columns(&columns, array, specs, sizeof(specs) / sizeof(specs[0]), allocator);
+    if (columnsError)
+    {
+        printf("Columns error : %s. Description : %s\n", SDSF_COLUMNS_ERROR_TO_STR[columnsError], columns.errorMsg);
+    }
+    else
+    {
+        const int32_t* const vals = (const int32_t*)columns.columns[0].data;
+        const double* const antotherVals = (const double*)columns.columns[1].data;
+        for (size_t it = 0; it < columns.rowCount; it++)
+        {
+            printf("row %zu : val ", it);
+            if (sdsf_column_is_valid(&columns.columns[0], it)) printf("%d", vals[it]); else printf("null");
+            printf(", antother_val ");
+            if (sdsf_column_is_valid(&columns.columns[1], it)) printf("%f", antotherVals[it]); else printf("null");
+            printf("\n");
+        }
+    }
+
+    sdsf_columns_free(&columns);
+    sdsf_deserialized_result_free(&dr);
+}
+
 void serialize_bunch_of_stuff(SdsfSerializer* sdsf)
 {
     sdsf_serialize_bool(sdsf, "boolValue", true);
     sdsf_serialize_int(sdsf, "intValue", 228);
     sdsf_serialize_float(sdsf, "floatValue", 2.001f);
+    sdsf_serialize_int64(sdsf, "int64Value", -9000000000LL);
+    sdsf_serialize_uint64(sdsf, "uint64Value", 18446744073709551615ULL);
+    sdsf_serialize_double(sdsf, "doubleValue", 0.1);
     sdsf_serialize_string(sdsf, "stringValue", "String string string!");
+    sdsf_serialize_string(sdsf, "escapedStringValue", "Quotes \" and backslashes \\ are escaped");
+}
+
+//
+// @NOTE : checks below compare concurrent and IO paths against the serial sdsf_deserialize
+// and the buffered serializer. Results must be the same values, events and bytes, and
+// malformed input must fail with the same error
+//
+int failedChecks = 0;
+
+#define CHECK(condition) do { if (!(condition)) { printf("   check failed at line %d : %s\n", __LINE__, #condition); failedChecks++; } } while (0)
+
+typedef struct
+{
+    char* data;
+    size_t size;
+} GeneratedDocument;
+
+GeneratedDocument generate_document(size_t valueCount, bool withBinaryData)
+{
+    char* const data = (char*)malloc(valueCount * 160 + 64);
+    size_t size = 0;
+    for (size_t it = 0; it < valueCount; it++)
+    {
+        switch (it % 6)
+        {
+            case 0: size += sprintf(data + size, "composite%zu { id %zu text \"brackets [ { ] } \\\" @ inside\" nested { deep [1, [2, \"]\"], { member \"}\" }] } }\n", it, it); break;
+            case 1: size += sprintf(data + size, "array%zu\t[%zu, -%zu, %zu.5, t]\n", it, it, it, it); break;
+            case 2: size += sprintf(data + size, "string%zu \"long string with escapes \\\\ and \\\" which goes to the strings arena %zu\"\n", it, it); break;
+            case 3: size += sprintf(data + size, "binary%zu %s\n", it, withBinaryData ? "b0-4" : "\"no binary\""); break;
+            case 4: size += sprintf(data + size, "flag%zu f  big%zu -9000000000 huge%zu 18446744073709551615u precise%zu 0.1d\n", it, it, it, it); break;
+            case 5: size += sprintf(data + size, "utf8%zu \"\xD0\xBF\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82 \xE2\x82\xAC\" numbers [%zu, %zu, %zu]\n", it, it, it + 1, it + 2); break;
+        }
+    }
+    if (withBinaryData) size += sprintf(data + size, "@blob [ with { bytes");
+    return (GeneratedDocument){ data, size };
+}
+
+size_t value_type_size(SdsfValueType type)
+{
+    switch (type)
+    {
+        case SDSF_VALUE_INT:    return sizeof(int32_t);
+        case SDSF_VALUE_FLOAT:  return sizeof(float);
+        case SDSF_VALUE_INT64:  return sizeof(int64_t);
+        case SDSF_VALUE_UINT64: return sizeof(uint64_t);
+        case SDSF_VALUE_DOUBLE: return sizeof(double);
+        default:                return 0;
+    }
+}
+
+bool values_equal(const SdsfValue* a, const SdsfValue* b)
+{
+    if (a->type != b->type) return false;
+    if ((a->name == NULL) != (b->name == NULL)) return false;
+    if (a->name && strcmp(a->name, b->name) != 0) return false;
+
+    switch (a->type)
+    {
+        case SDSF_VALUE_BOOL:   return a->asBool == b->asBool;
+        case SDSF_VALUE_INT:    return a->asInt == b->asInt;
+        case SDSF_VALUE_FLOAT:  return memcmp(&a->asFloat, &b->asFloat, sizeof(float)) == 0;
+        case SDSF_VALUE_INT64:  return a->asInt64 == b->asInt64;
+        case SDSF_VALUE_UINT64: return a->asUint64 == b->asUint64;
+        case SDSF_VALUE_DOUBLE: return memcmp(&a->asDouble, &b->asDouble, sizeof(double)) == 0;
+        case SDSF_VALUE_STRING: return sdsf_string_size(a) == sdsf_string_size(b) && memcmp(a->asString, b->asString, sdsf_string_size(a)) == 0;
+        case SDSF_VALUE_BINARY:
+        {
+            return a->asBinary.dataOffset == b->asBinary.dataOffset && a->asBinary.dataSize == b->asBinary.dataSize &&
+                   a->asBinary.elementType == b->asBinary.elementType && a->asBinary.isBigEndian == b->asBinary.isBigEndian;
+        }
+        case SDSF_VALUE_ARRAY:
+        case SDSF_VALUE_COMPOSITE:
+        {
+            const SdsfValuePtrArray* const aChilds = a->type == SDSF_VALUE_ARRAY ? &a->asArray.childs : &a->asComposite.childs;
+            const SdsfValuePtrArray* const bChilds = b->type == SDSF_VALUE_ARRAY ? &b->asArray.childs : &b->asComposite.childs;
+            if (aChilds->size != bChilds->size) return false;
+            for (size_t it = 0; it < aChilds->size; it++)
+            {
+                if (!values_equal(aChilds->ptr[it], bChilds->ptr[it])) return false;
+            }
+            return true;
+        }
+        case SDSF_VALUE_PACKED_ARRAY:
+        {
+            if (a->asPackedArray.elementType != b->asPackedArray.elementType || a->asPackedArray.size != b->asPackedArray.size) return false;
+            SdsfValue aElement, bElement;
+            for (size_t it = 0; sdsf_packed_array_get(a, it, &aElement); it++)
+            {
+                if (!sdsf_packed_array_get(b, it, &bElement) || !values_equal(&aElement, &bElement)) return false;
+            }
+            return true;
+        }
+        case SDSF_VALUE_TENSOR:
+        {
+            SdsfTensor aTensor, bTensor;
+            if (!sdsf_array_as_tensor(a, &aTensor) || !sdsf_array_as_tensor(b, &bTensor)) return false;
+            if (aTensor.elementType != bTensor.elementType || aTensor.rank != bTensor.rank || aTensor.count != bTensor.count) return false;
+            if (memcmp(aTensor.shape, bTensor.shape, aTensor.rank * sizeof(size_t)) != 0) return false;
+            return memcmp(aTensor.data, bTensor.data, aTensor.count * value_type_size(aTensor.elementType)) == 0;
+        }
+        default: return true;
+    }
+}
+
+bool results_equal(const SdsfDeserializedResult* a, const SdsfDeserializedResult* b)
+{
+    if (a->topLevelValues.size != b->topLevelValues.size) return false;
+    for (size_t it = 0; it < a->topLevelValues.size; it++)
+    {
+        if (!values_equal(a->topLevelValues.ptr[it], b->topLevelValues.ptr[it])) return false;
+    }
+    if (a->binaryDataSize != b->binaryDataSize) return false;
+    return a->binaryDataSize == 0 || memcmp(a->binaryData, b->binaryData, a->binaryDataSize) == 0;
+}
+
+bool error_messages_equal(const char* a, const char* b)
+{
+    return (a == NULL && b == NULL) || (a && b && strcmp(a, b) == 0);
+}
+
+//
+// Inputs for the differential checks : the test document, generated documents large enough
+// to be split between threads and malformed copies of them
+//
+typedef enum
+{
+    CHECK_INPUT_TEST_DOCUMENT,
+    CHECK_INPUT_SMALL,
+    CHECK_INPUT_LARGE,
+    CHECK_INPUT_LARGE_WITHOUT_BINARY_DATA,
+    CHECK_INPUT_UNEXPECTED_BRACE,
+    CHECK_INPUT_INVALID_UTF8,
+    CHECK_INPUT_INVALID_NUMBER,
+    CHECK_INPUT_COUNT,
+} CheckInput;
+
+const char* CHECK_INPUT_TO_STR[] =
+{
+    "test document",
+    "small document",
+    "large document",
+    "large document without binary data",
+    "unexpected brace",
+    "invalid utf-8",
+    "invalid number",
+};
+
+GeneratedDocument make_check_input(CheckInput input, FileContent testDocument)
+{
+    GeneratedDocument document = {0};
+    switch (input)
+    {
+        case CHECK_INPUT_TEST_DOCUMENT:
+        {
+            document.data = (char*)malloc(testDocument.size);
+            document.size = testDocument.size;
+            memcpy(document.data, testDocument.data, testDocument.size);
+        } break;
+        case CHECK_INPUT_SMALL:                     document = generate_document(7, true); break;
+        case CHECK_INPUT_LARGE:                     document = generate_document(30000, true); break;
+        case CHECK_INPUT_LARGE_WITHOUT_BINARY_DATA: document = generate_document(30000, false); break;
+        case CHECK_INPUT_UNEXPECTED_BRACE:          document = generate_document(30000, true); document.data[document.size * 2 / 3] = '}'; break;
+        case CHECK_INPUT_INVALID_UTF8:              document = generate_document(30000, true); document.data[document.size / 3] = (char)0xC3; break;
+        case CHECK_INPUT_INVALID_NUMBER:            document = generate_document(30000, false); strstr(document.data + document.size / 2, "-")[1] = 'x'; break;
+        default: break;
+    }
+    return document;
+}
+
+void check_deserialize_parallel(FileContent testDocument, SdsfAllocator allocator)
+{
+    printf("sdsf_deserialize_parallel\n");
+    const size_t threadCounts[] = { 1, 2, 3, 8 };
+    for (CheckInput input = 0; input < CHECK_INPUT_COUNT; input++)
+    {
+        const GeneratedDocument document = make_check_input(input, testDocument);
+        SdsfDeserializationError serialError = SDSF_DESERIALIZATION_ERROR_ALL_FINE;
+        for (uint32_t flags = 0; flags <= (SDSF_DESERIALIZER_FLAG_VALIDATE_UTF8 | SDSF_DESERIALIZER_FLAG_PACK_ARRAYS); flags++)
+        {
+            SdsfDeserializedResult serial = {0};
+            serialError = sdsf_deserialize_with_flags(&serial, document.data, document.size, allocator, flags);
+            for (size_t it = 0; it < sizeof(threadCounts) / sizeof(threadCounts[0]); it++)
+            {
+                SdsfDeserializedResult parallel = {0};
+                const SdsfDeserializationError parallelError = sdsf_deserialize_parallel(&parallel, document.data, document.size, allocator, threadCounts[it], flags);
+                CHECK(parallelError == serialError);
+                CHECK(serialError ? error_messages_equal(parallel.errorMsg, serial.errorMsg) : results_equal(&parallel, &serial));
+                sdsf_deserialized_result_free(&parallel);
+            }
+            sdsf_deserialized_result_free(&serial);
+        }
+        printf("   %s : %s\n", CHECK_INPUT_TO_STR[input], SDSF_DESERIALIZATION_ERROR_TO_STR[serialError]);
+        free(document.data);
+    }
+}
+
+void check_deserialize_pipelined(FileContent testDocument, SdsfAllocator allocator)
+{
+    printf("sdsf_deserialize_pipelined\n");
+    for (CheckInput input = 0; input < CHECK_INPUT_COUNT; input++)
+    {
+        const GeneratedDocument document = make_check_input(input, testDocument);
+        SdsfDeserializationError serialError = SDSF_DESERIALIZATION_ERROR_ALL_FINE;
+        for (uint32_t flags = 0; flags <= (SDSF_DESERIALIZER_FLAG_VALIDATE_UTF8 | SDSF_DESERIALIZER_FLAG_PACK_ARRAYS); flags++)
+        {
+            SdsfDeserializedResult serial = {0};
+            SdsfDeserializedResult pipelined = {0};
+            serialError = sdsf_deserialize_with_flags(&serial, document.data, document.size, allocator, flags);
+            const SdsfDeserializationError pipelinedError = sdsf_deserialize_pipelined(&pipelined, document.data, document.size, allocator, flags);
+            CHECK(pipelinedError == serialError);
+            CHECK(serialError ? error_messages_equal(pipelined.errorMsg, serial.errorMsg) : results_equal(&pipelined, &serial));
+            sdsf_deserialized_result_free(&pipelined);
+            sdsf_deserialized_result_free(&serial);
+        }
+        printf("   %s : %s\n", CHECK_INPUT_TO_STR[input], SDSF_DESERIALIZATION_ERROR_TO_STR[serialError]);
+        free(document.data);
+    }
+}
+
+#define CHECK_FILE_PATH "test/check.sdsf"
+#define CHECK_MISSING_FILE_PATH "test/missing.sdsf"
+
+bool write_whole_file(const char* path, const void* data, size_t dataSize)
+{
+    FILE* const file = fopen(path, "wb");
+    if (!file) return false;
+    const bool isWritten = fwrite(data, 1, dataSize, file) == dataSize;
+    return fclose(file) == 0 && isWritten;
+}
+
+void check_load_file(FileContent testDocument, SdsfAllocator allocator)
+{
+    printf("sdsf_load_file\n");
+    for (CheckInput input = 0; input < CHECK_INPUT_COUNT; input++)
+    {
+        const GeneratedDocument document = make_check_input(input, testDocument);
+        CHECK(write_whole_file(CHECK_FILE_PATH, document.data, document.size));
+        SdsfDeserializationError serialError = SDSF_DESERIALIZATION_ERROR_ALL_FINE;
+        for (uint32_t flags = 0; flags <= (SDSF_DESERIALIZER_FLAG_VALIDATE_UTF8 | SDSF_DESERIALIZER_FLAG_PACK_ARRAYS); flags++)
+        {
+            SdsfDeserializedResult serial = {0};
+            SdsfDeserializedResult loaded = {0};
+            serialError = sdsf_deserialize_with_flags(&serial, document.data, document.size, allocator, flags);
+            const SdsfDeserializationError loadedError = sdsf_load_file(&loaded, CHECK_FILE_PATH, allocator, flags);
+            CHECK(loadedError == serialError);
+            CHECK(serialError ? error_messages_equal(loaded.errorMsg, serial.errorMsg) : results_equal(&loaded, &serial));
+            sdsf_deserialized_result_free(&loaded);
+            sdsf_deserialized_result_free(&serial);
+        }
+        printf("   %s : %s\n", CHECK_INPUT_TO_STR[input], SDSF_DESERIALIZATION_ERROR_TO_STR[serialError]);
+        free(document.data);
+    }
+
+    SdsfDeserializedResult missing = {0};
+    CHECK(sdsf_load_file(&missing, CHECK_MISSING_FILE_PATH, allocator, 0) == SDSF_DESERIALIZATION_ERROR_READ_FAILED);
+    sdsf_deserialized_result_free(&missing);
+    printf("   missing file\n");
+
+    //
+    // @NOTE : test document is written to the check file, so every loaded file must be equal to it
+    //
+    SdsfDeserializedResult serial = {0};
+    CHECK(write_whole_file(CHECK_FILE_PATH, testDocument.data, testDocument.size));
+    CHECK(sdsf_deserialize(&serial, testDocument.data, testDocument.size, allocator) == SDSF_DESERIALIZATION_ERROR_ALL_FINE);
+    const char* const paths[] = { CHECK_FILE_PATH, CHECK_FILE_PATH, CHECK_MISSING_FILE_PATH, CHECK_FILE_PATH, CHECK_FILE_PATH };
+    const SdsfAllocator allocators[] = { allocator, allocator, allocator };
+    SdsfDeserializedResult results[5] = {0};
+    SdsfDeserializationError errors[5];
+    CHECK(sdsf_load_files(results, errors, paths, 5, allocators, 3, 0) == SDSF_DESERIALIZATION_ERROR_READ_FAILED);
+    for (size_t it = 0; it < 5; it++)
+    {
+        CHECK(errors[it] == (paths[it] == CHECK_MISSING_FILE_PATH ? SDSF_DESERIALIZATION_ERROR_READ_FAILED : SDSF_DESERIALIZATION_ERROR_ALL_FINE));
+        CHECK(errors[it] || results_equal(&results[it], &serial));
+        sdsf_deserialized_result_free(&results[it]);
+    }
+    sdsf_deserialized_result_free(&serial);
+    printf("   sdsf_load_files\n");
+    remove(CHECK_FILE_PATH);
+}
+
+int open_for_reading(const char* path)
+{
+#ifdef _WIN32
+    return _open(path, _O_RDONLY | _O_BINARY);
+#else
+    return open(path, O_RDONLY);
+#endif
+}
+
+void close_descriptor(int fd)
+{
+#ifdef _WIN32
+    _close(fd);
+#else
+    close(fd);
+#endif
+}
+
+//
+// @NOTE : every event is appended to the log as bytes, so event sequences of different readers
+// can be compared with a single memcmp
+//
+typedef struct
+{
+    char* data;
+    size_t size;
+    size_t capacity;
+    size_t eventCount;
+    size_t stopAfter;   // sink stops reading after this number of events if not 0
+} EventLog;
+
+void event_log_append(EventLog* log, const void* data, size_t dataSize)
+{
+    if (log->size + dataSize > log->capacity)
+    {
+        log->capacity = (log->size + dataSize) * 2;
+        log->data = (char*)realloc(log->data, log->capacity);
+    }
+    if (dataSize) memcpy(log->data + log->size, data, dataSize);
+    log->size += dataSize;
+}
+
+bool record_event(const SdsfEvent* event, void* userData)
+{
+    EventLog* const log = (EventLog*)userData;
+    const SdsfValue* const value = &event->value;
+    const uint32_t header[] = { (uint32_t)event->type, (uint32_t)event->depth, (uint32_t)value->type, value->name ? (uint32_t)strlen(value->name) : UINT32_MAX };
+    event_log_append(log, header, sizeof(header));
+    if (value->name) event_log_append(log, value->name, strlen(value->name));
+
+    if (event->type == SDSF_EVENT_VALUE)
+    {
+        switch (value->type)
+        {
+            case SDSF_VALUE_BOOL:   event_log_append(log, &value->asBool, sizeof(bool)); break;
+            case SDSF_VALUE_STRING: event_log_append(log, &event->stringSize, sizeof(size_t)); event_log_append(log, value->asString, event->stringSize); break;
+            case SDSF_VALUE_BINARY:
+            {
+                const size_t binary[] = { value->asBinary.dataOffset, value->asBinary.dataSize, (size_t)value->asBinary.elementType, (size_t)value->asBinary.isBigEndian, event->binaryData != NULL };
+                event_log_append(log, binary, sizeof(binary));
+                if (event->binaryData) event_log_append(log, event->binaryData, value->asBinary.dataSize);
+            } break;
+            default: event_log_append(log, &value->asUint64, value_type_size(value->type)); break;
+        }
+    }
+
+    log->eventCount++;
+    return log->stopAfter == 0 || log->eventCount < log->stopAfter;
+}
+
+bool event_logs_equal(const EventLog* a, const EventLog* b)
+{
+    return a->eventCount == b->eventCount && a->size == b->size && (a->size == 0 || memcmp(a->data, b->data, a->size) == 0);
+}
+
+void check_read_events_from_fd(FileContent testDocument, SdsfAllocator allocator)
+{
+    printf("sdsf_read_events_from_fd\n");
+    const size_t windowSizes[] = { 1, 7, 256, 4096, 0 };
+    for (CheckInput input = 0; input < CHECK_INPUT_COUNT; input++)
+    {
+        const GeneratedDocument document = make_check_input(input, testDocument);
+        CHECK(write_whole_file(CHECK_FILE_PATH, document.data, document.size));
+        SdsfDeserializationError documentError = SDSF_DESERIALIZATION_ERROR_ALL_FINE;
+        for (uint32_t flags = 0; flags <= SDSF_DESERIALIZER_FLAG_VALIDATE_UTF8; flags++)
+        {
+            //
+            // @NOTE : every input is read once more with a sink which stops in the middle of it
+            //
+            for (size_t stopAfter = 0; stopAfter <= 1000; stopAfter += 1000)
+            {
+                SdsfEventReader reader;
+                EventLog expected = { NULL, 0, 0, 0, stopAfter };
+                const SdsfDeserializationError error = sdsf_read_events(&reader, document.data, document.size, allocator, (SdsfEventSink){ record_event, &expected }, flags);
+                const char* const expectedErrorMsg = reader.errorMsg;
+                if (stopAfter == 0) documentError = error;
+                for (size_t it = 0; it < sizeof(windowSizes) / sizeof(windowSizes[0]); it++)
+                {
+                    //
+                    // @NOTE : small windows are checked only on small inputs, window is refilled too often for large ones
+                    //
+                    if (windowSizes[it] && windowSizes[it] < 256 && document.size > SDSF_EVENT_READER_WINDOW_SIZE) continue;
+
+                    EventLog events = { NULL, 0, 0, 0, stopAfter };
+                    const int fd = open_for_reading(CHECK_FILE_PATH);
+                    CHECK(fd >= 0);
+                    CHECK(sdsf_read_events_from_fd(&reader, fd, windowSizes[it], allocator, (SdsfEventSink){ record_event, &events }, flags) == error);
+                    CHECK(error_messages_equal(reader.errorMsg, expectedErrorMsg));
+                    CHECK(event_logs_equal(&events, &expected));
+                    close_descriptor(fd);
+                    free(events.data);
+                }
+                free(expected.data);
+            }
+        }
+        printf("   %s : %s\n", CHECK_INPUT_TO_STR[input], SDSF_DESERIALIZATION_ERROR_TO_STR[documentError]);
+        free(document.data);
+    }
+    remove(CHECK_FILE_PATH);
+}
+
+typedef struct
+{
+    char* data;
+    size_t size;
+    size_t capacity;
+} MemoryOutput;
+
+bool write_to_memory(const void* data, size_t dataSize, void* userData)
+{
+    MemoryOutput* const output = (MemoryOutput*)userData;
+    if (output->size + dataSize > output->capacity)
+    {
+        output->capacity = (output->size + dataSize) * 2;
+        output->data = (char*)realloc(output->data, output->capacity);
+    }
+    if (dataSize) memcpy(output->data + output->size, data, dataSize);
+    output->size += dataSize;
+    return true;
+}
+
+//
+// @NOTE : data is passed to the compressor in pieces of different sizes, so frames are cut at different places
+//
+MemoryOutput compress_document(const void* data, size_t dataSize, size_t pieceSize, SdsfAllocator allocator)
+{
+    MemoryOutput output = {0};
+    SdsfCompressor compressor;
+    sdsf_compressor_begin(&compressor, allocator, sdsf_lz_codec(), (SdsfOutputSink){ write_to_memory, &output });
+    const SdsfOutputSink sink = sdsf_compressor_sink(&compressor);
+    for (size_t offset = 0; offset < dataSize; offset += pieceSize)
+    {
+        CHECK(sink.write((const char*)data + offset, dataSize - offset < pieceSize ? dataSize - offset : pieceSize, sink.userData));
+    }
+    CHECK(sdsf_compressor_end(&compressor));
+    return output;
+}
+
+SdsfDeserializationError read_compressed_file_events(SdsfEventReader* reader, size_t windowSize, EventLog* events, uint32_t flags, SdsfAllocator allocator)
+{
+    const int fd = open_for_reading(CHECK_FILE_PATH);
+    CHECK(fd >= 0);
+    const SdsfDeserializationError error = sdsf_read_compressed_events_from_fd(reader, fd, windowSize, sdsf_lz_codec(), allocator, (SdsfEventSink){ record_event, events }, flags);
+    close_descriptor(fd);
+    return error;
 }
 
-void main()
+void check_read_compressed_events(FileContent testDocument, SdsfAllocator allocator)
+{
+    printf("sdsf_read_compressed_events_from_fd\n");
+    const size_t windowSizes[] = { 13, 4096, 0 };
+    const size_t pieceSizes[] = { 1000, 100000, 1 << 24 };
+    for (CheckInput input = 0; input < CHECK_INPUT_COUNT; input++)
+    {
+        const GeneratedDocument document = make_check_input(input, testDocument);
+        SdsfDeserializationError documentError = SDSF_DESERIALIZATION_ERROR_ALL_FINE;
+        for (uint32_t flags = 0; flags <= SDSF_DESERIALIZER_FLAG_VALIDATE_UTF8; flags++)
+        {
+            SdsfEventReader reader;
+            EventLog expected = {0};
+            documentError = sdsf_read_events(&reader, document.data, document.size, allocator, (SdsfEventSink){ record_event, &expected }, flags);
+            const char* const expectedErrorMsg = reader.errorMsg;
+            for (size_t it = 0; it < sizeof(pieceSizes) / sizeof(pieceSizes[0]); it++)
+            {
+                MemoryOutput compressed = compress_document(document.data, document.size, pieceSizes[it], allocator);
+                CHECK(write_whole_file(CHECK_FILE_PATH, compressed.data, compressed.size));
+                for (size_t windowIt = 0; windowIt < sizeof(windowSizes) / sizeof(windowSizes[0]); windowIt++)
+                {
+                    if (windowSizes[windowIt] && windowSizes[windowIt] < 256 && document.size > SDSF_EVENT_READER_WINDOW_SIZE) continue;
+
+                    //
+                    // @NOTE : binary data is read through the blob position from the stream trailer, so equal
+                    // binary events (which include binary data) mean that trailer was written and found correctly
+                    //
+                    EventLog events = {0};
+                    CHECK(read_compressed_file_events(&reader, windowSizes[windowIt], &events, flags, allocator) == documentError);
+                    CHECK(error_messages_equal(reader.errorMsg, expectedErrorMsg));
+                    CHECK(event_logs_equal(&events, &expected));
+                    free(events.data);
+                }
+                free(compressed.data);
+            }
+            free(expected.data);
+        }
+        printf("   %s : %s\n", CHECK_INPUT_TO_STR[input], SDSF_DESERIALIZATION_ERROR_TO_STR[documentError]);
+        free(document.data);
+    }
+
+    //
+    // Stream without trailer is still valid (blob is found by decompressing the rest of stream), truncated and
+    // corrupted streams and uncompressed file must be rejected. Trailer is 28 bytes long and follows 8 byte end frame header
+    //
+    const GeneratedDocument document = make_check_input(CHECK_INPUT_LARGE, testDocument);
+    MemoryOutput compressed = compress_document(document.data, document.size, 4096, allocator);
+    SdsfEventReader reader;
+    EventLog expected = {0};
+    EventLog events = {0};
+    CHECK(sdsf_read_events(&reader, document.data, document.size, allocator, (SdsfEventSink){ record_event, &expected }, 0) == SDSF_DESERIALIZATION_ERROR_ALL_FINE);
+
+    CHECK(write_whole_file(CHECK_FILE_PATH, compressed.data, compressed.size - 28));
+    CHECK(read_compressed_file_events(&reader, 0, &events, 0, allocator) == SDSF_DESERIALIZATION_ERROR_ALL_FINE);
+    CHECK(event_logs_equal(&events, &expected));
+    events.size = events.eventCount = 0;
+    printf("   stream without trailer\n");
+
+    CHECK(write_whole_file(CHECK_FILE_PATH, compressed.data, compressed.size - 28 - 8 - 3));
+    CHECK(read_compressed_file_events(&reader, 0, &events, 0, allocator) == SDSF_DESERIALIZATION_ERROR_DECOMPRESSION_FAILED);
+    events.size = events.eventCount = 0;
+    printf("   truncated stream\n");
+
+    compressed.data[compressed.size / 2] ^= 0x5A;
+    compressed.data[compressed.size / 2 + 1] ^= 0x5A;
+    CHECK(write_whole_file(CHECK_FILE_PATH, compressed.data, compressed.size));
+    CHECK(read_compressed_file_events(&reader, 0, &events, 0, allocator) == SDSF_DESERIALIZATION_ERROR_DECOMPRESSION_FAILED);
+    events.size = events.eventCount = 0;
+    printf("   corrupted stream\n");
+
+    CHECK(write_whole_file(CHECK_FILE_PATH, document.data, document.size));
+    CHECK(read_compressed_file_events(&reader, 0, &events, 0, allocator) == SDSF_DESERIALIZATION_ERROR_DECOMPRESSION_FAILED);
+    CHECK(events.eventCount == 0);
+    printf("   uncompressed file\n");
+
+    free(events.data);
+    free(expected.data);
+    free(compressed.data);
+    free(document.data);
+    remove(CHECK_FILE_PATH);
+}
+
+void serialize_check_document(SdsfSerializer* sdsf, size_t valueCount)
+{
+    uint8_t bytes[3000];
+    double doubles[100];
+    for (size_t it = 0; it < sizeof(bytes); it++) bytes[it] = (uint8_t)(it * 13);
+    for (size_t it = 0; it < sizeof(doubles) / sizeof(doubles[0]); it++) doubles[it] = it * 0.1;
+
+    sdsf_serialize_array_start(sdsf, "values");
+    for (size_t it = 0; it < valueCount; it++) sdsf_serialize_int(sdsf, NULL, (int32_t)(it * 7));
+    sdsf_serialize_array_end(sdsf);
+    for (size_t it = 0; it < valueCount / 1000; it++)
+    {
+        sdsf_serialize_composite_start(sdsf, "item");
+            serialize_bunch_of_stuff(sdsf);
+            sdsf_serialize_binary(sdsf, "bytes", bytes, sizeof(bytes));
+            sdsf_serialize_binary_f64(sdsf, "doubles", doubles, it % 100);
+        sdsf_serialize_composite_end(sdsf);
+    }
+}
+
+void check_serializer_begin_mapped(SdsfAllocator allocator)
+{
+    printf("sdsf_serializer_begin_mapped\n");
+    const size_t valueCounts[] = { 0, 10, 300000 };
+    for (size_t it = 0; it < sizeof(valueCounts) / sizeof(valueCounts[0]); it++)
+    {
+        SdsfSerializer buffered = sdsf_serializer_begin(allocator);
+        SdsfSerializer mapped = sdsf_serializer_begin_mapped(allocator, CHECK_FILE_PATH);
+        serialize_check_document(&buffered, valueCounts[it]);
+        serialize_check_document(&mapped, valueCounts[it]);
+
+        SdsfSerializedResult bufferedResult = {0};
+        SdsfSerializedResult mappedResult = {0};
+        CHECK(sdsf_serializer_end(&buffered, &bufferedResult) == SDSF_SERIALIZATION_ERROR_ALL_FINE);
+        const SdsfSerializationError mappedError = sdsf_serializer_end(&mapped, &mappedResult);
+        CHECK(mappedError == SDSF_SERIALIZATION_ERROR_ALL_FINE);
+        CHECK(mappedResult.buffer == NULL);
+        if (!mappedError)
+        {
+            const FileContent file = read_whole_file(CHECK_FILE_PATH);
+            CHECK(file.size == bufferedResult.bufferSize && memcmp(file.data, bufferedResult.buffer, file.size) == 0);
+            free((void*)file.data);
+        }
+        printf("   %zu values : %zu bytes\n", valueCounts[it], bufferedResult.bufferSize);
+        sdsf_serialized_result_free(&bufferedResult);
+    }
+
+    //
+    // Errors must be the same as errors of the buffered serializer
+    //
+    SdsfSerializationError errors[2][3];
+    for (size_t isMapped = 0; isMapped < 2; isMapped++)
+    {
+        SdsfSerializedResult result = {0};
+        SdsfSerializer unfinished = isMapped ? sdsf_serializer_begin_mapped(allocator, CHECK_FILE_PATH) : sdsf_serializer_begin(allocator);
+        sdsf_serialize_array_start(&unfinished, "values");
+        errors[isMapped][0] = sdsf_serializer_end(&unfinished, &result);
+        sdsf_serialized_result_free(&result);
+
+        SdsfSerializer invalidName = isMapped ? sdsf_serializer_begin_mapped(allocator, CHECK_FILE_PATH) : sdsf_serializer_begin(allocator);
+        errors[isMapped][1] = sdsf_serialize_int(&invalidName, "invalid name", 1);
+        errors[isMapped][2] = sdsf_serializer_end(&invalidName, &result);
+        sdsf_serialized_result_free(&result);
+    }
+    CHECK(errors[0][0] == SDSF_SERIALIZATION_ERROR_UNFINISHED_ARRAY_OR_COMPOSITE_VALUES && errors[1][0] == errors[0][0]);
+    CHECK(errors[0][1] == SDSF_SERIALIZATION_ERROR_INVALID_NAME && errors[1][1] == errors[0][1]);
+    CHECK(errors[1][2] == errors[0][2]);
+    printf("   unfinished array, invalid name\n");
+
+    SdsfSerializedResult result = {0};
+    SdsfSerializer badPath = sdsf_serializer_begin_mapped(allocator, "test/missing_directory/check.sdsf");
+    serialize_check_document(&badPath, 10);
+    CHECK(sdsf_serializer_end(&badPath, &result) == SDSF_SERIALIZATION_ERROR_OUTPUT_FAILED);
+    printf("   missing directory\n");
+    remove(CHECK_FILE_PATH);
+}
+
+//
+// @NOTE : every published document has the same generation number in both values and in the string, so reader
+// which sees a half-built, already freed or mixed document fails the check. Readers stop when they see the last generation
+//
+#define SLOT_GENERATION_COUNT 2000
+#define SLOT_READER_COUNT 4
+
+typedef struct
+{
+    SdsfDocumentSlot* slot;
+    size_t readCount;
+    size_t badReadCount;
+} SlotReader;
+
+bool is_slot_document_valid(const SdsfSharedDocument* document, int32_t* generation)
+{
+    const SdsfDeserializedResult* const result = &document->result;
+    if (result->topLevelValues.size != 3) return false;
+    char expected[64];
+    *generation = result->topLevelValues.ptr[0]->asInt;
+    sprintf(expected, "generation %d", *generation);
+    return result->topLevelValues.ptr[1]->asInt == *generation && strcmp(result->topLevelValues.ptr[2]->asString, expected) == 0;
+}
+
+SdsfSharedDocument* make_slot_document(int32_t generation, SdsfAllocator allocator)
+{
+    char text[128];
+    const int size = sprintf(text, "first %d second %d text \"generation %d\"", generation, generation, generation);
+    SdsfDeserializedResult result = {0};
+    CHECK(sdsf_deserialize(&result, text, (size_t)size, allocator) == SDSF_DESERIALIZATION_ERROR_ALL_FINE);
+    return sdsf_share_result(&result);
+}
+
+#ifdef _WIN32
+DWORD WINAPI slot_reader_thread(void* userData)
+#else
+void* slot_reader_thread(void* userData)
+#endif
+{
+    SlotReader* const reader = (SlotReader*)userData;
+    int32_t lastGeneration = -1;
+    while (lastGeneration != SLOT_GENERATION_COUNT - 1)
+    {
+        SdsfSharedDocument* const document = sdsf_document_slot_acquire(reader->slot);
+        if (!document) continue;
+
+        int32_t generation;
+        if (!is_slot_document_valid(document, &generation) || generation < lastGeneration)
+        {
+            reader->badReadCount++;
+        }
+        lastGeneration = generation;
+        reader->readCount++;
+        sdsf_shared_document_release(document);
+    }
+    return 0;
+}
+
+void check_document_slot(SdsfAllocator allocator)
+{
+    printf("sdsf_document_slot_publish / sdsf_document_slot_acquire\n");
+
+    //
+    // Single thread : slot and readers hold their own references, previous document stays valid while it is held
+    //
+    SdsfDocumentSlot slot = {0};
+    int32_t generation;
+    CHECK(sdsf_document_slot_acquire(&slot) == NULL);
+    SdsfSharedDocument* const first = make_slot_document(1, allocator);
+    SdsfSharedDocument* const second = make_slot_document(2, allocator);
+    CHECK(first->refCount == 1);
+    sdsf_document_slot_publish(&slot, first);
+    CHECK(first->refCount == 2);
+    SdsfSharedDocument* const acquired = sdsf_document_slot_acquire(&slot);
+    CHECK(acquired == first && first->refCount == 3);
+    sdsf_document_slot_publish(&slot, second);
+    CHECK(first->refCount == 2 && second->refCount == 2);
+    CHECK(is_slot_document_valid(acquired, &generation) && generation == 1);
+    sdsf_shared_document_release(acquired);
+    sdsf_shared_document_release(first);
+    SdsfSharedDocument* const acquiredSecond = sdsf_document_slot_acquire(&slot);
+    CHECK(acquiredSecond == second && is_slot_document_valid(acquiredSecond, &generation) && generation == 2);
+    sdsf_shared_document_release(acquiredSecond);
+    sdsf_shared_document_release(second);
+    sdsf_document_slot_publish(&slot, NULL);
+    CHECK(sdsf_document_slot_acquire(&slot) == NULL);
+    printf("   references\n");
+
+    //
+    // Readers on other threads while documents are replaced
+    //
+    SlotReader readers[SLOT_READER_COUNT] = {0};
+#ifdef _WIN32
+    HANDLE threads[SLOT_READER_COUNT];
+#else
+    pthread_t threads[SLOT_READER_COUNT];
+#endif
+    for (size_t it = 0; it < SLOT_READER_COUNT; it++)
+    {
+        readers[it].slot = &slot;
+#ifdef _WIN32
+        threads[it] = CreateThread(NULL, 0, slot_reader_thread, &readers[it], 0, NULL);
+#else
+        pthread_create(&threads[it], NULL, slot_reader_thread, &readers[it]);
+#endif
+    }
+    for (int32_t it = 0; it < SLOT_GENERATION_COUNT; it++)
+    {
+        SdsfSharedDocument* const document = make_slot_document(it, allocator);
+        sdsf_document_slot_publish(&slot, document);
+        sdsf_shared_document_release(document);
+    }
+    size_t readCount = 0;
+    for (size_t it = 0; it < SLOT_READER_COUNT; it++)
+    {
+#ifdef _WIN32
+        WaitForSingleObject(threads[it], INFINITE);
+        CloseHandle(threads[it]);
+#else
+        pthread_join(threads[it], NULL);
+#endif
+        CHECK(readers[it].badReadCount == 0);
+        readCount += readers[it].readCount;
+    }
+    sdsf_document_slot_publish(&slot, NULL);
+    CHECK(slot.document == NULL && slot.readerCounts[0] == 0 && slot.readerCounts[1] == 0 && slot.isPublishing == 0);
+    printf("   %d generations, %zu reads on %d threads\n", SLOT_GENERATION_COUNT, readCount, SLOT_READER_COUNT);
+}
+
+//
+// @NOTE : json doesn't keep number types (floats come back as the closest doubles and integers as the smallest type
+// they fit into) and binary values are written again one after another, so values are compared by their json meaning
+//
+void number_to_text(const SdsfValue* value, char* text)
+{
+    switch (value->type)
+    {
+        case SDSF_VALUE_INT:    sprintf(text, "%d", value->asInt); break;
+        case SDSF_VALUE_INT64:  sprintf(text, "%lld", (long long)value->asInt64); break;
+        case SDSF_VALUE_UINT64: sprintf(text, "%llu", (unsigned long long)value->asUint64); break;
+        case SDSF_VALUE_DOUBLE: sprintf(text, "%.17g fraction", value->asDouble); break;
+        default:                text[0] = '\0'; break;
+    }
+}
+
+bool values_equal_after_json(const SdsfValue* a, const SdsfDeserializedResult* aResult, const SdsfValue* b, const SdsfDeserializedResult* bResult)
+{
+    if ((a->name == NULL) != (b->name == NULL)) return false;
+    if (a->name && strcmp(a->name, b->name) != 0) return false;
+    if (a->type == SDSF_VALUE_FLOAT)
+    {
+        return b->type == SDSF_VALUE_DOUBLE && (float)b->asDouble == a->asFloat;
+    }
+    if (value_type_size(a->type))
+    {
+        char aText[64], bText[64];
+        number_to_text(a, aText);
+        number_to_text(b, bText);
+        return value_type_size(b->type) && strcmp(aText, bText) == 0;
+    }
+    if (a->type != b->type) return false;
+
+    switch (a->type)
+    {
+        case SDSF_VALUE_BOOL:   return a->asBool == b->asBool;
+        case SDSF_VALUE_STRING: return sdsf_string_size(a) == sdsf_string_size(b) && memcmp(a->asString, b->asString, sdsf_string_size(a)) == 0;
+        case SDSF_VALUE_BINARY:
+        {
+            return a->asBinary.dataSize == b->asBinary.dataSize && a->asBinary.elementType == b->asBinary.elementType &&
+                   a->asBinary.isBigEndian == b->asBinary.isBigEndian &&
+                   memcmp((const char*)aResult->binaryData + a->asBinary.dataOffset, (const char*)bResult->binaryData + b->asBinary.dataOffset, a->asBinary.dataSize) == 0;
+        }
+        case SDSF_VALUE_ARRAY:
+        case SDSF_VALUE_COMPOSITE:
+        {
+            const SdsfValuePtrArray* const aChilds = a->type == SDSF_VALUE_ARRAY ? &a->asArray.childs : &a->asComposite.childs;
+            const SdsfValuePtrArray* const bChilds = b->type == SDSF_VALUE_ARRAY ? &b->asArray.childs : &b->asComposite.childs;
+            if (aChilds->size != bChilds->size) return false;
+            for (size_t it = 0; it < aChilds->size; it++)
+            {
+                if (!values_equal_after_json(aChilds->ptr[it], aResult, bChilds->ptr[it], bResult)) return false;
+            }
+            return true;
+        }
+        default: return true;
+    }
+}
+
+bool results_equal_after_json(const SdsfDeserializedResult* a, const SdsfDeserializedResult* b)
+{
+    if (a->topLevelValues.size != b->topLevelValues.size) return false;
+    for (size_t it = 0; it < a->topLevelValues.size; it++)
+    {
+        if (!values_equal_after_json(a->topLevelValues.ptr[it], a, b->topLevelValues.ptr[it], b)) return false;
+    }
+    return true;
+}
+
+typedef struct
+{
+    const char* json;
+    SdsfTranscodingError error;
+} MalformedJson;
+
+void check_transcode_json(FileContent testDocument, SdsfAllocator allocator)
+{
+    printf("sdsf_transcode_to_json / sdsf_transcode_from_json\n");
+    for (CheckInput input = 0; input < CHECK_INPUT_COUNT; input++)
+    {
+        const GeneratedDocument document = make_check_input(input, testDocument);
+        SdsfDeserializedResult serial = {0};
+        const SdsfDeserializationError serialError = sdsf_deserialize_with_flags(&serial, document.data, document.size, allocator, SDSF_DESERIALIZER_FLAG_VALIDATE_UTF8);
+
+        SdsfTranscoder transcoder = { allocator };
+        MemoryOutput json = {0};
+        const SdsfTranscodingError toJsonError = sdsf_transcode_to_json(&transcoder, document.data, document.size, (SdsfOutputSink){ write_to_memory, &json });
+        CHECK(toJsonError == (serialError ? SDSF_TRANSCODING_ERROR_INVALID_SDSF : SDSF_TRANSCODING_ERROR_ALL_FINE));
+        if (serialError)
+        {
+            CHECK(error_messages_equal(transcoder.errorMsg, serial.errorMsg));
+        }
+        else
+        {
+            //
+            // Sdsf -> json -> sdsf must keep values and the second trip to json must give the same json
+            //
+            MemoryOutput sdsf = {0};
+            CHECK(sdsf_transcode_from_json(&transcoder, json.data, json.size, (SdsfOutputSink){ write_to_memory, &sdsf }) == SDSF_TRANSCODING_ERROR_ALL_FINE);
+            SdsfDeserializedResult roundTrip = {0};
+            CHECK(sdsf_deserialize(&roundTrip, sdsf.data, sdsf.size, allocator) == SDSF_DESERIALIZATION_ERROR_ALL_FINE);
+            CHECK(results_equal_after_json(&serial, &roundTrip));
+            MemoryOutput secondJson = {0};
+            CHECK(sdsf_transcode_to_json(&transcoder, sdsf.data, sdsf.size, (SdsfOutputSink){ write_to_memory, &secondJson }) == SDSF_TRANSCODING_ERROR_ALL_FINE);
+            CHECK(secondJson.size == json.size && memcmp(secondJson.data, json.data, json.size) == 0);
+
+            //
+            // Binary data in the sidecar must give the same sdsf as binary data in base64
+            //
+            MemoryOutput sidecar = {0};
+            MemoryOutput sidecarJson = {0};
+            MemoryOutput sidecarSdsf = {0};
+            SdsfTranscoder sidecarTranscoder = { allocator, SDSF_TRANSCODER_FLAG_BINARY_SIDECAR, { write_to_memory, &sidecar } };
+            CHECK(sdsf_transcode_to_json(&sidecarTranscoder, document.data, document.size, (SdsfOutputSink){ write_to_memory, &sidecarJson }) == SDSF_TRANSCODING_ERROR_ALL_FINE);
+            sidecarTranscoder.sidecarData = sidecar.data;
+            sidecarTranscoder.sidecarDataSize = sidecar.size;
+            CHECK(sdsf_transcode_from_json(&sidecarTranscoder, sidecarJson.data, sidecarJson.size, (SdsfOutputSink){ write_to_memory, &sidecarSdsf }) == SDSF_TRANSCODING_ERROR_ALL_FINE);
+            CHECK(sidecarSdsf.size == sdsf.size && memcmp(sidecarSdsf.data, sdsf.data, sdsf.size) == 0);
+
+            //
+            // Json cut at any place is never a complete top level object
+            //
+            const size_t cuts[] = { 1, json.size / 3, json.size / 2, json.size - 1 };
+            for (size_t it = 0; it < sizeof(cuts) / sizeof(cuts[0]); it++)
+            {
+                MemoryOutput cutSdsf = {0};
+                CHECK(sdsf_transcode_from_json(&transcoder, json.data, cuts[it], (SdsfOutputSink){ write_to_memory, &cutSdsf }) != SDSF_TRANSCODING_ERROR_ALL_FINE);
+                CHECK(transcoder.errorMsg != NULL);
+                free(cutSdsf.data);
+            }
+
+            sdsf_deserialized_result_free(&roundTrip);
+            free(sidecar.data);
+            free(sidecarJson.data);
+            free(sidecarSdsf.data);
+            free(secondJson.data);
+            free(sdsf.data);
+        }
+        printf("   %s : %s, %zu bytes of json\n", CHECK_INPUT_TO_STR[input], SDSF_TRANSCODING_ERROR_TO_STR[toJsonError], toJsonError ? 0 : json.size);
+        sdsf_deserialized_result_free(&serial);
+        free(json.data);
+        free(document.data);
+    }
+
+    const MalformedJson malformed[] =
+    {
+        { "{\"ab\": 1",                         SDSF_TRANSCODING_ERROR_INVALID_JSON },
+        { "{\"ab\" 1}",                         SDSF_TRANSCODING_ERROR_INVALID_JSON },
+        { "{\"ab\": 1,}",                       SDSF_TRANSCODING_ERROR_INVALID_JSON },
+        { "{\"ab\": nul}",                      SDSF_TRANSCODING_ERROR_INVALID_JSON },
+        { "{\"ab\": \"unterminated}",           SDSF_TRANSCODING_ERROR_INVALID_JSON },
+        { "{\"ab\": \"\\x\"}",                  SDSF_TRANSCODING_ERROR_INVALID_JSON },
+        { "{\"ab\": 1} {",                      SDSF_TRANSCODING_ERROR_INVALID_JSON },
+        { "{\"ab\": null}",                     SDSF_TRANSCODING_ERROR_UNSUPPORTED_VALUE },
+        { "[1, 2]",                             SDSF_TRANSCODING_ERROR_UNSUPPORTED_VALUE },
+        { "{\"ab\": -9223372036854775809}",     SDSF_TRANSCODING_ERROR_UNSUPPORTED_VALUE },
+        { "{\"ab\": {\"$binary\": \"!!!!\"}}",  SDSF_TRANSCODING_ERROR_INVALID_BINARY },
+        { "{\"ab\": {\"$binaryRef\": [0, 4]}}", SDSF_TRANSCODING_ERROR_INVALID_BINARY },
+        { "{\"ab\": {\"$binary\": \"AAA=\", \"$type\": \"f32\"}}", SDSF_TRANSCODING_ERROR_INVALID_BINARY },
+        { "{\"invalid name\": 1}",              SDSF_TRANSCODING_ERROR_SERIALIZATION_FAILED },
+    };
+    for (size_t it = 0; it < sizeof(malformed) / sizeof(malformed[0]); it++)
+    {
+        SdsfTranscoder transcoder = { allocator };
+        MemoryOutput sdsf = {0};
+        const SdsfTranscodingError error = sdsf_transcode_from_json(&transcoder, malformed[it].json, strlen(malformed[it].json), (SdsfOutputSink){ write_to_memory, &sdsf });
+        CHECK(error == malformed[it].error && transcoder.errorMsg != NULL);
+        printf("   %s : %s\n", malformed[it].json, SDSF_TRANSCODING_ERROR_TO_STR[error]);
+        free(sdsf.data);
+    }
+}
+
+//
+// Large arrays of numbers are converted by several threads if SDSF_DESERIALIZER_FLAG_PACK_ARRAYS is set,
+// arrays which can't be packed must fall back to the same result as the serial deserializer
+//
+typedef enum
+{
+    LARGE_ARRAY_INT,
+    LARGE_ARRAY_FLOAT,
+    LARGE_ARRAY_DOUBLE,
+    LARGE_ARRAY_INT64,
+    LARGE_ARRAY_MIXED,
+    LARGE_ARRAY_BOOL,
+    LARGE_ARRAY_NESTED,
+    LARGE_ARRAY_TRAILING_COMMA,
+    LARGE_ARRAY_MISSING_MEMBER,
+    LARGE_ARRAY_INVALID_MEMBER,
+    LARGE_ARRAY_COUNT,
+} LargeArrayKind;
+
+const char* LARGE_ARRAY_KIND_TO_STR[] =
+{
+    "ints",
+    "floats",
+    "doubles",
+    "int64s",
+    "ints and one float",
+    "bools",
+    "numbers and one nested array",
+    "trailing comma",
+    "missing member",
+    "invalid member",
+};
+
+GeneratedDocument generate_large_array_document(LargeArrayKind kind, size_t memberCount)
+{
+    char* const data = (char*)malloc(memberCount * 32 + 256);
+    size_t size = sprintf(data, "header { name \"large [ array\" } count %zu\nnumbers\n[", memberCount);
+    for (size_t it = 0; it < memberCount; it++)
+    {
+        const char* const separator = it == 0 ? "" : (it % 7 == 0 ? ",\n    " : ", ");
+        switch (kind)
+        {
+            case LARGE_ARRAY_INT:            size += sprintf(data + size, "%s%d", separator, (int)(it * 7) - 100000); break;
+            case LARGE_ARRAY_FLOAT:          size += sprintf(data + size, "%s%g", separator, it * 0.25 - 1000.5); break;
+            case LARGE_ARRAY_DOUBLE:         size += sprintf(data + size, "%s%.17gd", separator, it * 0.1); break;
+            case LARGE_ARRAY_INT64:          size += sprintf(data + size, "%s%lld", separator, (long long)it * -1000000007LL); break;
+            case LARGE_ARRAY_MIXED:          size += sprintf(data + size, "%s%s", separator, it == memberCount - 3 ? "2.5" : "7"); break;
+            case LARGE_ARRAY_BOOL:           size += sprintf(data + size, "%s%s", separator, it % 3 ? "t" : "f"); break;
+            case LARGE_ARRAY_NESTED:         size += sprintf(data + size, "%s%s", separator, it == memberCount / 2 ? "[1, 2]" : "-3"); break;
+            case LARGE_ARRAY_TRAILING_COMMA: size += sprintf(data + size, "%zu, ", it); break;
+            case LARGE_ARRAY_MISSING_MEMBER: size += sprintf(data + size, "%s%zu", it == memberCount / 2 ? ", ," : separator, it); break;
+            case LARGE_ARRAY_INVALID_MEMBER: size += sprintf(data + size, "%s%s", separator, it == memberCount / 2 ? "1x" : "7"); break;
+            default: break;
+        }
+    }
+    size += sprintf(data + size, "]\ntail [1, 2, 3] other 5\n");
+    return (GeneratedDocument){ data, size };
+}
+
+void check_deserialize_large_array(SdsfAllocator allocator)
+{
+    printf("sdsf_deserialize_parallel, large arrays\n");
+    for (LargeArrayKind kind = 0; kind < LARGE_ARRAY_COUNT; kind++)
+    {
+        const GeneratedDocument document = generate_large_array_document(kind, 60000);
+        SdsfDeserializationError serialError = SDSF_DESERIALIZATION_ERROR_ALL_FINE;
+        for (uint32_t flags = 0; flags <= (SDSF_DESERIALIZER_FLAG_VALIDATE_UTF8 | SDSF_DESERIALIZER_FLAG_PACK_ARRAYS); flags++)
+        {
+            SdsfDeserializedResult serial = {0};
+            SdsfDeserializedResult parallel = {0};
+            serialError = sdsf_deserialize_with_flags(&serial, document.data, document.size, allocator, flags);
+            const SdsfDeserializationError parallelError = sdsf_deserialize_parallel(&parallel, document.data, document.size, allocator, 4, flags);
+            CHECK(parallelError == serialError);
+            CHECK(serialError ? error_messages_equal(parallel.errorMsg, serial.errorMsg) : results_equal(&parallel, &serial));
+            sdsf_deserialized_result_free(&parallel);
+            sdsf_deserialized_result_free(&serial);
+        }
+        printf("   %s : %s\n", LARGE_ARRAY_KIND_TO_STR[kind], SDSF_DESERIALIZATION_ERROR_TO_STR[serialError]);
+        free(document.data);
+    }
+}
+
+int main(void)
 {
     const SdsfAllocator allocator = { alloc, dealloc, NULL };
 
@@ -105,9 +1188,15 @@ void main()
     printf(" TEST DESERIALIZATION FROM FILE\n");
     printf(" ===================================================================\n\n");
 
-    const FileContent file = read_whole_file("test\\document.sdsf");
+    const FileContent file = read_whole_file("test/document.sdsf");
     deserialize_and_print(file.data, file.size, allocator);
 
+    printf("\n ===================================================================\n");
+    printf(" TEST COLUMNAR EXTRACTION\n");
+    printf(" ===================================================================\n\n");
+
+    extract_and_print_columns(file.data, file.size, allocator);
+
     printf("\n ===================================================================\n");
     printf(" TEST SERIALIZATION\n");
     printf(" ===================================================================\n\n");
@@ -115,6 +1204,9 @@ void main()
     SdsfSerializer sdsf = sdsf_serializer_begin(allocator);
 
     const char* binaryData = "This is stored in binary section";
+    const float floatsData[] = { 0.5f, 1.0f, 1.5f, 2.0f };
+    const float matrixData[] = { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+    const size_t matrixShape[] = { 2, 3 };
 
     //
     // @NOTE : here we don't check SdsfSerializationError's because we know that all commands will succeed
@@ -136,6 +1228,16 @@ void main()
         //
         sdsf_serialize_binary(&sdsf, "binaryValue", binaryData, strlen(binaryData) + 1);
     sdsf_serialize_composite_end(&sdsf);
+    //
+    // @NOTE : typed binary values are stored in the same binary section, but they can be accessed
+    // in place using sdsf_binary_as_* functions (see sdsf_binary_as_f32)
+    //
+    sdsf_serialize_binary_f32(&sdsf, "floatsInBinary", floatsData, sizeof(floatsData) / sizeof(floatsData[0]));
+    //
+    // @NOTE : tensors are written as nested arrays and read back as SDSF_VALUE_TENSOR
+    // if SDSF_DESERIALIZER_FLAG_PACK_ARRAYS is used
+    //
+    sdsf_serialize_tensor(&sdsf, "matrix", SDSF_VALUE_FLOAT, matrixData, matrixShape, 2);
 
     SdsfSerializedResult sr = {0};
     SdsfSerializationError error = sdsf_serializer_end(&sdsf, &sr);
@@ -152,5 +1254,41 @@ void main()
 
     deserialize_and_print(sr.buffer, sr.bufferSize, allocator);
 
+    printf("\n ===================================================================\n");
+    printf(" TEST TRANSCODING TO JSON\n");
+    printf(" ===================================================================\n\n");
+
+    //
+    // @NOTE : transcoder doesn't build SdsfValue tree, json is written to the output sink
+    // while sdsf data is being read. Binary values are written as base64 strings
+    //
+    SdsfTranscoder transcoder = { allocator };
+    const SdsfOutputSink stdoutSink = { write_to_stdout, NULL };
+    const SdsfTranscodingError transcodingError = sdsf_transcode_to_json(&transcoder, sr.buffer, sr.bufferSize, stdoutSink);
+    if (transcodingError)
+    {
+        printf("Transcoding error : %s. Description : %s\n", SDSF_TRANSCODING_ERROR_TO_STR[transcodingError], transcoder.errorMsg);
+    }
+    printf("\n");
+
+    printf("\n ===================================================================\n");
+    printf(" TEST DIFFERENTIAL CHECKS\n");
+    printf(" ===================================================================\n\n");
+
+    check_deserialize_parallel(file, allocator);
+    check_deserialize_large_array(allocator);
+    check_deserialize_pipelined(file, allocator);
+    check_load_file(file, allocator);
+    check_read_events_from_fd(file, allocator);
+    check_read_compressed_events(file, allocator);
+    check_serializer_begin_mapped(allocator);
+    check_document_slot(allocator);
+    check_transcode_json(file, allocator);
+
+    if (failedChecks) printf("\n%d checks failed\n", failedChecks);
+    else              printf("\nAll checks passed\n");
+
     sdsf_serialized_result_free(&sr);
+    free((void*)file.data);
+    return failedChecks;
 }